@@ -5,9 +5,12 @@
 
 @class BFTask;
 @class BFCancellationToken;
+@class BFExecutor;
 @class GINIPartialDocumentInfo;
 @class GINIDocumentMetadata;
 @protocol GINIAPIManagerRequestFactory;
+@class GINITracer;
+@class GINILayoutPage;
 @protocol GINIURLSession;
 #import "GINIAPI.h"
 
@@ -66,6 +69,22 @@ typedef NS_ENUM(NSUInteger, GiniAPIResponseType){
  */
 + (instancetype)apiManagerWithURLSession:(id<GINIURLSession>)urlSession requestFactory:(id <GINIAPIManagerRequestFactory>)requestFactory api:(GINIAPI *)api;
 
+/**
+ * The tracer that records the HTTP requests as spans, or nil if the requests are not traced (the default).
+ *
+ * When a tracer is set, every request carries the trace context of the span that was current (see
+ * `GINISpan currentSpan`) when the request was made in the `traceparent` HTTP header.
+ */
+@property (nonatomic) GINITracer *tracer;
+
+/**
+ * The executor on which the bodies of the responses are decoded (see `GINIURLResponse`) and the results of the tasks
+ * are created, must not be nil. Defaults to `+[BFExecutor defaultExecutor]`, which decodes on the thread on which the
+ * response arrived. SDK instances created with the `GINISDKBuilder` decode on a dedicated concurrent queue, see
+ * `-[GINISDKBuilder useDecodingQualityOfService:]`.
+ */
+@property (nonatomic) BFExecutor *decodingExecutor;
+
 /**
  * Gets the document with the given ID.
  *
@@ -182,6 +201,24 @@ typedef NS_ENUM(NSUInteger, GiniAPIResponseType){
                     responseType:(GiniAPIResponseType)responseType
                cancellationToken:(BFCancellationToken *)cancellationToken;
 
+/**
+ * Gets the layout of a document page by page while it is downloaded, see `GINILayoutParser`. The first page is
+ * available before the download has finished, and only one page at a time is kept in memory.
+ *
+ * @param documentId               The document's id.
+ * @param responseType             The format in which the layout is downloaded. The pages have the same format.
+ * @param pageBlock                Called serially with each page as soon as it has been downloaded, on a background
+ *                                 thread.
+ * @param cancellationToken        Cancellation token used to cancel the download.
+ *
+ * @return                         A `BFTask*` that will resolve to the number of pages (NSNumber*) when all pages have
+ *                                 been handed to the page block, or fail if the layout is invalid.
+ */
+- (BFTask *)getLayoutForDocument:(NSString *)documentId
+                    responseType:(GiniAPIResponseType)responseType
+                       pageBlock:(void (^)(GINILayoutPage *page))pageBlock
+               cancellationToken:(BFCancellationToken *)cancellationToken;
+
 /**
  * Creates a new document from the given NSData*.
  *
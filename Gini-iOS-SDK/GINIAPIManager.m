@@ -15,6 +15,9 @@
 #import "GINIDocumentMetadata.h"
 #import "GINIAPI.h"
 #import "GINIAPIFactory.h"
+#import "GINITracer.h"
+#import "GINITracingURLSession.h"
+#import "GINILayoutParser.h"
 
 /**
  * Returns the string that is part of the URL of an API request for the given image preview size.
@@ -44,9 +47,20 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     id<GINIAPIManagerRequestFactory> _requestFactory;
 
     /**
-     * The URL session that is used to do the request. Usually this is an instance of NSURLSession.
+     * The URL session that is used to do the request. Usually this is an instance of NSURLSession. It is replaced when
+     * the tracer is set, so it is only accessed while holding the lock, see `urlSession`.
      */
     id<GINIURLSession> _urlSession;
+
+    /**
+     * The URL session that was passed to the initializer. If a tracer is set, `_urlSession` wraps this session.
+     */
+    id<GINIURLSession> _untracedURLSession;
+
+    /**
+     * The tracer, see `tracer`. Like `_urlSession` it is only accessed while holding the lock.
+     */
+    GINITracer *_tracer;
 }
 
 #pragma mark - Initializer
@@ -62,7 +76,9 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
         _baseURL = baseURL;
         _requestFactory = requestFactory;
         _urlSession = urlSession;
+        _untracedURLSession = urlSession;
         _api = [GINIAPIFactory apiWith:GINIAPITypeDefault];
+        _decodingExecutor = [BFExecutor defaultExecutor];
     }
     return self;
 }
@@ -79,7 +95,9 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
         _baseURL = api.baseUrl;
         _requestFactory = requestFactory;
         _urlSession = urlSession;
+        _untracedURLSession = urlSession;
         _api = api;
+        _decodingExecutor = [BFExecutor defaultExecutor];
     }
     return self;
 }
@@ -120,10 +138,10 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
 
 -(BFTask *)getDocumentWithURL:(NSURL *)location
             cancellationToken:(BFCancellationToken *)cancellationToken {
-    return [[_requestFactory asynchronousRequestUrl:location withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:location method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Accept"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *documentTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *documentTask) {
             GINIURLResponse *response = documentTask.result;
             return response.data;
         }];
@@ -145,9 +163,9 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
 
     NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@/pages/%lu/%@", documentId, (unsigned long)pageNumber, GINIPreviewSizeString(size)]
                         relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
-        return [[self->_urlSession BFDownloadTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *downloadTask) {
+        return [[[self urlSession] BFDownloadTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *downloadTask) {
             GINIURLResponse *response = downloadTask.result;
             NSURL *pathURL = response.data;
             NSData *imageData = [NSData dataWithContentsOfURL:pathURL];
@@ -166,10 +184,10 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
     NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@/pages", documentId] relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Accept"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *pagesTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *pagesTask) {
             GINIURLResponse *response = pagesTask.result;
             return response.data;
         }];
@@ -187,20 +205,48 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
     NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@/layout", documentId] relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         if (responseType == GiniAPIResponseTypeJSON) {
             [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Accept"];
         } else {
             [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeXmlKey] forHTTPHeaderField:@"Accept"];
         }
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *layoutTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *layoutTask) {
             GINIURLResponse *response = layoutTask.result;
             return response.data;
         }];
     } cancellationToken:cancellationToken];
 }
 
+- (BFTask *)getLayoutForDocument:(NSString *)documentId
+                    responseType:(GiniAPIResponseType)responseType
+                       pageBlock:(void (^)(GINILayoutPage *page))pageBlock
+               cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+    NSParameterAssert(pageBlock);
+
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@/layout", documentId] relativeToURL:_baseURL];
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+        NSMutableURLRequest *request = requestTask.result;
+        NSString *contentTypeKey = responseType == GiniAPIResponseTypeJSON ? GINIContentTypeJsonKey : GINIContentTypeXmlKey;
+        [request setValue:[self->_api.contentTypes valueForKey:contentTypeKey] forHTTPHeaderField:@"Accept"];
+
+        GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:responseType pageBlock:pageBlock];
+        __block NSError *parseError;
+        BFTask *dataTask = GINIStreamingDataTaskWithRequest([self urlSession], request, ^BOOL(NSData *data) {
+            return [parser appendData:data error:&parseError];
+        }, cancellationToken);
+        return [dataTask continueWithSuccessBlock:^id(BFTask *layoutTask) {
+            NSError *error = parseError;
+            if (!error) {
+                [parser finishWithError:&error];
+            }
+            return error ? [BFTask taskWithError:error] : @(parser.pageCount);
+        }];
+    } cancellationToken:cancellationToken];
+}
+
 
 - (BFTask *)uploadDocumentWithData:(NSData *)documentData
                        contentType:(NSString *)contentType
@@ -238,18 +284,21 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     }
     
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    GINISpan *span = [GINISpan currentSpan];
+    return [[self requestWithURL:url method:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:contentType forHTTPHeaderField:@"Content-Type"];
         
         [self addMetadata:metadata toRequest:request];
         
-        return [[self->_urlSession BFUploadTaskWithRequest:requestTask.result fromData:documentData] continueWithSuccessBlock:^id(BFTask *uploadTask) {
+        return [[[self urlSession] BFUploadTaskWithRequest:requestTask.result fromData:documentData] continueWithSuccessBlock:^id(BFTask *uploadTask) {
             // The HTTP response has a Location header with the URL of the document.
             GINIURLResponse *response = uploadTask.result;
             NSString *location = [[response.response allHeaderFields] valueForKey:@"Location"];
             // Get the document.
-            return [self getDocumentWithURL:[NSURL URLWithString:location] cancellationToken:cancellationToken];
+            return GINISpanPerform(span, ^id{
+                return [self getDocumentWithURL:[NSURL URLWithString:location] cancellationToken:cancellationToken];
+            });
         }];
     } cancellationToken:cancellationToken];
 }
@@ -299,19 +348,22 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     }
     
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    GINISpan *span = [GINISpan currentSpan];
+    return [[self requestWithURL:url method:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self->_api.contentTypes
                            valueForKey:GINIContentTypeCompositeJsonKey] forHTTPHeaderField:@"Content-Type"];
         
         [self addMetadata:metadata toRequest:request];
 
-        return [[self->_urlSession BFUploadTaskWithRequest:requestTask.result fromData:jsonDataFormatted] continueWithSuccessBlock:^id(BFTask *uploadTask) {
+        return [[[self urlSession] BFUploadTaskWithRequest:requestTask.result fromData:jsonDataFormatted] continueWithSuccessBlock:^id(BFTask *uploadTask) {
             // The HTTP response has a Location header with the URL of the document.
             GINIURLResponse *response = uploadTask.result;
             NSString *location = [[response.response allHeaderFields] valueForKey:@"Location"];
             // Get the document.
-            return [self getDocumentWithURL:[NSURL URLWithString:location] cancellationToken:cancellationToken];
+            return GINISpanPerform(span, ^id{
+                return [self getDocumentWithURL:[NSURL URLWithString:location] cancellationToken:cancellationToken];
+            });
         }];
     } cancellationToken:cancellationToken];
 }
@@ -325,9 +377,9 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
     NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@", documentId] relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"DELETE"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"DELETE"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *documentTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *documentTask) {
             GINIURLResponse *response = documentTask.result;
             return response.data;
         }];
@@ -347,10 +399,10 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     
     NSString *urlString = [NSString stringWithFormat:@"documents?limit=%lu&offset=%lu", (unsigned long)limit, (unsigned long)offset];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Accept"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *documentsTask) {
+        return [GINIDataTaskWithRequest([self urlSession], request, cancellationToken) continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *documentsTask) {
             GINIURLResponse *response = documentsTask.result;
             return response.data;
         }];
@@ -384,10 +436,10 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
 
     NSString *urlString = [NSString stringWithFormat:@"documents/%@/extractions", documentId];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:header forHTTPHeaderField:@"Accept"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *extractionsTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *extractionsTask) {
             GINIURLResponse *response = extractionsTask.result;
             return response.data;
         }];
@@ -405,14 +457,15 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSString *urlString = [NSString stringWithFormat:@"documents/%@/extractions/%@", documentId, label];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
     
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"PUT"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"PUT"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Content-Type"];
-        NSDictionary *feedbackDict = @{@"box": boundingBox, @"value": value};
+        NSMutableDictionary *feedbackDict = [NSMutableDictionary dictionaryWithObject:value forKey:@"value"];
+        feedbackDict[@"box"] = boundingBox;
         NSData *feedbackData = [NSJSONSerialization dataWithJSONObject:feedbackDict
-                                                               options:NSJSONWritingPrettyPrinted
+                                                               options:0
                                                                  error:nil];
-        return [[self->_urlSession BFUploadTaskWithRequest:request fromData:feedbackData] continueWithSuccessBlock:^id(BFTask *updateTask) {
+        return [[[self urlSession] BFUploadTaskWithRequest:request fromData:feedbackData] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *updateTask) {
             GINIURLResponse *response = updateTask.result;
             return response.data;
         }];
@@ -427,14 +480,14 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSString *urlString = [NSString stringWithFormat:@"documents/%@/extractions", documentId];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
 
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"PUT"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"PUT"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Content-Type"];
         NSData *feedbackData = [NSJSONSerialization dataWithJSONObject:@{@"feedback": feedback}
-                                                               options:NSJSONWritingPrettyPrinted
+                                                               options:0
                                                                  error:nil];
 
-        return [[self->_urlSession BFUploadTaskWithRequest:request fromData:feedbackData] continueWithSuccessBlock:^id(BFTask *updateTask) {
+        return [[[self urlSession] BFUploadTaskWithRequest:request fromData:feedbackData] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *updateTask) {
             GINIURLResponse *response = updateTask.result;
             return response.data;
         }];
@@ -449,9 +502,9 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSString *urlString = [NSString stringWithFormat:@"documents/%@/extractions/%@", documentId, label];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
 
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"DELETE"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"DELETE"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *feedbackTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *feedbackTask) {
             GINIURLResponse *response = feedbackTask.result;
             return response.data;
         }];
@@ -472,13 +525,16 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
  cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([searchTerm isKindOfClass:[NSString class]]);
     
-    NSString *urlString = [NSString stringWithFormat:@"search?q=%@&limit=%lu&offset=%lu&docType=%@", searchTerm, (unsigned long)limit, (unsigned long)offset, docType];
+    NSString *urlString = [NSString stringWithFormat:@"search?q=%@&limit=%lu&offset=%lu", stringByEscapingString(searchTerm), (unsigned long)limit, (unsigned long)offset];
+    if (docType) {
+        urlString = [urlString stringByAppendingString:[NSString stringWithFormat:@"&docType=%@", stringByEscapingString(docType)]];
+    }
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
     
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"GET"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Accept"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *searchTask) {
+        return [GINIDataTaskWithRequest([self urlSession], request, cancellationToken) continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *searchTask) {
             GINIURLResponse *response = searchTask.result;
             return response.data;
         }];
@@ -496,16 +552,64 @@ NSString *GINIPreviewSizeString(GiniApiPreviewSize previewSize) {
     NSString *urlString = [NSString stringWithFormat:@"https://api.gini.net/documents/%@/errorreport?summary=%@&description=%@", documentId, summaryEncoded, descriptionEncoded];
     NSURL *url = [NSURL URLWithString:urlString relativeToURL:_baseURL];
 
-    return [[_requestFactory asynchronousRequestUrl:url withMethod:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
+    return [[self requestWithURL:url method:@"POST"] continueWithSuccessBlock:^id(BFTask *requestTask) {
         NSMutableURLRequest *request = requestTask.result;
         [request setValue:[self -> _api.contentTypes valueForKey:GINIContentTypeJsonKey] forHTTPHeaderField:@"Content-Type"];
-        return [[self->_urlSession BFDataTaskWithRequest:request] continueWithSuccessBlock:^id(BFTask *reportErrorTask) {
+        return [[[self urlSession] BFDataTaskWithRequest:request] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *reportErrorTask) {
             GINIURLResponse *response = reportErrorTask.result;
             return response.data;
         }];
     }];
 }
 
+#pragma mark - Decoding
+- (void)setDecodingExecutor:(BFExecutor *)decodingExecutor {
+    NSParameterAssert([decodingExecutor isKindOfClass:[BFExecutor class]]);
+
+    _decodingExecutor = decodingExecutor;
+}
+
+#pragma mark - Tracing
+- (GINITracer *)tracer {
+    @synchronized (self) {
+        return _tracer;
+    }
+}
+
+- (void)setTracer:(GINITracer *)tracer {
+    @synchronized (self) {
+        _tracer = tracer;
+        _urlSession = tracer ? [GINITracingURLSession tracingURLSessionWithURLSession:_untracedURLSession tracer:tracer] : _untracedURLSession;
+    }
+}
+
+/**
+ * Returns the URL session the requests are done with. The session is read under the same lock it is replaced with, so
+ * a request keeps a strong reference to the session it uses even if the tracer is set concurrently.
+ */
+- (id<GINIURLSession>)urlSession {
+    @synchronized (self) {
+        return _urlSession;
+    }
+}
+
+/**
+ * Creates a request with the request factory. If a tracer is set, the request gets the `traceparent` header of the
+ * span that is current when this method is called, since the request is created asynchronously on another thread.
+ */
+- (BFTask *)requestWithURL:(NSURL *)url method:(NSString *)method {
+    GINISpan *span = self.tracer ? [GINISpan currentSpan] : nil;
+    BFTask *requestTask = [_requestFactory asynchronousRequestUrl:url withMethod:method];
+    if (!span) {
+        return requestTask;
+    }
+    return [requestTask continueWithSuccessBlock:^id(BFTask *task) {
+        NSMutableURLRequest *request = task.result;
+        [request setValue:span.traceParentHeaderValue forHTTPHeaderField:GINITraceParentHeaderField];
+        return request;
+    }];
+}
+
 - (NSData *)partialDocumentsJsonFormattedFromArray:(NSArray<GINIPartialDocumentInfo* >*)partialDocumentsInfo {
     NSMutableArray *partialInfoFormattedJsonStrings = [NSMutableArray new];
     for (GINIPartialDocumentInfo* partialDocumentInfo in partialDocumentsInfo) {
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class BFCancellationToken;
+
+
+/**
+ * The outcome of the operation on one document of a bulk operation.
+ */
+@interface GINIBulkItemResult : NSObject
+
+/// The ID of the document.
+@property (readonly) NSString *documentId;
+
+/// The result of the operation if it succeeded.
+@property (readonly) id result;
+
+/// The error if the operation failed.
+@property (readonly) NSError *error;
+
+/// YES if the operation was cancelled or never started because the bulk operation was cancelled.
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+/// YES if the operation neither failed nor was cancelled.
+@property (readonly, getter=isSucceeded) BOOL succeeded;
+
+@end
+
+
+/**
+ * Called with the outcome of each document of a bulk operation as soon as its operation has finished. The block may
+ * be called on any thread, but never concurrently for the same bulk operation.
+ */
+typedef void (^GINIBulkItemResultBlock)(GINIBulkItemResult *itemResult);
+
+
+/**
+ * The outcome of a bulk operation. A bulk operation never fails as a whole, so the outcome of every document is
+ * available, even if some of the operations failed or the bulk operation was cancelled.
+ */
+@interface GINIBulkResult : NSObject
+
+/// The outcomes of all documents, in the order of the document IDs the bulk operation was started with.
+@property (readonly) NSArray<GINIBulkItemResult *> *itemResults;
+
+/// The results of the succeeded operations, with the document ID as key.
+@property (readonly) NSDictionary<NSString *, id> *results;
+
+/// The errors of the failed operations, with the document ID as key.
+@property (readonly) NSDictionary<NSString *, NSError *> *errors;
+
+/// The IDs of the documents whose operation was cancelled.
+@property (readonly) NSArray<NSString *> *cancelledDocumentIds;
+
+/// YES if all operations succeeded.
+@property (readonly, getter=isSucceeded) BOOL succeeded;
+
+@end
+
+
+/**
+ * A `GINIBulkOperation` runs an operation for each of a list of documents, at most `maxConcurrentOperations` at a
+ * time. As soon as an operation finishes the next one is started, so a slow document does not hold back the others.
+ *
+ * Used by the bulk methods of the `GINIDocumentTaskManager`.
+ */
+@interface GINIBulkOperation : NSObject
+
+/**
+ * Factory to create a new bulk operation.
+ *
+ * @param documentIds               The IDs of the documents.
+ * @param maxConcurrentOperations   The maximum number of operations that run at the same time. Must be > 0.
+ * @param operationBlock            Called with each document ID to start its operation. Returns a `BFTask*` which
+ *                                  resolves to the result of the operation.
+ */
++ (instancetype)bulkOperationWithDocumentIds:(NSArray<NSString *> *)documentIds
+                     maxConcurrentOperations:(NSUInteger)maxConcurrentOperations
+                              operationBlock:(BFTask *(^)(NSString *documentId))operationBlock;
+
+/// The IDs of the documents.
+@property (readonly) NSArray<NSString *> *documentIds;
+
+/// The maximum number of operations that run at the same time.
+@property (readonly) NSUInteger maxConcurrentOperations;
+
+/**
+ * Starts the operations.
+ *
+ * @param itemResultBlock       Called with the outcome of each document as soon as its operation has finished
+ *                              (optional).
+ * @param cancellationToken     Cancellation token used to cancel the bulk operation. Operations that have not been
+ *                              started yet are not started anymore. The token is not passed to the operation block,
+ *                              so it must be captured by the block to cancel the running operations as well.
+ *
+ * @returns                     A `BFTask*` which never fails and resolves to the `GINIBulkResult` once all operations
+ *                              have finished.
+ */
+- (BFTask *)startWithItemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                   cancellationToken:(BFCancellationToken *)cancellationToken;
+
+@end
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIBulkOperation.h"
+
+
+@implementation GINIBulkItemResult
+
+#pragma mark - Factory
++ (instancetype)itemResultWithDocumentId:(NSString *)documentId task:(BFTask *)task {
+    return [[self alloc] initWithDocumentId:documentId task:task];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentId:(NSString *)documentId task:(BFTask *)task {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+    NSParameterAssert(task.completed);
+
+    self = [super init];
+    if (self) {
+        _documentId = documentId;
+        _result = task.result;
+        _error = task.error;
+        _cancelled = task.cancelled;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (BOOL)isSucceeded {
+    return !_error && !_cancelled;
+}
+
+- (NSString *)description {
+    if (_cancelled) {
+        return [NSString stringWithFormat:@"<GINIBulkItemResult %@ cancelled>", _documentId];
+    }
+    if (_error) {
+        return [NSString stringWithFormat:@"<GINIBulkItemResult %@ error=%@>", _documentId, _error];
+    }
+    return [NSString stringWithFormat:@"<GINIBulkItemResult %@ result=%@>", _documentId, _result];
+}
+
+@end
+
+
+@implementation GINIBulkResult
+
+#pragma mark - Factory
++ (instancetype)bulkResultWithItemResults:(NSArray<GINIBulkItemResult *> *)itemResults {
+    return [[self alloc] initWithItemResults:itemResults];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithItemResults:(NSArray<GINIBulkItemResult *> *)itemResults {
+    NSParameterAssert([itemResults isKindOfClass:[NSArray class]]);
+
+    self = [super init];
+    if (self) {
+        _itemResults = [itemResults copy];
+        NSMutableDictionary *results = [NSMutableDictionary new];
+        NSMutableDictionary *errors = [NSMutableDictionary new];
+        NSMutableArray *cancelledDocumentIds = [NSMutableArray new];
+        for (GINIBulkItemResult *itemResult in itemResults) {
+            if (itemResult.cancelled) {
+                [cancelledDocumentIds addObject:itemResult.documentId];
+            } else if (itemResult.error) {
+                errors[itemResult.documentId] = itemResult.error;
+            } else {
+                results[itemResult.documentId] = itemResult.result ?: [NSNull null];
+            }
+        }
+        _results = results;
+        _errors = errors;
+        _cancelledDocumentIds = cancelledDocumentIds;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (BOOL)isSucceeded {
+    return [_errors count] == 0 && [_cancelledDocumentIds count] == 0;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINIBulkResult succeeded=%lu failed=%lu cancelled=%lu>",
+            (unsigned long)[_results count], (unsigned long)[_errors count], (unsigned long)[_cancelledDocumentIds count]];
+}
+
+@end
+
+
+@implementation GINIBulkOperation {
+    BFTask *(^_operationBlock)(NSString *documentId);
+    GINIBulkItemResultBlock _itemResultBlock;
+    BFCancellationToken *_cancellationToken;
+    /// The outcomes of the documents in the order of `documentIds`, `NSNull` for the unfinished ones.
+    NSMutableArray *_itemResults;
+    /// The index of the next document whose operation is started.
+    NSUInteger _nextIndex;
+}
+
+#pragma mark - Factory
++ (instancetype)bulkOperationWithDocumentIds:(NSArray<NSString *> *)documentIds
+                     maxConcurrentOperations:(NSUInteger)maxConcurrentOperations
+                              operationBlock:(BFTask *(^)(NSString *documentId))operationBlock {
+    return [[self alloc] initWithDocumentIds:documentIds
+                     maxConcurrentOperations:maxConcurrentOperations
+                              operationBlock:operationBlock];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentIds:(NSArray<NSString *> *)documentIds
+            maxConcurrentOperations:(NSUInteger)maxConcurrentOperations
+                     operationBlock:(BFTask *(^)(NSString *documentId))operationBlock {
+    NSParameterAssert([documentIds isKindOfClass:[NSArray class]]);
+    NSParameterAssert(maxConcurrentOperations > 0);
+    NSParameterAssert(operationBlock);
+
+    self = [super init];
+    if (self) {
+        _documentIds = [documentIds copy];
+        _maxConcurrentOperations = maxConcurrentOperations;
+        _operationBlock = [operationBlock copy];
+        _itemResults = [NSMutableArray arrayWithCapacity:[documentIds count]];
+        for (NSUInteger i = 0; i < [documentIds count]; i++) {
+            [_itemResults addObject:[NSNull null]];
+        }
+    }
+    return self;
+}
+
+#pragma mark - Running
+- (BFTask *)startWithItemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                   cancellationToken:(BFCancellationToken *)cancellationToken {
+    @synchronized (self) {
+        NSAssert(_nextIndex == 0, @"A bulk operation can only be started once");
+        _itemResultBlock = [itemResultBlock copy];
+        _cancellationToken = cancellationToken;
+    }
+
+    // Each lane runs the operations one after another, taking the next document as soon as its previous operation has
+    // finished, so there are never more than `maxConcurrentOperations` operations running.
+    NSUInteger laneCount = MIN(_maxConcurrentOperations, [_documentIds count]);
+    NSMutableArray *laneTasks = [NSMutableArray arrayWithCapacity:laneCount];
+    for (NSUInteger i = 0; i < laneCount; i++) {
+        [laneTasks addObject:[self runNextOperation]];
+    }
+
+    return [[BFTask taskForCompletionOfAllTasks:laneTasks] continueWithBlock:^id(BFTask *task) {
+        @synchronized (self) {
+            GINIBulkResult *bulkResult = [GINIBulkResult bulkResultWithItemResults:self->_itemResults];
+            self->_itemResultBlock = nil;
+            return bulkResult;
+        }
+    }];
+}
+
+- (BFTask *)runNextOperation {
+    NSUInteger index;
+    @synchronized (self) {
+        if (_nextIndex >= [_documentIds count]) {
+            return [BFTask taskWithResult:nil];
+        }
+        index = _nextIndex++;
+    }
+
+    NSString *documentId = _documentIds[index];
+    BFTask *operationTask;
+    if (_cancellationToken.cancellationRequested) {
+        operationTask = [BFTask cancelledTask];
+    } else {
+        operationTask = _operationBlock(documentId) ?: [BFTask taskWithResult:nil];
+    }
+
+    return [operationTask continueWithBlock:^id(BFTask *task) {
+        GINIBulkItemResult *itemResult = [GINIBulkItemResult itemResultWithDocumentId:documentId task:task];
+        @synchronized (self) {
+            self->_itemResults[index] = itemResult;
+            if (self->_itemResultBlock) {
+                self->_itemResultBlock(itemResult);
+            }
+        }
+        return [self runNextOperation];
+    }];
+}
+
+@end
@@ -5,6 +5,7 @@
 
 #import <Bolts/BFTask.h>
 #import "GINIDocument.h"
+#import "GINIDocument_Private.h"
 #import "GINIDocumentTaskManager.h"
 
 
@@ -17,18 +18,66 @@
     GINIDocumentTaskManager *_documentTaskManager;
     BFTask *_extractions;
     BFTask *_layout;
+    BFTask *_textIndex;
+    /// The last known extraction values on the server (name to a dictionary with "value" and optionally "box").
+    NSDictionary<NSString *, NSDictionary *> *_serverExtractions;
 }
 
 + (instancetype)documentFromAPIResponse:(NSDictionary *)apiResponse withDocumentManager:(GINIDocumentTaskManager *)documentManager {
-    NSString *documentId = apiResponse[@"id"];
+    NSDictionary *linksDict = apiResponse[@"_links"];
+    GINIDocumentLinks *links = [[GINIDocumentLinks alloc] initWithDocumentURL:linksDict[@"document"]
+                                                               extractionsURL:linksDict[@"extractions"]
+                                                                    layoutURL:linksDict[@"layout"]
+                                                                 processedURL:linksDict[@"processed"]];
+
+    NSArray *compositeDocumentsArray = apiResponse[@"compositeDocuments"];
+    NSMutableArray<NSString *> *compositeDocuments = [NSMutableArray arrayWithCapacity:[compositeDocumentsArray count]];
+    for (NSDictionary *dict in compositeDocumentsArray) {
+        [compositeDocuments addObject:dict[@"document"]];
+    }
+
+    NSArray *partialDocumentsArray = apiResponse[@"partialDocuments"];
+    NSMutableArray<GINIPartialDocumentInfo *> *partialDocumentInfos = [NSMutableArray arrayWithCapacity:[partialDocumentsArray count]];
+    for (NSDictionary *dict in partialDocumentsArray) {
+        NSNumber *rotationDelta = dict[@"rotationDelta"];
+        GINIPartialDocumentInfo *partialDocumentInfo =
+        [[GINIPartialDocumentInfo alloc] initWithDocumentUrl:dict[@"document"]
+                                               rotationDelta:[rotationDelta intValue]];
+        [partialDocumentInfos addObject:partialDocumentInfo];
+    }
+
+    GINIDocument *document = [self documentWithId:apiResponse[@"id"]
+                                         progress:apiResponse[@"progress"]
+                             sourceClassification:apiResponse[@"sourceClassification"]
+                                        pageCount:apiResponse[@"pageCount"]
+                                            links:links
+                               compositeDocuments:compositeDocuments
+                             partialDocumentInfos:partialDocumentInfos
+                                         filename:apiResponse[@"name"]
+                                     creationDate:apiResponse[@"creationDate"]
+                                  documentManager:documentManager];
+    if (!document && !apiResponse[@"id"]) {
+        NSLog(@"Document without id: %@", apiResponse);
+    }
+    return document;
+}
+
++ (instancetype)documentWithId:(NSString *)documentId
+                      progress:(NSString *)progress
+          sourceClassification:(NSString *)classification
+                     pageCount:(NSNumber *)pageCount
+                         links:(GINIDocumentLinks *)links
+            compositeDocuments:(NSArray<NSString *> *)compositeDocuments
+          partialDocumentInfos:(NSArray<GINIPartialDocumentInfo *> *)partialDocumentInfos
+                      filename:(NSString *)filename
+                  creationDate:(NSNumber *)creationDate
+               documentManager:(GINIDocumentTaskManager *)documentManager {
     // Documents must have an ID.
     if (!documentId) {
-        NSLog(@"Document without id: %@", apiResponse);
         return nil;
     }
 
     GiniDocumentState documentState;
-    NSString *progress = [apiResponse valueForKey:@"progress"];
     if ([progress isEqualToString:@"PENDING"]) {
         documentState = GiniDocumentStatePending;
     } else if([progress isEqualToString:@"COMPLETED"]) {
@@ -41,7 +90,6 @@
     }
 
     GiniDocumentSourceClassification sourceClassification;
-    NSString *classification = [apiResponse valueForKey:@"sourceClassification"];
     if ([classification isEqualToString:@"SCANNED"]) {
         sourceClassification = GiniDocumentSourceClassificationScanned;
     } else if ([classification isEqualToString:@"NATIVE"]) {
@@ -57,39 +105,17 @@
         return nil;
     }
 
-    NSUInteger pageCount = [apiResponse[@"pageCount"] unsignedIntValue];
-    
-    NSDictionary *linksDict = [apiResponse valueForKey:@"_links"];
-    GINIDocumentLinks *links = [[GINIDocumentLinks alloc] initWithDocumentURL:linksDict[@"document"]
-                                                               extractionsURL:linksDict[@"extractions"]
-                                                                    layoutURL:linksDict[@"layout"] 
-                                                                 processedURL:linksDict[@"processed"]];
-    
-    NSMutableArray<NSString *> *compositeDocuments = [NSMutableArray new];
-    for (NSDictionary *dict in [apiResponse valueForKey:@"compositeDocuments"]) {
-        [compositeDocuments addObject:dict[@"document"]];
-    }
-    
-    NSMutableArray<GINIPartialDocumentInfo *> *partialDocumentInfos = [NSMutableArray new];
-    for (NSDictionary *dict in [apiResponse valueForKey:@"partialDocuments"]) {
-        NSNumber *rotationDelta = dict[@"rotationDelta"];
-        GINIPartialDocumentInfo *partialDocumentInfo =
-        [[GINIPartialDocumentInfo alloc] initWithDocumentUrl:dict[@"document"]
-                                               rotationDelta:[rotationDelta intValue]];
-        [partialDocumentInfos addObject:partialDocumentInfo];
-    }
-    
     GINIDocument *document = [[GINIDocument alloc] initWithId:documentId
                                                         state:documentState
-                                                    pageCount:pageCount
-                                         sourceClassification:(GiniDocumentSourceClassification) sourceClassification
+                                                    pageCount:[pageCount unsignedIntValue]
+                                         sourceClassification:sourceClassification
                                                         links:links
-                                           compositeDocuments:compositeDocuments
-                                         partialDocumentInfos:partialDocumentInfos
+                                           compositeDocuments:compositeDocuments ?: @[]
+                                         partialDocumentInfos:partialDocumentInfos ?: @[]
                                               documentManager:documentManager];
-    
-    document.filename = [apiResponse valueForKey:@"name"];
-    document.creationDate = [NSDate dateWithTimeIntervalSince1970:floor([[apiResponse valueForKey:@"creationDate"] doubleValue] / 1000)];
+
+    document.filename = filename;
+    document.creationDate = [NSDate dateWithTimeIntervalSince1970:floor([creationDate doubleValue] / 1000)];
 
     return document;
 }
@@ -163,13 +189,102 @@
 }
 
 - (BFTask *)layout {
-    return [self->_documentTaskManager getExtractionsForDocument:self cancellationToken:nil];
+    return [self->_documentTaskManager getLayoutForDocument:self cancellationToken:nil];
 }
 
 - (NSString *)description {
     return [NSString stringWithFormat:@"<GINIDocument id=%@>", _documentId];
 }
 
+#pragma mark - Cached results
+
+/**
+ * Returns the task in the given cache slot, or calls the block and caches its task if the slot is empty or its task
+ * failed or was cancelled, so errors are not cached.
+ */
+- (BFTask *)cachedTaskInSlot:(BFTask * __strong *)slot usingBlock:(BFTask *(^)(void))fetchBlock {
+    @synchronized (self) {
+        BFTask *task = *slot;
+        if (!task || (task.completed && (task.faulted || task.cancelled))) {
+            task = fetchBlock();
+            *slot = task;
+        }
+        return task;
+    }
+}
+
+- (BFTask *)cachedExtractionsUsingBlock:(BFTask *(^)(void))fetchBlock {
+    return [self cachedTaskInSlot:&_extractions usingBlock:fetchBlock];
+}
+
+- (BFTask *)cachedLayoutUsingBlock:(BFTask *(^)(void))fetchBlock {
+    return [self cachedTaskInSlot:&_layout usingBlock:fetchBlock];
+}
+
+- (BFTask *)cachedTextIndexUsingBlock:(BFTask *(^)(void))fetchBlock {
+    return [self cachedTaskInSlot:&_textIndex usingBlock:fetchBlock];
+}
+
+- (void)updateCachedExtractionsResultUsingBlock:(NSDictionary *(^)(NSDictionary *result))block {
+    @synchronized (self) {
+        BFTask *task = _extractions;
+        if (task.completed && !task.faulted && !task.cancelled) {
+            _extractions = [BFTask taskWithResult:block(task.result)];
+        }
+    }
+}
+
+- (void)updateState:(GiniDocumentState)state {
+    @synchronized (self) {
+        if (_state != state) {
+            _state = state;
+            _extractions = nil;
+            _layout = nil;
+            _textIndex = nil;
+            _serverExtractions = nil;
+        }
+    }
+}
+
+- (NSDictionary<NSString *, NSDictionary *> *)serverExtractions {
+    @synchronized (self) {
+        return _serverExtractions;
+    }
+}
+
+- (void)setServerExtractions:(NSDictionary<NSString *, NSDictionary *> *)serverExtractions {
+    @synchronized (self) {
+        _serverExtractions = [serverExtractions copy];
+    }
+}
+
+- (void)mergeServerExtractions:(NSDictionary<NSString *, NSDictionary *> *)serverExtractions {
+    @synchronized (self) {
+        if (!_serverExtractions) {
+            // Without a complete snapshot the other extractions are still unknown.
+            return;
+        }
+        NSMutableDictionary *mergedExtractions = [_serverExtractions mutableCopy];
+        [mergedExtractions addEntriesFromDictionary:serverExtractions];
+        _serverExtractions = mergedExtractions;
+    }
+}
+
+- (void)mergeDocument:(GINIDocument *)document {
+    NSParameterAssert([document.documentId isEqualToString:_documentId]);
+
+    @synchronized (self) {
+        _pageCount = document.pageCount;
+        _filename = document.filename;
+        _creationDate = document.creationDate;
+        _sourceClassification = document.sourceClassification;
+        _links = document.links;
+        _compositeDocuments = document.compositeDocuments;
+        _partialDocumentInfos = document.partialDocumentInfos;
+    }
+    [self updateState:document.state];
+}
+
 -(BFTask *)previewWithSize:(GiniApiPreviewSize)size forPage:(NSUInteger)page {
     return [self->_documentTaskManager getPreviewForPage:page ofDocument:self withSize:size cancellationToken:nil];
 }
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class GINIDocument;
+
+/**
+ * The sub-resources of a document that can be fetched with a `GINIDocumentBundle`.
+ */
+typedef NS_OPTIONS(NSUInteger, GINIDocumentBundleContents) {
+    /// The extractions and the candidates, which share one request.
+    GINIDocumentBundleContentsExtractions = 1 << 0,
+    /// The incubator extractions.
+    GINIDocumentBundleContentsIncubatorExtractions = 1 << 1,
+    /// The layout.
+    GINIDocumentBundleContentsLayout = 1 << 2,
+    /// The pages.
+    GINIDocumentBundleContentsPages = 1 << 3,
+    /// The preview of the first page.
+    GINIDocumentBundleContentsFirstPagePreview = 1 << 4,
+    /// All of the above.
+    GINIDocumentBundleContentsAll = (1 << 5) - 1
+};
+
+/**
+ * A `GINIDocumentBundle` holds the tasks of a processed document and its sub-resources, which are fetched concurrently
+ * once the document has been polled. See `-[GINIDocumentTaskManager getBundleForDocument:contents:previewSize:cancellationToken:]`.
+ *
+ * The tasks are available immediately, so partial results can be shown as they arrive. The tasks of sub-resources that
+ * were not requested are nil.
+ */
+@interface GINIDocumentBundle : NSObject
+
+/**
+ * Factory to create a new bundle.
+ *
+ * @param documentTask      A task resolving to the processed `GINIDocument`.
+ * @param contents          The requested sub-resources.
+ * @param fetchBlock        Called with each of the requested sub-resources (a single flag of `contents`) and the
+ *                          processed document as soon as the document task resolves. Returns the task fetching the
+ *                          sub-resource. For `GINIDocumentBundleContentsExtractions` the task must resolve to a
+ *                          dictionary with the keys "extractions" and "candidates".
+ */
++ (instancetype)bundleWithDocumentTask:(BFTask *)documentTask
+                              contents:(GINIDocumentBundleContents)contents
+                            fetchBlock:(BFTask *(^)(GINIDocumentBundleContents content, GINIDocument *document))fetchBlock;
+
+/**
+ * Same as `bundleWithDocumentTask:contents:fetchBlock:`, but all tasks of the bundle are passed through the given
+ * block, e.g. to complete them on the main queue. The sub-resources are fetched as soon as the undelivered document
+ * task resolves.
+ *
+ * @param deliveryBlock     Returns a task which is completed like the given task (optional).
+ */
++ (instancetype)bundleWithDocumentTask:(BFTask *)documentTask
+                              contents:(GINIDocumentBundleContents)contents
+                            fetchBlock:(BFTask *(^)(GINIDocumentBundleContents content, GINIDocument *document))fetchBlock
+                         deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock;
+
+/// The requested sub-resources.
+@property (readonly) GINIDocumentBundleContents contents;
+
+/// A `BFTask*` resolving to the processed `GINIDocument`.
+@property (readonly) BFTask *documentTask;
+
+/// A `BFTask*` resolving to a mapping with the extractions (extraction name as key).
+@property (readonly) BFTask *extractionsTask;
+
+/// A `BFTask*` resolving to a mapping with the candidates (extraction entity as key).
+@property (readonly) BFTask *candidatesTask;
+
+/// A `BFTask*` resolving to the response of the incubator extractions (see `getIncubatorExtractionsForDocument:`).
+@property (readonly) BFTask *incubatorExtractionsTask;
+
+/// A `BFTask*` resolving to a dictionary with the layout of the document.
+@property (readonly) BFTask *layoutTask;
+
+/// A `BFTask*` resolving to the pages of the document.
+@property (readonly) BFTask *pagesTask;
+
+/// A `BFTask*` resolving to the `UIImage*` of the preview of the first page.
+@property (readonly) BFTask *previewTask;
+
+/**
+ * A `BFTask*` which completes when all tasks of the bundle are finished. It fails if the document task fails, otherwise
+ * it resolves to the bundle; errors of the sub-resources are only reported by their own tasks.
+ */
+@property (readonly) BFTask *completionTask;
+
+@end
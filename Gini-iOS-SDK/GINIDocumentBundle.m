@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIDocumentBundle.h"
+#import "GINIDocument.h"
+
+
+@implementation GINIDocumentBundle
+
+#pragma mark - Factory
++ (instancetype)bundleWithDocumentTask:(BFTask *)documentTask
+                              contents:(GINIDocumentBundleContents)contents
+                            fetchBlock:(BFTask *(^)(GINIDocumentBundleContents content, GINIDocument *document))fetchBlock {
+    return [self bundleWithDocumentTask:documentTask contents:contents fetchBlock:fetchBlock deliveryBlock:nil];
+}
+
++ (instancetype)bundleWithDocumentTask:(BFTask *)documentTask
+                              contents:(GINIDocumentBundleContents)contents
+                            fetchBlock:(BFTask *(^)(GINIDocumentBundleContents content, GINIDocument *document))fetchBlock
+                         deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock {
+    return [[self alloc] initWithDocumentTask:documentTask contents:contents fetchBlock:fetchBlock deliveryBlock:deliveryBlock];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentTask:(BFTask *)documentTask
+                            contents:(GINIDocumentBundleContents)contents
+                          fetchBlock:(BFTask *(^)(GINIDocumentBundleContents content, GINIDocument *document))fetchBlock
+                       deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock {
+    NSParameterAssert([documentTask isKindOfClass:[BFTask class]]);
+    NSParameterAssert(fetchBlock);
+
+    self = [super init];
+    if (self) {
+        _contents = contents;
+        // Only the tasks handed out are delivered, the sub-resources continue the undelivered tasks.
+        BFTask *(^deliver)(BFTask *) = ^BFTask *(BFTask *task) {
+            return (task && deliveryBlock) ? deliveryBlock(task) : task;
+        };
+
+        // All sub-resources are continuations of the document task, so they are requested concurrently as soon as the
+        // document is processed.
+        BFTask *(^fetch)(GINIDocumentBundleContents) = ^BFTask *(GINIDocumentBundleContents content) {
+            if (!(contents & content)) {
+                return nil;
+            }
+            return [documentTask continueWithSuccessBlock:^id(BFTask *task) {
+                return fetchBlock(content, task.result);
+            }];
+        };
+
+        BFTask *extractionsResponseTask = fetch(GINIDocumentBundleContentsExtractions);
+        BFTask *extractionsTask = [extractionsResponseTask continueWithSuccessBlock:^id(BFTask *task) {
+            return task.result[@"extractions"];
+        }];
+        BFTask *candidatesTask = [extractionsResponseTask continueWithSuccessBlock:^id(BFTask *task) {
+            return task.result[@"candidates"];
+        }];
+        BFTask *incubatorExtractionsTask = fetch(GINIDocumentBundleContentsIncubatorExtractions);
+        BFTask *layoutTask = fetch(GINIDocumentBundleContentsLayout);
+        BFTask *pagesTask = fetch(GINIDocumentBundleContentsPages);
+        BFTask *previewTask = fetch(GINIDocumentBundleContentsFirstPagePreview);
+
+        NSMutableArray *tasks = [NSMutableArray arrayWithObject:documentTask];
+        for (BFTask *task in @[extractionsTask ?: [NSNull null], candidatesTask ?: [NSNull null],
+                               incubatorExtractionsTask ?: [NSNull null], layoutTask ?: [NSNull null],
+                               pagesTask ?: [NSNull null], previewTask ?: [NSNull null]]) {
+            if ([task isKindOfClass:[BFTask class]]) {
+                [tasks addObject:task];
+            }
+        }
+        // The continuation retains the bundle only until it has run.
+        BFTask *completionTask = [[BFTask taskForCompletionOfAllTasks:tasks] continueWithBlock:^id(BFTask *task) {
+            if (documentTask.faulted || documentTask.cancelled) {
+                return documentTask;
+            }
+            return self;
+        }];
+
+        _documentTask = deliver(documentTask);
+        _extractionsTask = deliver(extractionsTask);
+        _candidatesTask = deliver(candidatesTask);
+        _incubatorExtractionsTask = deliver(incubatorExtractionsTask);
+        _layoutTask = deliver(layoutTask);
+        _pagesTask = deliver(pagesTask);
+        _previewTask = deliver(previewTask);
+        _completionTask = deliver(completionTask);
+    }
+    return self;
+}
+
+@end
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class BFCancellationToken;
+@class GINIDocument;
+
+
+/**
+ * A `GINIDocumentIterator` iterates over a paginated list of documents, e.g. all documents of the user or the results
+ * of a search. See `-[GINIDocumentTaskManager documentIteratorWithPageSize:readAheadDepth:]`.
+ *
+ * While a page is consumed, the following `readAheadDepth` pages are already requested, so iterating over many
+ * documents is not a chain of round trips. The documents of a page are only created when the page is consumed.
+ *
+ * All methods of this class are thread-safe. The pages are always returned in order, even if `nextPage` is called
+ * again before the previous page has arrived.
+ */
+@interface GINIDocumentIterator : NSObject
+
+/**
+ * Factory to create a new iterator.
+ *
+ * @param pageSize              The number of documents per page. Must be > 0.
+ * @param readAheadDepth        The number of pages that are requested ahead of the consumed page.
+ * @param pageBlock             Requests the page with the given limit and offset. Returns a `BFTask*` resolving to the
+ *                              API response, a dictionary with the keys "totalCount" and "documents".
+ * @param documentBlock         Creates the document for an entry of the "documents" of a page.
+ */
++ (instancetype)iteratorWithPageSize:(NSUInteger)pageSize
+                      readAheadDepth:(NSUInteger)readAheadDepth
+                           pageBlock:(BFTask *(^)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken))pageBlock
+                       documentBlock:(GINIDocument *(^)(NSDictionary *apiResponse))documentBlock;
+
+/**
+ * Same as `iteratorWithPageSize:readAheadDepth:pageBlock:documentBlock:`, but the tasks returned by `nextPage` and
+ * `enumerateDocumentsUsingBlock:` are passed through the given block, e.g. to complete them on the main queue.
+ *
+ * @param deliveryBlock         Returns a task which is completed like the given task (optional).
+ */
++ (instancetype)iteratorWithPageSize:(NSUInteger)pageSize
+                      readAheadDepth:(NSUInteger)readAheadDepth
+                           pageBlock:(BFTask *(^)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken))pageBlock
+                       documentBlock:(GINIDocument *(^)(NSDictionary *apiResponse))documentBlock
+                       deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock;
+
+/// The number of documents per page.
+@property (readonly) NSUInteger pageSize;
+
+/// The number of pages that are requested ahead of the consumed page.
+@property (readonly) NSUInteger readAheadDepth;
+
+/// The total number of documents as reported by the Gini API, or `NSNotFound` before the first page has arrived.
+@property (readonly) NSUInteger totalCount;
+
+/// NO if all pages have been consumed.
+@property (readonly) BOOL hasMorePages;
+
+/**
+ * Returns the next page.
+ *
+ * @returns                 A `BFTask*` resolving to the `GINIDocument` instances of the next page, or to an empty array
+ *                          if there are no more documents. If the request of the page fails, the task fails and the
+ *                          page is requested again by the next call.
+ */
+- (BFTask *)nextPage;
+
+/**
+ * Calls the given block with each of the remaining documents, requesting the pages as needed.
+ *
+ * @param block             Called with each document. Set `stop` to YES to stop the iteration; the rest of the
+ *                          current page is skipped. Called as soon as a page has arrived, before the returned task
+ *                          is passed through the delivery block.
+ *
+ * @returns                 A `BFTask*` which resolves to nil when the iteration is finished or fails if a page could
+ *                          not be requested.
+ */
+- (BFTask *)enumerateDocumentsUsingBlock:(void (^)(GINIDocument *document, BOOL *stop))block;
+
+/**
+ * Cancels the pending requests. The iterator can not be used anymore afterwards.
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIDocumentIterator.h"
+
+
+/**
+ * A page of the iterator: its offset and the task of its request, which is nil as long as the page is not requested.
+ */
+@interface GINIDocumentIteratorPage : NSObject
+@property (readonly) NSUInteger offset;
+@property BFTask *task;
+@end
+
+@implementation GINIDocumentIteratorPage
+
+- (instancetype)initWithOffset:(NSUInteger)offset {
+    self = [super init];
+    if (self) {
+        _offset = offset;
+    }
+    return self;
+}
+
+@end
+
+
+@implementation GINIDocumentIterator {
+    BFTask *(^_pageBlock)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken);
+    GINIDocument *(^_documentBlock)(NSDictionary *apiResponse);
+    BFTask *(^_deliveryBlock)(BFTask *task);
+    BFCancellationTokenSource *_cancellationTokenSource;
+    /// The pages that are requested but not consumed yet, in order.
+    NSMutableArray<GINIDocumentIteratorPage *> *_pages;
+    /// The offset of the next page that is requested.
+    NSUInteger _nextOffset;
+    /// YES when a page with less than `pageSize` documents has arrived.
+    BOOL _reachedEnd;
+}
+
+#pragma mark - Factory
++ (instancetype)iteratorWithPageSize:(NSUInteger)pageSize
+                      readAheadDepth:(NSUInteger)readAheadDepth
+                           pageBlock:(BFTask *(^)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken))pageBlock
+                       documentBlock:(GINIDocument *(^)(NSDictionary *apiResponse))documentBlock {
+    return [self iteratorWithPageSize:pageSize readAheadDepth:readAheadDepth pageBlock:pageBlock documentBlock:documentBlock deliveryBlock:nil];
+}
+
++ (instancetype)iteratorWithPageSize:(NSUInteger)pageSize
+                      readAheadDepth:(NSUInteger)readAheadDepth
+                           pageBlock:(BFTask *(^)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken))pageBlock
+                       documentBlock:(GINIDocument *(^)(NSDictionary *apiResponse))documentBlock
+                       deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock {
+    return [[self alloc] initWithPageSize:pageSize readAheadDepth:readAheadDepth pageBlock:pageBlock documentBlock:documentBlock deliveryBlock:deliveryBlock];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithPageSize:(NSUInteger)pageSize
+                  readAheadDepth:(NSUInteger)readAheadDepth
+                       pageBlock:(BFTask *(^)(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken))pageBlock
+                   documentBlock:(GINIDocument *(^)(NSDictionary *apiResponse))documentBlock
+                   deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock {
+    NSParameterAssert(pageSize > 0);
+    NSParameterAssert(pageBlock);
+    NSParameterAssert(documentBlock);
+
+    self = [super init];
+    if (self) {
+        _pageSize = pageSize;
+        _readAheadDepth = readAheadDepth;
+        _pageBlock = [pageBlock copy];
+        _documentBlock = [documentBlock copy];
+        _deliveryBlock = [deliveryBlock copy];
+        _cancellationTokenSource = [BFCancellationTokenSource cancellationTokenSource];
+        _pages = [NSMutableArray new];
+        _totalCount = NSNotFound;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)totalCount {
+    @synchronized (self) {
+        return _totalCount;
+    }
+}
+
+- (BOOL)hasMorePages {
+    @synchronized (self) {
+        return [_pages count] > 0 || [self canRequestMorePages];
+    }
+}
+
+#pragma mark - Iterating
+- (BFTask *)nextPage {
+    return [self deliverResultOfTask:[self undeliveredNextPage]];
+}
+
+- (BFTask *)enumerateDocumentsUsingBlock:(void (^)(GINIDocument *document, BOOL *stop))block {
+    NSParameterAssert(block);
+
+    return [self deliverResultOfTask:[self enumerateRemainingDocumentsUsingBlock:block]];
+}
+
+- (void)cancel {
+    [_cancellationTokenSource cancel];
+}
+
+#pragma mark - Private methods
+
+/**
+ * Passes the task through the delivery block, if there is one. Only the tasks returned to the caller are delivered, so
+ * the pages of an enumeration don't hop to the delivery executor and back.
+ */
+- (BFTask *)deliverResultOfTask:(BFTask *)task {
+    return _deliveryBlock ? _deliveryBlock(task) : task;
+}
+
+/**
+ * Same as `nextPage`, but the returned task is not passed through the delivery block.
+ */
+- (BFTask *)undeliveredNextPage {
+    GINIDocumentIteratorPage *page;
+    @synchronized (self) {
+        if ([_pages count] == 0) {
+            [self requestNextPage];
+        }
+        page = [_pages firstObject];
+        if (!page) {
+            return [BFTask taskWithResult:@[]];
+        }
+        [_pages removeObjectAtIndex:0];
+        if (!page.task) {
+            page.task = [self requestPageAtOffset:page.offset];
+        }
+        [self readAhead];
+    }
+
+    return [page.task continueWithBlock:^id(BFTask *task) {
+        if (task.error) {
+            // Keep the page, so the next call requests it again.
+            @synchronized (self) {
+                [self->_pages insertObject:[[GINIDocumentIteratorPage alloc] initWithOffset:page.offset] atIndex:0];
+            }
+            return task;
+        }
+        if (task.cancelled) {
+            return task;
+        }
+        // The documents are created only now that the page is consumed.
+        NSArray *entries = task.result[@"documents"];
+        NSMutableArray<GINIDocument *> *documents = [NSMutableArray arrayWithCapacity:[entries count]];
+        for (NSDictionary *entry in entries) {
+            GINIDocument *document = self->_documentBlock(entry);
+            if (document) {
+                [documents addObject:document];
+            }
+        }
+        return documents;
+    }];
+}
+
+/**
+ * Same as `enumerateDocumentsUsingBlock:`, but the returned task is not passed through the delivery block.
+ */
+- (BFTask *)enumerateRemainingDocumentsUsingBlock:(void (^)(GINIDocument *document, BOOL *stop))block {
+    return [[self undeliveredNextPage] continueWithSuccessBlock:^id(BFTask *task) {
+        NSArray<GINIDocument *> *documents = task.result;
+        if ([documents count] == 0) {
+            return nil;
+        }
+        BOOL stop = NO;
+        for (GINIDocument *document in documents) {
+            block(document, &stop);
+            if (stop) {
+                return nil;
+            }
+        }
+        return [self enumerateRemainingDocumentsUsingBlock:block];
+    }];
+}
+
+#pragma mark - Requests
+
+/**
+ * Requests pages until `readAheadDepth` pages are pending after the consumed one. Must be called while synchronized.
+ */
+- (void)readAhead {
+    while ([_pages count] < _readAheadDepth && [self canRequestMorePages]) {
+        [self requestNextPage];
+    }
+}
+
+/**
+ * Requests the page after the pages requested so far, if there may be one. Must be called while synchronized.
+ */
+- (void)requestNextPage {
+    if (![self canRequestMorePages]) {
+        return;
+    }
+    GINIDocumentIteratorPage *page = [[GINIDocumentIteratorPage alloc] initWithOffset:_nextOffset];
+    page.task = [self requestPageAtOffset:_nextOffset];
+    [_pages addObject:page];
+    _nextOffset += _pageSize;
+}
+
+/**
+ * Whether there may be documents after the pages requested so far. Before the first page has arrived the total
+ * number of documents is unknown, so the pages are requested speculatively. Must be called while synchronized.
+ */
+- (BOOL)canRequestMorePages {
+    if (_reachedEnd || _cancellationTokenSource.cancellationRequested) {
+        return NO;
+    }
+    return _totalCount == NSNotFound || _nextOffset < _totalCount;
+}
+
+- (BFTask *)requestPageAtOffset:(NSUInteger)offset {
+    BFTask *pageTask = _pageBlock(_pageSize, offset, _cancellationTokenSource.token);
+    return [pageTask continueWithSuccessBlock:^id(BFTask *task) {
+        NSDictionary *response = task.result;
+        @synchronized (self) {
+            if ([response[@"totalCount"] isKindOfClass:[NSNumber class]]) {
+                self->_totalCount = [response[@"totalCount"] unsignedIntegerValue];
+            }
+            if ([response[@"documents"] count] < self->_pageSize) {
+                self->_reachedEnd = YES;
+            }
+        }
+        return response;
+    }];
+}
+
+@end
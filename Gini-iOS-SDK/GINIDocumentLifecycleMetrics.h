@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class GINIHistogram;
+
+
+/**
+ * The stages of a document's lifecycle for which the `GINIDocumentTaskManager` records latencies.
+ */
+typedef NS_ENUM(NSUInteger, GINIDocumentLifecycleStage) {
+    /// The time it takes to upload a document until the created document is available.
+    GINIDocumentLifecycleStageUpload,
+    /// The time a document spends in the PENDING state. Measured from the end of the upload (or from the start of
+    /// polling if the document was not uploaded by the same document task manager) until the document is processed.
+    GINIDocumentLifecycleStagePending,
+    /// The time it takes to fetch the extractions of a processed document.
+    GINIDocumentLifecycleStageExtractions,
+    /// The time it takes to submit feedback for a document.
+    GINIDocumentLifecycleStageFeedback
+};
+
+/// The doctype under which latencies of documents with an unknown doctype are recorded.
+extern NSString *const GINIDocumentLifecycleUnknownDocType;
+
+/**
+ * Returns a human readable name of the given lifecycle stage, e.g. "upload".
+ */
+NSString *GINIDocumentLifecycleStageName(GINIDocumentLifecycleStage stage);
+
+
+/**
+ * The `GINIDocumentLifecycleMetrics` collects latency histograms per lifecycle stage and doctype. An instance is
+ * maintained by every `GINIDocumentTaskManager` (see its `lifecycleMetrics` property).
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIDocumentLifecycleMetrics : NSObject
+
+/**
+ * Records the duration of a lifecycle stage.
+ *
+ * @param duration      The duration in seconds.
+ * @param stage         The lifecycle stage.
+ * @param docType       The doctype of the document or nil if the doctype is not known.
+ */
+- (void)recordDuration:(NSTimeInterval)duration forStage:(GINIDocumentLifecycleStage)stage docType:(NSString *)docType;
+
+/**
+ * Gets a copy of the histogram for the given lifecycle stage and doctype.
+ *
+ * @param stage         The lifecycle stage.
+ * @param docType       The doctype or nil to get the histogram of all doctypes combined.
+ *
+ * @returns             A `GINIHistogram` that is not updated anymore, or an empty histogram if nothing was recorded.
+ */
+- (GINIHistogram *)histogramForStage:(GINIDocumentLifecycleStage)stage docType:(NSString *)docType;
+
+/**
+ * Gets a copy of all histograms.
+ *
+ * @returns             A dictionary where the keys are the stage names (see `GINIDocumentLifecycleStageName`) and the
+ *                      values are dictionaries mapping the doctype to a `GINIHistogram`.
+ */
+- (NSDictionary<NSString *, NSDictionary<NSString *, GINIHistogram *> *> *)snapshot;
+
+/**
+ * Gets a copy of all histograms and removes all recorded values afterwards. Useful to periodically report the
+ * metrics of an interval.
+ */
+- (NSDictionary<NSString *, NSDictionary<NSString *, GINIHistogram *> *> *)snapshotAndReset;
+
+/**
+ * Removes all recorded values.
+ */
+- (void)reset;
+
+@end
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIDocumentLifecycleMetrics.h"
+#import "GINIHistogram.h"
+
+
+NSString *const GINIDocumentLifecycleUnknownDocType = @"unknown";
+
+NSString *GINIDocumentLifecycleStageName(GINIDocumentLifecycleStage stage) {
+    static NSArray *stageNames;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        stageNames = @[@"upload", @"pending", @"extractions", @"feedback"];
+    });
+    return stageNames[stage];
+}
+
+
+@implementation GINIDocumentLifecycleMetrics {
+    /// Maps the stage name to a mapping of doctype to `GINIHistogram`.
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, GINIHistogram *> *> *_histograms;
+}
+
+#pragma mark - Initializer
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _histograms = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Recording
+- (void)recordDuration:(NSTimeInterval)duration forStage:(GINIDocumentLifecycleStage)stage docType:(NSString *)docType {
+    NSString *stageName = GINIDocumentLifecycleStageName(stage);
+    NSString *key = docType ?: GINIDocumentLifecycleUnknownDocType;
+
+    GINIHistogram *histogram;
+    @synchronized (_histograms) {
+        NSMutableDictionary *stageHistograms = _histograms[stageName];
+        if (!stageHistograms) {
+            stageHistograms = [NSMutableDictionary new];
+            _histograms[stageName] = stageHistograms;
+        }
+        histogram = stageHistograms[key];
+        if (!histogram) {
+            histogram = [GINIHistogram new];
+            stageHistograms[key] = histogram;
+        }
+    }
+    // The histogram is thread-safe on its own, so the (short) recording happens outside of the lock.
+    [histogram recordValue:duration];
+}
+
+#pragma mark - Queries
+- (GINIHistogram *)histogramForStage:(GINIDocumentLifecycleStage)stage docType:(NSString *)docType {
+    NSDictionary *stageHistograms = [self snapshot][GINIDocumentLifecycleStageName(stage)];
+    if (docType) {
+        return stageHistograms[docType] ?: [GINIHistogram new];
+    }
+
+    GINIHistogram *combined = [GINIHistogram new];
+    for (GINIHistogram *histogram in [stageHistograms allValues]) {
+        [combined addHistogram:histogram];
+    }
+    return combined;
+}
+
+- (NSDictionary *)snapshot {
+    return [self snapshotResetting:NO];
+}
+
+- (NSDictionary *)snapshotAndReset {
+    return [self snapshotResetting:YES];
+}
+
+- (void)reset {
+    @synchronized (_histograms) {
+        [_histograms removeAllObjects];
+    }
+}
+
+#pragma mark - Private methods
+- (NSDictionary *)snapshotResetting:(BOOL)reset {
+    NSMutableDictionary *snapshot = [NSMutableDictionary new];
+    @synchronized (_histograms) {
+        for (NSString *stageName in _histograms) {
+            NSMutableDictionary *stageSnapshot = [NSMutableDictionary new];
+            NSDictionary *stageHistograms = _histograms[stageName];
+            for (NSString *docType in stageHistograms) {
+                stageSnapshot[docType] = [stageHistograms[docType] copy];
+            }
+            snapshot[stageName] = stageSnapshot;
+        }
+        if (reset) {
+            [_histograms removeAllObjects];
+        }
+    }
+    return snapshot;
+}
+
+@end
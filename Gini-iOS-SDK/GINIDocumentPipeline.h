@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class BFCancellationToken;
+@class GINIDocument;
+@class GINIDocumentMetadata;
+@class GINIDocumentTaskManager;
+
+
+/**
+ * The stages a document passes through in a `GINIDocumentPipeline`.
+ */
+typedef NS_ENUM(NSUInteger, GINIPipelineStage) {
+    /// The document is uploaded.
+    GINIPipelineStageUpload,
+    /// The document is polled until it is processed.
+    GINIPipelineStageProcessing,
+    /// The extractions of the document are fetched.
+    GINIPipelineStageExtractions
+};
+
+
+/**
+ * A file that is processed by a `GINIDocumentPipeline`.
+ */
+@interface GINIPipelineInput : NSObject
+
+/**
+ * Factory to create a new input.
+ *
+ * @param fileName      The file name of the document.
+ * @param data          Data representing the document.
+ * @param docType       The doctype hint for the document (optional).
+ * @param metadata      The document metadata (optional).
+ */
++ (instancetype)inputWithFileName:(NSString *)fileName
+                             data:(NSData *)data
+                          docType:(NSString *)docType
+                         metadata:(GINIDocumentMetadata *)metadata;
+
+@property (readonly) NSString *fileName;
+@property (readonly) NSData *data;
+@property (readonly) NSString *docType;
+@property (readonly) GINIDocumentMetadata *metadata;
+
+@end
+
+
+/**
+ * The outcome of an input of a `GINIDocumentPipeline`.
+ */
+@interface GINIPipelineResult : NSObject
+
+/// The input.
+@property (readonly) GINIPipelineInput *input;
+
+/// The created document, or nil if the upload failed.
+@property (readonly) GINIDocument *document;
+
+/// The extractions of the document (extraction name as key), or nil if the input failed.
+@property (readonly) NSDictionary *extractions;
+
+/// The error if a stage failed.
+@property (readonly) NSError *error;
+
+/// YES if the pipeline was cancelled before the input was finished.
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+/// The stage that failed or was cancelled. Only meaningful if `error` is set or `cancelled` is YES.
+@property (readonly) GINIPipelineStage failedStage;
+
+@end
+
+
+/**
+ * A `GINIDocumentPipeline` processes many documents: it uploads them, waits until they are processed and fetches their
+ * extractions. Each of these stages runs with its own concurrency limit, so a document is uploaded while others are
+ * still processed, and the throughput is bounded by the slowest stage instead of the latency of a single document.
+ *
+ * The inputs are pulled from the input block only when an upload can be started, and a stage does not start new
+ * documents while `bufferSize` documents are waiting for the next stage. So a slow stage holds back the stages
+ * before it instead of piling up documents, and the inputs don't need to be kept in memory all at once.
+ *
+ * A pipeline can only be started once.
+ */
+@interface GINIDocumentPipeline : NSObject
+
+/**
+ * Factory to create a new pipeline.
+ *
+ * @param documentTaskManager   The document task manager used to upload the documents and fetch the extractions.
+ */
++ (instancetype)pipelineWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager;
+
+/**
+ * The designated initializer.
+ *
+ * @param documentTaskManager   The document task manager used to upload the documents and fetch the extractions.
+ */
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager;
+
+/// The maximum number of uploads at the same time. Defaults to 2.
+@property NSUInteger maxConcurrentUploads;
+
+/// The maximum number of documents that are polled at the same time. Defaults to 16.
+@property NSUInteger maxConcurrentPolls;
+
+/// The maximum number of documents whose extractions are fetched at the same time. Defaults to 4.
+@property NSUInteger maxConcurrentExtractionFetches;
+
+/// The maximum number of documents waiting between two stages. Defaults to 8.
+@property NSUInteger bufferSize;
+
+/**
+ * Starts the pipeline.
+ *
+ * @param inputBlock            Called whenever an upload can be started. Returns the next input, or nil if there are
+ *                              no more inputs. Never called concurrently.
+ * @param resultBlock           Called with the outcome of each input in the order the inputs are finished. Never called
+ *                              concurrently. Called on the `decodingExecutor` of the document task manager, not on its
+ *                              `resultExecutor`.
+ * @param cancellationToken     Cancellation token used to cancel the pipeline. No more inputs are pulled and the
+ *                              running stages are cancelled.
+ *
+ * @returns                     A `BFTask*` which never fails and resolves to the number of inputs (as `NSNumber`)
+ *                              once all of them are finished. Completed on the `resultExecutor` of the document task
+ *                              manager.
+ */
+- (BFTask *)startWithInputBlock:(GINIPipelineInput *(^)(void))inputBlock
+                    resultBlock:(void (^)(GINIPipelineResult *result))resultBlock
+              cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Starts the pipeline with the given inputs (see `startWithInputBlock:resultBlock:cancellationToken:`).
+ *
+ * @param inputs                The inputs.
+ * @param resultBlock           Called with the outcome of each input in the order the inputs are finished.
+ * @param cancellationToken     Cancellation token used to cancel the pipeline.
+ */
+- (BFTask *)startWithInputs:(NSArray<GINIPipelineInput *> *)inputs
+                resultBlock:(void (^)(GINIPipelineResult *result))resultBlock
+          cancellationToken:(BFCancellationToken *)cancellationToken;
+
+@end
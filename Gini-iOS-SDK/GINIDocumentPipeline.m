@@ -0,0 +1,281 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIDocumentPipeline.h"
+#import "GINIDocumentTaskManager_Private.h"
+#import "GINIDocument.h"
+
+/// The number of stages of the pipeline.
+static const NSUInteger GINIPipelineStageCount = GINIPipelineStageExtractions + 1;
+
+
+@implementation GINIPipelineInput
+
+#pragma mark - Factory
++ (instancetype)inputWithFileName:(NSString *)fileName
+                             data:(NSData *)data
+                          docType:(NSString *)docType
+                         metadata:(GINIDocumentMetadata *)metadata {
+    return [[self alloc] initWithFileName:fileName data:data docType:docType metadata:metadata];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithFileName:(NSString *)fileName
+                            data:(NSData *)data
+                         docType:(NSString *)docType
+                        metadata:(GINIDocumentMetadata *)metadata {
+    NSParameterAssert([fileName isKindOfClass:[NSString class]]);
+    NSParameterAssert([data isKindOfClass:[NSData class]]);
+
+    self = [super init];
+    if (self) {
+        _fileName = [fileName copy];
+        _data = data;
+        _docType = [docType copy];
+        _metadata = metadata;
+    }
+    return self;
+}
+
+@end
+
+
+@interface GINIPipelineResult ()
+@property (readwrite) GINIDocument *document;
+@property (readwrite) NSDictionary *extractions;
+@property (readwrite) NSError *error;
+@property (readwrite, getter=isCancelled) BOOL cancelled;
+@property (readwrite) GINIPipelineStage failedStage;
+@end
+
+@implementation GINIPipelineResult
+
+- (instancetype)initWithInput:(GINIPipelineInput *)input {
+    self = [super init];
+    if (self) {
+        _input = input;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINIPipelineResult %@ document=%@ error=%@ cancelled=%d>",
+            _input.fileName, _document.documentId, _error, _cancelled];
+}
+
+@end
+
+
+@implementation GINIDocumentPipeline {
+    GINIDocumentTaskManager *_documentTaskManager;
+    GINIPipelineInput *(^_inputBlock)(void);
+    void (^_resultBlock)(GINIPipelineResult *result);
+    BFCancellationToken *_cancellationToken;
+    BFTaskCompletionSource *_completionSource;
+    /// The concurrency limits of the stages, fixed when the pipeline is started.
+    NSUInteger _limits[GINIPipelineStageCount];
+    /// The number of documents running in each stage.
+    NSUInteger _running[GINIPipelineStageCount];
+    /// The documents waiting for each stage. The queue of the upload stage is unused, its inputs come from the input block.
+    NSArray<NSMutableArray<GINIPipelineResult *> *> *_queues;
+    NSUInteger _bufferLimit;
+    BOOL _started;
+    BOOL _inputsExhausted;
+    BOOL _finished;
+    NSUInteger _inputCount;
+    /// Serializes the calls of the result block.
+    NSObject *_resultLock;
+}
+
+#pragma mark - Factory
++ (instancetype)pipelineWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager {
+    return [[self alloc] initWithDocumentTaskManager:documentTaskManager];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager {
+    NSParameterAssert([documentTaskManager isKindOfClass:[GINIDocumentTaskManager class]]);
+
+    self = [super init];
+    if (self) {
+        _documentTaskManager = documentTaskManager;
+        _maxConcurrentUploads = 2;
+        _maxConcurrentPolls = 16;
+        _maxConcurrentExtractionFetches = 4;
+        _bufferSize = 8;
+        _queues = @[[NSMutableArray new], [NSMutableArray new], [NSMutableArray new]];
+        _resultLock = [NSObject new];
+        _completionSource = [BFTaskCompletionSource taskCompletionSource];
+    }
+    return self;
+}
+
+#pragma mark - Running
+- (BFTask *)startWithInputs:(NSArray<GINIPipelineInput *> *)inputs
+                resultBlock:(void (^)(GINIPipelineResult *result))resultBlock
+          cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([inputs isKindOfClass:[NSArray class]]);
+
+    NSEnumerator *enumerator = [inputs objectEnumerator];
+    return [self startWithInputBlock:^GINIPipelineInput *{
+        return [enumerator nextObject];
+    } resultBlock:resultBlock cancellationToken:cancellationToken];
+}
+
+- (BFTask *)startWithInputBlock:(GINIPipelineInput *(^)(void))inputBlock
+                    resultBlock:(void (^)(GINIPipelineResult *result))resultBlock
+              cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert(inputBlock);
+
+    @synchronized (self) {
+        NSAssert(!_started, @"A pipeline can only be started once");
+        _started = YES;
+        _inputBlock = [inputBlock copy];
+        _resultBlock = [resultBlock copy];
+        _cancellationToken = cancellationToken;
+        _limits[GINIPipelineStageUpload] = MAX(self.maxConcurrentUploads, 1);
+        _limits[GINIPipelineStageProcessing] = MAX(self.maxConcurrentPolls, 1);
+        _limits[GINIPipelineStageExtractions] = MAX(self.maxConcurrentExtractionFetches, 1);
+        _bufferLimit = MAX(self.bufferSize, 1);
+    }
+    [cancellationToken registerCancellationObserverWithBlock:^{
+        [self pump];
+    }];
+    [self pump];
+    // The stages don't hop to the result executor of the document task manager, only the pipeline's result does.
+    return [_documentTaskManager deliverResultOfTask:_completionSource.task];
+}
+
+/**
+ * Starts as many documents in each stage as the concurrency limits and the buffers allow. Called whenever a stage has
+ * finished a document.
+ */
+- (void)pump {
+    NSMutableArray<NSArray *> *starts = [NSMutableArray new];
+    BOOL finished = NO;
+    @synchronized (self) {
+        if (_finished) {
+            return;
+        }
+        // The later stages are filled first, so they drain the buffers before the earlier stages check them.
+        for (NSInteger stage = GINIPipelineStageCount - 1; stage >= 0; stage--) {
+            while (_running[stage] < _limits[stage] && [self hasRoomAfterStage:stage]) {
+                GINIPipelineResult *item = [self nextItemForStage:stage];
+                if (!item) {
+                    break;
+                }
+                _running[stage] += 1;
+                [starts addObject:@[@(stage), item]];
+            }
+        }
+        finished = _inputsExhausted && [starts count] == 0 && [self isIdle];
+        _finished = finished;
+    }
+
+    for (NSArray *start in starts) {
+        [self runStage:[start[0] unsignedIntegerValue] withItem:start[1]];
+    }
+    if (finished) {
+        _inputBlock = nil;
+        _resultBlock = nil;
+        [_completionSource setResult:@(_inputCount)];
+    }
+}
+
+- (BOOL)hasRoomAfterStage:(GINIPipelineStage)stage {
+    if (stage + 1 >= GINIPipelineStageCount) {
+        return YES;
+    }
+    return [_queues[stage + 1] count] < _bufferLimit;
+}
+
+- (BOOL)isIdle {
+    for (NSUInteger stage = 0; stage < GINIPipelineStageCount; stage++) {
+        if (_running[stage] > 0 || [_queues[stage] count] > 0) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (GINIPipelineResult *)nextItemForStage:(GINIPipelineStage)stage {
+    if (stage != GINIPipelineStageUpload) {
+        NSMutableArray *queue = _queues[stage];
+        GINIPipelineResult *item = [queue firstObject];
+        if (item) {
+            [queue removeObjectAtIndex:0];
+        }
+        return item;
+    }
+
+    if (_inputsExhausted) {
+        return nil;
+    }
+    GINIPipelineInput *input = _cancellationToken.cancellationRequested ? nil : _inputBlock();
+    if (!input) {
+        _inputsExhausted = YES;
+        return nil;
+    }
+    _inputCount += 1;
+    return [[GINIPipelineResult alloc] initWithInput:input];
+}
+
+- (void)runStage:(GINIPipelineStage)stage withItem:(GINIPipelineResult *)item {
+    BFTask *stageTask;
+    if (_cancellationToken.cancellationRequested) {
+        stageTask = [BFTask cancelledTask];
+    } else {
+        stageTask = [self taskForStage:stage withItem:item] ?: [BFTask taskWithResult:nil];
+    }
+
+    [stageTask continueWithBlock:^id(BFTask *task) {
+        BOOL done = YES;
+        if (task.error || task.cancelled) {
+            item.error = task.error;
+            item.cancelled = task.cancelled;
+            item.failedStage = stage;
+        } else if (stage == GINIPipelineStageUpload || stage == GINIPipelineStageProcessing) {
+            item.document = task.result;
+            done = NO;
+        } else {
+            item.extractions = task.result;
+        }
+
+        if (done) {
+            @synchronized (self->_resultLock) {
+                if (self->_resultBlock) {
+                    self->_resultBlock(item);
+                }
+            }
+        }
+        @synchronized (self) {
+            self->_running[stage] -= 1;
+            if (!done) {
+                [self->_queues[stage + 1] addObject:item];
+            }
+        }
+        [self pump];
+        return nil;
+    }];
+}
+
+- (BFTask *)taskForStage:(GINIPipelineStage)stage withItem:(GINIPipelineResult *)item {
+    switch (stage) {
+        case GINIPipelineStageUpload:
+            return [_documentTaskManager privateCreateDocumentWithFilename:item.input.fileName
+                                                                  fromData:item.input.data
+                                                                   docType:item.input.docType
+                                                                  metadata:item.input.metadata
+                                                         cancellationToken:_cancellationToken];
+        case GINIPipelineStageProcessing:
+            return [_documentTaskManager privatePollDocument:item.document cancellationToken:_cancellationToken];
+        case GINIPipelineStageExtractions:
+            return [_documentTaskManager privateGetExtractionsForDocument:item.document cancellationToken:_cancellationToken];
+    }
+    return nil;
+}
+
+@end
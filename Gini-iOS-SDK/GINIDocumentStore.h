@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ * The `GINIDocumentStore` is an on-disk store (an SQLite database) for the API responses of documents and their
+ * extractions, keyed by the document ID. It lets an app show the documents and their extractions right after launch
+ * and then only fetch what changed, see the `documentStore` of the `GINIDocumentTaskManager`.
+ *
+ * The store contains the user's financial data (e.g. the extracted IBANs, amounts and payment recipients) and must be
+ * treated accordingly. The database and its journal files are protected with
+ * `NSFileProtectionCompleteUntilFirstUserAuthentication`, so they can't be read before the device is first unlocked.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIDocumentStore : NSObject
+
+/**
+ * Factory to create a new document store. The documents stored in the file by a previous store are available.
+ *
+ * @param fileURL       The file of the database, which is created if it does not exist.
+ */
++ (instancetype)documentStoreWithFileURL:(NSURL *)fileURL;
+
+/**
+ * The default file of the document store in the application support directory.
+ */
++ (NSURL *)defaultFileURL;
+
+/// The number of stored documents.
+@property (readonly) NSUInteger documentCount;
+
+/**
+ * The latest creation date of the stored documents, or nil if no document is stored. Documents created after this date
+ * are not known to the store.
+ */
+@property (readonly) NSDate *latestCreationDate;
+
+/**
+ * Stores the API response of a document (see `-[GINIAPIManager getDocument:]`), replacing the previous one of the
+ * document. The stored extractions of the document are kept.
+ *
+ * @param apiResponse   The API response of the document. Must contain the "id".
+ */
+- (void)storeDocumentResponse:(NSDictionary *)apiResponse;
+
+/**
+ * Stores the API response of the extractions of a document (see `-[GINIAPIManager getExtractionsForDocument:]`).
+ * Does nothing if the document itself is not stored.
+ *
+ * @param apiResponse   The API response of the extractions.
+ * @param documentId    The document's unique identifier.
+ */
+- (void)storeExtractionsResponse:(NSDictionary *)apiResponse forDocumentWithId:(NSString *)documentId;
+
+/**
+ * Applies submitted feedback to the stored extractions of a document. Does nothing if no extractions are stored.
+ *
+ * @param feedback      The feedback (the extraction name as the key and a dictionary with the "value" and optionally
+ *                      the "box" as value).
+ * @param documentId    The document's unique identifier.
+ */
+- (void)updateStoredExtractions:(NSDictionary<NSString *, NSDictionary *> *)feedback forDocumentWithId:(NSString *)documentId;
+
+/**
+ * The API responses of all stored documents, the most recently created document first.
+ */
+- (NSArray<NSDictionary *> *)documentResponses;
+
+/**
+ * The stored API response of the extractions of a document, or nil if they are not stored.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (NSDictionary *)extractionsResponseForDocumentWithId:(NSString *)documentId;
+
+/**
+ * Returns YES if the extractions of a document are stored. Cheaper than `extractionsResponseForDocumentWithId:`, since
+ * the response is not read.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (BOOL)hasExtractionsForDocumentWithId:(NSString *)documentId;
+
+/**
+ * Same as `documentResponses`, but the JSON data of the responses is not decoded, e.g. to decode it with the
+ * `GINIResourceDecoder`. The data is only valid during the call of the block.
+ *
+ * @param block         Called with the JSON data of each response.
+ */
+- (void)enumerateDocumentResponseDataUsingBlock:(void (^)(NSData *data))block;
+
+/**
+ * Same as `extractionsResponseForDocumentWithId:`, but the JSON data of the response is not decoded.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (NSData *)extractionsResponseDataForDocumentWithId:(NSString *)documentId;
+
+/**
+ * Removes a document and its extractions.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (void)removeDocumentWithId:(NSString *)documentId;
+
+/**
+ * Removes all documents, e.g. when the user logs out.
+ */
+- (void)removeAllDocuments;
+
+@end
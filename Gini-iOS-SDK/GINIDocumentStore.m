@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <sqlite3.h>
+#import "GINIDocumentStore.h"
+
+
+/**
+ * The schema of the database. The creation date is stored in seconds, the responses as JSON.
+ */
+static const char *GINIDocumentStoreSchema =
+    "PRAGMA journal_mode=WAL;"
+    "CREATE TABLE IF NOT EXISTS documents ("
+    "  id TEXT PRIMARY KEY NOT NULL,"
+    "  creation_date REAL NOT NULL,"
+    "  document BLOB NOT NULL,"
+    "  extractions BLOB"
+    ");"
+    "CREATE INDEX IF NOT EXISTS documents_creation_date ON documents (creation_date);";
+
+
+@implementation GINIDocumentStore {
+    NSURL *_fileURL;
+    sqlite3 *_database;
+}
+
+#pragma mark - Factory
++ (instancetype)documentStoreWithFileURL:(NSURL *)fileURL {
+    return [[self alloc] initWithFileURL:fileURL];
+}
+
++ (NSURL *)defaultFileURL {
+    NSURL *directory = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    return [directory URLByAppendingPathComponent:@"GINIDocuments.sqlite"];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithFileURL:(NSURL *)fileURL {
+    NSParameterAssert([fileURL isKindOfClass:[NSURL class]]);
+
+    self = [super init];
+    if (self) {
+        _fileURL = fileURL;
+        [[NSFileManager defaultManager] createDirectoryAtURL:[fileURL URLByDeletingLastPathComponent]
+                                 withIntermediateDirectories:YES
+                                                  attributes:nil
+                                                       error:nil];
+        // The database and its journal files are created with the data protection class, see `protectFiles`.
+        int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX | SQLITE_OPEN_FILEPROTECTION_COMPLETEUNTILFIRSTUSERAUTHENTICATION;
+        if (sqlite3_open_v2([[fileURL path] fileSystemRepresentation], &_database, flags, NULL) != SQLITE_OK ||
+            sqlite3_exec(_database, GINIDocumentStoreSchema, NULL, NULL, NULL) != SQLITE_OK) {
+            NSLog(@"Could not open the document store %@: %s", fileURL, sqlite3_errmsg(_database));
+            sqlite3_close(_database);
+            _database = NULL;
+        }
+        [self protectFiles];
+    }
+    return self;
+}
+
+/**
+ * Sets the data protection class of the database and its WAL and shared memory files, since they contain the
+ * extractions. SQLite only applies the class to files it creates, so this covers stores created by earlier versions.
+ */
+- (void)protectFiles {
+    NSDictionary *attributes = @{NSFileProtectionKey: NSFileProtectionCompleteUntilFirstUserAuthentication};
+    for (NSString *suffix in @[@"", @"-wal", @"-shm"]) {
+        NSString *path = [[_fileURL path] stringByAppendingString:suffix];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:path]) {
+            [[NSFileManager defaultManager] setAttributes:attributes ofItemAtPath:path error:nil];
+        }
+    }
+}
+
+- (void)dealloc {
+    sqlite3_close(_database);
+}
+
+#pragma mark - Properties
+- (NSUInteger)documentCount {
+    __block NSUInteger count = 0;
+    [self executeStatement:@"SELECT COUNT(*) FROM documents" arguments:@[] rowBlock:^(sqlite3_stmt *statement) {
+        count = (NSUInteger)sqlite3_column_int64(statement, 0);
+    }];
+    return count;
+}
+
+- (NSDate *)latestCreationDate {
+    __block NSDate *date;
+    [self executeStatement:@"SELECT MAX(creation_date) FROM documents" arguments:@[] rowBlock:^(sqlite3_stmt *statement) {
+        if (sqlite3_column_type(statement, 0) != SQLITE_NULL) {
+            date = [NSDate dateWithTimeIntervalSince1970:sqlite3_column_double(statement, 0)];
+        }
+    }];
+    return date;
+}
+
+#pragma mark - Storing
+- (void)storeDocumentResponse:(NSDictionary *)apiResponse {
+    NSString *documentId = apiResponse[@"id"];
+    NSData *data = [self dataWithResponse:apiResponse];
+    if (![documentId isKindOfClass:[NSString class]] || !data) {
+        return;
+    }
+    // The creation date of the API is in milliseconds, `GINIDocument` rounds it down to seconds.
+    NSNumber *creationDate = @(floor([apiResponse[@"creationDate"] doubleValue] / 1000));
+
+    @synchronized (self) {
+        [self executeStatement:@"INSERT OR IGNORE INTO documents (id, creation_date, document) VALUES (?, ?, ?)"
+                     arguments:@[documentId, creationDate, data]
+                      rowBlock:nil];
+        [self executeStatement:@"UPDATE documents SET creation_date = ?, document = ? WHERE id = ?"
+                     arguments:@[creationDate, data, documentId]
+                      rowBlock:nil];
+    }
+}
+
+- (void)storeExtractionsResponse:(NSDictionary *)apiResponse forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    NSData *data = [self dataWithResponse:apiResponse];
+    if (!data) {
+        return;
+    }
+    [self executeStatement:@"UPDATE documents SET extractions = ? WHERE id = ?" arguments:@[data, documentId] rowBlock:nil];
+}
+
+- (void)updateStoredExtractions:(NSDictionary<NSString *, NSDictionary *> *)feedback forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    @synchronized (self) {
+        NSMutableDictionary *response = [self extractionsResponseForDocumentWithId:documentId mutable:YES];
+        NSMutableDictionary *extractions = response[@"extractions"];
+        if (![extractions isKindOfClass:[NSMutableDictionary class]]) {
+            return;
+        }
+        for (NSString *name in feedback) {
+            NSMutableDictionary *extraction = [extractions[name] isKindOfClass:[NSDictionary class]] ? [extractions[name] mutableCopy] : [NSMutableDictionary new];
+            extraction[@"value"] = feedback[name][@"value"];
+            if (feedback[name][@"box"]) {
+                extraction[@"box"] = feedback[name][@"box"];
+            }
+            extractions[name] = extraction;
+        }
+        [self storeExtractionsResponse:response forDocumentWithId:documentId];
+    }
+}
+
+- (void)removeDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    [self executeStatement:@"DELETE FROM documents WHERE id = ?" arguments:@[documentId] rowBlock:nil];
+}
+
+- (void)removeAllDocuments {
+    [self executeStatement:@"DELETE FROM documents" arguments:@[] rowBlock:nil];
+}
+
+#pragma mark - Loading
+- (NSArray<NSDictionary *> *)documentResponses {
+    NSMutableArray *responses = [NSMutableArray new];
+    [self executeStatement:@"SELECT document FROM documents ORDER BY creation_date DESC" arguments:@[] rowBlock:^(sqlite3_stmt *statement) {
+        NSDictionary *response = [self responseInColumn:0 ofStatement:statement mutable:NO];
+        if (response) {
+            [responses addObject:response];
+        }
+    }];
+    return responses;
+}
+
+- (NSDictionary *)extractionsResponseForDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    return [self extractionsResponseForDocumentWithId:documentId mutable:NO];
+}
+
+- (id)extractionsResponseForDocumentWithId:(NSString *)documentId mutable:(BOOL)mutable {
+    __block NSDictionary *response;
+    [self executeStatement:@"SELECT extractions FROM documents WHERE id = ?" arguments:@[documentId] rowBlock:^(sqlite3_stmt *statement) {
+        response = [self responseInColumn:0 ofStatement:statement mutable:mutable];
+    }];
+    return response;
+}
+
+- (BOOL)hasExtractionsForDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    __block BOOL hasExtractions = NO;
+    [self executeStatement:@"SELECT extractions IS NOT NULL FROM documents WHERE id = ?" arguments:@[documentId] rowBlock:^(sqlite3_stmt *statement) {
+        hasExtractions = sqlite3_column_int(statement, 0) != 0;
+    }];
+    return hasExtractions;
+}
+
+- (void)enumerateDocumentResponseDataUsingBlock:(void (^)(NSData *data))block {
+    NSParameterAssert(block);
+
+    [self executeStatement:@"SELECT document FROM documents ORDER BY creation_date DESC" arguments:@[] rowBlock:^(sqlite3_stmt *statement) {
+        NSData *data = [self dataInColumn:0 ofStatement:statement];
+        if (data) {
+            block(data);
+        }
+    }];
+}
+
+- (NSData *)extractionsResponseDataForDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    __block NSData *data;
+    [self executeStatement:@"SELECT extractions FROM documents WHERE id = ?" arguments:@[documentId] rowBlock:^(sqlite3_stmt *statement) {
+        data = [[self dataInColumn:0 ofStatement:statement] copy];
+    }];
+    return data;
+}
+
+#pragma mark - Private methods
+
+- (NSData *)dataWithResponse:(NSDictionary *)response {
+    if (![NSJSONSerialization isValidJSONObject:response]) {
+        return nil;
+    }
+    return [NSJSONSerialization dataWithJSONObject:response options:0 error:nil];
+}
+
+/**
+ * The blob in a column of the current row, without copying it. The data is only valid until the statement is stepped.
+ */
+- (NSData *)dataInColumn:(int)column ofStatement:(sqlite3_stmt *)statement {
+    const void *bytes = sqlite3_column_blob(statement, column);
+    int length = sqlite3_column_bytes(statement, column);
+    if (!bytes || length == 0) {
+        return nil;
+    }
+    return [NSData dataWithBytesNoCopy:(void *)bytes length:(NSUInteger)length freeWhenDone:NO];
+}
+
+- (id)responseInColumn:(int)column ofStatement:(sqlite3_stmt *)statement mutable:(BOOL)mutable {
+    NSData *data = [self dataInColumn:column ofStatement:statement];
+    if (!data) {
+        return nil;
+    }
+    id response = [NSJSONSerialization JSONObjectWithData:data options:mutable ? NSJSONReadingMutableContainers : 0 error:nil];
+    return [response isKindOfClass:[NSDictionary class]] ? response : nil;
+}
+
+/**
+ * Executes the statement with the given arguments (strings, numbers and data) and calls the row block for each row of
+ * the result.
+ */
+- (BOOL)executeStatement:(NSString *)sql arguments:(NSArray *)arguments rowBlock:(void (^)(sqlite3_stmt *statement))rowBlock {
+    @synchronized (self) {
+        if (!_database) {
+            return NO;
+        }
+        sqlite3_stmt *statement;
+        if (sqlite3_prepare_v2(_database, [sql UTF8String], -1, &statement, NULL) != SQLITE_OK) {
+            NSLog(@"Could not prepare the statement %@: %s", sql, sqlite3_errmsg(_database));
+            return NO;
+        }
+        for (NSUInteger i = 0; i < [arguments count]; i++) {
+            id argument = arguments[i];
+            int index = (int)i + 1;
+            if ([argument isKindOfClass:[NSString class]]) {
+                sqlite3_bind_text(statement, index, [argument UTF8String], -1, SQLITE_TRANSIENT);
+            } else if ([argument isKindOfClass:[NSData class]]) {
+                sqlite3_bind_blob(statement, index, [argument bytes], (int)[argument length], SQLITE_TRANSIENT);
+            } else if ([argument isKindOfClass:[NSNumber class]]) {
+                sqlite3_bind_double(statement, index, [argument doubleValue]);
+            } else {
+                sqlite3_bind_null(statement, index);
+            }
+        }
+        int result;
+        while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+            if (rowBlock) {
+                rowBlock(statement);
+            }
+        }
+        sqlite3_finalize(statement);
+        if (result != SQLITE_DONE) {
+            NSLog(@"Could not execute the statement %@: %s", sql, sqlite3_errmsg(_database));
+            return NO;
+        }
+        return YES;
+    }
+}
+
+@end
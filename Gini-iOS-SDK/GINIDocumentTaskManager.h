@@ -8,8 +8,21 @@
 #import "GINIAPIManager.h"
 #import "GINIPartialDocumentInfo.h"
 #import "GINIDocumentMetadata.h"
+#import "GINIDocumentLifecycleMetrics.h"
+#import "GINITracer.h"
+#import "GINIDocumentBundle.h"
+#import "GINIOutbox.h"
+#import "GINIBulkOperation.h"
+#import "GINIDocumentIterator.h"
+#import "GINISearchSession.h"
+#import "GINIDocumentStore.h"
+#import "GINIExtractionIndex.h"
+#import "GINILayoutParser.h"
+#import "GINIIndexedLayoutPage.h"
+#import "GINIDocumentTextIndex.h"
 
 @class BFTask;
+@class BFExecutor;
 @class GINIDocument;
 @class GINIExtraction;
 
@@ -46,6 +59,81 @@
  */
 @property NSUInteger pollingInterval;
 
+/**
+ * Latency histograms for the stages of the document lifecycle (upload, processing, fetching the extractions and
+ * submitting feedback), recorded per doctype for all successful operations of this document task manager.
+ *
+ * Use `snapshot` or `snapshotAndReset` to periodically report the metrics, e.g. to detect regressions in the field.
+ */
+@property (readonly) GINIDocumentLifecycleMetrics *lifecycleMetrics;
+
+/**
+ * If > 0, the extractions updated with `updateExtraction:forDocument:` are not submitted one by one, but collected per
+ * document and submitted as one batch feedback when no extraction of the document has been updated for this number of
+ * seconds, or when the feedback is flushed with `flushFeedbackForDocument:` or `flushFeedback`. All tasks of the updates
+ * of a batch resolve with the result of the batch submission. Defaults to 0.
+ */
+@property NSTimeInterval feedbackDebounceInterval;
+
+/**
+ * If set, feedback, error reports and deletions that fail because the device is offline (or with a 5xx or 429
+ * response) are queued in the outbox and submitted when the network is reachable again. The tasks of queued operations
+ * resolve to nil instead of failing. The local effects of a queued operation (removing a deleted document from the
+ * document store, writing feedback through to the extractions) are only applied once the outbox has submitted it, so
+ * they are never applied if the outbox drops the operation. Defaults to nil.
+ *
+ * The size of the queue and the latency until queued operations are submitted are available as metrics of the outbox.
+ */
+@property GINIOutbox *outbox;
+
+/**
+ * If set, the documents and their extractions are stored in the document store as they are fetched, so they are
+ * available right after the next launch with `storedDocuments`; the extractions of stored documents are not downloaded
+ * again. Use `syncDocumentStoreWithCancellationToken:` to fetch only the new and changed documents. Defaults to nil.
+ */
+@property GINIDocumentStore *documentStore;
+
+/**
+ * If set, the extractions of documents are added to the extraction index as they are fetched and updated with
+ * submitted feedback, so documents can be searched by their extraction values without a request. Defaults to nil.
+ */
+@property GINIExtractionIndex *extractionIndex;
+
+/**
+ * The maximum number of requests the bulk methods (e.g. `deleteDocumentsWithIds:itemResultBlock:cancellationToken:`)
+ * run at the same time. Defaults to 4.
+ */
+@property NSUInteger maxConcurrentBulkOperations;
+
+/**
+ * The tracer that records the operations of this document task manager as spans, or nil if the operations are not
+ * traced (the default).
+ *
+ * Every operation (e.g. `createDocumentWithFilename:fromData:docType:`) is recorded as a span which is a child of the
+ * span that is current when the operation is started, and every HTTP request of the operation is recorded as a child
+ * of the operation's span. The trace context is sent to the Gini API in the `traceparent` HTTP header.
+ */
+@property (nonatomic) GINITracer *tracer;
+
+/**
+ * The executor on which the responses of the Gini API are turned into models (documents, extractions, layouts), must
+ * not be nil. Defaults to `+[BFExecutor defaultExecutor]`. SDK instances created with the `GINISDKBuilder` use the
+ * same dedicated concurrent queue as their `GINIAPIManager`, see `-[GINISDKBuilder useDecodingQualityOfService:]`.
+ */
+@property (nonatomic) BFExecutor *decodingExecutor;
+
+/**
+ * The executor on which the tasks returned by the operations of this document task manager are completed, so the
+ * continuations of the caller run there, or nil to complete them on the `decodingExecutor` (the default). This includes
+ * the tasks of the returned `GINIDocumentBundle` and `GINIDocumentIterator` instances. See
+ * `-[GINISDKBuilder useResultQueue:]`.
+ *
+ * Only the task returned to the caller is completed on this executor. The steps of an operation (e.g. polling the
+ * documents of a bulk operation) don't hop to it, so the `itemResultBlock` of the bulk operations is called on the
+ * `decodingExecutor`.
+ */
+@property (nonatomic) BFExecutor *resultExecutor;
+
 /**
  * Gets the document with the given id.
  *
@@ -499,6 +587,22 @@
  */
 - (BFTask *)updateExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document;
 
+/**
+ * Submits the collected feedback of the given document immediately, see `feedbackDebounceInterval`.
+ *
+ * @param document      The document.
+ *
+ * @returns             A `BFTask*` resolving to the result of the submission, or to nil if there was no collected
+ *                      feedback.
+ */
+- (BFTask *)flushFeedbackForDocument:(GINIDocument *)document;
+
+/**
+ * Submits the collected feedback of all documents immediately, e.g. when the app goes to the background. See
+ * `feedbackDebounceInterval`.
+ */
+- (BFTask *)flushFeedback;
+
 /**
  * Gets the layout for the given document.
  *
@@ -515,6 +619,198 @@
 - (BFTask *)getLayoutForDocument:(GINIDocument *)document
                cancellationToken:(BFCancellationToken *)cancellationToken;
 
+/**
+ * Gets the layout for the given document page by page while it is downloaded, so the first page can be shown before
+ * the whole layout has been downloaded. Unlike `getLayoutForDocument:`, the layout is not cached by the document.
+ *
+ * @param document                  The document.
+ * @param pageBlock                 Called serially with each page (in the format of the JSON layout) as soon as it has
+ *                                  been downloaded, on a background thread.
+ * @param cancellationToken         Cancellation token used to cancel the download.
+ *
+ * @returns                         A `BFTask*` that will resolve to the number of pages (NSNumber*).
+ */
+- (BFTask *)getLayoutPagesForDocument:(GINIDocument *)document
+                            pageBlock:(GINILayoutPageBlock)pageBlock
+                    cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Gets the layout for the given document in a compact form for hit-testing, see `GINIIndexedLayoutPage`.
+ *
+ * @param document                  The document.
+ * @param cancellationToken         Cancellation token used to cancel the current task.
+ *
+ * @returns                         A `BFTask*` that will resolve to an array of `GINIIndexedLayoutPage` objects.
+ */
+- (BFTask *)getIndexedLayoutForDocument:(GINIDocument *)document
+                      cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Gets the text index of the given document to find text in it, see `GINIDocumentTextIndex`. The index is built from
+ * the layout once and cached by the document.
+ *
+ * @param document                  The document.
+ * @param cancellationToken         Cancellation token used to cancel the current task.
+ *
+ * @returns                         A `BFTask*` that will resolve to a `GINIDocumentTextIndex`.
+ */
+- (BFTask *)getTextIndexForDocument:(GINIDocument *)document
+                  cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Polls the document once and then fetches all requested sub-resources concurrently, instead of polling the document
+ * again for each of them and fetching them one after another.
+ *
+ * @param document                  The document.
+ * @param contents                  The sub-resources that are fetched.
+ * @param previewSize               The size of the preview if `GINIDocumentBundleContentsFirstPagePreview` is requested.
+ * @param cancellationToken         Cancellation token used to cancel the polling and the returned tasks.
+ *
+ * @returns                         The bundle with the tasks of the document and the sub-resources.
+ */
+- (GINIDocumentBundle *)getBundleForDocument:(GINIDocument *)document
+                                    contents:(GINIDocumentBundleContents)contents
+                                 previewSize:(GiniApiPreviewSize)previewSize
+                           cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Same as `getBundleForDocument:contents:previewSize:cancellationToken:`, but for the document with the given ID.
+ *
+ * @param documentId                The document's unique identifier.
+ * @param contents                  The sub-resources that are fetched.
+ * @param previewSize               The size of the preview if `GINIDocumentBundleContentsFirstPagePreview` is requested.
+ * @param cancellationToken         Cancellation token used to cancel the polling and the returned tasks.
+ */
+- (GINIDocumentBundle *)getBundleForDocumentWithId:(NSString *)documentId
+                                          contents:(GINIDocumentBundleContents)contents
+                                       previewSize:(GiniApiPreviewSize)previewSize
+                                 cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Returns an iterator over all documents of the user. The next pages are requested while the current one is consumed.
+ *
+ * @param pageSize                  The number of documents per page.
+ * @param readAheadDepth            The number of pages that are requested ahead of the consumed page.
+ */
+- (GINIDocumentIterator *)documentIteratorWithPageSize:(NSUInteger)pageSize
+                                        readAheadDepth:(NSUInteger)readAheadDepth;
+
+/**
+ * Searches for documents containing the given words. For searching while the user is typing, use a
+ * `GINISearchSession`.
+ *
+ * @param searchTerm                The search term(s) separated by space.
+ * @param docType                   Restrict the search to a specific doctype (optional).
+ * @param limit                     The maximum number of documents to return.
+ * @param offset                    The start offset.
+ * @param cancellationToken         Cancellation token used to cancel the search, including the HTTP request.
+ *
+ * @returns                         A `BFTask*` resolving to a `GINISearchResult`.
+ */
+- (BFTask *)searchDocumentsWithTerm:(NSString *)searchTerm
+                            docType:(NSString *)docType
+                              limit:(NSUInteger)limit
+                             offset:(NSUInteger)offset
+                  cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Returns an iterator over the documents containing the given words. The next pages are requested while the current
+ * one is consumed.
+ *
+ * @param searchTerm                The search term(s) separated by space.
+ * @param docType                   Restrict the search to a specific doctype.
+ * @param pageSize                  The number of documents per page.
+ * @param readAheadDepth            The number of pages that are requested ahead of the consumed page.
+ */
+- (GINIDocumentIterator *)searchIteratorWithTerm:(NSString *)searchTerm
+                                         docType:(NSString *)docType
+                                        pageSize:(NSUInteger)pageSize
+                                  readAheadDepth:(NSUInteger)readAheadDepth;
+
+/**
+ * Returns the documents in the `documentStore`, the most recently created document first, without any request. The
+ * extractions of the documents are read from the store as well when they are requested.
+ */
+- (NSArray<GINIDocument *> *)storedDocuments;
+
+/**
+ * Brings the `documentStore` up to date: lists the documents created since the latest creation date in the store,
+ * refreshes the stored documents which were still being processed and downloads the extractions of the new documents.
+ * The document list of the Gini API is expected to be ordered by creation date, the most recent document first.
+ *
+ * The synchronization is incremental, so the store is not fully reconciled with the Gini API: documents deleted on the
+ * server by another client stay in the store, and stored documents which are no longer being processed are not
+ * refreshed. Documents deleted with this document task manager are removed from the store. To reconcile the store, e.g.
+ * after a long time offline, call `removeAllDocuments` on the store and synchronize again.
+ *
+ * @param cancellationToken         Cancellation token used to cancel the synchronization.
+ *
+ * @returns                         A `BFTask*` resolving to the new and changed `GINIDocument` instances.
+ */
+- (BFTask *)syncDocumentStoreWithCancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Deletes the documents with the given IDs, at most `maxConcurrentBulkOperations` at a time.
+ *
+ * @param documentIds               The IDs of the documents.
+ * @param itemResultBlock           Called with the outcome of each document as soon as it has been deleted (optional).
+ * @param cancellationToken         Cancellation token used to cancel the deletions.
+ *
+ * @returns                         A `BFTask*` which never fails and resolves to a `GINIBulkResult` with the outcome
+ *                                  of each document.
+ */
+- (BFTask *)deleteDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                   itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                 cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Gets the documents with the given IDs, at most `maxConcurrentBulkOperations` at a time.
+ *
+ * @param documentIds               The IDs of the documents.
+ * @param itemResultBlock           Called with the outcome of each document as soon as it has been fetched (optional).
+ * @param cancellationToken         Cancellation token used to cancel the requests.
+ *
+ * @returns                         A `BFTask*` which never fails and resolves to a `GINIBulkResult` whose results are
+ *                                  the `GINIDocument` instances.
+ */
+- (BFTask *)getDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+              cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Gets the extractions of the documents with the given IDs, at most `maxConcurrentBulkOperations` documents at a time.
+ * Documents which are not fully processed yet are polled first (see `getExtractionsForDocument:`).
+ *
+ * @param documentIds               The IDs of the documents.
+ * @param itemResultBlock           Called with the outcome of each document as soon as its extractions have been
+ *                                  fetched (optional).
+ * @param cancellationToken         Cancellation token used to cancel the polling and the requests.
+ *
+ * @returns                         A `BFTask*` which never fails and resolves to a `GINIBulkResult` whose results are
+ *                                  the mappings with the extractions (extraction name as key).
+ */
+- (BFTask *)getExtractionsForDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                              itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                            cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Saves the updates on the extractions of several documents, at most `maxConcurrentBulkOperations` documents at a
+ * time. As with `updateDocument:updatedExtractions:cancellationToken:` only the changed extractions are submitted. Only
+ * the documents without a `GINIDocument` instance are fetched before their feedback is submitted.
+ *
+ * @param updatedExtractions        The updated extractions (a mapping of the extraction name to the `GINIExtraction`)
+ *                                  with the document ID as key.
+ * @param itemResultBlock           Called with the outcome of each document as soon as its feedback has been submitted
+ *                                  (optional).
+ * @param cancellationToken         Cancellation token used to cancel the requests.
+ *
+ * @returns                         A `BFTask*` which never fails and resolves to a `GINIBulkResult` with the outcome
+ *                                  of each document.
+ */
+- (BFTask *)updateDocumentsWithIds:(NSDictionary<NSString *, NSDictionary *> *)updatedExtractions
+                   itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                 cancellationToken:(BFCancellationToken *)cancellationToken;
+
 /**
  * Report an error for a specific document. If the processing result for a document was not satisfactory (e.g.
  * extractions where empty or incorrect), you can create an error report for a document. This allows Gini to analyze and
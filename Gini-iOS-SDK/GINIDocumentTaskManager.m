@@ -4,12 +4,18 @@
  */
 
 #import "GINIDocumentTaskManager.h"
+#import "GINIDocumentTaskManager_Private.h"
 #import "GINIDocument.h"
+#import "GINIDocument_Private.h"
 #import "GINIExtraction.h"
 #import "GINIError.h"
 #import <Bolts/Bolts.h>
 #import "NSData+MimeTypes.h"
 #import "GINIConstants.h"
+#import "GINIHistogram.h"
+#import "GINIFeedbackBuffer.h"
+#import "GINIOutbox.h"
+#import "GINIResourceDecoder.h"
 
 /**
  * Handles common HTTP errors and expected errors that occur during task execution.
@@ -38,9 +44,48 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
     }];
 }
 
+/**
+ * Returns the representation of an extraction value in the `serverExtractions` of a document.
+ */
+static NSDictionary *GINIServerExtraction(NSString *value, NSDictionary *box) {
+    NSMutableDictionary *serverExtraction = [NSMutableDictionary dictionaryWithCapacity:2];
+    serverExtraction[@"value"] = value;
+    serverExtraction[@"box"] = box;
+    return serverExtraction;
+}
+
+/**
+ * Wraps the given continuation block, so it runs with the span that is current when this function is called as the
+ * current span. Continuations run on other threads, so without this the HTTP requests made in the continuation would
+ * not belong to the trace of the operation.
+ */
+static BFContinuationBlock GINITracedContinuation(BFContinuationBlock block) {
+    GINISpan *span = [GINISpan currentSpan];
+    if (!span) {
+        return block;
+    }
+    return ^id(BFTask *task) {
+        return GINISpanPerform(span, ^id{
+            return block(task);
+        });
+    };
+}
+
 
 @implementation GINIDocumentTaskManager {
     GINIAPIManager *_apiManager;
+    /// Maps the document ID to the doctype the document was uploaded with. Used to record the lifecycle metrics.
+    NSMutableDictionary<NSString *, NSString *> *_docTypes;
+    /// Maps the document ID to the monotonic timestamp since when the document is known to be PENDING.
+    NSMutableDictionary<NSString *, NSNumber *> *_pendingSince;
+    /// The identity map of the documents: maps the document ID weakly to the one instance of the document.
+    NSMapTable<NSString *, GINIDocument *> *_documents;
+    /// Collects the updated extractions if `feedbackDebounceInterval` is > 0.
+    GINIFeedbackBuffer *_feedbackBuffer;
+    /// Decodes the stored responses directly into the models.
+    GINIResourceDecoder *_resourceDecoder;
+    /// The outbox, see `outbox`. Only accessed while holding the lock.
+    GINIOutbox *_outbox;
 }
 
 #pragma mark - Factory
@@ -57,6 +102,17 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
     if (self) {
         _apiManager = apiManager;
         _pollingInterval = 1;
+        _maxConcurrentBulkOperations = 4;
+        _lifecycleMetrics = [GINIDocumentLifecycleMetrics new];
+        _docTypes = [NSMutableDictionary new];
+        _pendingSince = [NSMutableDictionary new];
+        _documents = [NSMapTable strongToWeakObjectsMapTable];
+        _resourceDecoder = [GINIResourceDecoder resourceDecoderWithDocumentManager:self];
+        _decodingExecutor = [BFExecutor defaultExecutor];
+        __weak GINIDocumentTaskManager *weakSelf = self;
+        _feedbackBuffer = [GINIFeedbackBuffer feedbackBufferWithDebounceInterval:0 submitBlock:^BFTask *(GINIDocument *document, NSDictionary *feedback, NSArray<GINIExtraction *> *extractions) {
+            return [weakSelf submitBufferedFeedback:feedback extractions:extractions forDocument:document];
+        }];
     }
     return self;
 }
@@ -135,18 +191,35 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
                                docType:(NSString *)docType
                               metadata:metadata
                      cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateCreateDocumentWithFilename:fileName
+                                                                   fromData:data
+                                                                    docType:docType
+                                                                   metadata:metadata
+                                                          cancellationToken:cancellationToken]];
+}
+
+- (BFTask *)privateCreateDocumentWithFilename:(NSString *)fileName
+                                     fromData:(NSData *)data
+                                      docType:(NSString *)docType
+                                     metadata:(GINIDocumentMetadata *)metadata
+                            cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([fileName isKindOfClass:[NSString class]]);
     NSParameterAssert([data isKindOfClass:[NSData class]]);
     
-    BFTask *createTask = [[_apiManager uploadDocumentWithData:data
-                                                  contentType:[data mimeType]
-                                                     fileName:fileName
-                                                      docType:docType
-                                                     metadata:metadata
-                                            cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
-        return [GINIDocument documentFromAPIResponse:task.result withDocumentManager:self];
+    return [self traceUndeliveredOperation:@"createDocument" usingBlock:^BFTask *{
+        NSTimeInterval uploadStart = GINIMonotonicTimestamp();
+        BFTask *createTask = [[self->_apiManager uploadDocumentWithData:data
+                                                            contentType:[data mimeType]
+                                                               fileName:fileName
+                                                                docType:docType
+                                                               metadata:metadata
+                                                      cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            GINIDocument *document = [self documentFromAPIResponse:task.result];
+            [self didUploadDocument:document docType:docType uploadStart:uploadStart];
+            return document;
+        }];
+        return GINIhandleHTTPerrors(createTask);
     }];
-    return GINIhandleHTTPerrors(createTask);
 
 }
 
@@ -176,16 +249,21 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
         concreteType = lastContentTypeComponent;
     }
     
-    BFTask *createTask = [[_apiManager createPartialDocumentWithData:data
-                                                 partialDocumentType:concreteType
-                                                            fileName:fileName
-                                                             docType:docType
-                                                            metadata:metadata
-                                                   cancellationToken:cancellationToken]
-                          continueWithSuccessBlock:^id(BFTask *task) {
-        return [GINIDocument documentFromAPIResponse:task.result withDocumentManager:self];
+    return [self traceOperation:@"createPartialDocument" usingBlock:^BFTask *{
+        NSTimeInterval uploadStart = GINIMonotonicTimestamp();
+        BFTask *createTask = [[self->_apiManager createPartialDocumentWithData:data
+                                                           partialDocumentType:concreteType
+                                                                      fileName:fileName
+                                                                       docType:docType
+                                                                      metadata:metadata
+                                                             cancellationToken:cancellationToken]
+                              continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            GINIDocument *document = [self documentFromAPIResponse:task.result];
+            [self didUploadDocument:document docType:docType uploadStart:uploadStart];
+            return document;
+        }];
+        return GINIhandleHTTPerrors(createTask);
     }];
-    return GINIhandleHTTPerrors(createTask);
 }
 
 - (BFTask *)createCompositeDocumentWithPartialDocumentsInfo:(NSArray<GINIPartialDocumentInfo *>*)partialDocumentsInfo
@@ -203,14 +281,20 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
                                                    fileName:(NSString *)fileName docType:(NSString *)docType
                                                    metadata:(GINIDocumentMetadata *)metadata
                                           cancellationToken:(BFCancellationToken *)cancellationToken {
-    BFTask* createTask = [[_apiManager createCompositeDocumentWithPartialDocumentsInfo:partialDocumentsInfo
-                                                                              fileName:fileName
-                                                                               docType:docType
-                                                                              metadata:metadata
-                                                                     cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
-        return [GINIDocument documentFromAPIResponse:task.result withDocumentManager:self];
+    return [self traceOperation:@"createCompositeDocument" usingBlock:^BFTask *{
+        BFTask* createTask = [[self->_apiManager createCompositeDocumentWithPartialDocumentsInfo:partialDocumentsInfo
+                                                                                        fileName:fileName
+                                                                                         docType:docType
+                                                                                        metadata:metadata
+                                                                               cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            GINIDocument *document = [self documentFromAPIResponse:task.result];
+            // Composite documents are processed like any other document, so the time in PENDING is tracked as well.
+            [self rememberDocType:docType forDocument:document];
+            [self markPendingDocument:document];
+            return document;
+        }];
+        return GINIhandleHTTPerrors(createTask);
     }];
-    return GINIhandleHTTPerrors(createTask);
 }
 
 - (BFTask *)errorReportForDocument:(GINIDocument *)document
@@ -218,8 +302,13 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
                        description:(NSString *)description{
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    BFTask *errorReportTask = [_apiManager reportErrorForDocument:document.documentId summary:summary description:description];
-    return GINIhandleHTTPerrors(errorReportTask);
+    return [self traceOperation:@"errorReport" usingBlock:^BFTask *{
+        BFTask *errorReportTask = [self->_apiManager reportErrorForDocument:document.documentId summary:summary description:description];
+        errorReportTask = [self queueInOutboxOnTransientError:errorReportTask usingBlock:^(GINIOutbox *outbox) {
+            [outbox enqueueErrorReportWithSummary:summary description:description forDocumentWithId:document.documentId];
+        }];
+        return GINIhandleHTTPerrors(errorReportTask);
+    }];
 }
 
 - (BFTask *)getDocumentWithId:(NSString *)documentId{
@@ -227,13 +316,22 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 }
 
 - (BFTask *)getDocumentWithId:(NSString *)documentId cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateGetDocumentWithId:documentId cancellationToken:cancellationToken]];
+}
+
+/**
+ * Same as `getDocumentWithId:cancellationToken:`, but the returned task is not completed on the `resultExecutor`.
+ */
+- (BFTask *)privateGetDocumentWithId:(NSString *)documentId cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
-    BFTask *documentTask = [[_apiManager getDocument:documentId cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
-        GINIDocument *document = [GINIDocument documentFromAPIResponse:task.result withDocumentManager:self];
-        return document;
+    return [self traceUndeliveredOperation:@"getDocument" usingBlock:^BFTask *{
+        BFTask *documentTask = [[self->_apiManager getDocument:documentId cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            GINIDocument *document = [self documentFromAPIResponse:task.result];
+            return document;
+        }];
+        return GINIhandleHTTPerrors(documentTask);
     }];
-    return GINIhandleHTTPerrors(documentTask);
 }
 
 - (BFTask *)getPreviewForPage:(NSUInteger)page
@@ -249,8 +347,10 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
     NSParameterAssert(page > 0);
     NSParameterAssert(page <= document.pageCount);
     
-    BFTask *pageTask = [_apiManager getPreviewForPage:page ofDocument:document.documentId withSize:size cancellationToken:cancellationToken];
-    return GINIhandleHTTPerrors(pageTask);
+    return [self traceOperation:@"getPreview" usingBlock:^BFTask *{
+        BFTask *pageTask = [self->_apiManager getPreviewForPage:page ofDocument:document.documentId withSize:size cancellationToken:cancellationToken];
+        return GINIhandleHTTPerrors(pageTask);
+    }];
 }
 
 - (BFTask *)deleteDocument:(GINIDocument *)document {
@@ -267,37 +367,71 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 
 - (BFTask *)deleteCompositeDocumentWithId:(NSString *)documentId
                         cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateDeleteDocumentWithId:documentId cancellationToken:cancellationToken]];
+}
+
+/**
+ * Same as `deleteCompositeDocumentWithId:cancellationToken:`, but the returned task is not completed on the
+ * `resultExecutor`.
+ */
+- (BFTask *)privateDeleteDocumentWithId:(NSString *)documentId
+                      cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
-    return GINIhandleHTTPerrors([_apiManager deleteDocument:documentId cancellationToken:cancellationToken]);
+    return [self traceUndeliveredOperation:@"deleteDocument" usingBlock:^BFTask *{
+        // A queued deletion is only applied locally once the outbox has submitted it, see `setOutbox:`.
+        BFTask *deleteTask = [[self->_apiManager deleteDocument:documentId cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
+            [self didDeleteDocumentWithId:documentId];
+            return task;
+        }];
+        return GINIhandleHTTPerrors([self queueInOutboxOnTransientError:deleteTask usingBlock:^(GINIOutbox *outbox) {
+            [outbox enqueueDeletionOfDocumentWithId:documentId];
+        }]);
+    }];
 }
 
 - (BFTask *)deletePartialDocumentWithId:(NSString *)documentId
                       cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
-    return [[self getDocumentWithId:documentId] continueWithSuccessBlock:^id(BFTask *task) {
-        
-        GINIDocument *document = (GINIDocument*) task.result;
-        return [[self deleteDocumentsWithUrls:document.compositeDocuments
-                            cancellationToken:cancellationToken]
-                continueWithSuccessBlock: ^id(BFTask *task) {
-            return GINIhandleHTTPerrors([self->_apiManager deleteDocument:document.documentId
-                                                       cancellationToken:cancellationToken]);
-        }];
+    return [self traceOperation:@"deletePartialDocument" usingBlock:^BFTask *{
+        return [[self privateGetDocumentWithId:documentId cancellationToken:nil] continueWithExecutor:self->_decodingExecutor withSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
+            
+            GINIDocument *document = (GINIDocument*) task.result;
+            return [[self deleteDocumentsWithUrls:document.compositeDocuments
+                                cancellationToken:cancellationToken]
+                    continueWithExecutor:self->_decodingExecutor withSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
+                return [self privateDeleteDocumentWithId:document.documentId cancellationToken:cancellationToken];
+            })];
+        })];
     }];
 }
 
 - (BFTask *)deleteDocumentsWithUrls:(NSArray<NSString*> *)urls
                   cancellationToken:(BFCancellationToken *)cancellationToken {
-    NSMutableArray<BFTask *>* deleteTasks = [NSMutableArray new];
-    
+    NSMutableArray<NSString *> *documentIds = [NSMutableArray arrayWithCapacity:[urls count]];
     for (NSString* url in urls) {
-        NSString* documentId = [[url componentsSeparatedByString:@"/"] lastObject];
-        [deleteTasks addObject:[self deleteCompositeDocumentWithId:documentId cancellationToken:cancellationToken]];
+        [documentIds addObject:[[url componentsSeparatedByString:@"/"] lastObject]];
     }
     
-    return [BFTask taskForCompletionOfAllTasks:deleteTasks];
+    BFTask *bulkTask = [self runBulkOperationWithDocumentIds:documentIds itemResultBlock:nil cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+        return [self privateDeleteDocumentWithId:documentId cancellationToken:cancellationToken];
+    }];
+    return [bulkTask continueWithExecutor:_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+        GINIBulkResult *bulkResult = task.result;
+        // Fail like `taskForCompletionOfAllTasks:` did, so callers keep seeing a single error.
+        NSArray<NSError *> *errors = [bulkResult.errors allValues];
+        if ([errors count] == 1) {
+            return [BFTask taskWithError:[errors firstObject]];
+        } else if ([errors count] > 1) {
+            return [BFTask taskWithError:[NSError errorWithDomain:BFTaskErrorDomain
+                                                             code:kBFMultipleErrorsError
+                                                         userInfo:@{BFTaskMultipleErrorsUserInfoKey: errors}]];
+        } else if ([bulkResult.cancelledDocumentIds count] > 0) {
+            return [BFTask cancelledTask];
+        }
+        return nil;
+    }];
 }
 
 - (BFTask *)pollDocument:(GINIDocument *)document {
@@ -306,6 +440,11 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 
 - (BFTask *)pollDocument:(GINIDocument *)document
        cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privatePollDocument:document cancellationToken:cancellationToken]];
+}
+
+- (BFTask *)privatePollDocument:(GINIDocument *)document
+              cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
     // Immediately return already processed documents.
@@ -313,8 +452,8 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
         return [BFTask taskWithResult:document];
     }
     
-    return [self pollDocumentWithId:document.documentId
-                  cancellationToken:cancellationToken];
+    return [self tracedPollDocumentWithId:document.documentId
+                        cancellationToken:cancellationToken];
 }
 
 - (BFTask *)pollDocumentWithId:(NSString *)documentId{
@@ -323,116 +462,285 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 
 - (BFTask *)pollDocumentWithId:(NSString *)documentId
              cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self tracedPollDocumentWithId:documentId cancellationToken:cancellationToken]];
+}
+
+/**
+ * Same as `pollDocumentWithId:cancellationToken:`, but the returned task is not completed on the `resultExecutor`.
+ */
+- (BFTask *)tracedPollDocumentWithId:(NSString *)documentId
+                   cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([documentId isKindOfClass:[NSString class]]);
     
-    BFTask *pollTask = [self privatePollDocumentWithId:documentId cancellationToken:cancellationToken];
-    return GINIhandleHTTPerrors(pollTask);
+    return [self traceUndeliveredOperation:@"pollDocument" usingBlock:^BFTask *{
+        BFTask *pollTask = [self privatePollDocumentWithId:documentId cancellationToken:cancellationToken];
+        return GINIhandleHTTPerrors(pollTask);
+    }];
 }
 
 
 - (BFTask *)privatePollDocumentWithId:(NSString *)documentId
                     cancellationToken:(BFCancellationToken *)cancellationToken {
-    return [[_apiManager getDocument:documentId cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
+    return [[_apiManager getDocument:documentId cancellationToken:cancellationToken] continueWithExecutor:_decodingExecutor withSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
         NSDictionary *polledDocument = task.result;
         // If the document is not fully processed yet, wait a second and then poll again.
         if ([polledDocument[@"progress"] isEqualToString:@"PENDING"]) {
-            return [[BFTask taskWithDelay:(int)self.pollingInterval * 1000 cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *waitTask) {
+            @synchronized (self->_docTypes) {
+                if (!self->_pendingSince[documentId]) {
+                    self->_pendingSince[documentId] = @(GINIMonotonicTimestamp());
+                }
+            }
+            return [[BFTask taskWithDelay:(int)self.pollingInterval * 1000 cancellationToken:cancellationToken] continueWithSuccessBlock:GINITracedContinuation(^id(BFTask *waitTask) {
                 return [self privatePollDocumentWithId:documentId cancellationToken:cancellationToken];
-            }];
+            })];
             // Otherwise return the document.
         } else {
-            return [GINIDocument documentFromAPIResponse:task.result withDocumentManager:self];
+            [self didFinishProcessingDocumentWithId:documentId];
+            return [self documentFromAPIResponse:task.result];
         }
-    }];
+    })];
 }
 
 - (BFTask *)updateDocument:(GINIDocument *)document {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    BFTask *updateTask = [[self getExtractionsForDocument: document] continueWithSuccessBlock:^id(BFTask *task) {
-        NSDictionary *extractions = task.result;
-        NSMutableDictionary *updateExtractions = [NSMutableDictionary new];
-        
-        NSArray *keys = @[@"paymentReference", @"iban", @"bic", @"amountToPay", @"paymentRecipient", @"paymentPurpose"];
-        for (NSString *key in extractions) {
-                if ([keys containsObject:key]) {
-                        GINIExtraction *extraction = extractions[key];
-                        updateExtractions[key] = @{@"value": extraction.value};
-                    }
-            }
-        
-        return [self->_apiManager submitBatchFeedbackForDocument:document.documentId feedback:updateExtractions];
+    return [self traceOperation:@"updateDocument" usingBlock:^BFTask *{
+        BFTask *updateTask = [[self privateGetExtractionsForDocument:document cancellationToken:nil] continueWithExecutor:self->_decodingExecutor withSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
+            return [self submitFeedbackForExtractions:task.result ofDocument:document];
+        })];
+        return GINIhandleHTTPerrors(updateTask);
     }];
-
-    return GINIhandleHTTPerrors(updateTask);
 }
                           
 
 - (BFTask *)updateDocument:(GINIDocument *)document
         updatedExtractions:(NSDictionary *)updatedExtractions
          cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateUpdateDocument:document updatedExtractions:updatedExtractions]];
+}
+
+/**
+ * Same as `updateDocument:updatedExtractions:cancellationToken:`, but the returned task is not completed on the
+ * `resultExecutor`.
+ */
+- (BFTask *)privateUpdateDocument:(GINIDocument *)document updatedExtractions:(NSDictionary *)updatedExtractions {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    NSMutableDictionary *filteredUpdatedExtractions = [NSMutableDictionary new];
-    
-    // When updating a document you are providing feedback to the API, that's why
-    // only the main parameters are sent.
-    NSArray *keys = @[ExtractionPaymentReferenceKey,
-                      ExtractionIbanKey,
-                      ExtractionBicKey,
-                      ExtractionAmountToPayKey,
-                      ExtractionPaymentRecipientKey,
-                      ExtractionPaymentPurposeKey];
-    for (NSString *key in updatedExtractions) {
-        if ([keys containsObject:key]) {
-            GINIExtraction *extraction = updatedExtractions[key];
-            filteredUpdatedExtractions[key] = @{@"value": extraction.value};
+    return [self traceUndeliveredOperation:@"updateDocument" usingBlock:^BFTask *{
+        return GINIhandleHTTPerrors([self submitFeedbackForExtractions:updatedExtractions ofDocument:document]);
+    }];
+}
+
+/**
+ * Returns the feedback for the given extractions: only the changed extractions, i.e. the ones whose value differs from
+ * the last known value on the server, are included. If the values on the server are unknown, all extractions are
+ * included.
+ *
+ * When updating a document you are providing feedback to the API, that's why only the main parameters are sent.
+ */
+- (NSDictionary *)feedbackForExtractions:(NSDictionary *)extractions ofDocument:(GINIDocument *)document {
+    static NSArray *keys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @[ExtractionPaymentReferenceKey,
+                 ExtractionIbanKey,
+                 ExtractionBicKey,
+                 ExtractionAmountToPayKey,
+                 ExtractionPaymentRecipientKey,
+                 ExtractionPaymentPurposeKey];
+    });
+
+    NSDictionary *serverExtractions = document.serverExtractions;
+    NSMutableDictionary *feedback = [NSMutableDictionary new];
+    for (NSString *key in keys) {
+        GINIExtraction *extraction = extractions[key];
+        if (!extraction.value) {
+            continue;
+        }
+        if (serverExtractions && [serverExtractions[key][@"value"] isEqual:extraction.value]) {
+            continue;
         }
+        feedback[key] = @{@"value": extraction.value};
+    }
+    return feedback;
+}
+
+/**
+ * Submits the changed extractions as feedback, see `feedbackForExtractions:ofDocument:`, and writes them through to the
+ * document. If nothing changed, no request is made at all.
+ */
+- (BFTask *)submitFeedbackForExtractions:(NSDictionary *)extractions ofDocument:(GINIDocument *)document {
+    NSDictionary *feedback = [self feedbackForExtractions:extractions ofDocument:document];
+    if ([feedback count] == 0) {
+        return [BFTask taskWithResult:nil];
+    }
+    NSMutableArray<GINIExtraction *> *submittedExtractions = [NSMutableArray arrayWithCapacity:[feedback count]];
+    for (NSString *name in feedback) {
+        GINIExtraction *extraction = extractions[name];
+        [submittedExtractions addObject:[GINIExtraction extractionWithName:name value:extraction.value entity:extraction.entity box:extraction.box]];
+    }
+    BFTask *submitTask = [self measureStage:GINIDocumentLifecycleStageFeedback ofDocumentWithId:document.documentId usingBlock:^BFTask *{
+        return [self->_apiManager submitBatchFeedbackForDocument:document.documentId feedback:feedback];
+    }];
+    // Queued feedback is only written through once the outbox has submitted it, see `setOutbox:`.
+    submitTask = [submitTask continueWithSuccessBlock:^id(BFTask *task) {
+        [self writeExtractions:submittedExtractions throughToDocument:document];
+        return task;
+    }];
+    return [self queueInOutboxOnTransientError:submitTask usingBlock:^(GINIOutbox *outbox) {
+        [outbox enqueueFeedback:feedback forDocumentWithId:document.documentId];
+    }];
+}
+
+#pragma mark - Outbox
+
+- (GINIOutbox *)outbox {
+    @synchronized (self) {
+        return _outbox;
+    }
+}
+
+/**
+ * Sets the outbox and applies the operations it submits to the local state. Queued operations may still be dropped by
+ * the outbox, so their effects are not applied when they are queued.
+ */
+- (void)setOutbox:(GINIOutbox *)outbox {
+    __weak GINIDocumentTaskManager *weakSelf = self;
+    outbox.feedbackSubmittedBlock = ^(NSString *documentId, NSDictionary *feedback) {
+        [weakSelf didSubmitQueuedFeedback:feedback forDocumentWithId:documentId];
+    };
+    outbox.deletionSubmittedBlock = ^(NSString *documentId) {
+        [weakSelf didDeleteDocumentWithId:documentId];
+    };
+    @synchronized (self) {
+        _outbox = outbox;
+    }
+}
+
+/**
+ * Writes feedback submitted by the outbox through to the document, or to the document store and the extraction index if
+ * there is no instance of the document.
+ */
+- (void)didSubmitQueuedFeedback:(NSDictionary *)feedback forDocumentWithId:(NSString *)documentId {
+    GINIDocument *document;
+    @synchronized (_documents) {
+        document = [_documents objectForKey:documentId];
+    }
+    if (!document) {
+        [self.documentStore updateStoredExtractions:feedback forDocumentWithId:documentId];
+        [self.extractionIndex updateIndexedExtractions:feedback forDocumentWithId:documentId];
+        return;
+    }
+    NSMutableArray<GINIExtraction *> *extractions = [NSMutableArray arrayWithCapacity:[feedback count]];
+    for (NSString *name in feedback) {
+        [extractions addObject:[GINIExtraction extractionWithName:name value:feedback[name][@"value"] entity:nil box:feedback[name][@"box"]]];
+    }
+    [self writeExtractions:extractions throughToDocument:document];
+}
+
+/**
+ * Removes all local state of a document that has been deleted on the server.
+ */
+- (void)didDeleteDocumentWithId:(NSString *)documentId {
+    [self forgetLifecycleStateOfDocumentWithId:documentId];
+    [self.documentStore removeDocumentWithId:documentId];
+    [self.extractionIndex removeDocumentWithId:documentId];
+    @synchronized (_documents) {
+        [_documents removeObjectForKey:documentId];
+    }
+}
+
+/**
+ * If an outbox is set and the given task fails with a transient error (e.g. because the device is offline), the
+ * operation is queued in the outbox with the given block and the returned task resolves to nil instead of failing.
+ */
+- (BFTask *)queueInOutboxOnTransientError:(BFTask *)task usingBlock:(void (^)(GINIOutbox *outbox))block {
+    GINIOutbox *outbox = self.outbox;
+    if (!outbox) {
+        return task;
+    }
+    return [task continueWithBlock:^id(BFTask *operationTask) {
+        if (operationTask.error && [GINIOutbox isTransientError:operationTask.error]) {
+            block(outbox);
+            return nil;
+        }
+        return operationTask;
+    }];
+}
+
+#pragma mark - Identity map
+
+/**
+ * Creates the document for the given API response. If there is already an instance of the document, the new state is
+ * merged into it and the existing instance is returned, so all parts of an app share one instance (and its cached
+ * results) per document.
+ */
+- (GINIDocument *)documentFromAPIResponse:(NSDictionary *)apiResponse {
+    GINIDocument *document = [self mergedDocumentFromAPIResponse:apiResponse];
+    if (document) {
+        [self.documentStore storeDocumentResponse:apiResponse];
+    }
+    return document;
+}
+
+/**
+ * Same as `documentFromAPIResponse:`, but the response is not written to the document store.
+ */
+- (GINIDocument *)mergedDocumentFromAPIResponse:(NSDictionary *)apiResponse {
+    return [self mergedDocument:[GINIDocument documentFromAPIResponse:apiResponse withDocumentManager:self]];
+}
+
+/**
+ * Returns the one instance of the given document, see `-[GINIDocument mergeDocument:]`.
+ */
+- (GINIDocument *)mergedDocument:(GINIDocument *)document {
+    if (!document) {
+        return nil;
+    }
+    @synchronized (_documents) {
+        GINIDocument *existingDocument = [_documents objectForKey:document.documentId];
+        if (existingDocument) {
+            [existingDocument mergeDocument:document];
+            return existingDocument;
+        }
+        [_documents setObject:document forKey:document.documentId];
+        return document;
     }
-    
-    BFTask *updateTask = [self->_apiManager submitBatchFeedbackForDocument:document.documentId feedback:filteredUpdatedExtractions];
-    return GINIhandleHTTPerrors(updateTask);
 }
 
 #pragma mark - Extraction methods
 
 - (BFTask *)createExtractionsForGetTask:(BFTask *)getTask {
-    return [getTask continueWithSuccessBlock:^id(BFTask *task) {
+    return [getTask continueWithExecutor:_decodingExecutor withSuccessBlock:^id(BFTask *task) {
         NSDictionary *apiResponse = task.result;
         // First of all, create the candidates.
-        NSMutableDictionary *giniCandidates = [NSMutableDictionary new];
-        NSDictionary *candidatesMapping = [apiResponse valueForKey:@"candidates"];
+        NSDictionary *candidatesMapping = apiResponse[@"candidates"];
+        NSMutableDictionary *giniCandidates = [NSMutableDictionary dictionaryWithCapacity:[candidatesMapping count]];
         for (NSString *entity in candidatesMapping) {
             NSArray *candidates = candidatesMapping[entity];
-            giniCandidates[entity] = [NSMutableArray new];
-            
-            for (NSUInteger i=0; i < [candidates count]; i++) {
-                NSDictionary *candidate = candidates[i];
+            NSMutableArray *entityCandidates = [NSMutableArray arrayWithCapacity:[candidates count]];
+            for (NSDictionary *candidate in candidates) {
                 GINIExtraction *giniExtraction = [GINIExtraction extractionWithName:nil
-                                                                              value:[candidate valueForKey:@"value"]
+                                                                              value:candidate[@"value"]
                                                                              entity:entity
-                                                                                box:[candidate valueForKey:@"box"]];
-                [giniCandidates[entity] addObject:giniExtraction];
+                                                                                box:candidate[@"box"]];
+                [entityCandidates addObject:giniExtraction];
             }
-            
+            giniCandidates[entity] = entityCandidates;
         }
-        
+
         // And then create the extractions.
-        NSMutableDictionary *extractions = [apiResponse valueForKey:@"extractions"];
-        NSMutableDictionary *giniExtractions = [NSMutableDictionary new];
+        NSDictionary *extractions = apiResponse[@"extractions"];
+        NSMutableDictionary *giniExtractions = [NSMutableDictionary dictionaryWithCapacity:[extractions count]];
+        NSArray *noCandidates = @[];
         for (NSString *name in extractions) {
             NSDictionary *extraction = extractions[name];
-            NSString *entity = [extraction valueForKey:@"entity"];
-            NSArray *candidatesForExtraction;
-            if (giniCandidates[entity]) {
-                candidatesForExtraction = giniCandidates[entity];
-            } else {
-                candidatesForExtraction = [NSArray new];
-            }
+            NSString *entity = extraction[@"entity"];
+            NSArray *candidatesForExtraction = (entity ? giniCandidates[entity] : nil) ?: noCandidates;
             GINIExtraction *giniExtraction = [GINIExtraction extractionWithName:name
-                                                                          value:[extraction valueForKey:@"value"]
+                                                                          value:extraction[@"value"]
                                                                          entity:entity
-                                                                            box:[extraction valueForKey:@"box"]];
+                                                                            box:extraction[@"box"]];
             giniExtraction.candidates = candidatesForExtraction;
             giniExtractions[name] = giniExtraction;
         }
@@ -441,17 +749,85 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
     }];
 }
 
+/**
+ * Returns a task resolving to the processed extractions response (see `createExtractionsForGetTask:`) of the document
+ * without polling it. The response is cached by the document, so the extractions and the candidates are only downloaded
+ * once. The shared download is not cancelled by the cancellation token, only the returned task is. Extractions in the
+ * document store are used instead of downloading them.
+ *
+ * Every caller gets its own copies of the extractions and the candidates, so it can change them and enumerate them while
+ * feedback is written through to the cache.
+ */
+- (BFTask *)cachedExtractionsResponseForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
+    BFTask *cachedTask = [document cachedExtractionsUsingBlock:^BFTask *{
+        GINIDocumentStore *documentStore = self.documentStore;
+        NSData *storedResponse = document.state == GiniDocumentStateComplete ? [documentStore extractionsResponseDataForDocumentWithId:document.documentId] : nil;
+        NSMutableDictionary *storedExtractions = storedResponse ? [GINIResourceDecoder extractionsWithData:storedResponse error:nil] : nil;
+        BFTask *extractionsTask;
+        if (storedExtractions) {
+            extractionsTask = [BFTask taskWithResult:storedExtractions];
+        } else {
+            extractionsTask = [self createExtractionsForGetTask:[[self measureStage:GINIDocumentLifecycleStageExtractions ofDocumentWithId:document.documentId usingBlock:^BFTask *{
+                return [self->_apiManager getExtractionsForDocument:document.documentId cancellationToken:nil];
+            }] continueWithSuccessBlock:^id(BFTask *task) {
+                [documentStore storeExtractionsResponse:task.result forDocumentWithId:document.documentId];
+                return task;
+            }]];
+        }
+        return [extractionsTask continueWithSuccessBlock:^id(BFTask *task) {
+            // Remember the values on the server before the extractions are handed out and possibly changed.
+            NSDictionary *extractions = task.result[@"extractions"];
+            NSMutableDictionary *serverExtractions = [NSMutableDictionary dictionaryWithCapacity:[extractions count]];
+            for (NSString *name in extractions) {
+                GINIExtraction *extraction = extractions[name];
+                serverExtractions[name] = GINIServerExtraction(extraction.value, extraction.box);
+            }
+            document.serverExtractions = serverExtractions;
+            [self.extractionIndex indexExtractions:extractions forDocumentWithId:document.documentId];
+            return task;
+        }];
+    }];
+    return [cachedTask continueWithSuccessBlock:^id(BFTask *cachedResponseTask) {
+        NSDictionary *cachedResponse = cachedResponseTask.result;
+        NSMutableDictionary *response = [NSMutableDictionary dictionaryWithCapacity:2];
+        response[@"extractions"] = [cachedResponse[@"extractions"] mutableCopy];
+        response[@"candidates"] = [cachedResponse[@"candidates"] mutableCopy];
+        return response;
+    } cancellationToken:cancellationToken];
+}
+
+/**
+ * Same as `cachedExtractionsResponseForDocument:cancellationToken:`, but for the layout.
+ */
+- (BFTask *)cachedLayoutForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
+    BFTask *cachedTask = [document cachedLayoutUsingBlock:^BFTask *{
+        return [self->_apiManager getLayoutForDocument:document.documentId responseType:GiniAPIResponseTypeJSON cancellationToken:nil];
+    }];
+    return [cachedTask continueWithBlock:^id(BFTask *cachedLayoutTask) {
+        return cachedLayoutTask;
+    } cancellationToken:cancellationToken];
+}
+
+/**
+ * Polls the document and then returns the cached extractions response, see
+ * `cachedExtractionsResponseForDocument:cancellationToken:`.
+ */
+- (BFTask *)extractionsResponseForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [[self privatePollDocument:document cancellationToken:cancellationToken] continueWithExecutor:_decodingExecutor withBlock:GINITracedContinuation(^id(BFTask *task) {
+        return [self cachedExtractionsResponseForDocument:document cancellationToken:cancellationToken];
+    })];
+}
+
 - (BFTask *)getCandidatesForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    BFTask *extractionsTask = [[self pollDocument:document cancellationToken:cancellationToken] continueWithBlock:^id(BFTask *task) {
-        return [[self createExtractionsForGetTask:[self->_apiManager getExtractionsForDocument:document.documentId
-                                                                             cancellationToken:cancellationToken]] continueWithSuccessBlock:^id(BFTask *task) {
+    return [self traceOperation:@"getCandidates" usingBlock:^BFTask *{
+        BFTask *candidatesTask = [[self extractionsResponseForDocument:document cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
             NSDictionary *results = task.result;
             return [results valueForKey:@"candidates"];
-        }] ;
+        }];
+        return GINIhandleHTTPerrors(candidatesTask);
     }];
-    return GINIhandleHTTPerrors(extractionsTask);
 }
 
 - (BFTask *)getExtractionsForDocument:(GINIDocument *)document {
@@ -460,16 +836,20 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 
 - (BFTask *)getExtractionsForDocument:(GINIDocument *)document
                     cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateGetExtractionsForDocument:document cancellationToken:cancellationToken]];
+}
+
+- (BFTask *)privateGetExtractionsForDocument:(GINIDocument *)document
+                           cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    BFTask *extractionsTask = [[self pollDocument:document cancellationToken:cancellationToken] continueWithBlock:^id(BFTask *task) {
-        return [[self createExtractionsForGetTask:[self->_apiManager getExtractionsForDocument:document.documentId
-                                                                             cancellationToken:cancellationToken]] continueWithSuccessBlock:^id(BFTask *task) {
+    return [self traceUndeliveredOperation:@"getExtractions" usingBlock:^BFTask *{
+        BFTask *extractionsTask = [[self extractionsResponseForDocument:document cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
             NSDictionary *results = task.result;
             return [results valueForKey:@"extractions"];
-        }] ;
+        }];
+        return GINIhandleHTTPerrors(extractionsTask);
     }];
-    return GINIhandleHTTPerrors(extractionsTask);
 }
 
 - (BFTask *)getIncubatorExtractionsForDocument:(GINIDocument *)document {
@@ -480,9 +860,11 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
                              cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
     
-    BFTask *extractionsTask = [self createExtractionsForGetTask:[_apiManager getIncubatorExtractionsForDocument:document.documentId
-                                                                                              cancellationToken:cancellationToken]];
-    return GINIhandleHTTPerrors(extractionsTask);
+    return [self traceOperation:@"getIncubatorExtractions" usingBlock:^BFTask *{
+        BFTask *extractionsTask = [self createExtractionsForGetTask:[self->_apiManager getIncubatorExtractionsForDocument:document.documentId
+                                                                                                        cancellationToken:cancellationToken]];
+        return GINIhandleHTTPerrors(extractionsTask);
+    }];
 }
 
 - (BFTask *)getLayoutForDocument:(GINIDocument *)document {
@@ -490,32 +872,591 @@ BFTask*GINIhandleHTTPerrors(BFTask *originalTask){
 }
 
 - (BFTask *)getLayoutForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self privateGetLayoutForDocument:document cancellationToken:cancellationToken]];
+}
+
+/**
+ * Same as `getLayoutForDocument:cancellationToken:`, but the returned task is not completed on the `resultExecutor`.
+ */
+- (BFTask *)privateGetLayoutForDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+    return [self traceUndeliveredOperation:@"getLayout" usingBlock:^BFTask *{
+        BFTask *layoutTask = [[self privatePollDocument:document cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withBlock:GINITracedContinuation(^id(BFTask *task) {
+            return [self cachedLayoutForDocument:document cancellationToken:cancellationToken];
+        })];
+        return GINIhandleHTTPerrors(layoutTask);
+    }];
+}
+
+- (BFTask *)getLayoutPagesForDocument:(GINIDocument *)document
+                            pageBlock:(GINILayoutPageBlock)pageBlock
+                    cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+    NSParameterAssert(pageBlock);
+
+    return [self traceOperation:@"getLayoutPages" usingBlock:^BFTask *{
+        BFTask *layoutTask = [[self privatePollDocument:document cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor successBlock:GINITracedContinuation(^id(BFTask *task) {
+            return [self->_apiManager getLayoutForDocument:document.documentId
+                                              responseType:GiniAPIResponseTypeJSON
+                                                 pageBlock:pageBlock
+                                         cancellationToken:cancellationToken];
+        }) cancellationToken:cancellationToken];
+        return GINIhandleHTTPerrors(layoutTask);
+    }];
+}
+
+- (BFTask *)getIndexedLayoutForDocument:(GINIDocument *)document
+                      cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    return [self traceOperation:@"getIndexedLayout" usingBlock:^BFTask *{
+        BFTask *indexTask = [[self privatePollDocument:document cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor successBlock:GINITracedContinuation(^id(BFTask *task) {
+            return [[self cachedLayoutForDocument:document cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *layoutTask) {
+                if (![layoutTask.result isKindOfClass:[NSDictionary class]]) {
+                    return @[];
+                }
+                return [GINIIndexedLayoutPage indexedLayoutPagesWithLayout:layoutTask.result];
+            }];
+        }) cancellationToken:cancellationToken];
+        return GINIhandleHTTPerrors(indexTask);
+    }];
+}
+
+- (BFTask *)getTextIndexForDocument:(GINIDocument *)document
+                  cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    return [self traceOperation:@"getTextIndex" usingBlock:^BFTask *{
+        BFTask *textIndexTask = [[self privatePollDocument:document cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor successBlock:GINITracedContinuation(^id(BFTask *task) {
+            // Like the layout, the index is shared by all callers and not cancelled by their tokens.
+            return [[document cachedTextIndexUsingBlock:^BFTask *{
+                return [[self cachedLayoutForDocument:document cancellationToken:nil] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *layoutTask) {
+                    NSDictionary *layout = [layoutTask.result isKindOfClass:[NSDictionary class]] ? layoutTask.result : @{};
+                    return [GINIDocumentTextIndex textIndexWithLayoutPages:[GINIIndexedLayoutPage indexedLayoutPagesWithLayout:layout]];
+                }];
+            }] continueWithBlock:^id(BFTask *cachedTask) {
+                return cachedTask;
+            } cancellationToken:cancellationToken];
+        }) cancellationToken:cancellationToken];
+        return GINIhandleHTTPerrors(textIndexTask);
+    }];
+}
+
+- (GINIDocumentBundle *)getBundleForDocument:(GINIDocument *)document
+                                    contents:(GINIDocumentBundleContents)contents
+                                 previewSize:(GiniApiPreviewSize)previewSize
+                           cancellationToken:(BFCancellationToken *)cancellationToken {
     NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
-    BFTask *layoutTask = [[self pollDocument:document cancellationToken:cancellationToken] continueWithBlock:^id(BFTask *task) {
-        return [self->_apiManager getLayoutForDocument:document.documentId responseType:(GiniAPIResponseTypeJSON)];;
+
+    return [self bundleWithContents:contents previewSize:previewSize cancellationToken:cancellationToken documentTaskBlock:^BFTask *{
+        return [self privatePollDocument:document cancellationToken:cancellationToken];
     }];
-    return GINIhandleHTTPerrors(layoutTask);
+}
+
+- (GINIDocumentBundle *)getBundleForDocumentWithId:(NSString *)documentId
+                                          contents:(GINIDocumentBundleContents)contents
+                                       previewSize:(GiniApiPreviewSize)previewSize
+                                 cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    return [self bundleWithContents:contents previewSize:previewSize cancellationToken:cancellationToken documentTaskBlock:^BFTask *{
+        return [self tracedPollDocumentWithId:documentId cancellationToken:cancellationToken];
+    }];
+}
+
+/**
+ * Creates the bundle for the document task returned by the given block. The block is called while the span of the
+ * operation is the current span.
+ */
+- (GINIDocumentBundle *)bundleWithContents:(GINIDocumentBundleContents)contents
+                               previewSize:(GiniApiPreviewSize)previewSize
+                         cancellationToken:(BFCancellationToken *)cancellationToken
+                         documentTaskBlock:(BFTask *(^)(void))documentTaskBlock {
+    __block GINIDocumentBundle *bundle;
+    [self traceUndeliveredOperation:@"getBundle" usingBlock:^BFTask *{
+        GINISpan *span = [GINISpan currentSpan];
+        bundle = [GINIDocumentBundle bundleWithDocumentTask:documentTaskBlock() contents:contents fetchBlock:^BFTask *(GINIDocumentBundleContents content, GINIDocument *document) {
+            return GINISpanPerform(span, ^id{
+                return GINIhandleHTTPerrors([self fetchContent:content ofDocument:document previewSize:previewSize cancellationToken:cancellationToken]);
+            });
+        } deliveryBlock:^BFTask *(BFTask *task) {
+            return [self deliverResultOfTask:task];
+        }];
+        return bundle.completionTask;
+    }];
+    return bundle;
+}
+
+/**
+ * Fetches a single sub-resource of a processed document for a bundle.
+ */
+- (BFTask *)fetchContent:(GINIDocumentBundleContents)content
+              ofDocument:(GINIDocument *)document
+             previewSize:(GiniApiPreviewSize)previewSize
+       cancellationToken:(BFCancellationToken *)cancellationToken {
+    switch (content) {
+        case GINIDocumentBundleContentsExtractions:
+            return [self cachedExtractionsResponseForDocument:document cancellationToken:cancellationToken];
+        case GINIDocumentBundleContentsIncubatorExtractions:
+            return [self createExtractionsForGetTask:[_apiManager getIncubatorExtractionsForDocument:document.documentId
+                                                                                   cancellationToken:cancellationToken]];
+        case GINIDocumentBundleContentsLayout:
+            return [self cachedLayoutForDocument:document cancellationToken:cancellationToken];
+        case GINIDocumentBundleContentsPages:
+            return [_apiManager getPagesForDocument:document.documentId cancellationToken:cancellationToken];
+        case GINIDocumentBundleContentsFirstPagePreview:
+            return [_apiManager getPreviewForPage:1 ofDocument:document.documentId withSize:previewSize cancellationToken:cancellationToken];
+        default:
+            NSAssert(NO, @"Unknown bundle content %lu", (unsigned long)content);
+            return nil;
+    }
 }
 
 - (BFTask *)updateExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document {
     NSParameterAssert([GINIExtraction isKindOfClass:[GINIExtraction class]]);
     NSParameterAssert([GINIDocument isKindOfClass:[GINIDocument class]]);
     
-    BFTask *updateTask = [[_apiManager submitFeedbackForDocument:document.documentId
-                                                           label:extraction.name
-                                                           value:extraction.value
-                                                     boundingBox:extraction.box] continueWithSuccessBlock:^id(BFTask *task) {
-        [[self getExtractionsForDocument:document] continueWithSuccessBlock:^id(BFTask *extractionsTask) {
-            NSMutableDictionary *extractions = extractionsTask.result;
-            extractions[extraction.name] = [GINIExtraction extractionWithName:extraction.name
-                                                                        value:extraction.value
-                                                                       entity:extraction.entity
-                                                                          box:extraction.box];
+    NSDictionary *serverExtraction = document.serverExtractions[extraction.name];
+    if (serverExtraction && [serverExtraction isEqual:GINIServerExtraction(extraction.value, extraction.box)]) {
+        // The extraction was changed back to the value on the server, so a pending update of it must not be submitted.
+        BFTask *revertTask = [_feedbackBuffer removeExtraction:extraction forDocument:document];
+        if (revertTask) {
+            return [self deliverResultOfTask:GINIhandleHTTPerrors(revertTask)];
+        }
+        // The server already has this value, so there is no feedback to submit.
+        return [BFTask taskWithResult:nil];
+    }
+
+    if (self.feedbackDebounceInterval > 0) {
+        return [self deliverResultOfTask:GINIhandleHTTPerrors([_feedbackBuffer addExtraction:extraction forDocument:document])];
+    }
+
+    return [self traceOperation:@"updateExtraction" usingBlock:^BFTask *{
+        BFTask *submitTask = [self measureStage:GINIDocumentLifecycleStageFeedback ofDocumentWithId:document.documentId usingBlock:^BFTask *{
+            return [self->_apiManager submitFeedbackForDocument:document.documentId
+                                                          label:extraction.name
+                                                          value:extraction.value
+                                                    boundingBox:extraction.box];
+        }];
+        BFTask *updateTask = [submitTask continueWithSuccessBlock:^id(BFTask *task) {
+            [self writeExtractions:@[extraction] throughToDocument:document];
             return nil;
         }];
-        return nil;
+        updateTask = [self queueInOutboxOnTransientError:updateTask usingBlock:^(GINIOutbox *outbox) {
+            NSMutableDictionary *extractionFeedback = [NSMutableDictionary dictionaryWithObject:extraction.value forKey:@"value"];
+            extractionFeedback[@"box"] = extraction.box;
+            [outbox enqueueFeedback:@{extraction.name: extractionFeedback} forDocumentWithId:document.documentId];
+        }];
+        return GINIhandleHTTPerrors(updateTask);
     }];
-    return GINIhandleHTTPerrors(updateTask);
+}
+
+#pragma mark - Document lists
+
+- (GINIDocumentIterator *)documentIteratorWithPageSize:(NSUInteger)pageSize
+                                        readAheadDepth:(NSUInteger)readAheadDepth {
+    return [self documentIteratorWithPageSize:pageSize readAheadDepth:readAheadDepth deliveryBlock:^BFTask *(BFTask *task) {
+        return [self deliverResultOfTask:task];
+    }];
+}
+
+/**
+ * Same as `documentIteratorWithPageSize:readAheadDepth:`, but the tasks of the iterator are passed through the given
+ * delivery block. Operations which iterate the documents themselves pass nil, so the pages are not delivered.
+ */
+- (GINIDocumentIterator *)documentIteratorWithPageSize:(NSUInteger)pageSize
+                                        readAheadDepth:(NSUInteger)readAheadDepth
+                                         deliveryBlock:(BFTask *(^)(BFTask *task))deliveryBlock {
+    return [GINIDocumentIterator iteratorWithPageSize:pageSize readAheadDepth:readAheadDepth pageBlock:^BFTask *(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken) {
+        return GINIhandleHTTPerrors([self->_apiManager getDocumentsWithLimit:limit offset:offset cancellationToken:cancellationToken]);
+    } documentBlock:^GINIDocument *(NSDictionary *apiResponse) {
+        return [self documentFromAPIResponse:apiResponse];
+    } deliveryBlock:deliveryBlock];
+}
+
+- (BFTask *)searchDocumentsWithTerm:(NSString *)searchTerm
+                            docType:(NSString *)docType
+                              limit:(NSUInteger)limit
+                             offset:(NSUInteger)offset
+                  cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([searchTerm isKindOfClass:[NSString class]]);
+
+    return [self traceOperation:@"search" usingBlock:^BFTask *{
+        BFTask *searchTask = [[self->_apiManager search:searchTerm limit:limit offset:offset docType:docType cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            NSDictionary *response = task.result;
+            NSMutableArray<GINIDocument *> *documents = [NSMutableArray new];
+            for (NSDictionary *entry in response[@"documents"]) {
+                GINIDocument *document = [self documentFromAPIResponse:entry];
+                if (document) {
+                    [documents addObject:document];
+                }
+            }
+            NSNumber *totalCount = response[@"totalCount"];
+            return [GINISearchResult searchResultWithQuery:searchTerm
+                                                 documents:documents
+                                                totalCount:[totalCount isKindOfClass:[NSNumber class]] ? [totalCount unsignedIntegerValue] : [documents count]
+                                               provisional:NO];
+        }];
+        return GINIhandleHTTPerrors(searchTask);
+    }];
+}
+
+- (GINIDocumentIterator *)searchIteratorWithTerm:(NSString *)searchTerm
+                                         docType:(NSString *)docType
+                                        pageSize:(NSUInteger)pageSize
+                                  readAheadDepth:(NSUInteger)readAheadDepth {
+    NSParameterAssert([searchTerm isKindOfClass:[NSString class]]);
+
+    return [GINIDocumentIterator iteratorWithPageSize:pageSize readAheadDepth:readAheadDepth pageBlock:^BFTask *(NSUInteger limit, NSUInteger offset, BFCancellationToken *cancellationToken) {
+        return GINIhandleHTTPerrors([self->_apiManager search:searchTerm limit:limit offset:offset docType:docType cancellationToken:cancellationToken]);
+    } documentBlock:^GINIDocument *(NSDictionary *apiResponse) {
+        return [self documentFromAPIResponse:apiResponse];
+    } deliveryBlock:^BFTask *(BFTask *task) {
+        return [self deliverResultOfTask:task];
+    }];
+}
+
+#pragma mark - Document store
+
+- (NSArray<GINIDocument *> *)storedDocuments {
+    NSMutableArray<GINIDocument *> *documents = [NSMutableArray new];
+    [self.documentStore enumerateDocumentResponseDataUsingBlock:^(NSData *data) {
+        GINIDocument *document = [self mergedDocument:[self->_resourceDecoder documentWithData:data error:nil]];
+        if (document) {
+            [documents addObject:document];
+        }
+    }];
+    return documents;
+}
+
+- (BFTask *)syncDocumentStoreWithCancellationToken:(BFCancellationToken *)cancellationToken {
+    GINIDocumentStore *documentStore = self.documentStore;
+    if (!documentStore) {
+        return [BFTask taskWithResult:@[]];
+    }
+
+    return [self traceOperation:@"syncDocumentStore" usingBlock:^BFTask *{
+        NSDate *watermark = documentStore.latestCreationDate;
+        NSMutableArray<NSString *> *pendingDocumentIds = [NSMutableArray new];
+        for (GINIDocument *document in [self storedDocuments]) {
+            if (document.state == GiniDocumentStatePending) {
+                [pendingDocumentIds addObject:document.documentId];
+            }
+        }
+
+        // The listed documents are written to the store when they are created. The listing stops at the first
+        // document which is older than the newest stored one.
+        NSMutableOrderedSet<GINIDocument *> *changedDocuments = [NSMutableOrderedSet new];
+        GINIDocumentIterator *iterator = [self documentIteratorWithPageSize:50 readAheadDepth:1 deliveryBlock:nil];
+        [cancellationToken registerCancellationObserverWithBlock:^{
+            [iterator cancel];
+        }];
+        BFTask *listTask = [iterator enumerateDocumentsUsingBlock:^(GINIDocument *document, BOOL *stop) {
+            if (watermark && [document.creationDate compare:watermark] == NSOrderedAscending) {
+                *stop = YES;
+                return;
+            }
+            [changedDocuments addObject:document];
+        }];
+
+        return [[[listTask continueWithSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
+            return [self runBulkOperationWithDocumentIds:pendingDocumentIds itemResultBlock:nil cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+                return [self privateGetDocumentWithId:documentId cancellationToken:cancellationToken];
+            }];
+        })] continueWithExecutor:self->_decodingExecutor withSuccessBlock:GINITracedContinuation(^id(BFTask *task) {
+            GINIBulkResult *refreshResult = task.result;
+            for (GINIDocument *document in [refreshResult.results allValues]) {
+                if (document.state != GiniDocumentStatePending) {
+                    [changedDocuments addObject:document];
+                }
+            }
+
+            // Download the extractions which are not stored yet, so they are available after the next launch.
+            NSMutableDictionary<NSString *, GINIDocument *> *documentsWithoutExtractions = [NSMutableDictionary new];
+            for (GINIDocument *document in changedDocuments) {
+                if (document.state == GiniDocumentStateComplete && ![documentStore hasExtractionsForDocumentWithId:document.documentId]) {
+                    documentsWithoutExtractions[document.documentId] = document;
+                }
+            }
+            return [self runBulkOperationWithDocumentIds:[documentsWithoutExtractions allKeys] itemResultBlock:nil cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+                return [self cachedExtractionsResponseForDocument:documentsWithoutExtractions[documentId] cancellationToken:cancellationToken];
+            }];
+        })] continueWithSuccessBlock:^id(BFTask *task) {
+            return [changedDocuments array];
+        } cancellationToken:cancellationToken];
+    }];
+}
+
+#pragma mark - Bulk operations
+
+- (BFTask *)deleteDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                   itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                 cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self runBulkOperationWithDocumentIds:documentIds itemResultBlock:itemResultBlock cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+        return [self privateDeleteDocumentWithId:documentId cancellationToken:cancellationToken];
+    }]];
+}
+
+- (BFTask *)getDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+              cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self runBulkOperationWithDocumentIds:documentIds itemResultBlock:itemResultBlock cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+        return [self privateGetDocumentWithId:documentId cancellationToken:cancellationToken];
+    }]];
+}
+
+- (BFTask *)getExtractionsForDocumentsWithIds:(NSArray<NSString *> *)documentIds
+                              itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                            cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self deliverResultOfTask:[self runBulkOperationWithDocumentIds:documentIds itemResultBlock:itemResultBlock cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+        return [[self privateGetDocumentWithId:documentId cancellationToken:cancellationToken] continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            return [self privateGetExtractionsForDocument:task.result cancellationToken:cancellationToken];
+        }];
+    }]];
+}
+
+- (BFTask *)updateDocumentsWithIds:(NSDictionary<NSString *, NSDictionary *> *)updatedExtractions
+                   itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                 cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert([updatedExtractions isKindOfClass:[NSDictionary class]]);
+
+    return [self deliverResultOfTask:[self runBulkOperationWithDocumentIds:[updatedExtractions allKeys] itemResultBlock:itemResultBlock cancellationToken:cancellationToken operationBlock:^BFTask *(NSString *documentId) {
+        // The known instance of the document has the last known extractions on the server, so only the changes are
+        // submitted. The document is only fetched if there is no instance of it.
+        GINIDocument *document;
+        @synchronized (self->_documents) {
+            document = [self->_documents objectForKey:documentId];
+        }
+        BFTask *documentTask = document ? [BFTask taskWithResult:document] : [self privateGetDocumentWithId:documentId cancellationToken:cancellationToken];
+        return [documentTask continueWithExecutor:self->_decodingExecutor withSuccessBlock:^id(BFTask *task) {
+            return [self privateUpdateDocument:task.result updatedExtractions:updatedExtractions[documentId]];
+        }];
+    }]];
+}
+
+/**
+ * Runs the given operation for each of the documents with at most `maxConcurrentBulkOperations` operations at a time.
+ */
+- (BFTask *)runBulkOperationWithDocumentIds:(NSArray<NSString *> *)documentIds
+                            itemResultBlock:(GINIBulkItemResultBlock)itemResultBlock
+                          cancellationToken:(BFCancellationToken *)cancellationToken
+                             operationBlock:(BFTask *(^)(NSString *documentId))operationBlock {
+    NSParameterAssert([documentIds isKindOfClass:[NSArray class]]);
+
+    GINIBulkOperation *bulkOperation = [GINIBulkOperation bulkOperationWithDocumentIds:documentIds
+                                                               maxConcurrentOperations:MAX(self.maxConcurrentBulkOperations, 1)
+                                                                        operationBlock:operationBlock];
+    return [bulkOperation startWithItemResultBlock:itemResultBlock cancellationToken:cancellationToken];
+}
+
+#pragma mark - Buffered feedback
+
+- (NSTimeInterval)feedbackDebounceInterval {
+    return _feedbackBuffer.debounceInterval;
+}
+
+- (void)setFeedbackDebounceInterval:(NSTimeInterval)feedbackDebounceInterval {
+    _feedbackBuffer.debounceInterval = feedbackDebounceInterval;
+}
+
+- (BFTask *)flushFeedbackForDocument:(GINIDocument *)document {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    return [self deliverResultOfTask:GINIhandleHTTPerrors([_feedbackBuffer flushFeedbackForDocument:document])];
+}
+
+- (BFTask *)flushFeedback {
+    return [self deliverResultOfTask:[_feedbackBuffer flush]];
+}
+
+/**
+ * Submits the feedback collected by the feedback buffer as one batch.
+ */
+- (BFTask *)submitBufferedFeedback:(NSDictionary *)feedback
+                       extractions:(NSArray<GINIExtraction *> *)extractions
+                       forDocument:(GINIDocument *)document {
+    return [self traceUndeliveredOperation:@"updateExtractions" usingBlock:^BFTask *{
+        BFTask *submitTask = [self measureStage:GINIDocumentLifecycleStageFeedback ofDocumentWithId:document.documentId usingBlock:^BFTask *{
+            return [self->_apiManager submitBatchFeedbackForDocument:document.documentId feedback:feedback];
+        }];
+        submitTask = [submitTask continueWithSuccessBlock:^id(BFTask *task) {
+            [self writeExtractions:extractions throughToDocument:document];
+            return task;
+        }];
+        return [self queueInOutboxOnTransientError:submitTask usingBlock:^(GINIOutbox *outbox) {
+            [outbox enqueueFeedback:feedback forDocumentWithId:document.documentId];
+        }];
+    }];
+}
+
+/**
+ * Writes the submitted extractions through to the known server state and the cached extractions of the document
+ * instead of downloading all extractions again. If the extractions are not cached yet, the next download contains the
+ * new values anyway.
+ */
+- (void)writeExtractions:(NSArray<GINIExtraction *> *)submittedExtractions throughToDocument:(GINIDocument *)document {
+    NSMutableDictionary *serverExtractions = [NSMutableDictionary dictionaryWithCapacity:[submittedExtractions count]];
+    for (GINIExtraction *extraction in submittedExtractions) {
+        serverExtractions[extraction.name] = GINIServerExtraction(extraction.value, extraction.box);
+    }
+    [document mergeServerExtractions:serverExtractions];
+    [self.documentStore updateStoredExtractions:serverExtractions forDocumentWithId:document.documentId];
+    [self.extractionIndex updateIndexedExtractions:serverExtractions forDocumentWithId:document.documentId];
+
+    [document updateCachedExtractionsResultUsingBlock:^NSDictionary *(NSDictionary *result) {
+        NSDictionary *cachedExtractions = result[@"extractions"];
+        NSMutableDictionary *extractions = [NSMutableDictionary dictionaryWithDictionary:cachedExtractions];
+        for (GINIExtraction *extraction in submittedExtractions) {
+            GINIExtraction *cachedExtraction = cachedExtractions[extraction.name];
+            GINIExtraction *updatedExtraction = [GINIExtraction extractionWithName:extraction.name
+                                                                            value:extraction.value
+                                                                           entity:extraction.entity ?: cachedExtraction.entity
+                                                                              box:extraction.box];
+            updatedExtraction.candidates = cachedExtraction.candidates ?: extraction.candidates;
+            extractions[extraction.name] = updatedExtraction;
+        }
+        NSMutableDictionary *updatedResult = [result mutableCopy];
+        updatedResult[@"extractions"] = extractions;
+        return updatedResult;
+    }];
+}
+
+#pragma mark - Executors
+
+- (void)setDecodingExecutor:(BFExecutor *)decodingExecutor {
+    NSParameterAssert([decodingExecutor isKindOfClass:[BFExecutor class]]);
+
+    _decodingExecutor = decodingExecutor;
+}
+
+/**
+ * The continuations of this document task manager run on the `decodingExecutor`, so only the completion of the tasks
+ * returned by the public operations happens on the result executor, which is usually the main queue. Operations which
+ * are part of other operations use the private variants, which don't hop to the result executor and back.
+ */
+- (BFTask *)deliverResultOfTask:(BFTask *)task {
+    BFExecutor *resultExecutor = _resultExecutor;
+    if (!resultExecutor) {
+        return task;
+    }
+    return [task continueWithExecutor:resultExecutor withBlock:^id(BFTask *completedTask) {
+        return completedTask;
+    }];
+}
+
+#pragma mark - Tracing
+
+- (GINITracer *)tracer {
+    return _apiManager.tracer;
+}
+
+- (void)setTracer:(GINITracer *)tracer {
+    _apiManager.tracer = tracer;
+}
+
+/**
+ * Runs the given block, which starts the operation with the given name, while a new span for the operation is the
+ * current span. The span is finished when the task returned by the block is completed. If no tracer is set, the block
+ * is simply called. The returned task is completed on the `resultExecutor`, so only public entry points may use it.
+ */
+- (BFTask *)traceOperation:(NSString *)name usingBlock:(BFTask *(^)(void))block {
+    return [self deliverResultOfTask:[self traceUndeliveredOperation:name usingBlock:block]];
+}
+
+/**
+ * Same as `traceOperation:usingBlock:`, but the returned task is not completed on the `resultExecutor`. Used by the
+ * operations which are also part of other operations, so their continuations don't hop to the result executor and back.
+ */
+- (BFTask *)traceUndeliveredOperation:(NSString *)name usingBlock:(BFTask *(^)(void))block {
+    GINITracer *tracer = self.tracer;
+    if (!tracer) {
+        return block();
+    }
+    GINISpan *span = [tracer startSpanWithName:name];
+    BFTask *operationTask = GINISpanPerform(span, ^id{
+        return block();
+    });
+    return [operationTask continueWithBlock:^id(BFTask *task) {
+        if (task.error) {
+            [span finishWithError:task.error];
+        } else {
+            if (task.cancelled) {
+                [span setTag:@"true" forKey:@"cancelled"];
+            }
+            [span finish];
+        }
+        return task;
+    }];
+}
+
+#pragma mark - Lifecycle metrics
+
+- (BFTask *)measureStage:(GINIDocumentLifecycleStage)stage
+        ofDocumentWithId:(NSString *)documentId
+              usingBlock:(BFTask *(^)(void))block {
+    NSTimeInterval start = GINIMonotonicTimestamp();
+    return [block() continueWithSuccessBlock:^id(BFTask *task) {
+        [self->_lifecycleMetrics recordDuration:GINIMonotonicTimestamp() - start
+                                       forStage:stage
+                                        docType:[self docTypeForDocumentId:documentId]];
+        return task;
+    }];
+}
+
+- (void)didUploadDocument:(GINIDocument *)document docType:(NSString *)docType uploadStart:(NSTimeInterval)uploadStart {
+    if (!document) {
+        return;
+    }
+    [_lifecycleMetrics recordDuration:GINIMonotonicTimestamp() - uploadStart
+                             forStage:GINIDocumentLifecycleStageUpload
+                              docType:docType];
+    [self rememberDocType:docType forDocument:document];
+    [self markPendingDocument:document];
+}
+
+- (void)rememberDocType:(NSString *)docType forDocument:(GINIDocument *)document {
+    if (!docType || !document) {
+        return;
+    }
+    @synchronized (_docTypes) {
+        _docTypes[document.documentId] = docType;
+    }
+}
+
+- (void)markPendingDocument:(GINIDocument *)document {
+    if (document.state != GiniDocumentStatePending) {
+        return;
+    }
+    @synchronized (_docTypes) {
+        _pendingSince[document.documentId] = @(GINIMonotonicTimestamp());
+    }
+}
+
+- (void)didFinishProcessingDocumentWithId:(NSString *)documentId {
+    NSNumber *pendingSince;
+    @synchronized (_docTypes) {
+        pendingSince = _pendingSince[documentId];
+        [_pendingSince removeObjectForKey:documentId];
+    }
+    // Documents which were never seen in the PENDING state don't say anything about the processing time.
+    if (pendingSince) {
+        [_lifecycleMetrics recordDuration:GINIMonotonicTimestamp() - [pendingSince doubleValue]
+                                 forStage:GINIDocumentLifecycleStagePending
+                                  docType:[self docTypeForDocumentId:documentId]];
+    }
+}
+
+- (NSString *)docTypeForDocumentId:(NSString *)documentId {
+    @synchronized (_docTypes) {
+        return _docTypes[documentId];
+    }
+}
+
+- (void)forgetLifecycleStateOfDocumentWithId:(NSString *)documentId {
+    @synchronized (_docTypes) {
+        [_docTypes removeObjectForKey:documentId];
+        [_pendingSince removeObjectForKey:documentId];
+    }
 }
 
 @end
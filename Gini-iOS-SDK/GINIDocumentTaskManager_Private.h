@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIDocumentTaskManager.h"
+
+@class BFTask;
+@class BFCancellationToken;
+
+/**
+ * The operations of the `GINIDocumentTaskManager` complete their tasks on the `resultExecutor`. Other classes of the SDK
+ * which run these operations as part of their own operation (e.g. the `GINIDocumentPipeline`) use the variants below,
+ * whose tasks are not completed on the result executor, and deliver only their own result with `deliverResultOfTask:`.
+ */
+@interface GINIDocumentTaskManager (Private)
+
+/**
+ * Same as `createDocumentWithFilename:fromData:docType:metadata:cancellationToken:`, but the returned task is not
+ * completed on the `resultExecutor`.
+ */
+- (BFTask *)privateCreateDocumentWithFilename:(NSString *)fileName
+                                     fromData:(NSData *)data
+                                      docType:(NSString *)docType
+                                     metadata:(GINIDocumentMetadata *)metadata
+                            cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Same as `pollDocument:cancellationToken:`, but the returned task is not completed on the `resultExecutor`.
+ */
+- (BFTask *)privatePollDocument:(GINIDocument *)document cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Same as `getExtractionsForDocument:cancellationToken:`, but the returned task is not completed on the
+ * `resultExecutor`.
+ */
+- (BFTask *)privateGetExtractionsForDocument:(GINIDocument *)document
+                           cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Returns a task which is completed like the given task, but on the `resultExecutor`, or the given task if no result
+ * executor is set.
+ */
+- (BFTask *)deliverResultOfTask:(BFTask *)task;
+
+@end
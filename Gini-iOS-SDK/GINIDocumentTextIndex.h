@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class GINIIndexedLayoutPage;
+
+
+/**
+ * An occurrence of the searched string in a document.
+ */
+@interface GINITextSearchMatch : NSObject
+
+/// The number of the page containing the match, starting with 1.
+@property (readonly) NSUInteger pageNumber;
+
+/// The indexes of the words of the page containing the match, see `GINIIndexedLayoutPage`.
+@property (readonly) NSRange wordRange;
+
+/// The text of the words containing the match, as in the layout.
+@property (readonly) NSString *text;
+
+/**
+ * The boxes to highlight (`CGRect` values in the coordinate space of the layout), one for each line the match spans.
+ * The layout has no boxes for single characters, so for matches starting or ending inside a word, the box of the word
+ * is narrowed in proportion to the matched characters.
+ */
+@property (readonly) NSArray<NSValue *> *rects;
+
+@end
+
+
+/**
+ * The `GINIDocumentTextIndex` finds text in a processed document. It is built once from the layout of the document and
+ * then answers queries without walking the layout: the text of all words is kept as one normalized string together with
+ * the positions of the words in it.
+ *
+ * The search finds any substring, ignoring case and diacritics; whitespace in the query matches the gap between words
+ * and lines, but not between pages. See `-[GINIDocumentTaskManager getTextIndexForDocument:cancellationToken:]`, which
+ * caches the index with the document.
+ *
+ * Instances are immutable and can be used from any thread.
+ */
+@interface GINIDocumentTextIndex : NSObject
+
+/**
+ * Creates the text index of a document.
+ *
+ * @param pages     The pages of the layout of the document.
+ */
++ (instancetype)textIndexWithLayoutPages:(NSArray<GINIIndexedLayoutPage *> *)pages;
+
+/// The pages of the layout of the document, e.g. to hit-test a match.
+@property (readonly) NSArray<GINIIndexedLayoutPage *> *pages;
+
+/**
+ * Searches the document.
+ *
+ * @param string    The string to search. Only whitespace or an empty string has no matches.
+ * @param limit     The maximum number of matches.
+ *
+ * @returns         The matches in the order of the document.
+ */
+- (NSArray<GINITextSearchMatch *> *)searchForString:(NSString *)string limit:(NSUInteger)limit;
+
+@end
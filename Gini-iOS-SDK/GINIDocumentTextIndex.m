@@ -0,0 +1,200 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <UIKit/UIKit.h>
+#import "GINIDocumentTextIndex.h"
+#import "GINIIndexedLayoutPage.h"
+
+
+/**
+ * Folds case and diacritics, so the text and the queries can be compared literally.
+ */
+static NSString *GINITextIndexFoldedString(NSString *string) {
+    return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil];
+}
+
+/**
+ * Returns the number of values in the sorted array which are less than or equal to the given value.
+ */
+static NSUInteger GINITextIndexUpperBound(const uint32_t *values, NSUInteger count, NSUInteger value) {
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (values[middle] <= value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+
+@implementation GINITextSearchMatch
+
+- (instancetype)initWithPageNumber:(NSUInteger)pageNumber wordRange:(NSRange)wordRange text:(NSString *)text rects:(NSArray<NSValue *> *)rects {
+    self = [super init];
+    if (self) {
+        _pageNumber = pageNumber;
+        _wordRange = wordRange;
+        _text = text;
+        _rects = rects;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINITextSearchMatch page=%lu \"%@\">", (unsigned long)_pageNumber, _text];
+}
+
+@end
+
+
+@implementation GINIDocumentTextIndex {
+    /// The folded text of all words, separated by spaces and the pages by newlines.
+    NSString *_text;
+    NSData *_wordStartData;
+    NSData *_wordEndData;
+    NSData *_pageFirstWordData;
+    /// The position of each word in the text (all words of the document, numbered in the order of the pages).
+    const uint32_t *_wordStarts;
+    const uint32_t *_wordEnds;
+    /// The number of the first word of each page, followed by the number of words.
+    const uint32_t *_pageFirstWords;
+}
+
+#pragma mark - Factory
++ (instancetype)textIndexWithLayoutPages:(NSArray<GINIIndexedLayoutPage *> *)pages {
+    return [[self alloc] initWithLayoutPages:pages];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithLayoutPages:(NSArray<GINIIndexedLayoutPage *> *)pages {
+    NSParameterAssert([pages isKindOfClass:[NSArray class]]);
+
+    self = [super init];
+    if (self) {
+        _pages = [pages copy];
+        NSMutableString *text = [NSMutableString new];
+        NSMutableData *wordStarts = [NSMutableData new];
+        NSMutableData *wordEnds = [NSMutableData new];
+        NSMutableData *pageFirstWords = [NSMutableData new];
+        uint32_t wordCount = 0;
+
+        for (GINIIndexedLayoutPage *page in _pages) {
+            [pageFirstWords appendBytes:&wordCount length:sizeof(wordCount)];
+            if ([text length] > 0) {
+                [text appendString:@"\n"];
+            }
+            BOOL pageStart = YES;
+            for (NSUInteger word = 0; word < page.wordCount; word++) {
+                NSString *foldedWord = GINITextIndexFoldedString([page textOfWordAtIndex:word]);
+                if ([foldedWord length] > 0) {
+                    if (!pageStart) {
+                        [text appendString:@" "];
+                    }
+                    pageStart = NO;
+                }
+                uint32_t start = (uint32_t)[text length];
+                [text appendString:foldedWord];
+                uint32_t end = (uint32_t)[text length];
+                [wordStarts appendBytes:&start length:sizeof(start)];
+                [wordEnds appendBytes:&end length:sizeof(end)];
+                wordCount++;
+            }
+        }
+        [pageFirstWords appendBytes:&wordCount length:sizeof(wordCount)];
+
+        _text = [text copy];
+        _wordStartData = wordStarts;
+        _wordEndData = wordEnds;
+        _pageFirstWordData = pageFirstWords;
+        _wordStarts = [wordStarts bytes];
+        _wordEnds = [wordEnds bytes];
+        _pageFirstWords = [pageFirstWords bytes];
+    }
+    return self;
+}
+
+#pragma mark - Searching
+- (NSArray<GINITextSearchMatch *> *)searchForString:(NSString *)string limit:(NSUInteger)limit {
+    NSParameterAssert([string isKindOfClass:[NSString class]]);
+
+    // The words of the text are separated by single spaces.
+    NSArray *components = [GINITextIndexFoldedString(string) componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    NSString *query = [[components filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]] componentsJoinedByString:@" "];
+    if ([query length] == 0) {
+        return @[];
+    }
+
+    NSMutableArray *matches = [NSMutableArray new];
+    NSRange searchRange = NSMakeRange(0, [_text length]);
+    while ([matches count] < limit) {
+        NSRange range = [_text rangeOfString:query options:NSLiteralSearch range:searchRange];
+        if (range.location == NSNotFound) {
+            break;
+        }
+        [matches addObject:[self matchForRange:range]];
+        searchRange = NSMakeRange(NSMaxRange(range), [_text length] - NSMaxRange(range));
+    }
+    return matches;
+}
+
+/**
+ * Creates the match for a range of the text. The range starts and ends inside of words, since the query neither starts
+ * nor ends with a space and does not contain newlines.
+ */
+- (GINITextSearchMatch *)matchForRange:(NSRange)range {
+    NSUInteger pageCount = [_pages count];
+    NSUInteger wordCount = _pageFirstWords[pageCount];
+    NSUInteger firstWord = GINITextIndexUpperBound(_wordStarts, wordCount, range.location) - 1;
+    NSUInteger lastWord = GINITextIndexUpperBound(_wordStarts, wordCount, NSMaxRange(range) - 1) - 1;
+    NSUInteger pageIndex = GINITextIndexUpperBound(_pageFirstWords, pageCount, firstWord) - 1;
+    GINIIndexedLayoutPage *page = _pages[pageIndex];
+    NSUInteger pageFirstWord = _pageFirstWords[pageIndex];
+
+    NSMutableArray *texts = [NSMutableArray new];
+    NSMutableArray *rects = [NSMutableArray new];
+    CGRect lineRect = CGRectNull;
+    NSUInteger line = NSNotFound;
+    for (NSUInteger word = firstWord; word <= lastWord; word++) {
+        NSUInteger pageWord = word - pageFirstWord;
+        CGRect wordRect = [page rectOfWordAtIndex:pageWord];
+        NSUInteger start = _wordStarts[word];
+        NSUInteger end = _wordEnds[word];
+        if (end == start) {
+            continue;
+        }
+        // Narrow the first and the last word to the matched characters.
+        CGFloat characterWidth = wordRect.size.width / (end - start);
+        if (word == lastWord && NSMaxRange(range) < end) {
+            wordRect.size.width -= (end - NSMaxRange(range)) * characterWidth;
+        }
+        if (word == firstWord && range.location > start) {
+            wordRect.origin.x += (range.location - start) * characterWidth;
+            wordRect.size.width -= (range.location - start) * characterWidth;
+        }
+
+        NSUInteger wordLine = [page lineIndexOfWordAtIndex:pageWord];
+        if (wordLine != line && !CGRectIsNull(lineRect)) {
+            [rects addObject:[NSValue valueWithCGRect:lineRect]];
+            lineRect = CGRectNull;
+        }
+        line = wordLine;
+        lineRect = CGRectUnion(lineRect, wordRect);
+        [texts addObject:[page textOfWordAtIndex:pageWord]];
+    }
+    if (!CGRectIsNull(lineRect)) {
+        [rects addObject:[NSValue valueWithCGRect:lineRect]];
+    }
+
+    return [[GINITextSearchMatch alloc] initWithPageNumber:page.number
+                                                 wordRange:NSMakeRange(firstWord - pageFirstWord, lastWord - firstWord + 1)
+                                                      text:[texts componentsJoinedByString:@" "]
+                                                     rects:rects];
+}
+
+@end
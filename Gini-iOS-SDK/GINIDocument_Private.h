@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIDocument.h"
+
+@class BFTask;
+
+/**
+ * The results of a document (extractions, candidates, layout and text index) are cached by the document itself, so every accessor
+ * of the `GINIDocumentTaskManager` shares one download. The cache is only invalidated by state changes; submitted
+ * feedback is written through to the cached extractions.
+ */
+@interface GINIDocument (Private)
+
+/**
+ * Creates a document from the fields of a document resource of the Gini API. Used by `documentFromAPIResponse:` and by
+ * the typed decoders of the `GINIResourceDecoder`.
+ *
+ * @returns         The document, or nil if the ID is missing or the progress or source classification is unknown.
+ */
++ (instancetype)documentWithId:(NSString *)documentId
+                      progress:(NSString *)progress
+          sourceClassification:(NSString *)classification
+                     pageCount:(NSNumber *)pageCount
+                         links:(GINIDocumentLinks *)links
+            compositeDocuments:(NSArray<NSString *> *)compositeDocuments
+          partialDocumentInfos:(NSArray<GINIPartialDocumentInfo *> *)partialDocumentInfos
+                      filename:(NSString *)filename
+                  creationDate:(NSNumber *)creationDate
+               documentManager:(GINIDocumentTaskManager *)documentManager;
+
+/**
+ * Returns the cached task which resolves to the processed extractions response (a dictionary with the keys
+ * "extractions" and "candidates"). If there is no cached task or the cached task failed or was cancelled, the given
+ * block is called to fetch the extractions and its task is cached.
+ */
+- (BFTask *)cachedExtractionsUsingBlock:(BFTask *(^)(void))fetchBlock;
+
+/**
+ * Same as `cachedExtractionsUsingBlock:`, but for the task resolving to the layout.
+ */
+- (BFTask *)cachedLayoutUsingBlock:(BFTask *(^)(void))fetchBlock;
+
+/**
+ * Same as `cachedExtractionsUsingBlock:`, but for the task resolving to the `GINIDocumentTextIndex`.
+ */
+- (BFTask *)cachedTextIndexUsingBlock:(BFTask *(^)(void))fetchBlock;
+
+/**
+ * Replaces the cached extractions response with the one returned by the block, which is called with the cached response
+ * while the document is locked. Does nothing if the extractions have not been downloaded successfully. Used to write
+ * feedback through to the cache without mutating the cached response.
+ */
+- (void)updateCachedExtractionsResultUsingBlock:(NSDictionary *(^)(NSDictionary *result))block;
+
+/**
+ * The extraction values the Gini API is known to have, i.e. the values of the last downloaded extractions with the
+ * submitted feedback applied. Maps the extraction name to a dictionary with the "value" and optionally the "box". Nil if
+ * the extractions have not been downloaded yet. Used to submit only the changed extractions as feedback.
+ */
+@property (copy) NSDictionary<NSString *, NSDictionary *> *serverExtractions;
+
+/**
+ * Applies submitted feedback to the `serverExtractions`. Does nothing if they are unknown.
+ */
+- (void)mergeServerExtractions:(NSDictionary<NSString *, NSDictionary *> *)serverExtractions;
+
+/**
+ * Sets the state of the document. The cached results are invalidated if the state changes.
+ */
+- (void)updateState:(GiniDocumentState)state;
+
+/**
+ * Copies the API state (state, page count, file name, creation date, source classification, links and partial/composite
+ * documents) of the given document with the same ID into this document. Used by the identity map of the
+ * `GINIDocumentTaskManager` to keep one instance per document.
+ */
+- (void)mergeDocument:(GINIDocument *)document;
+
+@end
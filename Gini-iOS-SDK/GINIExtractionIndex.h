@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class GINIExtraction;
+
+
+/**
+ * Options for searching a `GINIExtractionIndex`.
+ */
+typedef NS_OPTIONS(NSUInteger, GINIExtractionIndexSearchOptions) {
+    /// Only whole words match.
+    GINIExtractionIndexSearchExact = 0,
+    /// Each word of the query also matches words starting with it, ranked below whole words.
+    GINIExtractionIndexSearchPrefix = 1 << 0
+};
+
+
+/**
+ * A document found in a `GINIExtractionIndex`.
+ */
+@interface GINIExtractionIndexResult : NSObject
+
+/// The document's unique identifier.
+@property (readonly) NSString *documentId;
+
+/// The relevance of the document; results with a higher score match better.
+@property (readonly) double score;
+
+/// The names of the extractions of the document that matched the query.
+@property (readonly) NSSet<NSString *> *extractionNames;
+
+@end
+
+
+/**
+ * The `GINIExtractionIndex` is a local full-text index over the extraction values of documents, so documents can be
+ * found by e.g. their IBAN, payment recipient or amount without a request. See the `extractionIndex` of the
+ * `GINIDocumentTaskManager`, which keeps the index up to date.
+ *
+ * The values are split into words (letters and digits, case and diacritics are ignored); a value of several words is
+ * additionally indexed as one word without the separators, so an IBAN is found with or without spaces. A document
+ * matches if it matches all words of the query. The results are ranked by how rare the matched words are and by the
+ * entity of the matched extractions (e.g. an IBAN match ranks above a match in a payment purpose).
+ *
+ * The index is kept in memory. Only the extraction values are written to disk, the index is rebuilt when it is read.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIExtractionIndex : NSObject
+
+/**
+ * Creates an index with the contents of a file written by `writeToURL:error:`.
+ *
+ * @param url       The file URL.
+ * @param error     Set if the file could not be read or has an unsupported format.
+ */
++ (instancetype)extractionIndexWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+/// The number of indexed documents.
+@property (readonly) NSUInteger documentCount;
+
+/**
+ * Indexes the extractions of a document, replacing the previously indexed extractions of the document.
+ *
+ * @param extractions   The extractions (the extraction name as the key).
+ * @param documentId    The document's unique identifier.
+ */
+- (void)indexExtractions:(NSDictionary<NSString *, GINIExtraction *> *)extractions forDocumentWithId:(NSString *)documentId;
+
+/**
+ * Applies submitted feedback to the indexed extractions of a document. Does nothing if the document is not indexed.
+ *
+ * @param feedback      The feedback (the extraction name as the key and a dictionary with the "value" as value).
+ * @param documentId    The document's unique identifier.
+ */
+- (void)updateIndexedExtractions:(NSDictionary<NSString *, NSDictionary *> *)feedback forDocumentWithId:(NSString *)documentId;
+
+/**
+ * Removes a document from the index.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (void)removeDocumentWithId:(NSString *)documentId;
+
+/**
+ * Searches the indexed documents.
+ *
+ * @param query         The query.
+ * @param options       The search options.
+ * @param limit         The maximum number of results.
+ *
+ * @returns             The matching documents, the best match first.
+ */
+- (NSArray<GINIExtractionIndexResult *> *)searchWithQuery:(NSString *)query
+                                                  options:(GINIExtractionIndexSearchOptions)options
+                                                    limit:(NSUInteger)limit;
+
+/**
+ * Writes the indexed extraction values to the given file as a binary property list. The values are the user's financial
+ * data (e.g. IBANs and amounts), so the file is protected with `NSFileProtectionCompleteUntilFirstUserAuthentication`.
+ *
+ * @param url       The file URL.
+ * @param error     Set if writing the file failed.
+ */
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error;
+
+@end
@@ -0,0 +1,354 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIExtractionIndex.h"
+#import "GINIExtraction.h"
+
+/// The version of the file format.
+static const NSInteger GINIExtractionIndexVersion = 1;
+
+/// The ranking factor of words that only match as prefix of a word.
+static const double GINIExtractionIndexPrefixFactor = 0.5;
+
+/// The indexed values of a document: maps the extraction name to an array with the entity and the value.
+typedef NSDictionary<NSString *, NSArray<NSString *> *> GINIIndexedExtractions;
+
+
+/**
+ * Splits the value into its normalized words. A value of several words is also returned as one word.
+ */
+static NSArray<NSString *> *GINIIndexWords(NSString *value) {
+    if (![value isKindOfClass:[NSString class]]) {
+        return @[];
+    }
+    NSString *foldedValue = [value stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil];
+    NSArray *components = [foldedValue componentsSeparatedByCharactersInSet:[[NSCharacterSet alphanumericCharacterSet] invertedSet]];
+    NSMutableOrderedSet<NSString *> *words = [NSMutableOrderedSet orderedSetWithCapacity:[components count] + 1];
+    for (NSString *component in components) {
+        if ([component length] > 0) {
+            [words addObject:component];
+        }
+    }
+    if ([words count] > 1) {
+        [words addObject:[[words array] componentsJoinedByString:@""]];
+    }
+    return [words array];
+}
+
+/**
+ * The ranking weight of matches in extractions of the given entity.
+ */
+static double GINIIndexEntityWeight(NSString *entity) {
+    static NSDictionary<NSString *, NSNumber *> *weights;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        weights = @{@"iban": @3.0,
+                    @"bic": @2.0,
+                    @"companyname": @2.0,
+                    @"amount": @2.0,
+                    @"reference": @1.5};
+    });
+    NSNumber *weight = weights[entity];
+    return weight ? [weight doubleValue] : 1.0;
+}
+
+
+@interface GINIExtractionIndexResult ()
+@property (readwrite) double score;
+@end
+
+@implementation GINIExtractionIndexResult {
+    NSMutableSet<NSString *> *_matchedExtractionNames;
+}
+
+- (instancetype)initWithDocumentId:(NSString *)documentId {
+    self = [super init];
+    if (self) {
+        _documentId = documentId;
+        _matchedExtractionNames = [NSMutableSet new];
+    }
+    return self;
+}
+
+- (NSSet<NSString *> *)extractionNames {
+    return [_matchedExtractionNames copy];
+}
+
+- (void)addExtractionNames:(NSSet<NSString *> *)extractionNames {
+    [_matchedExtractionNames unionSet:extractionNames];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINIExtractionIndexResult %@ score=%.3f extractions=%@>", _documentId, _score,
+            [[[_matchedExtractionNames allObjects] sortedArrayUsingSelector:@selector(compare:)] componentsJoinedByString:@","]];
+}
+
+@end
+
+
+@implementation GINIExtractionIndex {
+    /// The indexed values with the document ID as key. This is what is written to disk.
+    NSMutableDictionary<NSString *, GINIIndexedExtractions *> *_documents;
+    /// The inverted index: maps each word to the document IDs and the names of the extractions containing the word.
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *> *_postings;
+    /// The words of `_postings` in sorted order for the prefix search, or nil if it has to be rebuilt.
+    NSArray<NSString *> *_sortedWords;
+}
+
+#pragma mark - Factory
++ (instancetype)extractionIndexWithContentsOfURL:(NSURL *)url error:(NSError **)error {
+    NSData *data = [NSData dataWithContentsOfURL:url options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+    NSDictionary *archive = [NSPropertyListSerialization propertyListWithData:data
+                                                                      options:NSPropertyListImmutable
+                                                                       format:NULL
+                                                                        error:error];
+    if (!archive) {
+        return nil;
+    }
+    if (![archive isKindOfClass:[NSDictionary class]] ||
+        ![archive[@"version"] isEqual:@(GINIExtractionIndexVersion)] ||
+        ![archive[@"documents"] isKindOfClass:[NSDictionary class]]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:nil];
+        }
+        return nil;
+    }
+
+    NSDictionary *documents = archive[@"documents"];
+    GINIExtractionIndex *index = [self new];
+    for (NSString *documentId in documents) {
+        if ([documents[documentId] isKindOfClass:[NSDictionary class]]) {
+            [index setIndexedExtractions:documents[documentId] forDocumentWithId:documentId];
+        }
+    }
+    return index;
+}
+
+#pragma mark - Initializer
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _documents = [NSMutableDictionary new];
+        _postings = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)documentCount {
+    @synchronized (self) {
+        return [_documents count];
+    }
+}
+
+#pragma mark - Indexing
+- (void)indexExtractions:(NSDictionary<NSString *, GINIExtraction *> *)extractions forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    NSMutableDictionary *indexedExtractions = [NSMutableDictionary dictionaryWithCapacity:[extractions count]];
+    for (NSString *name in extractions) {
+        GINIExtraction *extraction = extractions[name];
+        if ([extraction.value length] > 0) {
+            indexedExtractions[name] = @[extraction.entity ?: @"", extraction.value];
+        }
+    }
+    [self setIndexedExtractions:indexedExtractions forDocumentWithId:documentId];
+}
+
+- (void)updateIndexedExtractions:(NSDictionary<NSString *, NSDictionary *> *)feedback forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    @synchronized (self) {
+        GINIIndexedExtractions *indexedExtractions = _documents[documentId];
+        if (!indexedExtractions) {
+            return;
+        }
+        NSMutableDictionary *updatedExtractions = [indexedExtractions mutableCopy];
+        for (NSString *name in feedback) {
+            NSString *value = feedback[name][@"value"];
+            NSString *entity = [indexedExtractions[name] firstObject] ?: @"";
+            if ([value isKindOfClass:[NSString class]] && [value length] > 0) {
+                updatedExtractions[name] = @[entity, value];
+            } else {
+                [updatedExtractions removeObjectForKey:name];
+            }
+        }
+        [self setIndexedExtractions:updatedExtractions forDocumentWithId:documentId];
+    }
+}
+
+- (void)removeDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    [self setIndexedExtractions:nil forDocumentWithId:documentId];
+}
+
+/**
+ * Replaces the indexed values of a document and updates the inverted index.
+ */
+- (void)setIndexedExtractions:(GINIIndexedExtractions *)indexedExtractions forDocumentWithId:(NSString *)documentId {
+    @synchronized (self) {
+        // Remove the postings of the previously indexed values.
+        GINIIndexedExtractions *previousExtractions = _documents[documentId];
+        for (NSString *name in previousExtractions) {
+            for (NSString *word in GINIIndexWords([previousExtractions[name] lastObject])) {
+                NSMutableDictionary *postings = _postings[word];
+                [postings removeObjectForKey:documentId];
+                if ([postings count] == 0) {
+                    [_postings removeObjectForKey:word];
+                    _sortedWords = nil;
+                }
+            }
+        }
+
+        NSMutableDictionary *validExtractions = [NSMutableDictionary dictionaryWithCapacity:[indexedExtractions count]];
+        for (NSString *name in indexedExtractions) {
+            NSArray<NSString *> *entityAndValue = indexedExtractions[name];
+            if ([entityAndValue isKindOfClass:[NSArray class]] && [entityAndValue count] == 2) {
+                validExtractions[name] = entityAndValue;
+            }
+        }
+        if ([validExtractions count] == 0) {
+            [_documents removeObjectForKey:documentId];
+            return;
+        }
+        _documents[documentId] = validExtractions;
+        for (NSString *name in validExtractions) {
+            NSArray<NSString *> *entityAndValue = validExtractions[name];
+            for (NSString *word in GINIIndexWords([entityAndValue lastObject])) {
+                NSMutableDictionary *postings = _postings[word];
+                if (!postings) {
+                    postings = [NSMutableDictionary new];
+                    _postings[word] = postings;
+                    _sortedWords = nil;
+                }
+                NSMutableSet *names = postings[documentId];
+                if (!names) {
+                    names = [NSMutableSet new];
+                    postings[documentId] = names;
+                }
+                [names addObject:name];
+            }
+        }
+    }
+}
+
+#pragma mark - Searching
+- (NSArray<GINIExtractionIndexResult *> *)searchWithQuery:(NSString *)query
+                                                  options:(GINIExtractionIndexSearchOptions)options
+                                                    limit:(NSUInteger)limit {
+    NSParameterAssert([query isKindOfClass:[NSString class]]);
+
+    // The joined form of the query words is not a word of the query itself.
+    NSMutableArray<NSString *> *queryWords = [GINIIndexWords(query) mutableCopy];
+    if ([queryWords count] > 1) {
+        [queryWords removeLastObject];
+    }
+    if ([queryWords count] == 0 || limit == 0) {
+        return @[];
+    }
+
+    @synchronized (self) {
+        double documentCount = [_documents count];
+        NSMutableDictionary<NSString *, GINIExtractionIndexResult *> *results;
+        for (NSString *queryWord in queryWords) {
+            NSMutableDictionary<NSString *, GINIExtractionIndexResult *> *wordResults = [NSMutableDictionary new];
+            NSMutableDictionary<NSString *, NSNumber *> *wordScores = [NSMutableDictionary new];
+            for (NSString *word in [self wordsMatching:queryWord prefix:(options & GINIExtractionIndexSearchPrefix) != 0]) {
+                NSDictionary<NSString *, NSSet<NSString *> *> *postings = _postings[word];
+                // Rare words are more relevant than frequent ones.
+                double idf = log(1 + documentCount / [postings count]);
+                double factor = [word isEqualToString:queryWord] ? 1 : GINIExtractionIndexPrefixFactor;
+                for (NSString *documentId in postings) {
+                    double weight = 0;
+                    for (NSString *name in postings[documentId]) {
+                        weight = MAX(weight, GINIIndexEntityWeight([_documents[documentId][name] firstObject]));
+                    }
+                    double score = weight * idf * factor;
+                    GINIExtractionIndexResult *result = wordResults[documentId];
+                    if (!result) {
+                        result = [[GINIExtractionIndexResult alloc] initWithDocumentId:documentId];
+                        wordResults[documentId] = result;
+                    }
+                    [result addExtractionNames:postings[documentId]];
+                    if (score > [wordScores[documentId] doubleValue]) {
+                        wordScores[documentId] = @(score);
+                    }
+                }
+            }
+
+            // A document must match all words of the query.
+            if (!results) {
+                results = wordResults;
+                for (NSString *documentId in results) {
+                    results[documentId].score = [wordScores[documentId] doubleValue];
+                }
+            } else {
+                for (NSString *documentId in [results allKeys]) {
+                    GINIExtractionIndexResult *wordResult = wordResults[documentId];
+                    if (!wordResult) {
+                        [results removeObjectForKey:documentId];
+                        continue;
+                    }
+                    results[documentId].score += [wordScores[documentId] doubleValue];
+                    [results[documentId] addExtractionNames:wordResult.extractionNames];
+                }
+            }
+            if ([results count] == 0) {
+                return @[];
+            }
+        }
+
+        NSArray *sortedResults = [[results allValues] sortedArrayUsingComparator:^NSComparisonResult(GINIExtractionIndexResult *result1, GINIExtractionIndexResult *result2) {
+            if (result1.score != result2.score) {
+                return result1.score > result2.score ? NSOrderedAscending : NSOrderedDescending;
+            }
+            return [result1.documentId compare:result2.documentId];
+        }];
+        return [sortedResults subarrayWithRange:NSMakeRange(0, MIN(limit, [sortedResults count]))];
+    }
+}
+
+/**
+ * Returns the indexed words equal to the given word or, for a prefix search, starting with it. Must be called while
+ * synchronized.
+ */
+- (NSArray<NSString *> *)wordsMatching:(NSString *)word prefix:(BOOL)prefix {
+    if (!prefix) {
+        return _postings[word] ? @[word] : @[];
+    }
+    if (!_sortedWords) {
+        _sortedWords = [[_postings allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    }
+    NSUInteger start = [_sortedWords indexOfObject:word
+                                     inSortedRange:NSMakeRange(0, [_sortedWords count])
+                                           options:NSBinarySearchingInsertionIndex | NSBinarySearchingFirstEqual
+                                   usingComparator:^NSComparisonResult(NSString *word1, NSString *word2) {
+                                       return [word1 compare:word2];
+                                   }];
+    NSMutableArray<NSString *> *words = [NSMutableArray new];
+    for (NSUInteger i = start; i < [_sortedWords count] && [_sortedWords[i] hasPrefix:word]; i++) {
+        [words addObject:_sortedWords[i]];
+    }
+    return words;
+}
+
+#pragma mark - Persistence
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error {
+    NSDictionary *archive;
+    @synchronized (self) {
+        archive = @{@"version": @(GINIExtractionIndexVersion), @"documents": [_documents copy]};
+    }
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:archive
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:error];
+    return [data writeToURL:url options:NSDataWritingAtomic | NSDataWritingFileProtectionCompleteUntilFirstUserAuthentication error:error];
+}
+
+@end
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import "GINIURLSession.h"
+
+@class GINIInjector;
+
+
+/**
+ * The distributions of the injected latency.
+ */
+typedef NS_ENUM(NSUInteger, GINIFaultLatencyDistribution) {
+    /// Every request is delayed by `latency`.
+    GINIFaultLatencyDistributionConstant,
+    /// The delay is uniformly distributed between `latency` and `maximumLatency`.
+    GINIFaultLatencyDistributionUniform,
+    /// The delay is exponentially distributed with the mean `latency`, capped at `maximumLatency` (if it is > 0).
+    GINIFaultLatencyDistributionExponential
+};
+
+
+/**
+ * A `GINIFaultRule` describes which faults are injected into the requests that match the rule.
+ *
+ * The rates are probabilities between 0 and 1. For every request at most one of connection reset, rate limiting and
+ * server error is injected; they are checked in this order.
+ */
+@interface GINIFaultRule : NSObject <NSCopying>
+
+/**
+ * Factory to create a rule which matches the given requests.
+ *
+ * @param method        The HTTP method, e.g. "GET", or nil to match all methods.
+ * @param pathPattern   A regular expression which must match a part of the URL's path, e.g. "^/documents/[^/]+$", or
+ *                      nil to match all paths.
+ */
++ (instancetype)ruleWithMethod:(NSString *)method pathPattern:(NSString *)pathPattern;
+
+/// The HTTP method of the matching requests or nil for all methods.
+@property (readonly) NSString *method;
+
+/// The regular expression the path of the matching requests must contain a match of, or nil for all paths.
+@property (readonly) NSString *pathPattern;
+
+/// The distribution of the latency. Defaults to `GINIFaultLatencyDistributionConstant`.
+@property GINIFaultLatencyDistribution latencyDistribution;
+
+/// The (minimum or mean, depending on the distribution) latency in seconds that is added to every request.
+@property NSTimeInterval latency;
+
+/// The maximum latency in seconds for the uniform and exponential distributions.
+@property NSTimeInterval maximumLatency;
+
+/// The bandwidth cap in bytes per second for the request and response bodies. 0 (the default) means no cap.
+@property NSUInteger bandwidth;
+
+/// The probability that the connection is reset before a response arrives (`NSURLErrorNetworkConnectionLost`).
+@property double connectionResetRate;
+
+/// The probability that the response body is cut off after a random number of bytes.
+@property double truncationRate;
+
+/// The probability that the request is rejected with HTTP 429 and a `Retry-After` header.
+@property double rateLimitRate;
+
+/// The value of the `Retry-After` header of injected 429 responses in seconds. Defaults to 1.
+@property NSUInteger retryAfter;
+
+/// The probability that the request fails with a `serverErrorStatusCode` response.
+@property double serverErrorRate;
+
+/// The status code of injected server errors. Defaults to 503.
+@property NSInteger serverErrorStatusCode;
+
+/**
+ * Returns YES if the rule applies to the given request.
+ */
+- (BOOL)matchesRequest:(NSURLRequest *)request;
+
+@end
+
+
+/// The injector key of the URL session which is wrapped by the fault injecting URL session.
+extern NSString *const GINIInjectorFaultInjectionURLSessionKey;
+
+
+/**
+ * The `GINIFaultInjectingURLSession` wraps another <GINIURLSession> and injects latency, bandwidth limits, connection
+ * resets, truncated bodies and 5xx/429 responses into the requests, so bad networks can be reproduced
+ * deterministically when tuning timeouts, retries and polling.
+ *
+ * The faults of a request are defined by the first of the `rules` which matches it. The random decisions are made with
+ * a seeded generator, so the same sequence of requests always gets the same faults.
+ *
+ * Use `installInInjector:rules:seed:` to make all components of the Gini SDK use a fault injecting URL session, e.g.
+ * with the injector of a `GINISDKBuilder` before calling `build`.
+ *
+ * Never use this class in production builds.
+ */
+@interface GINIFaultInjectingURLSession : NSObject <GINIURLSession>
+
+/**
+ * Factory to create a new fault injecting URL session.
+ *
+ * @param urlSession    The URL session that does the actual requests.
+ * @param rules         The rules, the first matching rule is used for a request.
+ * @param seed          The seed of the random generator.
+ */
++ (instancetype)faultInjectingURLSessionWithURLSession:(id<GINIURLSession>)urlSession
+                                                 rules:(NSArray<GINIFaultRule *> *)rules
+                                                  seed:(uint64_t)seed;
+
+/**
+ * Replaces the factory for the `@protocol(GINIURLSession)` key of the given injector with a factory that wraps the
+ * URL session created by the original factory into a (single) fault injecting URL session.
+ *
+ * @param injector      The injector, e.g. `GINISDKBuilder.injector`.
+ * @param rules         The rules, the first matching rule is used for a request.
+ * @param seed          The seed of the random generator.
+ */
++ (void)installInInjector:(GINIInjector *)injector rules:(NSArray<GINIFaultRule *> *)rules seed:(uint64_t)seed;
+
+/// The URL session that does the actual requests.
+@property (readonly) id<GINIURLSession> urlSession;
+
+/// The rules of this session.
+@property (readonly) NSArray<GINIFaultRule *> *rules;
+
+/// The number of injected faults (connection resets, truncations, 429 and 5xx responses).
+@property (readonly) NSUInteger injectedFaultCount;
+
+@end
@@ -0,0 +1,403 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <objc/runtime.h>
+#import <Bolts/Bolts.h>
+#import "GINIFaultInjectingURLSession.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+#import "GINIInjector.h"
+#import "GINIFactoryDescription.h"
+
+
+NSString *const GINIInjectorFaultInjectionURLSessionKey = @"faultInjectionURLSession";
+
+/// The injector keys of the arguments of the fault injecting URL session.
+static NSString *const GINIInjectorFaultInjectionRulesKey = @"faultInjectionRules";
+static NSString *const GINIInjectorFaultInjectionSeedKey = @"faultInjectionSeed";
+
+/// Defined in GINIURLSession.m.
+GINIURLResponse *GINIDeserializeResponse(NSURLResponse *response, NSData *rawData, NSError **error);
+
+
+/**
+ * The faults that replace the response of a request.
+ */
+typedef NS_ENUM(NSUInteger, GINIInjectedFault) {
+    GINIInjectedFaultNone,
+    GINIInjectedFaultConnectionReset,
+    GINIInjectedFaultRateLimit,
+    GINIInjectedFaultServerError
+};
+
+
+@implementation GINIFaultRule {
+    NSRegularExpression *_pathExpression;
+}
+
+#pragma mark - Factory
++ (instancetype)ruleWithMethod:(NSString *)method pathPattern:(NSString *)pathPattern {
+    return [[self alloc] initWithMethod:method pathPattern:pathPattern];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithMethod:(NSString *)method pathPattern:(NSString *)pathPattern {
+    self = [super init];
+    if (self) {
+        _method = [method uppercaseString];
+        _pathPattern = [pathPattern copy];
+        if (pathPattern) {
+            NSError *error;
+            _pathExpression = [NSRegularExpression regularExpressionWithPattern:pathPattern options:0 error:&error];
+            NSAssert(_pathExpression, @"Invalid path pattern %@: %@", pathPattern, error);
+        }
+        _retryAfter = 1;
+        _serverErrorStatusCode = 503;
+    }
+    return self;
+}
+
+#pragma mark - Public methods
+- (BOOL)matchesRequest:(NSURLRequest *)request {
+    if (_method && ![_method isEqualToString:(request.HTTPMethod ?: @"GET")]) {
+        return NO;
+    }
+    if (_pathExpression) {
+        NSString *path = request.URL.path ?: @"";
+        return [_pathExpression firstMatchInString:path options:0 range:NSMakeRange(0, [path length])] != nil;
+    }
+    return YES;
+}
+
+#pragma mark - NSCopying
+- (id)copyWithZone:(NSZone *)zone {
+    GINIFaultRule *copy = [[[self class] allocWithZone:zone] initWithMethod:_method pathPattern:_pathPattern];
+    copy.latencyDistribution = self.latencyDistribution;
+    copy.latency = self.latency;
+    copy.maximumLatency = self.maximumLatency;
+    copy.bandwidth = self.bandwidth;
+    copy.connectionResetRate = self.connectionResetRate;
+    copy.truncationRate = self.truncationRate;
+    copy.rateLimitRate = self.rateLimitRate;
+    copy.retryAfter = self.retryAfter;
+    copy.serverErrorRate = self.serverErrorRate;
+    copy.serverErrorStatusCode = self.serverErrorStatusCode;
+    return copy;
+}
+
+@end
+
+
+/**
+ * Returns the raw bytes of the body of the given response, or nil if they can't be determined (e.g. for images
+ * created with already decoded data).
+ */
+static NSData *GINIResponseBody(GINIURLResponse *response) {
+    if (response.rawData) {
+        return response.rawData;
+    }
+    id data = response.data;
+    if ([data isKindOfClass:[NSData class]]) {
+        return data;
+    } else if ([data isKindOfClass:[NSURL class]]) {
+        return [NSData dataWithContentsOfURL:data];
+    } else if ([data isKindOfClass:[NSString class]]) {
+        return [data dataUsingEncoding:NSUTF8StringEncoding];
+    } else if ([NSJSONSerialization isValidJSONObject:data]) {
+        return [NSJSONSerialization dataWithJSONObject:data options:0 error:nil];
+    }
+    return nil;
+}
+
+
+/**
+ * Removes a file when it is deallocated. Attached to the responses with truncated downloads, so the file lives as long
+ * as the response and is removed once the task has completed and its continuations no longer need the response.
+ */
+@interface GINITemporaryFile : NSObject
+
+- (instancetype)initWithURL:(NSURL *)fileURL;
+
+@end
+
+@implementation GINITemporaryFile {
+    NSURL *_fileURL;
+}
+
+- (instancetype)initWithURL:(NSURL *)fileURL {
+    self = [super init];
+    if (self) {
+        _fileURL = fileURL;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSFileManager defaultManager] removeItemAtURL:_fileURL error:nil];
+}
+
+@end
+
+
+@implementation GINIFaultInjectingURLSession {
+    uint64_t _randomState;
+    NSUInteger _injectedFaultCount;
+}
+
+#pragma mark - Factory
++ (instancetype)faultInjectingURLSessionWithURLSession:(id<GINIURLSession>)urlSession
+                                                 rules:(NSArray<GINIFaultRule *> *)rules
+                                                  seed:(uint64_t)seed {
+    return [[self alloc] initWithURLSession:urlSession rules:rules seed:seed];
+}
+
+/**
+ * The factory which is used by the injector, since the injector can only pass objects.
+ */
++ (instancetype)faultInjectingURLSessionWithURLSession:(id<GINIURLSession>)urlSession
+                                                 rules:(NSArray<GINIFaultRule *> *)rules
+                                            seedNumber:(NSNumber *)seed {
+    return [[self alloc] initWithURLSession:urlSession rules:rules seed:[seed unsignedLongLongValue]];
+}
+
++ (void)installInInjector:(GINIInjector *)injector rules:(NSArray<GINIFaultRule *> *)rules seed:(uint64_t)seed {
+    NSParameterAssert([injector isKindOfClass:[GINIInjector class]]);
+    NSParameterAssert([rules isKindOfClass:[NSArray class]]);
+
+    GINIFactoryDescription *originalFactory = [injector factoryForKey:@protocol(GINIURLSession)];
+    NSAssert(originalFactory, @"The injector has no factory for the URL session");
+    GINIFactoryDescription *wrappedFactory = [injector setFactory:originalFactory.factoryMethod
+                                                               on:originalFactory.object
+                                                           forKey:GINIInjectorFaultInjectionURLSessionKey
+                                                 withDependencies:nil];
+    wrappedFactory.dependencies = originalFactory.dependencies;
+    wrappedFactory.isSingleton = originalFactory.isSingleton;
+
+    [injector setObject:rules forKey:GINIInjectorFaultInjectionRulesKey];
+    [injector setObject:@(seed) forKey:GINIInjectorFaultInjectionSeedKey];
+    // A single instance, so all components share the sequence of random decisions.
+    [injector setSingletonFactory:@selector(faultInjectingURLSessionWithURLSession:rules:seedNumber:)
+                               on:self
+                           forKey:@protocol(GINIURLSession)
+                 withDependencies:GINIInjectorFaultInjectionURLSessionKey, GINIInjectorFaultInjectionRulesKey, GINIInjectorFaultInjectionSeedKey, nil];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithURLSession:(id<GINIURLSession>)urlSession
+                             rules:(NSArray<GINIFaultRule *> *)rules
+                              seed:(uint64_t)seed {
+    NSParameterAssert([urlSession conformsToProtocol:@protocol(GINIURLSession)]);
+    NSParameterAssert([rules isKindOfClass:[NSArray class]]);
+
+    self = [super init];
+    if (self) {
+        _urlSession = urlSession;
+        _rules = [[NSArray alloc] initWithArray:rules copyItems:YES];
+        // xorshift must not start with 0.
+        _randomState = seed ?: 0x9E3779B97F4A7C15ULL;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)injectedFaultCount {
+    @synchronized (self) {
+        return _injectedFaultCount;
+    }
+}
+
+#pragma mark - GINIURLSession protocol
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request {
+    return [self injectFaultsIntoRequest:request uploadLength:[request.HTTPBody length] cancellationToken:nil usingBlock:^BFTask *{
+        return [self->_urlSession BFDataTaskWithRequest:request];
+    }];
+}
+
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self injectFaultsIntoRequest:request uploadLength:[request.HTTPBody length] cancellationToken:cancellationToken usingBlock:^BFTask *{
+        return GINIDataTaskWithRequest(self->_urlSession, request, cancellationToken);
+    }];
+}
+
+- (BFTask *)BFStreamingDataTaskWithRequest:(NSURLRequest *)request
+                                 dataBlock:(BOOL (^)(NSData *data))dataBlock
+                         cancellationToken:(BFCancellationToken *)cancellationToken {
+    // The body of a streamed response is handed to the data block as it arrives and is not part of the response, so
+    // it can't be truncated and the bandwidth cap is applied once the whole body has been handed on.
+    NSUInteger bandwidth = [self ruleForRequest:request].bandwidth;
+    __block NSUInteger bodyLength = 0;
+    BOOL (^countingDataBlock)(NSData *) = ^BOOL(NSData *data) {
+        bodyLength += [data length];
+        return dataBlock(data);
+    };
+    return [self injectFaultsIntoRequest:request uploadLength:[request.HTTPBody length] cancellationToken:cancellationToken usingBlock:^BFTask *{
+        return [GINIStreamingDataTaskWithRequest(self->_urlSession, request, countingDataBlock, cancellationToken) continueWithSuccessBlock:^id(BFTask *responseTask) {
+            if (bandwidth > 0 && bodyLength > 0) {
+                return [[BFTask taskWithDelay:(int)((double)bodyLength / bandwidth * 1000)] continueWithBlock:^id(BFTask *waitTask) {
+                    return responseTask;
+                }];
+            }
+            return responseTask;
+        }];
+    }];
+}
+
+- (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
+    return [self injectFaultsIntoRequest:request uploadLength:0 cancellationToken:nil usingBlock:^BFTask *{
+        return [self->_urlSession BFDownloadTaskWithRequest:request];
+    }];
+}
+
+- (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
+    return [self injectFaultsIntoRequest:request uploadLength:[uploadData length] cancellationToken:nil usingBlock:^BFTask *{
+        return [self->_urlSession BFUploadTaskWithRequest:request fromData:uploadData];
+    }];
+}
+
+#pragma mark - Fault injection
+- (BFTask *)injectFaultsIntoRequest:(NSURLRequest *)request
+                       uploadLength:(NSUInteger)uploadLength
+                  cancellationToken:(BFCancellationToken *)cancellationToken
+                         usingBlock:(BFTask *(^)(void))block {
+    GINIFaultRule *rule = [self ruleForRequest:request];
+    if (!rule) {
+        return block();
+    }
+
+    // All random decisions are made up front, so they only depend on the order of the requests and not on the order
+    // in which the responses arrive.
+    double latencyRandom, faultRandom, truncationRandom, truncationLength;
+    @synchronized (self) {
+        latencyRandom = [self nextRandom];
+        faultRandom = [self nextRandom];
+        truncationRandom = [self nextRandom];
+        truncationLength = [self nextRandom];
+    }
+
+    NSTimeInterval delay = [self latencyOfRule:rule random:latencyRandom];
+    if (rule.bandwidth > 0) {
+        delay += (double)uploadLength / rule.bandwidth;
+    }
+
+    GINIInjectedFault fault = GINIInjectedFaultNone;
+    if (faultRandom < rule.connectionResetRate) {
+        fault = GINIInjectedFaultConnectionReset;
+    } else if (faultRandom < rule.connectionResetRate + rule.rateLimitRate) {
+        fault = GINIInjectedFaultRateLimit;
+    } else if (faultRandom < rule.connectionResetRate + rule.rateLimitRate + rule.serverErrorRate) {
+        fault = GINIInjectedFaultServerError;
+    }
+    BOOL truncate = fault == GINIInjectedFaultNone && truncationRandom < rule.truncationRate;
+    if (fault != GINIInjectedFaultNone) {
+        @synchronized (self) {
+            _injectedFaultCount++;
+        }
+    }
+
+    BFTask *delayTask = delay > 0 ? [BFTask taskWithDelay:(int)(delay * 1000) cancellationToken:cancellationToken] : [BFTask taskWithResult:nil];
+    return [delayTask continueWithBlock:^id(BFTask *task) {
+        if (task.cancelled) {
+            return task;
+        }
+        if (fault != GINIInjectedFaultNone) {
+            return [self taskWithFault:fault rule:rule request:request];
+        }
+        return [block() continueWithSuccessBlock:^id(BFTask *responseTask) {
+            GINIURLResponse *response = responseTask.result;
+            NSData *body = (truncate || rule.bandwidth > 0) ? GINIResponseBody(response) : nil;
+            if (truncate && body) {
+                response = [self response:response truncatedBody:[body subdataWithRange:NSMakeRange(0, (NSUInteger)([body length] * truncationLength))]];
+                @synchronized (self) {
+                    self->_injectedFaultCount++;
+                }
+            }
+            if (rule.bandwidth > 0 && [body length] > 0) {
+                return [[BFTask taskWithDelay:(int)((double)[body length] / rule.bandwidth * 1000)] continueWithBlock:^id(BFTask *waitTask) {
+                    return response;
+                }];
+            }
+            return response;
+        }];
+    }];
+}
+
+- (GINIFaultRule *)ruleForRequest:(NSURLRequest *)request {
+    for (GINIFaultRule *rule in _rules) {
+        if ([rule matchesRequest:request]) {
+            return rule;
+        }
+    }
+    return nil;
+}
+
+- (NSTimeInterval)latencyOfRule:(GINIFaultRule *)rule random:(double)random {
+    NSTimeInterval latency;
+    switch (rule.latencyDistribution) {
+        case GINIFaultLatencyDistributionUniform:
+            latency = rule.latency + random * MAX(rule.maximumLatency - rule.latency, 0);
+            break;
+        case GINIFaultLatencyDistributionExponential:
+            latency = -rule.latency * log(1 - random);
+            if (rule.maximumLatency > 0) {
+                latency = MIN(latency, rule.maximumLatency);
+            }
+            break;
+        default:
+            latency = rule.latency;
+            break;
+    }
+    return latency;
+}
+
+- (BFTask *)taskWithFault:(GINIInjectedFault)fault rule:(GINIFaultRule *)rule request:(NSURLRequest *)request {
+    if (fault == GINIInjectedFaultConnectionReset) {
+        NSDictionary *userInfo = @{NSURLErrorFailingURLErrorKey: request.URL,
+                                   NSLocalizedDescriptionKey: @"The network connection was lost (injected fault)."};
+        return [BFTask taskWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:userInfo]];
+    }
+
+    NSInteger statusCode = fault == GINIInjectedFaultRateLimit ? 429 : rule.serverErrorStatusCode;
+    NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithObject:@"application/json" forKey:@"Content-Type"];
+    if (fault == GINIInjectedFaultRateLimit) {
+        headers[@"Retry-After"] = [@(rule.retryAfter) stringValue];
+    }
+    NSHTTPURLResponse *httpResponse = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                                                  statusCode:statusCode
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:headers];
+    NSDictionary *body = @{@"message": [NSHTTPURLResponse localizedStringForStatusCode:statusCode]};
+    GINIURLResponse *response = [GINIURLResponse urlResponseWithResponse:httpResponse data:body];
+    return [BFTask taskWithError:[GINIHTTPError errorWithResponse:response]];
+}
+
+/**
+ * Creates the response the wrapped URL session would have returned if only the given part of the body had arrived.
+ */
+- (GINIURLResponse *)response:(GINIURLResponse *)response truncatedBody:(NSData *)body {
+    if ([response.data isKindOfClass:[NSURL class]]) {
+        NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        [body writeToURL:fileURL atomically:NO];
+        GINIURLResponse *truncatedResponse = [GINIURLResponse urlResponseWithResponse:response.response data:fileURL];
+        objc_setAssociatedObject(truncatedResponse, @selector(response:truncatedBody:), [[GINITemporaryFile alloc] initWithURL:fileURL], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        return truncatedResponse;
+    }
+    if (response.response) {
+        NSError *error = nil;
+        return GINIDeserializeResponse(response.response, body, &error);
+    }
+    return [GINIURLResponse urlResponseWithResponse:nil data:body];
+}
+
+/**
+ * Returns a random number in [0, 1) (xorshift64*). Must be called while synchronized on self.
+ */
+- (double)nextRandom {
+    _randomState ^= _randomState >> 12;
+    _randomState ^= _randomState << 25;
+    _randomState ^= _randomState >> 27;
+    return (double)((_randomState * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+}
+
+@end
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class GINIDocument;
+@class GINIExtraction;
+
+
+/**
+ * The `GINIFeedbackBuffer` collects the updated extractions of documents and submits them as one batch feedback per
+ * document, either when no extraction of the document has been updated for `debounceInterval` seconds or when the
+ * feedback of the document is flushed explicitly. Several updates of the same extraction are coalesced into the last
+ * one.
+ *
+ * All tasks returned for the updates of a batch resolve with the result (or the error) of the single batch submission.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIFeedbackBuffer : NSObject
+
+/**
+ * Factory to create a new feedback buffer.
+ *
+ * @param debounceInterval  The time in seconds after the last update of a document until its feedback is submitted.
+ * @param submitBlock       Submits the feedback of a document (see `-[GINIAPIManager submitBatchFeedbackForDocument:feedback:]`)
+ *                          and returns the task of the submission. The updated extractions are passed along, so they
+ *                          can be written to the caches of the document once the submission succeeded.
+ */
++ (instancetype)feedbackBufferWithDebounceInterval:(NSTimeInterval)debounceInterval
+                                       submitBlock:(BFTask *(^)(GINIDocument *document, NSDictionary *feedback, NSArray<GINIExtraction *> *extractions))submitBlock;
+
+/// The time in seconds after the last update of a document until its feedback is submitted.
+@property NSTimeInterval debounceInterval;
+
+/// The number of documents with feedback that has not been submitted yet.
+@property (readonly) NSUInteger pendingDocumentCount;
+
+/**
+ * Adds the updated extraction to the feedback of the document and (re)starts the debounce timer of the document.
+ *
+ * @param extraction    The updated extraction.
+ * @param document      The document.
+ *
+ * @returns             A `BFTask*` which resolves with the result of the batch submission containing the extraction.
+ */
+- (BFTask *)addExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document;
+
+/**
+ * Removes the pending update of the extraction from the feedback of the document, e.g. because the extraction has been
+ * changed back to the value on the server. The debounce timer of the document is not restarted. If no other update of
+ * the document is pending, the tasks of the earlier updates resolve to nil.
+ *
+ * @param extraction    The extraction whose update is removed.
+ * @param document      The document.
+ *
+ * @returns             A `BFTask*` which resolves like the tasks of the other updates of the document, or nil if no
+ *                      update of the extraction was pending.
+ */
+- (BFTask *)removeExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document;
+
+/**
+ * Submits the pending feedback of the document immediately.
+ *
+ * @returns             A `BFTask*` which resolves with the result of the submission, or to nil if there was no pending
+ *                      feedback.
+ */
+- (BFTask *)flushFeedbackForDocument:(GINIDocument *)document;
+
+/**
+ * Submits the pending feedback of all documents immediately.
+ *
+ * @returns             A `BFTask*` which completes when all submissions are finished.
+ */
+- (BFTask *)flush;
+
+@end
@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIFeedbackBuffer.h"
+#import "GINIDocument.h"
+#import "GINIExtraction.h"
+
+
+/**
+ * The pending feedback of a single document.
+ */
+@interface GINIPendingFeedback : NSObject
+
+@property (readonly) GINIDocument *document;
+/// The updated extractions by name. Later updates replace earlier ones.
+@property (readonly) NSMutableDictionary<NSString *, GINIExtraction *> *extractions;
+/// The completion sources of the tasks returned for the updates.
+@property (readonly) NSMutableArray<BFTaskCompletionSource *> *completionSources;
+/// The generation of the latest update, so a debounce timer can tell if it is still the latest.
+@property NSUInteger generation;
+
+@end
+
+
+@implementation GINIPendingFeedback
+
+- (instancetype)initWithDocument:(GINIDocument *)document {
+    self = [super init];
+    if (self) {
+        _document = document;
+        _extractions = [NSMutableDictionary new];
+        _completionSources = [NSMutableArray new];
+    }
+    return self;
+}
+
+@end
+
+
+@implementation GINIFeedbackBuffer {
+    BFTask *(^_submitBlock)(GINIDocument *, NSDictionary *, NSArray<GINIExtraction *> *);
+    /// The pending feedback keyed by the document ID.
+    NSMutableDictionary<NSString *, GINIPendingFeedback *> *_pendingFeedback;
+    /// Incremented on every update. Unique across documents and flushes, so a stale timer never flushes newer feedback.
+    NSUInteger _generation;
+}
+
+#pragma mark - Factory
++ (instancetype)feedbackBufferWithDebounceInterval:(NSTimeInterval)debounceInterval
+                                       submitBlock:(BFTask *(^)(GINIDocument *, NSDictionary *, NSArray<GINIExtraction *> *))submitBlock {
+    return [[self alloc] initWithDebounceInterval:debounceInterval submitBlock:submitBlock];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDebounceInterval:(NSTimeInterval)debounceInterval
+                             submitBlock:(BFTask *(^)(GINIDocument *, NSDictionary *, NSArray<GINIExtraction *> *))submitBlock {
+    NSParameterAssert(submitBlock);
+
+    self = [super init];
+    if (self) {
+        _debounceInterval = debounceInterval;
+        _submitBlock = [submitBlock copy];
+        _pendingFeedback = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)pendingDocumentCount {
+    @synchronized (_pendingFeedback) {
+        return [_pendingFeedback count];
+    }
+}
+
+#pragma mark - Feedback
+- (BFTask *)addExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document {
+    NSParameterAssert([extraction isKindOfClass:[GINIExtraction class]]);
+    NSParameterAssert([extraction.value isKindOfClass:[NSString class]]);
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    NSUInteger generation;
+    @synchronized (_pendingFeedback) {
+        GINIPendingFeedback *pendingFeedback = _pendingFeedback[document.documentId];
+        if (!pendingFeedback) {
+            pendingFeedback = [[GINIPendingFeedback alloc] initWithDocument:document];
+            _pendingFeedback[document.documentId] = pendingFeedback;
+        }
+        pendingFeedback.extractions[extraction.name] = extraction;
+        [pendingFeedback.completionSources addObject:completionSource];
+        generation = ++_generation;
+        pendingFeedback.generation = generation;
+    }
+
+    [[BFTask taskWithDelay:(int)(self.debounceInterval * 1000)] continueWithBlock:^id(BFTask *task) {
+        @synchronized (self->_pendingFeedback) {
+            // A later update restarted the timer or the feedback has been flushed in the meantime.
+            if (self->_pendingFeedback[document.documentId].generation != generation) {
+                return nil;
+            }
+        }
+        [self flushFeedbackForDocument:document];
+        return nil;
+    }];
+    return completionSource.task;
+}
+
+- (BFTask *)removeExtraction:(GINIExtraction *)extraction forDocument:(GINIDocument *)document {
+    NSParameterAssert([extraction isKindOfClass:[GINIExtraction class]]);
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    NSArray<BFTaskCompletionSource *> *completedSources;
+    @synchronized (_pendingFeedback) {
+        GINIPendingFeedback *pendingFeedback = _pendingFeedback[document.documentId];
+        if (!extraction.name || !pendingFeedback.extractions[extraction.name]) {
+            return nil;
+        }
+        [pendingFeedback.extractions removeObjectForKey:extraction.name];
+        [pendingFeedback.completionSources addObject:completionSource];
+        if ([pendingFeedback.extractions count] == 0) {
+            // Nothing is left to submit, so the pending timer finds no feedback and the updates are done.
+            [_pendingFeedback removeObjectForKey:document.documentId];
+            completedSources = pendingFeedback.completionSources;
+        }
+    }
+    for (BFTaskCompletionSource *completedSource in completedSources) {
+        [completedSource setResult:nil];
+    }
+    return completionSource.task;
+}
+
+- (BFTask *)flushFeedbackForDocument:(GINIDocument *)document {
+    NSParameterAssert([document isKindOfClass:[GINIDocument class]]);
+
+    GINIPendingFeedback *pendingFeedback;
+    @synchronized (_pendingFeedback) {
+        pendingFeedback = _pendingFeedback[document.documentId];
+        [_pendingFeedback removeObjectForKey:document.documentId];
+    }
+    if (!pendingFeedback) {
+        return [BFTask taskWithResult:nil];
+    }
+
+    NSMutableDictionary *feedback = [NSMutableDictionary dictionaryWithCapacity:[pendingFeedback.extractions count]];
+    for (NSString *name in pendingFeedback.extractions) {
+        GINIExtraction *extraction = pendingFeedback.extractions[name];
+        NSMutableDictionary *extractionFeedback = [NSMutableDictionary dictionaryWithObject:extraction.value forKey:@"value"];
+        extractionFeedback[@"box"] = extraction.box;
+        feedback[name] = extractionFeedback;
+    }
+
+    BFTask *submitTask = _submitBlock(pendingFeedback.document, feedback, [pendingFeedback.extractions allValues]);
+    return [submitTask continueWithBlock:^id(BFTask *task) {
+        for (BFTaskCompletionSource *completionSource in pendingFeedback.completionSources) {
+            if (task.error) {
+                [completionSource setError:task.error];
+            } else if (task.cancelled) {
+                [completionSource cancel];
+            } else {
+                [completionSource setResult:task.result];
+            }
+        }
+        return task;
+    }];
+}
+
+- (BFTask *)flush {
+    NSArray<GINIPendingFeedback *> *pendingFeedback;
+    @synchronized (_pendingFeedback) {
+        pendingFeedback = [_pendingFeedback allValues];
+    }
+    NSMutableArray *flushTasks = [NSMutableArray arrayWithCapacity:[pendingFeedback count]];
+    for (GINIPendingFeedback *feedback in pendingFeedback) {
+        [flushTasks addObject:[self flushFeedbackForDocument:feedback.document]];
+    }
+    return [BFTask taskForCompletionOfAllTasks:flushTasks];
+}
+
+@end
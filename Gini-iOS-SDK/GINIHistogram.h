@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ * Returns a monotonic timestamp in seconds. Only the difference between two timestamps is meaningful, so use it to
+ * measure durations and not as a wall clock time.
+ */
+NSTimeInterval GINIMonotonicTimestamp(void);
+
+
+/**
+ * The `GINIHistogram` records durations with a bounded relative error (about 3%) in a fixed amount of memory,
+ * similar to an HDR histogram. Recording a value is a constant-time operation, which makes it cheap enough to be used
+ * on hot paths.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIHistogram : NSObject <NSCopying>
+
+/** The number of recorded values. */
+@property (readonly) uint64_t totalCount;
+
+/** The smallest recorded value in seconds or 0 if no value was recorded. */
+@property (readonly) NSTimeInterval minValue;
+
+/** The largest recorded value in seconds or 0 if no value was recorded. */
+@property (readonly) NSTimeInterval maxValue;
+
+/** The arithmetic mean of the recorded values in seconds or 0 if no value was recorded. */
+@property (readonly) NSTimeInterval mean;
+
+/**
+ * Records a value.
+ *
+ * @param value     The value (usually a duration) in seconds. Negative values are recorded as 0.
+ */
+- (void)recordValue:(NSTimeInterval)value;
+
+/**
+ * Gets the value at the given percentile, e.g. `[histogram valueAtPercentile:99]` for the p99.
+ *
+ * @param percentile    The percentile between 0 and 100.
+ *
+ * @returns             The value in seconds below or at which the given percentage of the recorded values are, or 0
+ *                      if no value was recorded.
+ */
+- (NSTimeInterval)valueAtPercentile:(double)percentile;
+
+/**
+ * Adds all recorded values of the given histogram to this histogram.
+ *
+ * @param histogram     The histogram whose values are added.
+ */
+- (void)addHistogram:(GINIHistogram *)histogram;
+
+/**
+ * Removes all recorded values.
+ */
+- (void)reset;
+
+/**
+ * A dictionary with a summary of the histogram (count, min, max, mean, p50, p90, p99 and p999) that can be serialized
+ * to JSON, e.g. to send it to a monitoring backend.
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
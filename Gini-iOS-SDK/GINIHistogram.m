@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import "GINIHistogram.h"
+
+
+/**
+ * Values below 2^GINIHistogramLinearBits microseconds are counted exactly. Every power of two above is split into
+ * 2^(GINIHistogramLinearBits - 1) linear sub-buckets, which bounds the relative error to about 3%.
+ */
+#define GINIHistogramLinearBits 6
+#define GINIHistogramLinearCount (1ULL << GINIHistogramLinearBits)
+#define GINIHistogramSubBucketCount (1ULL << (GINIHistogramLinearBits - 1))
+#define GINIHistogramBucketCount (GINIHistogramLinearCount + (64 - GINIHistogramLinearBits) * GINIHistogramSubBucketCount)
+
+
+NSTimeInterval GINIMonotonicTimestamp(void) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+/**
+ * Returns the index of the bucket that counts the given value (in microseconds).
+ */
+static NSUInteger GINIHistogramBucketIndex(uint64_t value) {
+    if (value < GINIHistogramLinearCount) {
+        return (NSUInteger)value;
+    }
+    NSUInteger exponent = 63 - __builtin_clzll(value);
+    NSUInteger shift = exponent - (GINIHistogramLinearBits - 1);
+    NSUInteger offset = (NSUInteger)((value >> shift) - GINIHistogramSubBucketCount);
+    return GINIHistogramLinearCount + (exponent - GINIHistogramLinearBits) * GINIHistogramSubBucketCount + offset;
+}
+
+/**
+ * Returns the largest value (in microseconds) that is counted by the bucket with the given index.
+ */
+static uint64_t GINIHistogramBucketUpperBound(NSUInteger index) {
+    if (index < GINIHistogramLinearCount) {
+        return index;
+    }
+    NSUInteger linearIndex = index - GINIHistogramLinearCount;
+    NSUInteger exponent = linearIndex / GINIHistogramSubBucketCount + GINIHistogramLinearBits;
+    NSUInteger shift = exponent - (GINIHistogramLinearBits - 1);
+    uint64_t lowerBound = (uint64_t)(linearIndex % GINIHistogramSubBucketCount + GINIHistogramSubBucketCount) << shift;
+    return lowerBound + (1ULL << shift) - 1;
+}
+
+
+@implementation GINIHistogram {
+    pthread_mutex_t _lock;
+    uint64_t _counts[GINIHistogramBucketCount];
+    uint64_t _totalCount;
+    uint64_t _min;
+    uint64_t _max;
+    double _sum;
+}
+
+#pragma mark - Initializer
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+        _min = UINT64_MAX;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Recording
+- (void)recordValue:(NSTimeInterval)value {
+    uint64_t microseconds = value > 0 ? (uint64_t)(value * USEC_PER_SEC) : 0;
+
+    pthread_mutex_lock(&_lock);
+    _counts[GINIHistogramBucketIndex(microseconds)] += 1;
+    _totalCount += 1;
+    _sum += microseconds;
+    _min = MIN(_min, microseconds);
+    _max = MAX(_max, microseconds);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)addHistogram:(GINIHistogram *)histogram {
+    NSParameterAssert([histogram isKindOfClass:[GINIHistogram class]]);
+
+    GINIHistogram *other = [histogram copy];
+    pthread_mutex_lock(&_lock);
+    for (NSUInteger i = 0; i < GINIHistogramBucketCount; i++) {
+        _counts[i] += other->_counts[i];
+    }
+    _totalCount += other->_totalCount;
+    _sum += other->_sum;
+    _min = MIN(_min, other->_min);
+    _max = MAX(_max, other->_max);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)reset {
+    pthread_mutex_lock(&_lock);
+    memset(_counts, 0, sizeof(_counts));
+    _totalCount = 0;
+    _sum = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Queries
+- (uint64_t)totalCount {
+    pthread_mutex_lock(&_lock);
+    uint64_t totalCount = _totalCount;
+    pthread_mutex_unlock(&_lock);
+    return totalCount;
+}
+
+- (NSTimeInterval)minValue {
+    pthread_mutex_lock(&_lock);
+    uint64_t min = _totalCount > 0 ? _min : 0;
+    pthread_mutex_unlock(&_lock);
+    return (NSTimeInterval)min / USEC_PER_SEC;
+}
+
+- (NSTimeInterval)maxValue {
+    pthread_mutex_lock(&_lock);
+    uint64_t max = _max;
+    pthread_mutex_unlock(&_lock);
+    return (NSTimeInterval)max / USEC_PER_SEC;
+}
+
+- (NSTimeInterval)mean {
+    pthread_mutex_lock(&_lock);
+    double mean = _totalCount > 0 ? _sum / _totalCount : 0;
+    pthread_mutex_unlock(&_lock);
+    return mean / USEC_PER_SEC;
+}
+
+- (NSTimeInterval)valueAtPercentile:(double)percentile {
+    NSParameterAssert(percentile >= 0 && percentile <= 100);
+
+    uint64_t value = 0;
+    pthread_mutex_lock(&_lock);
+    if (_totalCount > 0) {
+        uint64_t target = MAX((uint64_t)ceil(percentile / 100.0 * _totalCount), 1ULL);
+        uint64_t cumulativeCount = 0;
+        for (NSUInteger i = 0; i < GINIHistogramBucketCount; i++) {
+            cumulativeCount += _counts[i];
+            if (cumulativeCount >= target) {
+                // The upper bound of a bucket can be larger than any recorded value.
+                value = MIN(GINIHistogramBucketUpperBound(i), _max);
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+    return (NSTimeInterval)value / USEC_PER_SEC;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    GINIHistogram *snapshot = [self copy];
+    return @{@"count": @(snapshot.totalCount),
+             @"min": @(snapshot.minValue),
+             @"max": @(snapshot.maxValue),
+             @"mean": @(snapshot.mean),
+             @"p50": @([snapshot valueAtPercentile:50]),
+             @"p90": @([snapshot valueAtPercentile:90]),
+             @"p99": @([snapshot valueAtPercentile:99]),
+             @"p999": @([snapshot valueAtPercentile:99.9])};
+}
+
+#pragma mark - NSCopying
+- (id)copyWithZone:(NSZone *)zone {
+    GINIHistogram *copy = [[[self class] allocWithZone:zone] init];
+    pthread_mutex_lock(&_lock);
+    memcpy(copy->_counts, _counts, sizeof(_counts));
+    copy->_totalCount = _totalCount;
+    copy->_sum = _sum;
+    copy->_min = _min;
+    copy->_max = _max;
+    pthread_mutex_unlock(&_lock);
+    return copy;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINIHistogram count=%llu p50=%.3fs p99=%.3fs>",
+            self.totalCount, [self valueAtPercentile:50], [self valueAtPercentile:99]];
+}
+
+@end
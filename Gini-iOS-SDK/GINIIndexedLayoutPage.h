@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import "GINIAPIManager.h"
+
+@class GINILayoutPage;
+@class GINIExtraction;
+
+
+/**
+ * A page of the layout of a document in a compact form for hit-testing, e.g. to find the word under a tap.
+ *
+ * The boxes of the words and lines are stored in contiguous arrays, the texts of the words are stored once per distinct
+ * text. The words are indexed in a uniform grid over the page, so point, rectangle and nearest-neighbour queries only
+ * look at the words in the cells around the query instead of all words of the page.
+ *
+ * Words and lines are identified by their index, the words in reading order (the order of the layout). All coordinates
+ * are in the coordinate space of the layout, use the conversion methods for the coordinate spaces of the preview
+ * images (see `-[GINIDocumentTaskManager getPreviewForPage:ofDocument:withSize:]`).
+ *
+ * Instances are immutable and can be used from any thread.
+ */
+@interface GINIIndexedLayoutPage : NSObject
+
+/**
+ * Creates the indexed form of a page.
+ *
+ * @param page      The page, e.g. from `-[GINIDocumentTaskManager getLayoutPagesForDocument:pageBlock:cancellationToken:]`.
+ */
++ (instancetype)indexedLayoutPageWithLayoutPage:(GINILayoutPage *)page;
+
+/**
+ * Creates the indexed forms of all pages of a layout.
+ *
+ * @param layout    The JSON layout, e.g. from `-[GINIDocumentTaskManager getLayoutForDocument:]`.
+ */
++ (NSArray<GINIIndexedLayoutPage *> *)indexedLayoutPagesWithLayout:(NSDictionary *)layout;
+
+/// The page number, starting with 1.
+@property (readonly) NSUInteger number;
+
+/// The size of the page.
+@property (readonly) CGSize size;
+
+/// The number of words on the page.
+@property (readonly) NSUInteger wordCount;
+
+/// The number of lines on the page.
+@property (readonly) NSUInteger lineCount;
+
+#pragma mark - Words and lines
+
+/**
+ * The text of a word.
+ *
+ * @param index     The index of the word.
+ */
+- (NSString *)textOfWordAtIndex:(NSUInteger)index;
+
+/**
+ * The box of a word.
+ *
+ * @param index     The index of the word.
+ */
+- (CGRect)rectOfWordAtIndex:(NSUInteger)index;
+
+/**
+ * The index of the line containing a word.
+ *
+ * @param index     The index of the word.
+ */
+- (NSUInteger)lineIndexOfWordAtIndex:(NSUInteger)index;
+
+/**
+ * The box of a line.
+ *
+ * @param index     The index of the line.
+ */
+- (CGRect)rectOfLineAtIndex:(NSUInteger)index;
+
+/**
+ * The indexes of the words of a line.
+ *
+ * @param index     The index of the line.
+ */
+- (NSRange)wordRangeOfLineAtIndex:(NSUInteger)index;
+
+#pragma mark - Queries
+
+/**
+ * The index of the word whose box contains the point, or NSNotFound. If several boxes contain the point, the smallest
+ * one wins.
+ *
+ * @param point     The point.
+ */
+- (NSUInteger)wordIndexAtPoint:(CGPoint)point;
+
+/**
+ * The indexes of the words whose boxes intersect the rectangle.
+ *
+ * @param rect      The rectangle.
+ */
+- (NSIndexSet *)wordIndexesInRect:(CGRect)rect;
+
+/**
+ * The index of the word whose box is closest to the point, or NSNotFound if there is no word within the maximum
+ * distance. Useful for taps which miss the small box of a word.
+ *
+ * @param point             The point.
+ * @param maximumDistance   The maximum distance between the point and the box of the word.
+ */
+- (NSUInteger)nearestWordIndexToPoint:(CGPoint)point maximumDistance:(CGFloat)maximumDistance;
+
+/**
+ * The text of the words whose boxes intersect the rectangle in reading order, the words of a line separated by spaces
+ * and the lines by newlines.
+ *
+ * @param rect      The rectangle.
+ */
+- (NSString *)textInRect:(CGRect)rect;
+
+/**
+ * The extraction on this page whose box contains the point. If several boxes contain the point, the smallest one wins.
+ *
+ * @param point         The point.
+ * @param extractions   The extractions (e.g. the result of `-[GINIDocument extractions]`). Extractions without a box
+ *                      or on other pages are ignored.
+ */
+- (GINIExtraction *)extractionAtPoint:(CGPoint)point inExtractions:(NSDictionary<NSString *, GINIExtraction *> *)extractions;
+
+#pragma mark - Coordinate spaces
+
+/**
+ * The factor by which the page is scaled in the preview image of the given size. The page is scaled to fit into the
+ * size of the preview image, keeping its aspect ratio.
+ *
+ * @param previewSize   The size of the preview image.
+ */
+- (CGFloat)scaleForPreviewSize:(GiniApiPreviewSize)previewSize;
+
+/**
+ * Converts a rectangle from the coordinate space of the layout to the coordinate space of a preview image in pixels.
+ *
+ * @param rect          The rectangle in the coordinate space of the layout.
+ * @param previewSize   The size of the preview image.
+ */
+- (CGRect)convertRect:(CGRect)rect toPreviewSize:(GiniApiPreviewSize)previewSize;
+
+/**
+ * Converts a rectangle from the coordinate space of a preview image in pixels to the coordinate space of the layout.
+ *
+ * @param rect          The rectangle in the coordinate space of the preview image.
+ * @param previewSize   The size of the preview image.
+ */
+- (CGRect)convertRect:(CGRect)rect fromPreviewSize:(GiniApiPreviewSize)previewSize;
+
+/**
+ * Converts a point from the coordinate space of the layout to the coordinate space of a preview image in pixels.
+ *
+ * @param point         The point in the coordinate space of the layout.
+ * @param previewSize   The size of the preview image.
+ */
+- (CGPoint)convertPoint:(CGPoint)point toPreviewSize:(GiniApiPreviewSize)previewSize;
+
+/**
+ * Converts a point from the coordinate space of a preview image in pixels to the coordinate space of the layout.
+ *
+ * @param point         The point in the coordinate space of the preview image.
+ * @param previewSize   The size of the preview image.
+ */
+- (CGPoint)convertPoint:(CGPoint)point fromPreviewSize:(GiniApiPreviewSize)previewSize;
+
+@end
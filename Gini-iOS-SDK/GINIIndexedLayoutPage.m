@@ -0,0 +1,391 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIIndexedLayoutPage.h"
+#import "GINILayoutParser.h"
+#import "GINIExtraction.h"
+
+
+/// The maximum number of grid cells in each direction.
+static const NSUInteger GINIIndexedLayoutPageMaximumGridSize = 64;
+
+/**
+ * The box of a word or line: left, top, width and height.
+ */
+typedef struct {
+    float left;
+    float top;
+    float width;
+    float height;
+} GINILayoutBox;
+
+static GINILayoutBox GINILayoutBoxWithDictionary(NSDictionary *dictionary) {
+    return (GINILayoutBox){[dictionary[@"l"] floatValue], [dictionary[@"t"] floatValue], [dictionary[@"w"] floatValue], [dictionary[@"h"] floatValue]};
+}
+
+static CGRect GINILayoutBoxRect(GINILayoutBox box) {
+    return CGRectMake(box.left, box.top, box.width, box.height);
+}
+
+static BOOL GINILayoutBoxContainsPoint(GINILayoutBox box, CGPoint point) {
+    return point.x >= box.left && point.x <= box.left + box.width && point.y >= box.top && point.y <= box.top + box.height;
+}
+
+static BOOL GINILayoutBoxIntersectsRect(GINILayoutBox box, CGRect rect) {
+    return box.left <= CGRectGetMaxX(rect) && box.left + box.width >= CGRectGetMinX(rect) &&
+           box.top <= CGRectGetMaxY(rect) && box.top + box.height >= CGRectGetMinY(rect);
+}
+
+static CGFloat GINILayoutBoxDistanceToPoint(GINILayoutBox box, CGPoint point) {
+    CGFloat dx = MAX(MAX(box.left - point.x, 0), point.x - (box.left + box.width));
+    CGFloat dy = MAX(MAX(box.top - point.y, 0), point.y - (box.top + box.height));
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * The pixel size of the preview images.
+ */
+static CGSize GINIPreviewImageSize(GiniApiPreviewSize previewSize) {
+    return previewSize == GiniApiPreviewSizeBig ? CGSizeMake(1280, 1810) : CGSizeMake(750, 900);
+}
+
+
+@implementation GINIIndexedLayoutPage {
+    /// The texts of the words, each distinct text once.
+    NSArray<NSString *> *_texts;
+
+    // The arrays are kept as NSData, the pointers point into their bytes.
+    NSData *_wordBoxData;
+    NSData *_wordTextData;
+    NSData *_wordLineData;
+    NSData *_lineBoxData;
+    NSData *_lineFirstWordData;
+    const GINILayoutBox *_wordBoxes;
+    /// The index of the text of each word in `_texts`.
+    const uint32_t *_wordTexts;
+    const uint32_t *_wordLines;
+    const GINILayoutBox *_lineBoxes;
+    /// The index of the first word of each line, followed by the number of words.
+    const uint32_t *_lineFirstWords;
+
+    // The grid: the words of cell i are `_cellWords[_cellStarts[i]]` to `_cellWords[_cellStarts[i + 1] - 1]`.
+    NSUInteger _columns;
+    NSUInteger _rows;
+    CGFloat _cellWidth;
+    CGFloat _cellHeight;
+    NSData *_cellStartData;
+    NSData *_cellWordData;
+    const uint32_t *_cellStarts;
+    const uint32_t *_cellWords;
+}
+
+#pragma mark - Factory
++ (instancetype)indexedLayoutPageWithLayoutPage:(GINILayoutPage *)page {
+    NSParameterAssert([page isKindOfClass:[GINILayoutPage class]]);
+
+    return [[self alloc] initWithDictionary:page.dictionary];
+}
+
++ (NSArray<GINIIndexedLayoutPage *> *)indexedLayoutPagesWithLayout:(NSDictionary *)layout {
+    NSParameterAssert([layout isKindOfClass:[NSDictionary class]]);
+
+    NSMutableArray *pages = [NSMutableArray new];
+    for (NSDictionary *page in layout[@"pages"]) {
+        if ([page isKindOfClass:[NSDictionary class]]) {
+            [pages addObject:[[self alloc] initWithDictionary:page]];
+        }
+    }
+    return pages;
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    self = [super init];
+    if (self) {
+        _number = [dictionary[@"number"] unsignedIntegerValue];
+        _size = CGSizeMake([dictionary[@"sizeX"] doubleValue], [dictionary[@"sizeY"] doubleValue]);
+
+        NSMutableData *wordBoxes = [NSMutableData new];
+        NSMutableData *wordTexts = [NSMutableData new];
+        NSMutableData *wordLines = [NSMutableData new];
+        NSMutableData *lineBoxes = [NSMutableData new];
+        NSMutableData *lineFirstWords = [NSMutableData new];
+        NSMutableArray *texts = [NSMutableArray new];
+        NSMutableDictionary<NSString *, NSNumber *> *textIndexes = [NSMutableDictionary new];
+        uint32_t wordCount = 0;
+        uint32_t lineCount = 0;
+
+        for (NSDictionary *textZone in dictionary[@"textZones"]) {
+            for (NSDictionary *paragraph in textZone[@"paragraphs"]) {
+                for (NSDictionary *line in paragraph[@"lines"]) {
+                    GINILayoutBox lineBox = GINILayoutBoxWithDictionary(line);
+                    [lineBoxes appendBytes:&lineBox length:sizeof(lineBox)];
+                    [lineFirstWords appendBytes:&wordCount length:sizeof(wordCount)];
+                    for (NSDictionary *word in line[@"wds"]) {
+                        NSString *text = [word[@"text"] isKindOfClass:[NSString class]] ? word[@"text"] : @"";
+                        NSNumber *textIndex = textIndexes[text];
+                        if (!textIndex) {
+                            textIndex = @([texts count]);
+                            textIndexes[text] = textIndex;
+                            [texts addObject:text];
+                        }
+                        GINILayoutBox wordBox = GINILayoutBoxWithDictionary(word);
+                        uint32_t textIndexValue = [textIndex unsignedIntValue];
+                        [wordBoxes appendBytes:&wordBox length:sizeof(wordBox)];
+                        [wordTexts appendBytes:&textIndexValue length:sizeof(textIndexValue)];
+                        [wordLines appendBytes:&lineCount length:sizeof(lineCount)];
+                        wordCount++;
+                    }
+                    lineCount++;
+                }
+            }
+        }
+        [lineFirstWords appendBytes:&wordCount length:sizeof(wordCount)];
+
+        _texts = texts;
+        _wordCount = wordCount;
+        _lineCount = lineCount;
+        _wordBoxData = wordBoxes;
+        _wordTextData = wordTexts;
+        _wordLineData = wordLines;
+        _lineBoxData = lineBoxes;
+        _lineFirstWordData = lineFirstWords;
+        _wordBoxes = [wordBoxes bytes];
+        _wordTexts = [wordTexts bytes];
+        _wordLines = [wordLines bytes];
+        _lineBoxes = [lineBoxes bytes];
+        _lineFirstWords = [lineFirstWords bytes];
+        [self buildGrid];
+    }
+    return self;
+}
+
+/**
+ * Builds the grid with about two words per cell. A word is added to every cell its box overlaps.
+ */
+- (void)buildGrid {
+    NSUInteger gridSize = (NSUInteger)ceil(sqrt(_wordCount / 2.0));
+    _columns = MAX(1, MIN(gridSize, GINIIndexedLayoutPageMaximumGridSize));
+    _rows = _columns;
+    _cellWidth = _size.width > 0 ? _size.width / _columns : 1;
+    _cellHeight = _size.height > 0 ? _size.height / _rows : 1;
+
+    NSUInteger cellCount = _columns * _rows;
+    NSMutableData *cellStarts = [NSMutableData dataWithLength:(cellCount + 1) * sizeof(uint32_t)];
+    uint32_t *starts = [cellStarts mutableBytes];
+    // Count the words of each cell, then place them (a counting sort by cell).
+    for (NSUInteger word = 0; word < _wordCount; word++) {
+        [self enumerateCellsInRect:GINILayoutBoxRect(_wordBoxes[word]) usingBlock:^(NSUInteger cell) {
+            starts[cell + 1]++;
+        }];
+    }
+    for (NSUInteger cell = 0; cell < cellCount; cell++) {
+        starts[cell + 1] += starts[cell];
+    }
+    NSMutableData *cellWords = [NSMutableData dataWithLength:starts[cellCount] * sizeof(uint32_t)];
+    uint32_t *words = [cellWords mutableBytes];
+    NSMutableData *cellFill = [NSMutableData dataWithLength:cellCount * sizeof(uint32_t)];
+    uint32_t *fill = [cellFill mutableBytes];
+    for (uint32_t word = 0; word < _wordCount; word++) {
+        [self enumerateCellsInRect:GINILayoutBoxRect(_wordBoxes[word]) usingBlock:^(NSUInteger cell) {
+            words[starts[cell] + fill[cell]] = word;
+            fill[cell]++;
+        }];
+    }
+
+    _cellStartData = cellStarts;
+    _cellWordData = cellWords;
+    _cellStarts = starts;
+    _cellWords = words;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINIIndexedLayoutPage %lu words=%lu lines=%lu>", (unsigned long)_number,
+            (unsigned long)_wordCount, (unsigned long)_lineCount];
+}
+
+#pragma mark - Words and lines
+- (NSString *)textOfWordAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _wordCount);
+    return _texts[_wordTexts[index]];
+}
+
+- (CGRect)rectOfWordAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _wordCount);
+    return GINILayoutBoxRect(_wordBoxes[index]);
+}
+
+- (NSUInteger)lineIndexOfWordAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _wordCount);
+    return _wordLines[index];
+}
+
+- (CGRect)rectOfLineAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _lineCount);
+    return GINILayoutBoxRect(_lineBoxes[index]);
+}
+
+- (NSRange)wordRangeOfLineAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _lineCount);
+    return NSMakeRange(_lineFirstWords[index], _lineFirstWords[index + 1] - _lineFirstWords[index]);
+}
+
+#pragma mark - Queries
+- (NSUInteger)wordIndexAtPoint:(CGPoint)point {
+    __block NSUInteger result = NSNotFound;
+    __block CGFloat resultArea = CGFLOAT_MAX;
+    [self enumerateCellsInRect:CGRectMake(point.x, point.y, 0, 0) usingBlock:^(NSUInteger cell) {
+        for (uint32_t i = self->_cellStarts[cell]; i < self->_cellStarts[cell + 1]; i++) {
+            uint32_t word = self->_cellWords[i];
+            GINILayoutBox box = self->_wordBoxes[word];
+            CGFloat area = (CGFloat)box.width * box.height;
+            if (GINILayoutBoxContainsPoint(box, point) && (area < resultArea || (area == resultArea && word < result))) {
+                result = word;
+                resultArea = area;
+            }
+        }
+    }];
+    return result;
+}
+
+- (NSIndexSet *)wordIndexesInRect:(CGRect)rect {
+    rect = CGRectStandardize(rect);
+    NSMutableIndexSet *indexes = [NSMutableIndexSet new];
+    [self enumerateCellsInRect:rect usingBlock:^(NSUInteger cell) {
+        for (uint32_t i = self->_cellStarts[cell]; i < self->_cellStarts[cell + 1]; i++) {
+            uint32_t word = self->_cellWords[i];
+            if (GINILayoutBoxIntersectsRect(self->_wordBoxes[word], rect)) {
+                [indexes addIndex:word];
+            }
+        }
+    }];
+    return indexes;
+}
+
+- (NSUInteger)nearestWordIndexToPoint:(CGPoint)point maximumDistance:(CGFloat)maximumDistance {
+    if (_wordCount == 0) {
+        return NSNotFound;
+    }
+    NSInteger column = [self columnOfX:point.x];
+    NSInteger row = [self rowOfY:point.y];
+    NSUInteger result = NSNotFound;
+    CGFloat resultDistance = maximumDistance;
+    // Search the cells in rings around the cell of the point. The words in ring r + 1 are at least r cells away, so
+    // the search stops as soon as the best word found so far is closer than that.
+    NSInteger maximumRing = MAX(_columns, _rows);
+    for (NSInteger ring = 0; ring <= maximumRing; ring++) {
+        CGFloat ringDistance = MAX(ring - 1, 0) * MIN(_cellWidth, _cellHeight);
+        if (ringDistance > resultDistance) {
+            break;
+        }
+        for (NSInteger y = row - ring; y <= row + ring; y++) {
+            for (NSInteger x = column - ring; x <= column + ring; x++) {
+                BOOL onRing = y == row - ring || y == row + ring || x == column - ring || x == column + ring;
+                if (!onRing || x < 0 || y < 0 || x >= (NSInteger)_columns || y >= (NSInteger)_rows) {
+                    continue;
+                }
+                NSUInteger cell = (NSUInteger)y * _columns + (NSUInteger)x;
+                for (uint32_t i = _cellStarts[cell]; i < _cellStarts[cell + 1]; i++) {
+                    uint32_t word = _cellWords[i];
+                    CGFloat distance = GINILayoutBoxDistanceToPoint(_wordBoxes[word], point);
+                    if (distance < resultDistance || (distance == resultDistance && word < result)) {
+                        result = word;
+                        resultDistance = distance;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+- (NSString *)textInRect:(CGRect)rect {
+    NSMutableString *text = [NSMutableString new];
+    __block NSUInteger previousLine = NSNotFound;
+    [[self wordIndexesInRect:rect] enumerateIndexesUsingBlock:^(NSUInteger word, BOOL *stop) {
+        NSUInteger line = self->_wordLines[word];
+        if (previousLine != NSNotFound) {
+            [text appendString:line == previousLine ? @" " : @"\n"];
+        }
+        [text appendString:self->_texts[self->_wordTexts[word]]];
+        previousLine = line;
+    }];
+    return text;
+}
+
+- (GINIExtraction *)extractionAtPoint:(CGPoint)point inExtractions:(NSDictionary<NSString *, GINIExtraction *> *)extractions {
+    GINIExtraction *result;
+    CGFloat resultArea = CGFLOAT_MAX;
+    for (NSString *name in [[extractions allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        NSDictionary *box = extractions[name].box;
+        if (![box isKindOfClass:[NSDictionary class]] || [box[@"page"] unsignedIntegerValue] != _number) {
+            continue;
+        }
+        CGRect rect = CGRectMake([box[@"left"] doubleValue], [box[@"top"] doubleValue], [box[@"width"] doubleValue], [box[@"height"] doubleValue]);
+        CGFloat area = rect.size.width * rect.size.height;
+        if (CGRectContainsPoint(rect, point) && area < resultArea) {
+            result = extractions[name];
+            resultArea = area;
+        }
+    }
+    return result;
+}
+
+#pragma mark - Coordinate spaces
+- (CGFloat)scaleForPreviewSize:(GiniApiPreviewSize)previewSize {
+    if (_size.width <= 0 || _size.height <= 0) {
+        return 1;
+    }
+    CGSize imageSize = GINIPreviewImageSize(previewSize);
+    return MIN(imageSize.width / _size.width, imageSize.height / _size.height);
+}
+
+- (CGRect)convertRect:(CGRect)rect toPreviewSize:(GiniApiPreviewSize)previewSize {
+    CGFloat scale = [self scaleForPreviewSize:previewSize];
+    return CGRectApplyAffineTransform(rect, CGAffineTransformMakeScale(scale, scale));
+}
+
+- (CGRect)convertRect:(CGRect)rect fromPreviewSize:(GiniApiPreviewSize)previewSize {
+    CGFloat scale = [self scaleForPreviewSize:previewSize];
+    return CGRectApplyAffineTransform(rect, CGAffineTransformMakeScale(1 / scale, 1 / scale));
+}
+
+- (CGPoint)convertPoint:(CGPoint)point toPreviewSize:(GiniApiPreviewSize)previewSize {
+    CGFloat scale = [self scaleForPreviewSize:previewSize];
+    return CGPointMake(point.x * scale, point.y * scale);
+}
+
+- (CGPoint)convertPoint:(CGPoint)point fromPreviewSize:(GiniApiPreviewSize)previewSize {
+    CGFloat scale = [self scaleForPreviewSize:previewSize];
+    return CGPointMake(point.x / scale, point.y / scale);
+}
+
+#pragma mark - Private methods
+
+- (NSInteger)columnOfX:(CGFloat)x {
+    return MIN(MAX((NSInteger)floor(x / _cellWidth), 0), (NSInteger)_columns - 1);
+}
+
+- (NSInteger)rowOfY:(CGFloat)y {
+    return MIN(MAX((NSInteger)floor(y / _cellHeight), 0), (NSInteger)_rows - 1);
+}
+
+/**
+ * Calls the block with each cell overlapping the rectangle. Parts of the rectangle outside the page belong to the
+ * cells at the border of the page.
+ */
+- (void)enumerateCellsInRect:(CGRect)rect usingBlock:(void (^)(NSUInteger cell))block {
+    NSInteger minColumn = [self columnOfX:CGRectGetMinX(rect)];
+    NSInteger maxColumn = [self columnOfX:CGRectGetMaxX(rect)];
+    NSInteger minRow = [self rowOfY:CGRectGetMinY(rect)];
+    NSInteger maxRow = [self rowOfY:CGRectGetMaxY(rect)];
+    for (NSInteger row = minRow; row <= maxRow; row++) {
+        for (NSInteger column = minColumn; column <= maxColumn; column++) {
+            block((NSUInteger)row * _columns + (NSUInteger)column);
+        }
+    }
+}
+
+@end
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ * The minimum size of a JSON response body in bytes which is decoded with the `GINIJSONDecoder` instead of
+ * `NSJSONSerialization`. For smaller bodies the setup costs of both decoders dominate and there is nothing to gain.
+ */
+extern NSUInteger const GINIJSONDecoderMinimumLength;
+
+
+/**
+ * The kinds of JSON values described by a `GINIJSONSchema`.
+ */
+typedef NS_ENUM(NSUInteger, GINIJSONSchemaType) {
+    /// Any value, decoded into Foundation objects.
+    GINIJSONSchemaTypeAny,
+    /// A string.
+    GINIJSONSchemaTypeString,
+    /// A string from a small set of values, like a state or an entity. Symbols are interned.
+    GINIJSONSchemaTypeSymbol,
+    /// A number.
+    GINIJSONSchemaTypeNumber,
+    /// An object with known keys, built into an arbitrary object.
+    GINIJSONSchemaTypeObject,
+    /// An array, decoded into an `NSArray`.
+    GINIJSONSchemaTypeArray,
+    /// An object with arbitrary keys and values of the same kind, decoded into an `NSDictionary`.
+    GINIJSONSchemaTypeMap
+};
+
+/**
+ * Builds the result of an object schema.
+ *
+ * @param fields    The decoded values of the fields, in the order of the keys of the schema. Missing values, null and
+ *                  values which do not match the schema of the field are nil.
+ * @param mapKey    The key of the innermost entry of a map schema containing the object, e.g. the name of an extraction.
+ *
+ * @returns         The result or nil, to leave the object out of the containing array or map.
+ */
+typedef id (^GINIJSONObjectBuildBlock)(const __unsafe_unretained id *fields, NSString *mapKey);
+
+
+/**
+ * A `GINIJSONSchema` describes the expected structure of a JSON document, so the `GINIJSONDecoder` can create the
+ * resulting objects (e.g. models) directly while decoding, without creating dictionaries for the objects of the document
+ * first. Keys of objects which are not part of the schema are skipped without creating any objects.
+ *
+ * Schemas are immutable and can be shared between threads, so they are usually created once.
+ */
+@interface GINIJSONSchema : NSObject
+
+/// Any value, see `GINIJSONSchemaTypeAny`.
++ (instancetype)anySchema;
+
+/// A string, see `GINIJSONSchemaTypeString`.
++ (instancetype)stringSchema;
+
+/// An interned string, see `GINIJSONSchemaTypeSymbol`.
++ (instancetype)symbolSchema;
+
+/// A number, see `GINIJSONSchemaTypeNumber`.
++ (instancetype)numberSchema;
+
+/**
+ * An array. Elements which do not match the schema or whose object schema returns nil are left out.
+ *
+ * @param elements  The schema of the elements.
+ */
++ (instancetype)arraySchemaWithElements:(GINIJSONSchema *)elements;
+
+/**
+ * An object with arbitrary keys. Entries whose values do not match the schema or whose object schema returns nil are
+ * left out.
+ *
+ * @param values    The schema of the values.
+ */
++ (instancetype)mapSchemaWithValues:(GINIJSONSchema *)values;
+
+/**
+ * An object with known keys.
+ *
+ * @param keys      The keys of the fields, at most 16.
+ * @param schemas   The schemas of the fields, in the order of the keys.
+ * @param build     Builds the result from the decoded fields.
+ */
++ (instancetype)objectSchemaWithKeys:(NSArray<NSString *> *)keys schemas:(NSArray<GINIJSONSchema *> *)schemas build:(GINIJSONObjectBuildBlock)build;
+
+/// The kind of values described by the schema.
+@property (readonly) GINIJSONSchemaType type;
+
+@end
+
+
+/**
+ * The `GINIJSONDecoder` is a fast decoder for large UTF-8 JSON documents, like long lists of documents, extractions
+ * with many candidates or layouts.
+ *
+ * It decodes the document in a single pass and creates the Foundation objects directly from the bytes of the data:
+ * - The contents of strings are scanned 16 bytes at a time with SIMD instructions (NEON on arm64, SSE2 on the
+ *   simulator, 8 bytes at a time in a general purpose register everywhere else) for the quote, the backslash and
+ *   control characters, so strings without escapes are copied only once, into the `NSString`.
+ * - Keys of objects are interned, so the same key is created only once per document no matter how often it occurs.
+ * - Integers are decoded without creating intermediate strings.
+ * - Arrays and dictionaries are created immutable and with their final size.
+ *
+ * The result is the same as the result of `+[NSJSONSerialization JSONObjectWithData:options:error:]` with the option
+ * `NSJSONReadingAllowFragments`. Documents in other encodings than UTF-8 are passed to `NSJSONSerialization`.
+ */
+@interface GINIJSONDecoder : NSObject
+
+/**
+ * Decodes a JSON document.
+ *
+ * @param data      The JSON document.
+ * @param error     Set to an error in the `NSCocoaErrorDomain` if the document is not valid JSON.
+ *
+ * @returns         The decoded object, or nil if the document is not valid JSON.
+ */
++ (id)JSONObjectWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Decodes a UTF-8 JSON document with a schema.
+ *
+ * @param data      The JSON document.
+ * @param schema    The schema of the document.
+ * @param error     Set to an error in the `NSCocoaErrorDomain` if the document is not valid JSON or does not match the
+ *                  schema.
+ *
+ * @returns         The result of the schema, or nil if the document is not valid JSON or does not match the schema.
+ */
++ (id)objectWithData:(NSData *)data schema:(GINIJSONSchema *)schema error:(NSError **)error;
+
+@end
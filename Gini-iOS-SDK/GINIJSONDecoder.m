@@ -0,0 +1,1000 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <xlocale.h>
+#import "GINIJSONDecoder.h"
+
+#if defined(__aarch64__)
+#import <arm_neon.h>
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#endif
+
+
+NSUInteger const GINIJSONDecoderMinimumLength = 32 * 1024;
+
+/// Deeper nested documents are rejected, so the decoder cannot run out of stack.
+static const NSUInteger GINIJSONMaximumDepth = 512;
+
+/// The number of slots of the string cache, a power of two.
+static const NSUInteger GINIJSONStringCacheSize = 256;
+
+/// The number of keys and values of objects which are collected on the stack instead of the heap.
+#define GINI_JSON_STACK_BUFFER_SIZE 32
+
+/// Longer strings are not interned.
+#define GINI_JSON_MAXIMUM_INTERNED_LENGTH 32
+
+/// The maximum number of fields of an object schema.
+#define GINI_JSON_MAXIMUM_FIELD_COUNT 16
+
+/// The maximum number of digits of an integer which is decoded without `strtod`, so it fits into a `long long`.
+static const NSUInteger GINIJSONMaximumIntegerDigits = 18;
+
+
+typedef struct {
+    uint32_t hash;
+    uint32_t length;
+    char bytes[GINI_JSON_MAXIMUM_INTERNED_LENGTH];
+    CFStringRef string;
+} GINIJSONStringCacheEntry;
+
+typedef struct {
+    const uint8_t *start;
+    const uint8_t *end;
+    const uint8_t *position;
+    NSUInteger depth;
+    /// The keys and values of the containers which are being decoded, so each container is created at once.
+    __unsafe_unretained NSMutableArray *values;
+    /// The buffer for the contents of strings with escapes.
+    uint8_t *scratch;
+    size_t scratchCapacity;
+    /// The interned keys and symbols.
+    GINIJSONStringCacheEntry *strings;
+    /// The key of the innermost entry of a map schema which is being decoded.
+    __unsafe_unretained NSString *mapKey;
+    const char *errorReason;
+    NSUInteger errorOffset;
+} GINIJSONContext;
+
+
+static id GINIJSONDecodeValue(GINIJSONContext *context);
+
+static void GINIJSONFail(GINIJSONContext *context, const uint8_t *position, const char *reason) {
+    if (!context->errorReason) {
+        context->errorReason = reason;
+        context->errorOffset = (NSUInteger)(position - context->start);
+    }
+}
+
+static inline void GINIJSONSkipWhitespace(GINIJSONContext *context) {
+    const uint8_t *position = context->position;
+    while (position < context->end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t')) {
+        position++;
+    }
+    context->position = position;
+}
+
+#pragma mark - Strings
+
+/**
+ * Returns the position of the first quote, backslash or control character, or the end.
+ */
+static inline const uint8_t *GINIJSONFindStringSpecial(const uint8_t *position, const uint8_t *end) {
+#if defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    while (end - position >= 16) {
+        uint8x16_t chunk = vld1q_u8(position);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)), vcltq_u8(chunk, space));
+        if (vmaxvq_u8(special)) {
+            break;
+        }
+        position += 16;
+    }
+#elif defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (end - position >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)position);
+        // The unsigned minimum of a byte and 0x1F is the byte itself for the control characters.
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) {
+            return position + __builtin_ctz(mask);
+        }
+        position += 16;
+    }
+#else
+    // Tests 8 bytes at once, see "Determine if a word has a zero byte" in Sean Eron Anderson's "Bit Twiddling Hacks".
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    while (end - position >= 8) {
+        uint64_t word;
+        memcpy(&word, position, sizeof(word));
+        uint64_t quotes = word ^ (ones * '"');
+        uint64_t backslashes = word ^ (ones * '\\');
+        uint64_t special = ((quotes - ones) & ~quotes) | ((backslashes - ones) & ~backslashes) | ((word - ones * 0x20) & ~word);
+        if (special & highs) {
+            break;
+        }
+        position += 8;
+    }
+#endif
+    while (position < end && *position != '"' && *position != '\\' && *position >= 0x20) {
+        position++;
+    }
+    return position;
+}
+
+static BOOL GINIJSONAppendScratch(GINIJSONContext *context, size_t *length, const uint8_t *bytes, size_t count) {
+    if (*length + count > context->scratchCapacity) {
+        size_t capacity = MAX(context->scratchCapacity * 2, *length + count + 64);
+        uint8_t *scratch = realloc(context->scratch, capacity);
+        if (!scratch) {
+            return NO;
+        }
+        context->scratch = scratch;
+        context->scratchCapacity = capacity;
+    }
+    memcpy(context->scratch + *length, bytes, count);
+    *length += count;
+    return YES;
+}
+
+/**
+ * Decodes the four hexadecimal digits of a \u escape, returns -1 for invalid digits.
+ */
+static int32_t GINIJSONDecodeHex(const uint8_t *digits) {
+    int32_t value = 0;
+    for (NSUInteger i = 0; i < 4; i++) {
+        uint8_t digit = digits[i];
+        value <<= 4;
+        if (digit >= '0' && digit <= '9') {
+            value |= digit - '0';
+        } else if (digit >= 'a' && digit <= 'f') {
+            value |= digit - 'a' + 10;
+        } else if (digit >= 'A' && digit <= 'F') {
+            value |= digit - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return value;
+}
+
+/**
+ * Decodes the contents of a string with escapes into the scratch buffer. The position points to the first backslash,
+ * returns the position of the closing quote or NULL.
+ */
+static const uint8_t *GINIJSONUnescapeString(GINIJSONContext *context, const uint8_t *start, const uint8_t *position, size_t *length) {
+    const uint8_t *end = context->end;
+    *length = 0;
+    if (!GINIJSONAppendScratch(context, length, start, position - start)) {
+        return NULL;
+    }
+    while (YES) {
+        if (position >= end) {
+            GINIJSONFail(context, position, "Unterminated string");
+            return NULL;
+        }
+        if (*position == '"') {
+            return position;
+        }
+        if (*position < 0x20) {
+            GINIJSONFail(context, position, "Unescaped control character");
+            return NULL;
+        }
+
+        // A backslash.
+        const uint8_t *escape = position;
+        if (end - position < 2) {
+            GINIJSONFail(context, escape, "Unterminated string");
+            return NULL;
+        }
+        uint8_t character;
+        switch (position[1]) {
+            case '"': character = '"'; break;
+            case '\\': character = '\\'; break;
+            case '/': character = '/'; break;
+            case 'b': character = '\b'; break;
+            case 'f': character = '\f'; break;
+            case 'n': character = '\n'; break;
+            case 'r': character = '\r'; break;
+            case 't': character = '\t'; break;
+            case 'u': character = 0; break;
+            default:
+                GINIJSONFail(context, escape, "Invalid escape sequence");
+                return NULL;
+        }
+        if (character) {
+            if (!GINIJSONAppendScratch(context, length, &character, 1)) {
+                return NULL;
+            }
+            position += 2;
+        } else {
+            int32_t codePoint = end - position >= 6 ? GINIJSONDecodeHex(position + 2) : -1;
+            position += 6;
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                // A high surrogate must be followed by an escaped low surrogate.
+                int32_t lowSurrogate = (end - position >= 6 && position[0] == '\\' && position[1] == 'u') ? GINIJSONDecodeHex(position + 2) : -1;
+                if (lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF) {
+                    GINIJSONFail(context, escape, "Invalid surrogate pair");
+                    return NULL;
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                position += 6;
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                GINIJSONFail(context, escape, "Invalid surrogate pair");
+                return NULL;
+            }
+            if (codePoint < 0) {
+                GINIJSONFail(context, escape, "Invalid unicode escape sequence");
+                return NULL;
+            }
+
+            uint8_t utf8[4];
+            size_t utf8Length;
+            if (codePoint < 0x80) {
+                utf8[0] = (uint8_t)codePoint;
+                utf8Length = 1;
+            } else if (codePoint < 0x800) {
+                utf8[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+                utf8[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+                utf8Length = 2;
+            } else if (codePoint < 0x10000) {
+                utf8[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+                utf8[1] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+                utf8[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+                utf8Length = 3;
+            } else {
+                utf8[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+                utf8[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+                utf8[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+                utf8[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+                utf8Length = 4;
+            }
+            if (!GINIJSONAppendScratch(context, length, utf8, utf8Length)) {
+                return NULL;
+            }
+        }
+
+        const uint8_t *run = position;
+        position = GINIJSONFindStringSpecial(position, end);
+        if (!GINIJSONAppendScratch(context, length, run, position - run)) {
+            return NULL;
+        }
+    }
+}
+
+static NSString *GINIJSONCreateString(GINIJSONContext *context, const uint8_t *bytes, size_t length, const uint8_t *position) {
+    CFStringRef string = CFStringCreateWithBytes(kCFAllocatorDefault, bytes, (CFIndex)length, kCFStringEncodingUTF8, false);
+    if (!string) {
+        GINIJSONFail(context, position, "Invalid UTF-8 in string");
+        return nil;
+    }
+    return CFBridgingRelease(string);
+}
+
+/**
+ * Looks up a string in the string cache, creates and caches it if it is not found.
+ */
+static NSString *GINIJSONInternString(GINIJSONContext *context, const uint8_t *bytes, size_t length, const uint8_t *position) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    GINIJSONStringCacheEntry *entry = &context->strings[hash & (GINIJSONStringCacheSize - 1)];
+    if (entry->string && entry->hash == hash && entry->length == length && memcmp(entry->bytes, bytes, length) == 0) {
+        return (__bridge NSString *)entry->string;
+    }
+
+    NSString *string = GINIJSONCreateString(context, bytes, length, position);
+    if (string) {
+        if (entry->string) {
+            CFRelease(entry->string);
+        }
+        entry->string = (CFStringRef)CFBridgingRetain(string);
+        entry->hash = hash;
+        entry->length = (uint32_t)length;
+        memcpy(entry->bytes, bytes, length);
+    }
+    return string;
+}
+
+/**
+ * Scans the string at the current position. The contents are either the bytes of the data or, for strings with escapes,
+ * the scratch buffer, which is overwritten by the next string.
+ */
+static BOOL GINIJSONScanString(GINIJSONContext *context, const uint8_t **bytes, size_t *length) {
+    const uint8_t *start = context->position + 1;
+    const uint8_t *position = GINIJSONFindStringSpecial(start, context->end);
+
+    if (position < context->end && *position == '"') {
+        context->position = position + 1;
+        *bytes = start;
+        *length = position - start;
+        return YES;
+    }
+    if (position >= context->end) {
+        GINIJSONFail(context, context->position, "Unterminated string");
+        return NO;
+    }
+    if (*position != '\\') {
+        GINIJSONFail(context, position, "Unescaped control character");
+        return NO;
+    }
+
+    position = GINIJSONUnescapeString(context, start, position, length);
+    if (!position) {
+        GINIJSONFail(context, start, "Out of memory");
+        return NO;
+    }
+    context->position = position + 1;
+    *bytes = context->scratch;
+    return YES;
+}
+
+/**
+ * Decodes the string at the current position. Keys and symbols are interned.
+ */
+static NSString *GINIJSONDecodeString(GINIJSONContext *context, BOOL intern) {
+    const uint8_t *start = context->position;
+    const uint8_t *bytes;
+    size_t length;
+    if (!GINIJSONScanString(context, &bytes, &length)) {
+        return nil;
+    }
+    if (intern && length <= GINI_JSON_MAXIMUM_INTERNED_LENGTH) {
+        return GINIJSONInternString(context, bytes, length, start);
+    }
+    return GINIJSONCreateString(context, bytes, length, start);
+}
+
+#pragma mark - Numbers and literals
+
+/**
+ * Scans the number at the current position. The integer digits are those without sign, fraction and exponent.
+ */
+static BOOL GINIJSONScanNumber(GINIJSONContext *context, BOOL *integer, const uint8_t **digits, BOOL *negative) {
+    const uint8_t *start = context->position;
+    const uint8_t *end = context->end;
+    const uint8_t *position = start;
+    *negative = NO;
+    *integer = YES;
+
+    if (*position == '-') {
+        *negative = YES;
+        position++;
+    }
+    *digits = position;
+    if (position < end && *position == '0') {
+        position++;
+    } else if (position < end && *position >= '1' && *position <= '9') {
+        while (position < end && *position >= '0' && *position <= '9') {
+            position++;
+        }
+    } else {
+        GINIJSONFail(context, start, "Invalid number");
+        return NO;
+    }
+    if (position < end && *position == '.') {
+        *integer = NO;
+        position++;
+        const uint8_t *fraction = position;
+        while (position < end && *position >= '0' && *position <= '9') {
+            position++;
+        }
+        if (position == fraction) {
+            GINIJSONFail(context, start, "Invalid number");
+            return NO;
+        }
+    }
+    if (position < end && (*position == 'e' || *position == 'E')) {
+        *integer = NO;
+        position++;
+        if (position < end && (*position == '+' || *position == '-')) {
+            position++;
+        }
+        const uint8_t *exponent = position;
+        while (position < end && *position >= '0' && *position <= '9') {
+            position++;
+        }
+        if (position == exponent) {
+            GINIJSONFail(context, start, "Invalid number");
+            return NO;
+        }
+    }
+    context->position = position;
+    return YES;
+}
+
+static NSNumber *GINIJSONDecodeNumber(GINIJSONContext *context) {
+    const uint8_t *start = context->position;
+    BOOL integer;
+    const uint8_t *digits;
+    BOOL negative;
+    if (!GINIJSONScanNumber(context, &integer, &digits, &negative)) {
+        return nil;
+    }
+    const uint8_t *position = context->position;
+
+    if (integer && (NSUInteger)(position - digits) <= GINIJSONMaximumIntegerDigits) {
+        long long value = 0;
+        for (const uint8_t *digit = digits; digit < position; digit++) {
+            value = value * 10 + (*digit - '0');
+        }
+        return @(negative ? -value : value);
+    }
+
+    // strtod needs a terminated string, and the decimal point of the C locale.
+    size_t length = position - start;
+    char buffer[64];
+    char *string = length < sizeof(buffer) ? buffer : malloc(length + 1);
+    if (!string) {
+        GINIJSONFail(context, start, "Out of memory");
+        return nil;
+    }
+    memcpy(string, start, length);
+    string[length] = '\0';
+    double value = strtod_l(string, NULL, NULL);
+    if (string != buffer) {
+        free(string);
+    }
+    return @(value);
+}
+
+static id GINIJSONDecodeLiteral(GINIJSONContext *context, const char *literal, size_t length, id value) {
+    if ((size_t)(context->end - context->position) < length || memcmp(context->position, literal, length) != 0) {
+        GINIJSONFail(context, context->position, "Invalid value");
+        return nil;
+    }
+    context->position += length;
+    return value;
+}
+
+#pragma mark - Containers
+
+/**
+ * Enters the array or object at the current position. Returns NO for an error. Sets `empty` and consumes the closing
+ * bracket if the container is empty.
+ */
+static BOOL GINIJSONBeginContainer(GINIJSONContext *context, uint8_t closing, BOOL *empty) {
+    if (++context->depth > GINIJSONMaximumDepth) {
+        GINIJSONFail(context, context->position, "Too deeply nested");
+        return NO;
+    }
+    context->position++;
+    GINIJSONSkipWhitespace(context);
+    *empty = context->position < context->end && *context->position == closing;
+    if (*empty) {
+        context->position++;
+        context->depth--;
+    }
+    return YES;
+}
+
+/**
+ * Consumes the separator after an element of an array or object. Returns NO for an error. Sets `last` and leaves the
+ * container if the closing bracket follows.
+ */
+static BOOL GINIJSONNextElement(GINIJSONContext *context, uint8_t closing, BOOL *last) {
+    GINIJSONSkipWhitespace(context);
+    if (context->position < context->end && *context->position == ',') {
+        context->position++;
+        GINIJSONSkipWhitespace(context);
+        *last = NO;
+        return YES;
+    }
+    if (context->position < context->end && *context->position == closing) {
+        context->position++;
+        context->depth--;
+        *last = YES;
+        return YES;
+    }
+    GINIJSONFail(context, context->position, closing == ']' ? "Expected ',' or ']' in array" : "Expected ',' or '}' in object");
+    return NO;
+}
+
+/**
+ * Consumes the colon after the key of an object.
+ */
+static BOOL GINIJSONSkipColon(GINIJSONContext *context) {
+    GINIJSONSkipWhitespace(context);
+    if (context->position >= context->end || *context->position != ':') {
+        GINIJSONFail(context, context->position, "Expected ':' after key in object");
+        return NO;
+    }
+    context->position++;
+    GINIJSONSkipWhitespace(context);
+    return YES;
+}
+
+static BOOL GINIJSONExpectKey(GINIJSONContext *context) {
+    if (context->position >= context->end || *context->position != '"') {
+        GINIJSONFail(context, context->position, "Expected a string key in object");
+        return NO;
+    }
+    return YES;
+}
+
+/**
+ * Creates an array of the values on the stack from the given index and removes them from the stack.
+ */
+static NSArray *GINIJSONArrayFromStack(GINIJSONContext *context, NSUInteger base) {
+    NSMutableArray *values = context->values;
+    NSRange range = NSMakeRange(base, [values count] - base);
+    NSArray *array = [values subarrayWithRange:range];
+    [values removeObjectsInRange:range];
+    return array;
+}
+
+/**
+ * Creates a dictionary of the keys and values on the stack from the given index and removes them from the stack.
+ */
+static NSDictionary *GINIJSONDictionaryFromStack(GINIJSONContext *context, NSUInteger base) {
+    // The keys and values are interleaved on the stack, they are still retained by it while the dictionary is created.
+    NSMutableArray *values = context->values;
+    NSRange range = NSMakeRange(base, [values count] - base);
+    NSUInteger count = range.length / 2;
+    __unsafe_unretained id stackBuffer[GINI_JSON_STACK_BUFFER_SIZE];
+    __unsafe_unretained id *buffer = range.length * 2 <= GINI_JSON_STACK_BUFFER_SIZE ? stackBuffer : (__unsafe_unretained id *)malloc(sizeof(id) * range.length * 2);
+    if (!buffer) {
+        GINIJSONFail(context, context->position, "Out of memory");
+        return nil;
+    }
+    __unsafe_unretained id *keys = buffer + range.length;
+    __unsafe_unretained id *objects = keys + count;
+    [values getObjects:buffer range:range];
+    for (NSUInteger i = 0; i < count; i++) {
+        keys[i] = buffer[2 * i];
+        objects[i] = buffer[2 * i + 1];
+    }
+    NSDictionary *dictionary = [NSDictionary dictionaryWithObjects:objects forKeys:keys count:count];
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    [values removeObjectsInRange:range];
+    return dictionary;
+}
+
+static NSArray *GINIJSONDecodeArray(GINIJSONContext *context) {
+    BOOL done;
+    if (!GINIJSONBeginContainer(context, ']', &done)) {
+        return nil;
+    }
+    if (done) {
+        return @[];
+    }
+
+    NSUInteger base = [context->values count];
+    while (!done) {
+        id value = GINIJSONDecodeValue(context);
+        if (!value) {
+            return nil;
+        }
+        [context->values addObject:value];
+        if (!GINIJSONNextElement(context, ']', &done)) {
+            return nil;
+        }
+    }
+    return GINIJSONArrayFromStack(context, base);
+}
+
+static NSDictionary *GINIJSONDecodeObject(GINIJSONContext *context) {
+    BOOL done;
+    if (!GINIJSONBeginContainer(context, '}', &done)) {
+        return nil;
+    }
+    if (done) {
+        return @{};
+    }
+
+    NSUInteger base = [context->values count];
+    while (!done) {
+        NSString *key = GINIJSONExpectKey(context) ? GINIJSONDecodeString(context, YES) : nil;
+        if (!key || !GINIJSONSkipColon(context)) {
+            return nil;
+        }
+        id value = GINIJSONDecodeValue(context);
+        if (!value) {
+            return nil;
+        }
+        [context->values addObject:key];
+        [context->values addObject:value];
+        if (!GINIJSONNextElement(context, '}', &done)) {
+            return nil;
+        }
+    }
+    return GINIJSONDictionaryFromStack(context, base);
+}
+
+static id GINIJSONDecodeValue(GINIJSONContext *context) {
+    if (context->position >= context->end) {
+        GINIJSONFail(context, context->position, "Unexpected end of data");
+        return nil;
+    }
+    switch (*context->position) {
+        case '{':
+            return GINIJSONDecodeObject(context);
+        case '[':
+            return GINIJSONDecodeArray(context);
+        case '"':
+            return GINIJSONDecodeString(context, NO);
+        case 't':
+            return GINIJSONDecodeLiteral(context, "true", 4, @YES);
+        case 'f':
+            return GINIJSONDecodeLiteral(context, "false", 5, @NO);
+        case 'n':
+            return GINIJSONDecodeLiteral(context, "null", 4, [NSNull null]);
+        default:
+            return GINIJSONDecodeNumber(context);
+    }
+}
+
+#pragma mark - Skipping
+
+/**
+ * Skips the value at the current position without creating any objects. Only the structure is checked, e.g. escape
+ * sequences and the encoding of skipped strings are not.
+ */
+static BOOL GINIJSONSkipValue(GINIJSONContext *context) {
+    if (context->position >= context->end) {
+        GINIJSONFail(context, context->position, "Unexpected end of data");
+        return NO;
+    }
+    uint8_t character = *context->position;
+    if (character == '"') {
+        const uint8_t *position = context->position + 1;
+        while (YES) {
+            position = GINIJSONFindStringSpecial(position, context->end);
+            if (position >= context->end) {
+                GINIJSONFail(context, context->position, "Unterminated string");
+                return NO;
+            }
+            if (*position == '"') {
+                context->position = position + 1;
+                return YES;
+            }
+            if (*position != '\\' || context->end - position < 2) {
+                GINIJSONFail(context, position, "Unescaped control character");
+                return NO;
+            }
+            position += 2;
+        }
+    }
+    if (character == '[' || character == '{') {
+        uint8_t closing = character == '[' ? ']' : '}';
+        BOOL done;
+        if (!GINIJSONBeginContainer(context, closing, &done)) {
+            return NO;
+        }
+        while (!done) {
+            if (closing == '}' && !(GINIJSONExpectKey(context) && GINIJSONSkipValue(context) && GINIJSONSkipColon(context))) {
+                return NO;
+            }
+            if (!GINIJSONSkipValue(context) || !GINIJSONNextElement(context, closing, &done)) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+    if (character == 't') {
+        return GINIJSONDecodeLiteral(context, "true", 4, @YES) != nil;
+    }
+    if (character == 'f') {
+        return GINIJSONDecodeLiteral(context, "false", 5, @NO) != nil;
+    }
+    if (character == 'n') {
+        return GINIJSONDecodeLiteral(context, "null", 4, [NSNull null]) != nil;
+    }
+    BOOL integer;
+    const uint8_t *digits;
+    BOOL negative;
+    return GINIJSONScanNumber(context, &integer, &digits, &negative);
+}
+
+#pragma mark - Schemas
+
+@interface GINIJSONSchema () {
+    @public
+    GINIJSONSchemaType _type;
+    /// The schema of the elements of arrays and the values of maps.
+    GINIJSONSchema *_elements;
+    /// The fields of objects, the keys as UTF-8.
+    NSUInteger _fieldCount;
+    NSArray<NSData *> *_fieldKeys;
+    NSArray<GINIJSONSchema *> *_fieldSchemas;
+    GINIJSONObjectBuildBlock _build;
+}
+
+- (instancetype)initWithType:(GINIJSONSchemaType)type;
+
+@end
+
+
+static id GINIJSONDecodeSchemaValue(GINIJSONContext *context, __unsafe_unretained GINIJSONSchema *schema);
+
+static NSArray *GINIJSONDecodeSchemaArray(GINIJSONContext *context, __unsafe_unretained GINIJSONSchema *schema) {
+    BOOL done;
+    if (!GINIJSONBeginContainer(context, ']', &done)) {
+        return nil;
+    }
+    if (done) {
+        return @[];
+    }
+
+    NSUInteger base = [context->values count];
+    while (!done) {
+        id value = GINIJSONDecodeSchemaValue(context, schema->_elements);
+        if (context->errorReason) {
+            return nil;
+        }
+        if (value) {
+            [context->values addObject:value];
+        }
+        if (!GINIJSONNextElement(context, ']', &done)) {
+            return nil;
+        }
+    }
+    return GINIJSONArrayFromStack(context, base);
+}
+
+static NSDictionary *GINIJSONDecodeSchemaMap(GINIJSONContext *context, __unsafe_unretained GINIJSONSchema *schema) {
+    BOOL done;
+    if (!GINIJSONBeginContainer(context, '}', &done)) {
+        return nil;
+    }
+    if (done) {
+        return @{};
+    }
+
+    NSUInteger base = [context->values count];
+    __unsafe_unretained NSString *outerMapKey = context->mapKey;
+    while (!done) {
+        NSString *key = GINIJSONExpectKey(context) ? GINIJSONDecodeString(context, YES) : nil;
+        if (!key || !GINIJSONSkipColon(context)) {
+            return nil;
+        }
+        context->mapKey = key;
+        id value = GINIJSONDecodeSchemaValue(context, schema->_elements);
+        context->mapKey = outerMapKey;
+        if (context->errorReason) {
+            return nil;
+        }
+        if (value) {
+            [context->values addObject:key];
+            [context->values addObject:value];
+        }
+        if (!GINIJSONNextElement(context, '}', &done)) {
+            return nil;
+        }
+    }
+    return GINIJSONDictionaryFromStack(context, base);
+}
+
+static id GINIJSONDecodeSchemaObject(GINIJSONContext *context, __unsafe_unretained GINIJSONSchema *schema) {
+    BOOL done;
+    if (!GINIJSONBeginContainer(context, '}', &done)) {
+        return nil;
+    }
+
+    __strong id fields[GINI_JSON_MAXIMUM_FIELD_COUNT];
+    while (!done) {
+        const uint8_t *key;
+        size_t keyLength;
+        if (!GINIJSONExpectKey(context) || !GINIJSONScanString(context, &key, &keyLength) || !GINIJSONSkipColon(context)) {
+            return nil;
+        }
+        NSUInteger field = NSNotFound;
+        for (NSUInteger i = 0; i < schema->_fieldCount; i++) {
+            NSData *fieldKey = schema->_fieldKeys[i];
+            if ([fieldKey length] == keyLength && memcmp([fieldKey bytes], key, keyLength) == 0) {
+                field = i;
+                break;
+            }
+        }
+        if (field == NSNotFound) {
+            if (!GINIJSONSkipValue(context)) {
+                return nil;
+            }
+        } else {
+            fields[field] = GINIJSONDecodeSchemaValue(context, schema->_fieldSchemas[field]);
+            if (context->errorReason) {
+                return nil;
+            }
+        }
+        if (!GINIJSONNextElement(context, '}', &done)) {
+            return nil;
+        }
+    }
+    return schema->_build((const __unsafe_unretained id *)fields, context->mapKey);
+}
+
+/**
+ * Decodes the value at the current position with the given schema. Returns nil (without setting an error) for values
+ * which do not match the schema, they are skipped.
+ */
+static id GINIJSONDecodeSchemaValue(GINIJSONContext *context, __unsafe_unretained GINIJSONSchema *schema) {
+    if (context->position >= context->end) {
+        GINIJSONFail(context, context->position, "Unexpected end of data");
+        return nil;
+    }
+    uint8_t character = *context->position;
+    switch (schema->_type) {
+        case GINIJSONSchemaTypeAny:
+            return GINIJSONDecodeValue(context);
+        case GINIJSONSchemaTypeString:
+        case GINIJSONSchemaTypeSymbol:
+            if (character == '"') {
+                return GINIJSONDecodeString(context, schema->_type == GINIJSONSchemaTypeSymbol);
+            }
+            break;
+        case GINIJSONSchemaTypeNumber:
+            if (character == '-' || (character >= '0' && character <= '9')) {
+                return GINIJSONDecodeNumber(context);
+            }
+            break;
+        case GINIJSONSchemaTypeObject:
+            if (character == '{') {
+                return GINIJSONDecodeSchemaObject(context, schema);
+            }
+            break;
+        case GINIJSONSchemaTypeArray:
+            if (character == '[') {
+                return GINIJSONDecodeSchemaArray(context, schema);
+            }
+            break;
+        case GINIJSONSchemaTypeMap:
+            if (character == '{') {
+                return GINIJSONDecodeSchemaMap(context, schema);
+            }
+            break;
+    }
+    GINIJSONSkipValue(context);
+    return nil;
+}
+
+
+@implementation GINIJSONSchema
+
+#pragma mark - Factories
++ (instancetype)anySchema {
+    return [[self alloc] initWithType:GINIJSONSchemaTypeAny];
+}
+
++ (instancetype)stringSchema {
+    return [[self alloc] initWithType:GINIJSONSchemaTypeString];
+}
+
++ (instancetype)symbolSchema {
+    return [[self alloc] initWithType:GINIJSONSchemaTypeSymbol];
+}
+
++ (instancetype)numberSchema {
+    return [[self alloc] initWithType:GINIJSONSchemaTypeNumber];
+}
+
++ (instancetype)arraySchemaWithElements:(GINIJSONSchema *)elements {
+    NSParameterAssert([elements isKindOfClass:[GINIJSONSchema class]]);
+
+    GINIJSONSchema *schema = [[self alloc] initWithType:GINIJSONSchemaTypeArray];
+    schema->_elements = elements;
+    return schema;
+}
+
++ (instancetype)mapSchemaWithValues:(GINIJSONSchema *)values {
+    NSParameterAssert([values isKindOfClass:[GINIJSONSchema class]]);
+
+    GINIJSONSchema *schema = [[self alloc] initWithType:GINIJSONSchemaTypeMap];
+    schema->_elements = values;
+    return schema;
+}
+
++ (instancetype)objectSchemaWithKeys:(NSArray<NSString *> *)keys schemas:(NSArray<GINIJSONSchema *> *)schemas build:(GINIJSONObjectBuildBlock)build {
+    NSParameterAssert([keys count] == [schemas count]);
+    NSParameterAssert([keys count] <= GINI_JSON_MAXIMUM_FIELD_COUNT);
+    NSParameterAssert(build);
+
+    GINIJSONSchema *schema = [[self alloc] initWithType:GINIJSONSchemaTypeObject];
+    NSMutableArray *fieldKeys = [NSMutableArray arrayWithCapacity:[keys count]];
+    for (NSString *key in keys) {
+        [fieldKeys addObject:[key dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    schema->_fieldCount = [keys count];
+    schema->_fieldKeys = fieldKeys;
+    schema->_fieldSchemas = [schemas copy];
+    schema->_build = [build copy];
+    return schema;
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithType:(GINIJSONSchemaType)type {
+    self = [super init];
+    if (self) {
+        _type = type;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (GINIJSONSchemaType)type {
+    return _type;
+}
+
+@end
+
+
+@implementation GINIJSONDecoder
+
++ (id)JSONObjectWithData:(NSData *)data error:(NSError **)error {
+    NSParameterAssert([data isKindOfClass:[NSData class]]);
+
+    return [self objectWithData:data schema:nil error:error];
+}
+
++ (id)objectWithData:(NSData *)data schema:(GINIJSONSchema *)schema error:(NSError **)error {
+    NSParameterAssert([data isKindOfClass:[NSData class]]);
+
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    // UTF-16 and UTF-32 documents have a zero byte in the first two bytes (or start with a byte order mark).
+    if (!schema && length >= 2 && (bytes[0] == 0 || bytes[1] == 0 || (bytes[0] == 0xFE && bytes[1] == 0xFF) || (bytes[0] == 0xFF && bytes[1] == 0xFE))) {
+        return [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:error];
+    }
+
+    GINIJSONContext context = {0};
+    context.start = bytes;
+    context.end = bytes + length;
+    context.position = bytes;
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        context.position += 3;
+    }
+    NSMutableArray *values = [NSMutableArray new];
+    context.values = values;
+    GINIJSONStringCacheEntry *strings = calloc(GINIJSONStringCacheSize, sizeof(GINIJSONStringCacheEntry));
+    if (!strings) {
+        GINIJSONFail(&context, context.position, "Out of memory");
+    }
+    context.strings = strings;
+
+    id result = nil;
+    if (strings) {
+        GINIJSONSkipWhitespace(&context);
+        result = schema ? GINIJSONDecodeSchemaValue(&context, schema) : GINIJSONDecodeValue(&context);
+        GINIJSONSkipWhitespace(&context);
+        if (!context.errorReason && context.position < context.end) {
+            GINIJSONFail(&context, context.position, "Garbage at end");
+        }
+        if (!context.errorReason && !result) {
+            GINIJSONFail(&context, context.start, "Document does not match the schema");
+        }
+        if (context.errorReason) {
+            result = nil;
+        }
+    }
+
+    free(context.scratch);
+    for (NSUInteger i = 0; strings && i < GINIJSONStringCacheSize; i++) {
+        if (strings[i].string) {
+            CFRelease(strings[i].string);
+        }
+    }
+    free(strings);
+
+    if (!result && error) {
+        NSString *description = [NSString stringWithFormat:@"%s around character %lu.", context.errorReason ?: "Invalid JSON", (unsigned long)context.errorOffset];
+        *error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                     code:NSPropertyListReadCorruptError
+                                 userInfo:@{NSDebugDescriptionErrorKey: description}];
+    }
+    return result;
+}
+
+@end
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import "GINIAPIManager.h"
+
+
+/**
+ * A page of the layout of a document.
+ */
+@interface GINILayoutPage : NSObject
+
+/// The page number, starting with 1.
+@property (readonly) NSUInteger number;
+
+/// The width of the page.
+@property (readonly) double width;
+
+/// The height of the page.
+@property (readonly) double height;
+
+/**
+ * The page in the format of the JSON layout (with the "number", "sizeX", "sizeY" and the "textZones" with their
+ * "paragraphs", "lines" and words in "wds"). Pages of XML layouts are converted to this format.
+ */
+@property (readonly) NSDictionary *dictionary;
+
+/**
+ * Creates a page from its dictionary in the format of the JSON layout.
+ *
+ * @param dictionary    The page.
+ */
++ (instancetype)layoutPageWithDictionary:(NSDictionary *)dictionary;
+
+@end
+
+
+typedef void (^GINILayoutPageBlock)(GINILayoutPage *page);
+
+
+/**
+ * The `GINILayoutParser` decodes the layout of a document (see `-[GINIAPIManager getLayoutForDocument:responseType:]`)
+ * page by page while its data arrives, so the first page is available before the download has finished and only one
+ * page at a time is kept in memory, instead of the whole layout.
+ *
+ * The data is scanned for the pages (the elements of the "pages" array of the JSON layout or the `Page` elements of the
+ * XML layout); everything else is skipped. Each page is decoded as soon as its data is complete.
+ *
+ * A parser decodes one layout. The methods of this class must not be called concurrently.
+ */
+@interface GINILayoutParser : NSObject
+
+/**
+ * Factory to create a new layout parser.
+ *
+ * @param responseType  The format of the layout.
+ * @param pageBlock     Called with each page as soon as it has been decoded, on the thread appending the data.
+ */
++ (instancetype)layoutParserWithResponseType:(GiniAPIResponseType)responseType pageBlock:(GINILayoutPageBlock)pageBlock;
+
+/// The number of decoded pages.
+@property (readonly) NSUInteger pageCount;
+
+/**
+ * Decodes the next part of the layout's data and calls the page block with each page it completes.
+ *
+ * @param data      The data following the previously appended data.
+ * @param error     Set if the data is not a valid layout. The parser can not be used anymore in this case.
+ *
+ * @returns         Whether the data could be decoded.
+ */
+- (BOOL)appendData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Checks that all data of the layout has been appended.
+ *
+ * @param error     Set if the layout is incomplete.
+ *
+ * @returns         Whether the layout is complete.
+ */
+- (BOOL)finishWithError:(NSError **)error;
+
+@end
@@ -0,0 +1,419 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINILayoutParser.h"
+#import "GINIJSONDecoder.h"
+
+
+/**
+ * Returns the error for layout data which can not be decoded.
+ */
+static NSError *GINILayoutParserError(NSString *reason) {
+    return [NSError errorWithDomain:NSCocoaErrorDomain
+                               code:NSPropertyListReadCorruptError
+                           userInfo:@{NSLocalizedFailureReasonErrorKey: reason}];
+}
+
+
+@implementation GINILayoutPage
+
+#pragma mark - Factory
++ (instancetype)layoutPageWithDictionary:(NSDictionary *)dictionary {
+    return [[self alloc] initWithDictionary:dictionary];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    NSParameterAssert([dictionary isKindOfClass:[NSDictionary class]]);
+
+    self = [super init];
+    if (self) {
+        _dictionary = dictionary;
+        _number = [dictionary[@"number"] unsignedIntegerValue];
+        _width = [dictionary[@"sizeX"] doubleValue];
+        _height = [dictionary[@"sizeY"] doubleValue];
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINILayoutPage %lu %.1fx%.1f>", (unsigned long)_number, _width, _height];
+}
+
+@end
+
+
+/**
+ * Converts the `Page` element of an XML layout to the format of the JSON layout.
+ */
+@interface GINILayoutXMLPageDecoder : NSObject <NSXMLParserDelegate>
+@end
+
+@implementation GINILayoutXMLPageDecoder {
+    /// The dictionaries of the open elements; NSNull for elements which are skipped.
+    NSMutableArray *_elements;
+    /// The text of the open word.
+    NSMutableString *_text;
+    NSDictionary *_page;
+}
+
+/**
+ * Decodes the data of a `Page` element.
+ */
++ (NSDictionary *)pageWithData:(NSData *)data error:(NSError **)error {
+    GINILayoutXMLPageDecoder *decoder = [self new];
+    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
+    parser.delegate = decoder;
+    if (![parser parse] || !decoder->_page) {
+        if (error) {
+            *error = parser.parserError ?: GINILayoutParserError(@"The page element is invalid.");
+        }
+        return nil;
+    }
+    return decoder->_page;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _elements = [NSMutableArray new];
+    }
+    return self;
+}
+
+/**
+ * The key of the array containing the child elements of the given name in the JSON layout.
+ */
++ (NSString *)childrenKeyForElementName:(NSString *)elementName {
+    static NSDictionary *keys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @{@"TextZone": @"textZones",
+                 @"Paragraph": @"paragraphs",
+                 @"Line": @"lines",
+                 @"Wd": @"wds"};
+    });
+    return keys[elementName];
+}
+
+/**
+ * Converts an attribute value: "true" and "false" to booleans, numbers to numbers, everything else is kept as string.
+ */
++ (id)valueForAttributeValue:(NSString *)attributeValue {
+    if ([attributeValue isEqualToString:@"true"] || [attributeValue isEqualToString:@"false"]) {
+        return @([attributeValue isEqualToString:@"true"]);
+    }
+    NSScanner *scanner = [NSScanner scannerWithString:attributeValue];
+    double number;
+    if ([scanner scanDouble:&number] && [scanner isAtEnd]) {
+        return @(number);
+    }
+    return attributeValue;
+}
+
+- (void)parser:(NSXMLParser *)parser didStartElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName attributes:(NSDictionary *)attributes {
+    NSString *childrenKey = [[self class] childrenKeyForElementName:elementName];
+    BOOL isPage = [_elements count] == 0 && [elementName isEqualToString:@"Page"];
+    id parent = [_elements lastObject];
+    if (!isPage && (!childrenKey || ![parent isKindOfClass:[NSMutableDictionary class]])) {
+        [_elements addObject:[NSNull null]];
+        return;
+    }
+
+    NSMutableDictionary *element = [NSMutableDictionary dictionaryWithCapacity:[attributes count] + 1];
+    for (NSString *name in attributes) {
+        // The attributes are capitalized versions of the JSON keys, e.g. "SizeX" and "sizeX".
+        NSString *key = [[[name substringToIndex:1] lowercaseString] stringByAppendingString:[name substringFromIndex:1]];
+        element[key] = [[self class] valueForAttributeValue:attributes[name]];
+    }
+    if (isPage) {
+        element[@"number"] = @([attributes[@"Number"] integerValue]);
+        element[@"textZones"] = [NSMutableArray new];
+    } else {
+        if (!parent[childrenKey]) {
+            parent[childrenKey] = [NSMutableArray new];
+        }
+        [parent[childrenKey] addObject:element];
+    }
+    if ([elementName isEqualToString:@"Wd"]) {
+        _text = [NSMutableString new];
+    }
+    [_elements addObject:element];
+}
+
+- (void)parser:(NSXMLParser *)parser foundCharacters:(NSString *)string {
+    [_text appendString:string];
+}
+
+- (void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName {
+    NSMutableDictionary *element = [_elements lastObject];
+    [_elements removeLastObject];
+    if ([element isKindOfClass:[NSNull class]]) {
+        return;
+    }
+    if (_text && [elementName isEqualToString:@"Wd"]) {
+        element[@"text"] = _text;
+        _text = nil;
+    }
+    if ([_elements count] == 0) {
+        _page = element;
+    }
+}
+
+@end
+
+
+@implementation GINILayoutParser {
+    GiniAPIResponseType _responseType;
+    GINILayoutPageBlock _pageBlock;
+    /// Set when invalid data has been appended.
+    NSError *_error;
+
+    // The state of the JSON scanner.
+    /// The types ('{' or '[') of the open objects and arrays.
+    NSMutableData *_containers;
+    BOOL _inString;
+    BOOL _escaped;
+    /// The last string on the top level, to find the "pages" key.
+    NSMutableData *_topLevelString;
+    BOOL _topLevelStringIsPagesKey;
+    BOOL _inPagesArray;
+
+    /// The data of the page which is not complete yet (JSON), or the data which has not been scanned yet (XML).
+    NSMutableData *_buffer;
+    /// XML: whether the buffer starts with the begin of a `Page` element.
+    BOOL _inPageElement;
+    /// XML: the position in the buffer up to which the end of the `Page` element has been searched.
+    NSUInteger _scannedLength;
+}
+
+#pragma mark - Factory
++ (instancetype)layoutParserWithResponseType:(GiniAPIResponseType)responseType pageBlock:(GINILayoutPageBlock)pageBlock {
+    return [[self alloc] initWithResponseType:responseType pageBlock:pageBlock];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithResponseType:(GiniAPIResponseType)responseType pageBlock:(GINILayoutPageBlock)pageBlock {
+    NSParameterAssert(pageBlock);
+
+    self = [super init];
+    if (self) {
+        _responseType = responseType;
+        _pageBlock = [pageBlock copy];
+        _containers = [NSMutableData new];
+        _topLevelString = [NSMutableData new];
+        _buffer = [NSMutableData new];
+    }
+    return self;
+}
+
+#pragma mark - Parsing
+- (BOOL)appendData:(NSData *)data error:(NSError **)error {
+    NSParameterAssert([data isKindOfClass:[NSData class]]);
+
+    if (!_error) {
+        if (_responseType == GiniAPIResponseTypeJSON) {
+            [self scanJSONData:data];
+        } else {
+            [_buffer appendData:data];
+            [self scanXMLBuffer];
+        }
+    }
+    if (_error && error) {
+        *error = _error;
+    }
+    return _error == nil;
+}
+
+- (BOOL)finishWithError:(NSError **)error {
+    if (!_error) {
+        BOOL complete = _responseType == GiniAPIResponseTypeJSON ? ([_containers length] == 0 && !_inString) : !_inPageElement;
+        if (!complete) {
+            _error = GINILayoutParserError(@"The layout is incomplete.");
+        }
+    }
+    if (_error && error) {
+        *error = _error;
+    }
+    return _error == nil;
+}
+
+/**
+ * Emits the decoded page.
+ */
+- (void)emitPageWithDictionary:(NSDictionary *)dictionary {
+    _pageCount += 1;
+    _pageBlock([GINILayoutPage layoutPageWithDictionary:dictionary]);
+}
+
+#pragma mark - JSON
+
+/**
+ * Tracks the nesting of the JSON data to find the elements of the "pages" array. Only the data of the current page is
+ * copied, the page is decoded as soon as its closing brace has been scanned (large pages with the `GINIJSONDecoder`).
+ */
+- (void)scanJSONData:(NSData *)data {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    // The start of the current page in this chunk of data, or NSNotFound.
+    NSUInteger pageStart = [_buffer length] > 0 ? 0 : NSNotFound;
+
+    for (NSUInteger i = 0; i < length; i++) {
+        uint8_t byte = bytes[i];
+        NSUInteger depth = [_containers length];
+        if (_inString) {
+            if (_escaped) {
+                _escaped = NO;
+            } else if (byte == '\\') {
+                _escaped = YES;
+            } else if (byte == '"') {
+                _inString = NO;
+            } else if (depth == 1 && [_topLevelString length] < 16) {
+                [_topLevelString appendBytes:&byte length:1];
+            }
+            continue;
+        }
+
+        switch (byte) {
+            case '"':
+                _inString = YES;
+                if (depth == 1) {
+                    [_topLevelString setLength:0];
+                }
+                break;
+            case ':':
+                if (depth == 1) {
+                    _topLevelStringIsPagesKey = [_topLevelString isEqualToData:[@"pages" dataUsingEncoding:NSUTF8StringEncoding]];
+                }
+                break;
+            case '{':
+            case '[':
+                if (depth == 0 && byte != '{') {
+                    _error = GINILayoutParserError(@"The layout is not a JSON object.");
+                    return;
+                }
+                if (depth == 1 && byte == '[' && _topLevelStringIsPagesKey) {
+                    _inPagesArray = YES;
+                } else if (depth == 2 && _inPagesArray) {
+                    pageStart = i;
+                }
+                [_containers appendBytes:&byte length:1];
+                break;
+            case '}':
+            case ']': {
+                uint8_t opening = byte == '}' ? '{' : '[';
+                if (depth == 0 || ((const uint8_t *)[_containers bytes])[depth - 1] != opening) {
+                    _error = GINILayoutParserError(@"The layout contains unbalanced brackets.");
+                    return;
+                }
+                [_containers setLength:depth - 1];
+                if (depth == 3 && _inPagesArray && pageStart != NSNotFound) {
+                    [_buffer appendBytes:bytes + pageStart length:i + 1 - pageStart];
+                    pageStart = NSNotFound;
+                    if (![self emitJSONPage]) {
+                        return;
+                    }
+                } else if (depth == 2 && _inPagesArray) {
+                    _inPagesArray = NO;
+                }
+                if (depth == 1) {
+                    _topLevelStringIsPagesKey = NO;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Keep the beginning of the page for the next chunk of data.
+    if (pageStart != NSNotFound) {
+        [_buffer appendBytes:bytes + pageStart length:length - pageStart];
+    }
+}
+
+- (BOOL)emitJSONPage {
+    NSError *error;
+    NSDictionary *page = [_buffer length] >= GINIJSONDecoderMinimumLength
+        ? [GINIJSONDecoder JSONObjectWithData:_buffer error:&error]
+        : [NSJSONSerialization JSONObjectWithData:_buffer options:0 error:&error];
+    [_buffer setLength:0];
+    if (![page isKindOfClass:[NSDictionary class]]) {
+        _error = error ?: GINILayoutParserError(@"The page is not a JSON object.");
+        return NO;
+    }
+    [self emitPageWithDictionary:page];
+    return YES;
+}
+
+#pragma mark - XML
+
+/**
+ * Searches the buffer for complete `Page` elements and decodes them. The data before a `Page` element is dropped, the
+ * data of an incomplete `Page` element is kept until its end tag has been appended.
+ */
+- (void)scanXMLBuffer {
+    static NSData *startTag;
+    static NSData *endTag;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        startTag = [@"<Page" dataUsingEncoding:NSUTF8StringEncoding];
+        endTag = [@"</Page>" dataUsingEncoding:NSUTF8StringEncoding];
+    });
+
+    while (YES) {
+        NSUInteger length = [_buffer length];
+        if (!_inPageElement) {
+            NSRange searchRange = NSMakeRange(0, length);
+            NSRange startRange;
+            while ((startRange = [_buffer rangeOfData:startTag options:0 range:searchRange]).location != NSNotFound) {
+                NSUInteger next = NSMaxRange(startRange);
+                if (next == length) {
+                    break;
+                }
+                // Skip other elements starting with "<Page", such as "<Pages>".
+                uint8_t nextByte = ((const uint8_t *)[_buffer bytes])[next];
+                if (nextByte == '>' || nextByte == '/' || isspace(nextByte)) {
+                    break;
+                }
+                searchRange = NSMakeRange(next, length - next);
+            }
+            if (startRange.location == NSNotFound) {
+                // Keep a possibly incomplete start tag at the end.
+                NSUInteger keptLength = MIN(length, [startTag length] - 1);
+                [_buffer replaceBytesInRange:NSMakeRange(0, length - keptLength) withBytes:NULL length:0];
+                return;
+            }
+            [_buffer replaceBytesInRange:NSMakeRange(0, startRange.location) withBytes:NULL length:0];
+            if (NSMaxRange(startRange) - startRange.location == [_buffer length]) {
+                // Whether this is a `Page` element is only known with the next byte.
+                return;
+            }
+            _inPageElement = YES;
+            _scannedLength = 0;
+            length = [_buffer length];
+        }
+
+        NSUInteger searchStart = _scannedLength >= [endTag length] ? _scannedLength - [endTag length] + 1 : 0;
+        NSRange endRange = [_buffer rangeOfData:endTag options:0 range:NSMakeRange(searchStart, length - searchStart)];
+        if (endRange.location == NSNotFound) {
+            _scannedLength = length;
+            return;
+        }
+
+        NSError *error;
+        NSRange pageRange = NSMakeRange(0, NSMaxRange(endRange));
+        NSDictionary *page = [GINILayoutXMLPageDecoder pageWithData:[_buffer subdataWithRange:pageRange] error:&error];
+        if (!page) {
+            _error = error;
+            return;
+        }
+        [_buffer replaceBytesInRange:pageRange withBytes:NULL length:0];
+        _inPageElement = NO;
+        [self emitPageWithDictionary:page];
+    }
+}
+
+@end
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class GINIAPIManager;
+@class GINIHistogram;
+
+
+/**
+ * The `GINIOutbox` is a persistent queue for the write operations on documents (feedback, error reports and deletions),
+ * so they are not lost if the device is offline. The queued operations are stored in a file and submitted when the
+ * network becomes reachable again or when `flush` is called.
+ *
+ * The operations of a document are merged: later feedback for a label replaces earlier feedback, and a deletion
+ * replaces all other operations of the document.
+ *
+ * Operations that fail because of the network or with a 5xx or 429 response stay in the outbox; operations that fail
+ * with any other error are dropped, since submitting them again would fail again. Since queued operations may still be
+ * dropped, their effects should only be applied locally once they have been submitted, see `feedbackSubmittedBlock`
+ * and `deletionSubmittedBlock`.
+ *
+ * The queued feedback is the user's financial data (e.g. IBANs and amounts), so the file is protected with
+ * `NSFileProtectionCompleteUntilFirstUserAuthentication`.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINIOutbox : NSObject
+
+/**
+ * Factory to create a new outbox. The operations stored in the file by a previous outbox are restored.
+ *
+ * @param apiManager    The API manager used to submit the operations.
+ * @param fileURL       The file the operations are stored in.
+ */
++ (instancetype)outboxWithAPIManager:(GINIAPIManager *)apiManager fileURL:(NSURL *)fileURL;
+
+/**
+ * Returns YES if an operation that failed with the given error may succeed when it is submitted again, i.e. if it
+ * failed because there was no connection to the Gini API (no network, lost connection, timeout, DNS failure) or with a
+ * 5xx or 429 response.
+ */
++ (BOOL)isTransientError:(NSError *)error;
+
+/**
+ * The default file of the outbox in the application support directory.
+ */
++ (NSURL *)defaultFileURL;
+
+/// The maximum number of documents whose operations are submitted concurrently when flushing. Defaults to 4.
+@property NSUInteger maxConcurrentDocuments;
+
+/// The number of queued operations.
+@property (readonly) NSUInteger pendingOperationCount;
+
+/// The time in seconds from queuing an operation until it was submitted successfully.
+@property (readonly) GINIHistogram *flushLatency;
+
+/**
+ * Called with the document ID and the submitted feedback when queued feedback has been submitted successfully. Called
+ * on an arbitrary thread.
+ */
+@property (copy) void (^feedbackSubmittedBlock)(NSString *documentId, NSDictionary *feedback);
+
+/**
+ * Called with the document ID when the queued deletion of a document has been submitted successfully, or when the
+ * document turned out to be deleted already. Called on an arbitrary thread.
+ */
+@property (copy) void (^deletionSubmittedBlock)(NSString *documentId);
+
+/**
+ * Queues feedback for a document, see `-[GINIAPIManager submitBatchFeedbackForDocument:feedback:]`.
+ *
+ * @param feedback      The feedback (the extraction name as the key and a dictionary with the "value" as value).
+ * @param documentId    The document's unique identifier.
+ */
+- (void)enqueueFeedback:(NSDictionary *)feedback forDocumentWithId:(NSString *)documentId;
+
+/**
+ * Queues an error report for a document, see `-[GINIAPIManager reportErrorForDocument:summary:description:]`.
+ *
+ * @param summary       The summary of the error.
+ * @param description   The description of the error.
+ * @param documentId    The document's unique identifier.
+ */
+- (void)enqueueErrorReportWithSummary:(NSString *)summary description:(NSString *)description forDocumentWithId:(NSString *)documentId;
+
+/**
+ * Queues the deletion of a document.
+ *
+ * @param documentId    The document's unique identifier.
+ */
+- (void)enqueueDeletionOfDocumentWithId:(NSString *)documentId;
+
+/**
+ * Submits all queued operations. The documents are flushed in batches of `maxConcurrentDocuments` documents whose
+ * operations are submitted concurrently. If a flush is already running, its task is returned.
+ *
+ * @returns             A `BFTask*` resolving to the number of operations which are still queued.
+ */
+- (BFTask *)flush;
+
+@end
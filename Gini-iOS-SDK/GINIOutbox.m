@@ -0,0 +1,377 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import <SystemConfiguration/SystemConfiguration.h>
+#import <netinet/in.h>
+#import "GINIOutbox.h"
+#import "GINIAPIManager.h"
+#import "GINIHistogram.h"
+#import "GINIHTTPError.h"
+#import "GINIURLResponse.h"
+
+
+/// The keys of the queued operations of a document in the outbox file.
+static NSString *const GINIOutboxFeedbackKey = @"feedback";
+static NSString *const GINIOutboxErrorReportsKey = @"errorReports";
+static NSString *const GINIOutboxDeleteKey = @"delete";
+static NSString *const GINIOutboxEnqueuedAtKey = @"enqueuedAt";
+static NSString *const GINIOutboxSummaryKey = @"summary";
+static NSString *const GINIOutboxDescriptionKey = @"description";
+
+static void GINIOutboxReachabilityCallback(SCNetworkReachabilityRef target, SCNetworkReachabilityFlags flags, void *info);
+
+
+@implementation GINIOutbox {
+    GINIAPIManager *_apiManager;
+    NSURL *_fileURL;
+    /// The queued operations keyed by the document ID.
+    NSMutableDictionary<NSString *, NSMutableDictionary *> *_documents;
+    /// The task of the running flush or nil.
+    BFTask *_flushTask;
+    SCNetworkReachabilityRef _reachability;
+    BOOL _reachable;
+}
+
++ (BOOL)isTransientError:(NSError *)error {
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        // Only connectivity problems go away by themselves. Cancelled requests, bad URLs and failed authentication or
+        // TLS trust evaluation would fail again on every retry.
+        switch (error.code) {
+            case NSURLErrorNotConnectedToInternet:
+            case NSURLErrorNetworkConnectionLost:
+            case NSURLErrorTimedOut:
+            case NSURLErrorCannotFindHost:
+            case NSURLErrorCannotConnectToHost:
+            case NSURLErrorDNSLookupFailed:
+            case NSURLErrorInternationalRoamingOff:
+            case NSURLErrorDataNotAllowed:
+                return YES;
+            default:
+                return NO;
+        }
+    }
+    if ([error isKindOfClass:[GINIHTTPError class]]) {
+        NSInteger statusCode = ((GINIHTTPError *)error).response.response.statusCode;
+        return statusCode >= 500 || statusCode == 429;
+    }
+    return NO;
+}
+
+#pragma mark - Factory
++ (instancetype)outboxWithAPIManager:(GINIAPIManager *)apiManager fileURL:(NSURL *)fileURL {
+    return [[self alloc] initWithAPIManager:apiManager fileURL:fileURL];
+}
+
++ (NSURL *)defaultFileURL {
+    NSURL *directory = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    return [directory URLByAppendingPathComponent:@"GINIOutbox.plist"];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithAPIManager:(GINIAPIManager *)apiManager fileURL:(NSURL *)fileURL {
+    NSParameterAssert([apiManager isKindOfClass:[GINIAPIManager class]]);
+    NSParameterAssert([fileURL isKindOfClass:[NSURL class]]);
+
+    self = [super init];
+    if (self) {
+        _apiManager = apiManager;
+        _fileURL = fileURL;
+        _maxConcurrentDocuments = 4;
+        _flushLatency = [GINIHistogram new];
+        _documents = [NSMutableDictionary new];
+
+        NSData *data = [NSData dataWithContentsOfURL:fileURL];
+        NSDictionary *documents = data ? [NSPropertyListSerialization propertyListWithData:data
+                                                                                   options:NSPropertyListMutableContainers
+                                                                                    format:NULL
+                                                                                     error:nil] : nil;
+        if ([documents isKindOfClass:[NSDictionary class]]) {
+            [_documents addEntriesFromDictionary:documents];
+        }
+
+        [self startMonitoringReachability];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_reachability) {
+        SCNetworkReachabilitySetDispatchQueue(_reachability, NULL);
+        SCNetworkReachabilitySetCallback(_reachability, NULL, NULL);
+        CFRelease(_reachability);
+    }
+}
+
+#pragma mark - Properties
+- (NSUInteger)pendingOperationCount {
+    NSUInteger count = 0;
+    @synchronized (_documents) {
+        for (NSString *documentId in _documents) {
+            NSDictionary *operations = _documents[documentId];
+            count += [operations[GINIOutboxDeleteKey] boolValue] ? 1 : 0;
+            count += [operations[GINIOutboxFeedbackKey] count] > 0 ? 1 : 0;
+            count += [operations[GINIOutboxErrorReportsKey] count];
+        }
+    }
+    return count;
+}
+
+#pragma mark - Queuing
+/**
+ * Returns the queued operations of the document, creating them if necessary. Must be called while holding the lock.
+ */
+- (NSMutableDictionary *)operationsForDocumentWithId:(NSString *)documentId {
+    NSMutableDictionary *operations = _documents[documentId];
+    if (!operations) {
+        operations = [NSMutableDictionary dictionaryWithObject:@([[NSDate date] timeIntervalSince1970]) forKey:GINIOutboxEnqueuedAtKey];
+        _documents[documentId] = operations;
+    }
+    return operations;
+}
+
+- (void)enqueueFeedback:(NSDictionary *)feedback forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([feedback isKindOfClass:[NSDictionary class]]);
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    @synchronized (_documents) {
+        NSMutableDictionary *operations = [self operationsForDocumentWithId:documentId];
+        if ([operations[GINIOutboxDeleteKey] boolValue]) {
+            return;
+        }
+        NSMutableDictionary *queuedFeedback = operations[GINIOutboxFeedbackKey] ?: [NSMutableDictionary new];
+        [queuedFeedback addEntriesFromDictionary:feedback];
+        operations[GINIOutboxFeedbackKey] = queuedFeedback;
+        [self save];
+    }
+}
+
+- (void)enqueueErrorReportWithSummary:(NSString *)summary description:(NSString *)description forDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    @synchronized (_documents) {
+        NSMutableDictionary *operations = [self operationsForDocumentWithId:documentId];
+        if ([operations[GINIOutboxDeleteKey] boolValue]) {
+            return;
+        }
+        NSMutableArray *errorReports = operations[GINIOutboxErrorReportsKey] ?: [NSMutableArray new];
+        NSMutableDictionary *errorReport = [NSMutableDictionary new];
+        errorReport[GINIOutboxSummaryKey] = summary;
+        errorReport[GINIOutboxDescriptionKey] = description;
+        [errorReports addObject:errorReport];
+        operations[GINIOutboxErrorReportsKey] = errorReports;
+        [self save];
+    }
+}
+
+- (void)enqueueDeletionOfDocumentWithId:(NSString *)documentId {
+    NSParameterAssert([documentId isKindOfClass:[NSString class]]);
+
+    @synchronized (_documents) {
+        NSMutableDictionary *operations = [self operationsForDocumentWithId:documentId];
+        // The other operations of a deleted document are obsolete.
+        [operations removeObjectForKey:GINIOutboxFeedbackKey];
+        [operations removeObjectForKey:GINIOutboxErrorReportsKey];
+        operations[GINIOutboxDeleteKey] = @YES;
+        [self save];
+    }
+}
+
+/**
+ * Writes the queued operations to the file. Must be called while holding the lock.
+ */
+- (void)save {
+    NSError *error;
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:_documents
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:&error];
+    [[NSFileManager defaultManager] createDirectoryAtURL:[_fileURL URLByDeletingLastPathComponent]
+                             withIntermediateDirectories:YES
+                                              attributes:nil
+                                                   error:nil];
+    // The queued feedback contains the user's financial data.
+    if (!data || ![data writeToURL:_fileURL options:NSDataWritingAtomic | NSDataWritingFileProtectionCompleteUntilFirstUserAuthentication error:&error]) {
+        NSLog(@"GINIOutbox: could not save the queued operations: %@", error);
+    }
+}
+
+#pragma mark - Flushing
+- (BFTask *)flush {
+    @synchronized (_documents) {
+        if (_flushTask) {
+            return _flushTask;
+        }
+        NSArray<NSString *> *documentIds = [_documents allKeys];
+        NSUInteger batchSize = MAX(self.maxConcurrentDocuments, 1);
+
+        // The batches are flushed one after another, the documents of a batch concurrently.
+        BFTask *flushTask = [BFTask taskWithResult:nil];
+        for (NSUInteger start = 0; start < [documentIds count]; start += batchSize) {
+            NSArray *batch = [documentIds subarrayWithRange:NSMakeRange(start, MIN(batchSize, [documentIds count] - start))];
+            flushTask = [flushTask continueWithBlock:^id(BFTask *task) {
+                NSMutableArray *documentTasks = [NSMutableArray arrayWithCapacity:[batch count]];
+                for (NSString *documentId in batch) {
+                    [documentTasks addObject:[self flushDocumentWithId:documentId]];
+                }
+                return [BFTask taskForCompletionOfAllTasks:documentTasks];
+            }];
+        }
+        flushTask = [flushTask continueWithBlock:^id(BFTask *task) {
+            return @(self.pendingOperationCount);
+        }];
+        // The flush may already be completed here (e.g. if the outbox is empty), so the task is only reset after it
+        // has been stored and only if no newer flush has been started since.
+        _flushTask = flushTask;
+        [flushTask continueWithBlock:^id(BFTask *task) {
+            @synchronized (self->_documents) {
+                if (self->_flushTask == flushTask) {
+                    self->_flushTask = nil;
+                }
+            }
+            return nil;
+        }];
+        return flushTask;
+    }
+}
+
+/**
+ * Submits the queued operations of a single document and removes the submitted operations from the outbox.
+ */
+- (BFTask *)flushDocumentWithId:(NSString *)documentId {
+    NSDictionary *operations;
+    NSDictionary *feedback;
+    NSArray *errorReports;
+    @synchronized (_documents) {
+        // The queued operations are mutable, so they are copied before they are submitted.
+        operations = [_documents[documentId] copy];
+        feedback = [operations[GINIOutboxFeedbackKey] copy];
+        errorReports = [operations[GINIOutboxErrorReportsKey] copy];
+    }
+    if (!operations) {
+        return [BFTask taskWithResult:nil];
+    }
+
+    if ([operations[GINIOutboxDeleteKey] boolValue]) {
+        return [[_apiManager deleteDocument:documentId] continueWithBlock:^id(BFTask *task) {
+            // The document is gone if it has already been deleted.
+            BOOL notFound = [task.error isKindOfClass:[GINIHTTPError class]] && ((GINIHTTPError *)task.error).response.response.statusCode == 404;
+            NSError *error = notFound ? nil : task.error;
+            [self completeOperations:operations ofDocumentWithId:documentId error:error usingBlock:^(NSMutableDictionary *queuedOperations) {
+                [queuedOperations removeObjectForKey:GINIOutboxDeleteKey];
+            }];
+            void (^deletionSubmittedBlock)(NSString *) = self.deletionSubmittedBlock;
+            if (!error && deletionSubmittedBlock) {
+                deletionSubmittedBlock(documentId);
+            }
+            return nil;
+        }];
+    }
+
+    BFTask *feedbackTask = [feedback count] > 0 ? [_apiManager submitBatchFeedbackForDocument:documentId feedback:feedback] : [BFTask taskWithResult:nil];
+    BFTask *documentTask = [feedbackTask continueWithBlock:^id(BFTask *task) {
+        [self completeOperations:operations ofDocumentWithId:documentId error:task.error usingBlock:^(NSMutableDictionary *queuedOperations) {
+            // Only remove the labels that were not updated while the feedback was submitted.
+            NSMutableDictionary *queuedFeedback = queuedOperations[GINIOutboxFeedbackKey];
+            for (NSString *label in feedback) {
+                if ([queuedFeedback[label] isEqual:feedback[label]]) {
+                    [queuedFeedback removeObjectForKey:label];
+                }
+            }
+        }];
+        void (^feedbackSubmittedBlock)(NSString *, NSDictionary *) = self.feedbackSubmittedBlock;
+        if ([feedback count] > 0 && !task.error && feedbackSubmittedBlock) {
+            feedbackSubmittedBlock(documentId, feedback);
+        }
+        return task;
+    }];
+
+    // Error reports are submitted one after another, so their order is kept.
+    for (NSDictionary *errorReport in errorReports) {
+        documentTask = [documentTask continueWithSuccessBlock:^id(BFTask *task) {
+            BFTask *reportTask = [self->_apiManager reportErrorForDocument:documentId
+                                                                   summary:errorReport[GINIOutboxSummaryKey]
+                                                               description:errorReport[GINIOutboxDescriptionKey]];
+            return [reportTask continueWithBlock:^id(BFTask *reportTask) {
+                [self completeOperations:operations ofDocumentWithId:documentId error:reportTask.error usingBlock:^(NSMutableDictionary *queuedOperations) {
+                    NSMutableArray *queuedErrorReports = queuedOperations[GINIOutboxErrorReportsKey];
+                    NSUInteger index = [queuedErrorReports indexOfObjectIdenticalTo:errorReport];
+                    if (index != NSNotFound) {
+                        [queuedErrorReports removeObjectAtIndex:index];
+                    }
+                }];
+                return reportTask;
+            }];
+        }];
+    }
+    return documentTask;
+}
+
+/**
+ * Removes a submitted operation of the document with the given block, or keeps it if it failed with a transient error.
+ * Records the flush latency once all operations of the document are submitted.
+ */
+- (void)completeOperations:(NSDictionary *)operations
+          ofDocumentWithId:(NSString *)documentId
+                     error:(NSError *)error
+                usingBlock:(void (^)(NSMutableDictionary *queuedOperations))block {
+    @synchronized (_documents) {
+        NSMutableDictionary *queuedOperations = _documents[documentId];
+        if (!queuedOperations) {
+            return;
+        }
+        if (error && [GINIOutbox isTransientError:error]) {
+            return;
+        }
+        if (error) {
+            NSLog(@"GINIOutbox: dropping operation of document %@: %@", documentId, error);
+        }
+        block(queuedOperations);
+
+        if ([queuedOperations[GINIOutboxFeedbackKey] count] == 0 && [queuedOperations[GINIOutboxErrorReportsKey] count] == 0 &&
+            ![queuedOperations[GINIOutboxDeleteKey] boolValue]) {
+            [_documents removeObjectForKey:documentId];
+            if (!error) {
+                [_flushLatency recordValue:[[NSDate date] timeIntervalSince1970] - [operations[GINIOutboxEnqueuedAtKey] doubleValue]];
+            }
+        }
+        [self save];
+    }
+}
+
+#pragma mark - Reachability
+- (void)startMonitoringReachability {
+    struct sockaddr_in address;
+    bzero(&address, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    _reachability = SCNetworkReachabilityCreateWithAddress(kCFAllocatorDefault, (const struct sockaddr *)&address);
+    if (!_reachability) {
+        return;
+    }
+    // The outbox is not retained by the reachability, the callback is removed in dealloc.
+    SCNetworkReachabilityContext context = {0, (__bridge void *)self, NULL, NULL, NULL};
+    SCNetworkReachabilitySetCallback(_reachability, GINIOutboxReachabilityCallback, &context);
+    SCNetworkReachabilitySetDispatchQueue(_reachability, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+}
+
+- (void)reachabilityDidChange:(SCNetworkReachabilityFlags)flags {
+    BOOL reachable = (flags & kSCNetworkReachabilityFlagsReachable) && !(flags & kSCNetworkReachabilityFlagsConnectionRequired);
+    BOOL becameReachable;
+    @synchronized (_documents) {
+        becameReachable = reachable && !_reachable;
+        _reachable = reachable;
+    }
+    if (becameReachable && self.pendingOperationCount > 0) {
+        [self flush];
+    }
+}
+
+@end
+
+
+static void GINIOutboxReachabilityCallback(SCNetworkReachabilityRef target, SCNetworkReachabilityFlags flags, void *info) {
+    [(__bridge GINIOutbox *)info reachabilityDidChange:flags];
+}
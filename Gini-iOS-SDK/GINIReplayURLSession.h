@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import "GINIURLSession.h"
+
+
+/**
+ * The `GINIReplayURLSession` serves the responses of a traffic archive that was recorded with a `GINITrafficRecorder`,
+ * so a recorded session (e.g. of a customer who reported slowness) can be replayed offline to benchmark changes of the
+ * SDK against real traffic.
+ *
+ * Requests are matched by their method and path, the query (which is not recorded) and the host are ignored. Requests
+ * with the same method and path are answered in the order they were recorded. Each response is delayed by its recorded duration multiplied by
+ * `timeScale`. Requests without a (remaining) recorded response fail with `NSURLErrorResourceUnavailable`.
+ */
+@interface GINIReplayURLSession : NSObject <GINIURLSession>
+
+/**
+ * Factory to create a new replay session.
+ *
+ * @param data      The archive, see `-[GINITrafficRecorder archivedData]`.
+ * @param error     Set if the archive is invalid.
+ */
++ (instancetype)replayURLSessionWithArchiveData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Factory to create a new replay session with the archive stored in the given file.
+ *
+ * @param url       The file URL of the archive, see `-[GINITrafficRecorder writeToURL:error:]`.
+ * @param error     Set if the file can't be read or the archive is invalid.
+ */
++ (instancetype)replayURLSessionWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+/**
+ * The factor the recorded durations are multiplied with. 1 (the default) replays with the original timing, 0 answers
+ * all requests immediately.
+ */
+@property double timeScale;
+
+/// The number of recorded responses that have not been served yet.
+@property (readonly) NSUInteger remainingEntryCount;
+
+@end
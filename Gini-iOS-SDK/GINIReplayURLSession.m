@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIReplayURLSession.h"
+#import "GINITrafficRecorder_Private.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+
+/// Defined in GINIURLSession.m.
+void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BFTaskCompletionSource *completionSource);
+
+
+@implementation GINIReplayURLSession {
+    /// The recorded entries that have not been served yet, keyed by `GINITrafficRequestKey`.
+    NSMutableDictionary<NSString *, NSMutableArray<NSDictionary *> *> *_entries;
+}
+
+#pragma mark - Factory
++ (instancetype)replayURLSessionWithArchiveData:(NSData *)data error:(NSError **)error {
+    NSParameterAssert([data isKindOfClass:[NSData class]]);
+
+    NSDictionary *archive = [NSPropertyListSerialization propertyListWithData:data
+                                                                      options:NSPropertyListImmutable
+                                                                       format:NULL
+                                                                        error:error];
+    if (!archive) {
+        return nil;
+    }
+    if (![archive isKindOfClass:[NSDictionary class]] ||
+        [archive[GINITrafficArchiveVersionKey] integerValue] != GINITrafficArchiveVersion ||
+        ![archive[GINITrafficArchiveEntriesKey] isKindOfClass:[NSArray class]]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:nil];
+        }
+        return nil;
+    }
+    return [[self alloc] initWithEntries:archive[GINITrafficArchiveEntriesKey]];
+}
+
++ (instancetype)replayURLSessionWithContentsOfURL:(NSURL *)url error:(NSError **)error {
+    NSData *data = [NSData dataWithContentsOfURL:url options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+    return [self replayURLSessionWithArchiveData:data error:error];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithEntries:(NSArray<NSDictionary *> *)entries {
+    self = [super init];
+    if (self) {
+        _timeScale = 1;
+        _entries = [NSMutableDictionary new];
+        for (NSDictionary *entry in entries) {
+            NSString *key = GINITrafficRequestKey(entry[GINITrafficEntryMethodKey], [NSURL URLWithString:entry[GINITrafficEntryURLKey]]);
+            if (!_entries[key]) {
+                _entries[key] = [NSMutableArray new];
+            }
+            [_entries[key] addObject:entry];
+        }
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)remainingEntryCount {
+    NSUInteger count = 0;
+    @synchronized (_entries) {
+        for (NSString *key in _entries) {
+            count += [_entries[key] count];
+        }
+    }
+    return count;
+}
+
+#pragma mark - Private methods
+/**
+ * Removes and returns the next recorded entry for the given request or nil if there is none.
+ */
+- (NSDictionary *)takeEntryForRequest:(NSURLRequest *)request {
+    NSString *key = GINITrafficRequestKey(request.HTTPMethod, request.URL);
+    @synchronized (_entries) {
+        NSMutableArray *entries = _entries[key];
+        NSDictionary *entry = [entries firstObject];
+        if (entry) {
+            [entries removeObjectAtIndex:0];
+        }
+        return entry;
+    }
+}
+
+/**
+ * Serves the next recorded entry for the given request after its (scaled) duration. The block is called with the
+ * recorded response, body and error; it is never called if there is no recorded entry for the request.
+ */
+- (BFTask *)replayRequest:(NSURLRequest *)request
+               usingBlock:(void (^)(NSHTTPURLResponse *response, NSData *body, NSError *error, BFTaskCompletionSource *completionSource))block {
+    NSParameterAssert([request isKindOfClass:[NSURLRequest class]]);
+
+    NSDictionary *entry = [self takeEntryForRequest:request];
+    if (!entry) {
+        return [BFTask taskWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                         code:NSURLErrorResourceUnavailable
+                                                     userInfo:@{NSURLErrorFailingURLErrorKey: request.URL}]];
+    }
+
+    BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    NSTimeInterval delay = [entry[GINITrafficEntryDurationKey] doubleValue] * self.timeScale;
+    BFTask *delayTask = delay > 0 ? [BFTask taskWithDelay:(int)(delay * 1000)] : [BFTask taskWithResult:nil];
+    [delayTask continueWithBlock:^id(BFTask *task) {
+        NSError *error;
+        if (entry[GINITrafficEntryErrorDomainKey] && !entry[GINITrafficEntryStatusCodeKey]) {
+            error = [NSError errorWithDomain:entry[GINITrafficEntryErrorDomainKey]
+                                        code:[entry[GINITrafficEntryErrorCodeKey] integerValue]
+                                    userInfo:@{NSURLErrorFailingURLErrorKey: request.URL}];
+        }
+        NSHTTPURLResponse *response;
+        if (entry[GINITrafficEntryStatusCodeKey]) {
+            response = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                                   statusCode:[entry[GINITrafficEntryStatusCodeKey] integerValue]
+                                                  HTTPVersion:@"HTTP/1.1"
+                                                 headerFields:entry[GINITrafficEntryHeadersKey]];
+        }
+        block(response, entry[GINITrafficEntryBodyKey] ?: [NSData data], error, completionSource);
+        return nil;
+    }];
+    return completionSource.task;
+}
+
+#pragma mark - GINIURLSession protocol
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request {
+    return [self replayRequest:request usingBlock:^(NSHTTPURLResponse *response, NSData *body, NSError *error, BFTaskCompletionSource *completionSource) {
+        GINIParseResponse(body, response, error, completionSource);
+    }];
+}
+
+- (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
+    return [self replayRequest:request usingBlock:^(NSHTTPURLResponse *response, NSData *body, NSError *error, BFTaskCompletionSource *completionSource) {
+        if (error) {
+            return [completionSource setError:error];
+        }
+        NSURL *location = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        if (![body writeToURL:location options:NSDataWritingAtomic error:&error]) {
+            return [completionSource setError:error];
+        }
+        GINIURLResponse *parsedResponse = [GINIURLResponse urlResponseWithResponse:response data:location];
+        if (response.statusCode < 200 || response.statusCode > 304) {
+            [completionSource setError:[GINIHTTPError errorWithResponse:parsedResponse]];
+        } else {
+            [completionSource setResult:parsedResponse];
+        }
+    }];
+}
+
+- (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
+    return [self BFDataTaskWithRequest:request];
+}
+
+@end
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class GINIDocument;
+@class GINIDocumentTaskManager;
+@class GINISession;
+
+
+/**
+ * The `GINIResourceDecoder` decodes JSON responses of the Gini API directly into the models of the SDK, in a single
+ * pass over the bytes of the response.
+ *
+ * The resources are described by schemas (see `GINIJSONSchema`), so no dictionaries are created for the documents,
+ * extractions and candidates, fields which are not used by the models are skipped, and keys and repeated values (like
+ * the progress of documents and the entities of extractions) are interned. The results are the same as the results of
+ * decoding the responses with `NSJSONSerialization` and creating the models from the dictionaries.
+ *
+ * Instances are immutable and can be used from any thread.
+ */
+@interface GINIResourceDecoder : NSObject
+
+/**
+ * Creates a resource decoder.
+ *
+ * @param documentManager   The document manager of the decoded documents.
+ */
++ (instancetype)resourceDecoderWithDocumentManager:(GINIDocumentTaskManager *)documentManager;
+
+/**
+ * Decodes a document resource (see `+[GINIDocument documentFromAPIResponse:withDocumentManager:]`).
+ *
+ * @param data          The JSON document resource.
+ * @param error         Set if the data is not a valid document.
+ */
+- (GINIDocument *)documentWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Decodes a list of documents, as returned by the documents and the search resources. Invalid documents are left out.
+ *
+ * @param data          The JSON list of documents.
+ * @param totalCount    Set to the total count of documents of the list, if the list has one.
+ * @param error         Set if the data is not a valid list of documents.
+ */
+- (NSArray<GINIDocument *> *)documentsWithData:(NSData *)data totalCount:(NSUInteger *)totalCount error:(NSError **)error;
+
+/**
+ * Decodes an extractions resource into a dictionary with the keys "extractions" (mapping the names to the
+ * `GINIExtraction` instances) and "candidates" (mapping the entities to arrays of `GINIExtraction` instances), like
+ * `-[GINIDocumentTaskManager getExtractionsForDocument:]`.
+ *
+ * @param data          The JSON extractions resource.
+ * @param error         Set if the data is not a valid extractions resource.
+ */
++ (NSMutableDictionary *)extractionsWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Decodes the response of the token endpoints (see `+[GINISessionParser sessionWithJSONDictionary:]`).
+ *
+ * @param data          The JSON token response.
+ * @param error         Set if the data is not a valid token response.
+ */
++ (GINISession *)sessionWithData:(NSData *)data error:(NSError **)error;
+
+@end
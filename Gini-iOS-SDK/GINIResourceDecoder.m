@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINIResourceDecoder.h"
+#import "GINIJSONDecoder.h"
+#import "GINIDocument.h"
+#import "GINIDocument_Private.h"
+#import "GINIDocumentLinks.h"
+#import "GINIPartialDocumentInfo.h"
+#import "GINIExtraction.h"
+#import "GINISession.h"
+
+
+/**
+ * The schema of the links of a document resource.
+ */
+static GINIJSONSchema *GINIDocumentLinksSchema(void) {
+    GINIJSONSchema *string = [GINIJSONSchema stringSchema];
+    return [GINIJSONSchema objectSchemaWithKeys:@[@"document", @"extractions", @"layout", @"processed"]
+                                        schemas:@[string, string, string, string]
+                                          build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+        return [[GINIDocumentLinks alloc] initWithDocumentURL:fields[0] extractionsURL:fields[1] layoutURL:fields[2] processedURL:fields[3]];
+    }];
+}
+
+/**
+ * The schema of a document resource, see `+[GINIDocument documentFromAPIResponse:withDocumentManager:]`.
+ */
+static GINIJSONSchema *GINIDocumentSchema(GINIDocumentTaskManager *documentManager) {
+    GINIJSONSchema *string = [GINIJSONSchema stringSchema];
+    GINIJSONSchema *symbol = [GINIJSONSchema symbolSchema];
+    GINIJSONSchema *number = [GINIJSONSchema numberSchema];
+    GINIJSONSchema *compositeDocument = [GINIJSONSchema objectSchemaWithKeys:@[@"document"] schemas:@[string] build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+        return fields[0];
+    }];
+    GINIJSONSchema *partialDocument = [GINIJSONSchema objectSchemaWithKeys:@[@"document", @"rotationDelta"] schemas:@[string, number] build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+        return [[GINIPartialDocumentInfo alloc] initWithDocumentUrl:fields[0] rotationDelta:[fields[1] intValue]];
+    }];
+
+    __weak GINIDocumentTaskManager *weakDocumentManager = documentManager;
+    return [GINIJSONSchema objectSchemaWithKeys:@[@"id", @"progress", @"sourceClassification", @"pageCount", @"_links",
+                                                  @"compositeDocuments", @"partialDocuments", @"name", @"creationDate"]
+                                        schemas:@[string, symbol, symbol, number, GINIDocumentLinksSchema(),
+                                                  [GINIJSONSchema arraySchemaWithElements:compositeDocument],
+                                                  [GINIJSONSchema arraySchemaWithElements:partialDocument], string, number]
+                                          build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+        return [GINIDocument documentWithId:fields[0]
+                                   progress:fields[1]
+                       sourceClassification:fields[2]
+                                  pageCount:fields[3]
+                                      links:fields[4] ?: [[GINIDocumentLinks alloc] initWithDocumentURL:nil extractionsURL:nil layoutURL:nil processedURL:nil]
+                         compositeDocuments:fields[5]
+                       partialDocumentInfos:fields[6]
+                                   filename:fields[7]
+                               creationDate:fields[8]
+                            documentManager:weakDocumentManager];
+    }];
+}
+
+/**
+ * The schema of an extractions resource, see `-[GINIDocumentTaskManager createExtractionsForGetTask:]`. The extractions
+ * are mapped by name and the candidates by entity, so both are taken from the key of the enclosing map.
+ */
+static GINIJSONSchema *GINIExtractionsSchema(void) {
+    static GINIJSONSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        GINIJSONSchema *string = [GINIJSONSchema stringSchema];
+        GINIJSONSchema *symbol = [GINIJSONSchema symbolSchema];
+        GINIJSONSchema *box = [GINIJSONSchema anySchema];
+        GINIJSONSchema *extraction = [GINIJSONSchema objectSchemaWithKeys:@[@"value", @"entity", @"box"] schemas:@[string, symbol, box] build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            return [GINIExtraction extractionWithName:mapKey value:fields[0] entity:fields[1] box:fields[2]];
+        }];
+        GINIJSONSchema *candidate = [GINIJSONSchema objectSchemaWithKeys:@[@"value", @"box"] schemas:@[string, box] build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            return [GINIExtraction extractionWithName:nil value:fields[0] entity:mapKey box:fields[1]];
+        }];
+
+        schema = [GINIJSONSchema objectSchemaWithKeys:@[@"extractions", @"candidates"]
+                                              schemas:@[[GINIJSONSchema mapSchemaWithValues:extraction],
+                                                        [GINIJSONSchema mapSchemaWithValues:[GINIJSONSchema arraySchemaWithElements:candidate]]]
+                                                build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            // Feedback is written through to the extractions, so they are mutable.
+            NSMutableDictionary *extractions = [fields[0] mutableCopy] ?: [NSMutableDictionary new];
+            NSMutableDictionary *candidates = [fields[1] mutableCopy] ?: [NSMutableDictionary new];
+            NSArray *noCandidates = @[];
+            for (GINIExtraction *extraction in [extractions objectEnumerator]) {
+                extraction.candidates = (extraction.entity ? candidates[extraction.entity] : nil) ?: noCandidates;
+            }
+            return [NSMutableDictionary dictionaryWithObjectsAndKeys:extractions, @"extractions", candidates, @"candidates", nil];
+        }];
+    });
+    return schema;
+}
+
+/**
+ * The schema of the responses of the token endpoints, see `GINISessionParser`.
+ */
+static GINIJSONSchema *GINISessionSchema(void) {
+    static GINIJSONSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        GINIJSONSchema *string = [GINIJSONSchema stringSchema];
+        schema = [GINIJSONSchema objectSchemaWithKeys:@[@"access_token", @"refresh_token", @"expires_in"]
+                                              schemas:@[string, string, [GINIJSONSchema numberSchema]]
+                                                build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            // Seconds until the session expires.
+            NSDate *expirationDate = [NSDate dateWithTimeIntervalSinceNow:[fields[2] doubleValue]];
+            return [[GINISession alloc] initWithAccessToken:fields[0] refreshToken:fields[1] expirationDate:expirationDate];
+        }];
+    });
+    return schema;
+}
+
+
+@implementation GINIResourceDecoder {
+    GINIJSONSchema *_documentSchema;
+    GINIJSONSchema *_documentsSchema;
+}
+
+#pragma mark - Factory
++ (instancetype)resourceDecoderWithDocumentManager:(GINIDocumentTaskManager *)documentManager {
+    return [[self alloc] initWithDocumentManager:documentManager];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentManager:(GINIDocumentTaskManager *)documentManager {
+    self = [super init];
+    if (self) {
+        _documentSchema = GINIDocumentSchema(documentManager);
+        _documentsSchema = [GINIJSONSchema objectSchemaWithKeys:@[@"documents", @"totalCount"]
+                                                        schemas:@[[GINIJSONSchema arraySchemaWithElements:_documentSchema], [GINIJSONSchema numberSchema]]
+                                                          build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            return @[fields[0] ?: @[], fields[1] ?: [NSNull null]];
+        }];
+    }
+    return self;
+}
+
+#pragma mark - Decoding
+- (GINIDocument *)documentWithData:(NSData *)data error:(NSError **)error {
+    return [GINIJSONDecoder objectWithData:data schema:_documentSchema error:error];
+}
+
+- (NSArray<GINIDocument *> *)documentsWithData:(NSData *)data totalCount:(NSUInteger *)totalCount error:(NSError **)error {
+    NSArray *list = [GINIJSONDecoder objectWithData:data schema:_documentsSchema error:error];
+    if (!list) {
+        return nil;
+    }
+    if (totalCount && [list[1] isKindOfClass:[NSNumber class]]) {
+        *totalCount = [list[1] unsignedIntegerValue];
+    }
+    return list[0];
+}
+
++ (NSMutableDictionary *)extractionsWithData:(NSData *)data error:(NSError **)error {
+    return [GINIJSONDecoder objectWithData:data schema:GINIExtractionsSchema() error:error];
+}
+
++ (GINISession *)sessionWithData:(NSData *)data error:(NSError **)error {
+    return [GINIJSONDecoder objectWithData:data schema:GINISessionSchema() error:error];
+}
+
+@end
@@ -236,6 +236,28 @@
  */
 - (instancetype)useNotificationCenter:(NSNotificationCenter *)notificationCenter;
 
+/**
+ * Set the quality of service of the queue on which the SDK decodes the responses of the Gini API and creates the
+ * models (documents, extractions, layouts). The queue is concurrent, so several responses are decoded at the same
+ * time, and it is never the main queue. Defaults to `NSQualityOfServiceUserInitiated`.
+ *
+ * This method returns the instance on which it is called, so it is possible to chain the configuration via builder
+ * methods.
+ */
+- (instancetype)useDecodingQualityOfService:(NSQualityOfService)qualityOfService;
+
+/**
+ * Set the queue on which the tasks returned by the `GINIDocumentTaskManager` are completed, e.g. the main queue, so
+ * continuations with the default executor run there without any JSON work happening on it. By default the tasks are
+ * completed on the decoding queue (see `useDecodingQualityOfService:`).
+ *
+ * Don't wait for tasks (e.g. with `-[BFTask waitUntilFinished]`) on a serial result queue, it would never complete them.
+ *
+ * This method returns the instance on which it is called, so it is possible to chain the configuration via builder
+ * methods.
+ */
+- (instancetype)useResultQueue:(dispatch_queue_t)queue;
+
 /**
  * Creates and returns the GiniSDK instance.
  */
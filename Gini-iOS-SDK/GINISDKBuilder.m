@@ -13,6 +13,33 @@
 NSString *const GINIEmailDomainKey = @"emailDomain";
 
 
+/**
+ * Creates the executor of a new concurrent queue with the given quality of service, on which the responses are decoded.
+ */
+static BFExecutor *GINIDecodingExecutor(NSQualityOfService qualityOfService) {
+    qos_class_t qosClass;
+    switch (qualityOfService) {
+        case NSQualityOfServiceUserInteractive:
+            qosClass = QOS_CLASS_USER_INTERACTIVE;
+            break;
+        case NSQualityOfServiceUserInitiated:
+            qosClass = QOS_CLASS_USER_INITIATED;
+            break;
+        case NSQualityOfServiceUtility:
+            qosClass = QOS_CLASS_UTILITY;
+            break;
+        case NSQualityOfServiceBackground:
+            qosClass = QOS_CLASS_BACKGROUND;
+            break;
+        default:
+            qosClass = QOS_CLASS_DEFAULT;
+            break;
+    }
+    dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_CONCURRENT, qosClass, 0);
+    return [BFExecutor executorWithDispatchQueue:dispatch_queue_create("net.gini.decoding", attributes)];
+}
+
+
 GINIInjector* GINIDefaultInjector() {
     GINIInjector *injector = [GINIInjector new];
 
@@ -230,6 +257,8 @@ GINIInjector* GINIDefaultInjector() {
         _injector = GINIDefaultInjector();
         [_injector setObject:clientID forKey:GINIInjectorClientIDKey];
         
+        [_injector setObject:GINIDecodingExecutor(NSQualityOfServiceUserInitiated) forKey:GINIInjectorDecodingExecutorKey];
+
         GINIAPI *api = [GINIAPIFactory apiWith:apiType];
         [_injector setObject:api.baseUrl forKey:GINIInjectorAPIBaseURLKey];
         [_injector setObject:api forKey:GINIInjectorAPIKey];
@@ -269,6 +298,18 @@ GINIInjector* GINIDefaultInjector() {
     return self;
 }
 
+- (instancetype)useDecodingQualityOfService:(NSQualityOfService)qualityOfService {
+    [_injector setObject:GINIDecodingExecutor(qualityOfService) forKey:GINIInjectorDecodingExecutorKey];
+    return self;
+}
+
+- (instancetype)useResultQueue:(dispatch_queue_t)queue {
+    NSParameterAssert(queue);
+
+    [_injector setObject:[BFExecutor executorWithDispatchQueue:queue] forKey:GINIInjectorResultExecutorKey];
+    return self;
+}
+
 
 - (GiniSDK *)build {
     return [[GiniSDK alloc] initWithInjector:_injector];
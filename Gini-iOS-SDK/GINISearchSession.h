@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class GINIDocument;
+@class GINIDocumentTaskManager;
+
+
+/**
+ * The result of a document search.
+ */
+@interface GINISearchResult : NSObject
+
+/**
+ * Factory to create a new search result.
+ *
+ * @param query         The normalized query.
+ * @param documents     The found documents.
+ * @param totalCount    The total number of found documents, which may be larger than the number of `documents`.
+ * @param provisional   Whether the result is a provisional one (see `provisional`).
+ */
++ (instancetype)searchResultWithQuery:(NSString *)query
+                            documents:(NSArray<GINIDocument *> *)documents
+                           totalCount:(NSUInteger)totalCount
+                          provisional:(BOOL)provisional;
+
+/// The normalized query.
+@property (readonly) NSString *query;
+
+/// The found documents.
+@property (readonly) NSArray<GINIDocument *> *documents;
+
+/// The total number of found documents, which may be larger than the number of `documents`.
+@property (readonly) NSUInteger totalCount;
+
+/**
+ * YES if this is the cached result of a shorter query (a prefix of `query`), which is shown while the result of the
+ * query itself is loading. The final result only contains documents matching all of the words.
+ */
+@property (readonly, getter=isProvisional) BOOL provisional;
+
+@end
+
+
+/**
+ * A `GINISearchSession` searches documents while the user is typing the query.
+ *
+ * The search request is only made when the query has not changed for `debounceInterval` seconds, and a request whose
+ * query has been superseded is cancelled, including the HTTP request. The results are cached per normalized query (see
+ * `normalizedQuery:`), and while the result of a query is loading, the cached result of the longest shorter query is
+ * reported as a provisional result.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINISearchSession : NSObject
+
+/**
+ * Factory to create a new search session.
+ *
+ * @param documentTaskManager   The document task manager used to search the documents.
+ */
++ (instancetype)searchSessionWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager;
+
+/**
+ * The designated initializer.
+ *
+ * @param documentTaskManager   The document task manager used to search the documents.
+ */
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager;
+
+/// The time in seconds the query must be unchanged before the search request is made. Defaults to 0.3.
+@property NSTimeInterval debounceInterval;
+
+/// The maximum number of documents per search result. Defaults to 20.
+@property NSUInteger resultLimit;
+
+/// Restricts the search to a specific doctype. Changing it clears the cache. Defaults to nil.
+@property (nonatomic, copy) NSString *docType;
+
+/// The maximum number of cached results; the least recently used results are removed first. Defaults to 32.
+@property (nonatomic) NSUInteger cacheCapacity;
+
+/**
+ * Called on the main thread with the provisional and the final results of the current query. Results of superseded
+ * queries are never reported.
+ */
+@property (copy) void (^resultBlock)(GINISearchResult *result);
+
+/**
+ * Sets the current query, e.g. whenever the text of the search field changes. Supersedes the previous query.
+ *
+ * @param query     The query.
+ *
+ * @returns         A `BFTask*` resolving to the final `GINISearchResult` of the query, or a cancelled task if the
+ *                  query has been superseded.
+ */
+- (BFTask *)searchWithQuery:(NSString *)query;
+
+/**
+ * Cancels the current query.
+ */
+- (void)cancel;
+
+/**
+ * Removes all cached results.
+ */
+- (void)clearCache;
+
+/**
+ * Returns the normalized form of the given query: lowercased, with the whitespace at the ends trimmed and collapsed
+ * between the words. Queries with the same normalized form share their results.
+ *
+ * @param query     The query.
+ */
++ (NSString *)normalizedQuery:(NSString *)query;
+
+@end
@@ -0,0 +1,244 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINISearchSession.h"
+#import "GINIDocumentTaskManager.h"
+
+
+@implementation GINISearchResult
+
+#pragma mark - Factory
++ (instancetype)searchResultWithQuery:(NSString *)query
+                            documents:(NSArray<GINIDocument *> *)documents
+                           totalCount:(NSUInteger)totalCount
+                          provisional:(BOOL)provisional {
+    return [[self alloc] initWithQuery:query documents:documents totalCount:totalCount provisional:provisional];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithQuery:(NSString *)query
+                    documents:(NSArray<GINIDocument *> *)documents
+                   totalCount:(NSUInteger)totalCount
+                  provisional:(BOOL)provisional {
+    NSParameterAssert([query isKindOfClass:[NSString class]]);
+    NSParameterAssert([documents isKindOfClass:[NSArray class]]);
+
+    self = [super init];
+    if (self) {
+        _query = [query copy];
+        _documents = [documents copy];
+        _totalCount = totalCount;
+        _provisional = provisional;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINISearchResult \"%@\" documents=%lu total=%lu%@>", _query,
+            (unsigned long)[_documents count], (unsigned long)_totalCount, _provisional ? @" provisional" : @""];
+}
+
+@end
+
+
+@implementation GINISearchSession {
+    GINIDocumentTaskManager *_documentTaskManager;
+    /// The cancellation token source of the current query.
+    BFCancellationTokenSource *_cancellationTokenSource;
+    /// The cached results with the normalized query as key.
+    NSMutableDictionary<NSString *, GINISearchResult *> *_cache;
+    /// The keys of the cache, the most recently used one last.
+    NSMutableArray<NSString *> *_cacheOrder;
+}
+
+#pragma mark - Factory
++ (instancetype)searchSessionWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager {
+    return [[self alloc] initWithDocumentTaskManager:documentTaskManager];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager {
+    NSParameterAssert([documentTaskManager isKindOfClass:[GINIDocumentTaskManager class]]);
+
+    self = [super init];
+    if (self) {
+        _documentTaskManager = documentTaskManager;
+        _debounceInterval = 0.3;
+        _resultLimit = 20;
+        _cacheCapacity = 32;
+        _cache = [NSMutableDictionary new];
+        _cacheOrder = [NSMutableArray new];
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSString *)docType {
+    @synchronized (self) {
+        return _docType;
+    }
+}
+
+- (void)setDocType:(NSString *)docType {
+    @synchronized (self) {
+        if (docType == _docType || [docType isEqualToString:_docType]) {
+            return;
+        }
+        _docType = [docType copy];
+        [self clearCache];
+    }
+}
+
+- (NSUInteger)cacheCapacity {
+    @synchronized (self) {
+        return _cacheCapacity;
+    }
+}
+
+- (void)setCacheCapacity:(NSUInteger)cacheCapacity {
+    @synchronized (self) {
+        _cacheCapacity = cacheCapacity;
+        [self trimCache];
+    }
+}
+
+#pragma mark - Searching
+- (BFTask *)searchWithQuery:(NSString *)query {
+    NSParameterAssert([query isKindOfClass:[NSString class]]);
+
+    NSString *normalizedQuery = [[self class] normalizedQuery:query];
+    BFCancellationTokenSource *cancellationTokenSource = [BFCancellationTokenSource cancellationTokenSource];
+    GINISearchResult *cachedResult;
+    GINISearchResult *prefixResult;
+    NSString *docType;
+    @synchronized (self) {
+        [_cancellationTokenSource cancel];
+        _cancellationTokenSource = cancellationTokenSource;
+        docType = _docType;
+        cachedResult = [self cachedResultForQuery:normalizedQuery];
+        if (!cachedResult) {
+            prefixResult = [self cachedResultForLongestPrefixOfQuery:normalizedQuery];
+        }
+    }
+
+    if ([normalizedQuery length] == 0) {
+        cachedResult = [GINISearchResult searchResultWithQuery:normalizedQuery documents:@[] totalCount:0 provisional:NO];
+    }
+    if (cachedResult) {
+        [self reportResult:cachedResult cancellationToken:cancellationTokenSource.token];
+        return [BFTask taskWithResult:cachedResult];
+    }
+    if (prefixResult) {
+        [self reportResult:[GINISearchResult searchResultWithQuery:normalizedQuery
+                                                         documents:prefixResult.documents
+                                                        totalCount:prefixResult.totalCount
+                                                       provisional:YES]
+         cancellationToken:cancellationTokenSource.token];
+    }
+
+    // The request is only made if the query is not superseded during the delay. A superseded request is cancelled
+    // with the token, which also cancels the HTTP request.
+    BFCancellationToken *cancellationToken = cancellationTokenSource.token;
+    NSUInteger limit = MAX(self.resultLimit, 1);
+    return [[[BFTask taskWithDelay:(int)(self.debounceInterval * 1000) cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
+        return [self->_documentTaskManager searchDocumentsWithTerm:normalizedQuery
+                                                           docType:docType
+                                                             limit:limit
+                                                            offset:0
+                                                 cancellationToken:cancellationToken];
+    } cancellationToken:cancellationToken] continueWithSuccessBlock:^id(BFTask *task) {
+        GINISearchResult *result = task.result;
+        @synchronized (self) {
+            // Results of an outdated doctype must not end up in the cache.
+            if (docType == self->_docType || [docType isEqualToString:self->_docType]) {
+                [self cacheResult:result];
+            }
+        }
+        [self reportResult:result cancellationToken:cancellationToken];
+        return result;
+    } cancellationToken:cancellationToken];
+}
+
+- (void)cancel {
+    @synchronized (self) {
+        [_cancellationTokenSource cancel];
+        _cancellationTokenSource = nil;
+    }
+}
+
+/**
+ * Reports the result on the main thread, unless the query has been superseded in the meantime.
+ */
+- (void)reportResult:(GINISearchResult *)result cancellationToken:(BFCancellationToken *)cancellationToken {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        void (^resultBlock)(GINISearchResult *) = self.resultBlock;
+        if (resultBlock && !cancellationToken.cancellationRequested) {
+            resultBlock(result);
+        }
+    });
+}
+
++ (NSString *)normalizedQuery:(NSString *)query {
+    NSArray *words = [[query lowercaseString] componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    words = [words filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+    return [[words componentsJoinedByString:@" "] precomposedStringWithCanonicalMapping];
+}
+
+#pragma mark - Cache
+
+- (void)clearCache {
+    @synchronized (self) {
+        [_cache removeAllObjects];
+        [_cacheOrder removeAllObjects];
+    }
+}
+
+/**
+ * Returns the cached result of the query and marks it as the most recently used one. Must be called while synchronized.
+ */
+- (GINISearchResult *)cachedResultForQuery:(NSString *)query {
+    GINISearchResult *result = _cache[query];
+    if (result) {
+        [_cacheOrder removeObject:query];
+        [_cacheOrder addObject:query];
+    }
+    return result;
+}
+
+/**
+ * Returns the cached result of the longest query which is a prefix of the given one. Must be called while synchronized.
+ */
+- (GINISearchResult *)cachedResultForLongestPrefixOfQuery:(NSString *)query {
+    NSString *longestPrefix;
+    for (NSString *cachedQuery in _cacheOrder) {
+        if ([cachedQuery length] > 0 && [query hasPrefix:cachedQuery] && [cachedQuery length] > [longestPrefix length]) {
+            longestPrefix = cachedQuery;
+        }
+    }
+    return longestPrefix ? [self cachedResultForQuery:longestPrefix] : nil;
+}
+
+/**
+ * Must be called while synchronized.
+ */
+- (void)cacheResult:(GINISearchResult *)result {
+    [_cacheOrder removeObject:result.query];
+    [_cacheOrder addObject:result.query];
+    _cache[result.query] = result;
+    [self trimCache];
+}
+
+/**
+ * Removes the least recently used results until the cache is within its capacity. Must be called while synchronized.
+ */
+- (void)trimCache {
+    while ([_cacheOrder count] > _cacheCapacity) {
+        [_cache removeObjectForKey:[_cacheOrder firstObject]];
+        [_cacheOrder removeObjectAtIndex:0];
+    }
+}
+
+@end
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class GINITracer;
+
+
+/// The HTTP header field that carries the trace context ([W3C Trace Context](https://www.w3.org/TR/trace-context/)).
+extern NSString *const GINITraceParentHeaderField;
+
+/// The kind of spans that represent outgoing HTTP requests.
+extern NSString *const GINISpanKindClient;
+
+
+/**
+ * A `GINISpan` represents a timed operation, e.g. a high level operation of the `GINIDocumentTaskManager` or a single
+ * HTTP request. Spans form a tree: all spans that belong to the same user action share the same `traceId`.
+ *
+ * Spans are created by a `GINITracer`. Call `finish` (or `finishWithError:`) when the operation is done, so the span
+ * is collected by its tracer.
+ */
+@interface GINISpan : NSObject
+
+/// The 32 hex digits identifier of the trace the span belongs to.
+@property (readonly) NSString *traceId;
+
+/// The 16 hex digits identifier of the span.
+@property (readonly) NSString *spanId;
+
+/// The identifier of the parent span or nil for root spans.
+@property (readonly) NSString *parentSpanId;
+
+/// The name of the operation.
+@property (readonly) NSString *name;
+
+/// The kind of the span, e.g. `GINISpanKindClient` for HTTP requests, or nil.
+@property NSString *kind;
+
+/// The wall clock time when the span was started.
+@property (readonly) NSDate *startDate;
+
+/// The duration in seconds, or 0 if the span is not finished yet.
+@property (readonly) NSTimeInterval duration;
+
+/// Whether the span has been finished.
+@property (readonly, getter=isFinished) BOOL finished;
+
+/// Additional information about the operation, e.g. the HTTP status code.
+@property (readonly) NSDictionary<NSString *, NSString *> *tags;
+
+/// The value of the `traceparent` HTTP header that makes the receiver the parent of the server side spans.
+@property (readonly) NSString *traceParentHeaderValue;
+
+/**
+ * The span which is active on the current thread or nil if there is none. See `GINISpanPerform`.
+ */
++ (GINISpan *)currentSpan;
+
+/**
+ * Sets a tag.
+ *
+ * @param value     The tag's value.
+ * @param key       The tag's name, e.g. "http.status_code".
+ */
+- (void)setTag:(NSString *)value forKey:(NSString *)key;
+
+/**
+ * Finishes the span. Finishing a span more than once has no effect.
+ */
+- (void)finish;
+
+/**
+ * Finishes the span and tags it with the given error.
+ *
+ * @param error     The error which made the operation fail.
+ */
+- (void)finishWithError:(NSError *)error;
+
+/**
+ * A dictionary representation of the span in the [Zipkin v2](https://zipkin.io/zipkin-api/#/default/post_spans) JSON
+ * format.
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
+
+
+/**
+ * Calls the given block while the given span is the current span (see `GINISpan currentSpan`) of the calling thread.
+ * Use this in task continuations to restore the span that was current when the continuation was created.
+ *
+ * @param span      The span that is the current span while the block runs. If nil, the block is called as it is.
+ * @param block     The block that is called synchronously.
+ *
+ * @returns         The return value of the block.
+ */
+id GINISpanPerform(GINISpan *span, id (^block)(void));
+
+
+/**
+ * The `GINITracer` creates spans and collects the finished ones so they can be exported for offline analysis.
+ *
+ * If a tracer is set on the `GINIDocumentTaskManager`, every operation of the document task manager is recorded as a
+ * span, and every HTTP request issued by the operation is recorded as a child span and carries the trace context in
+ * the `traceparent` HTTP header, which makes it possible to correlate the requests with the server logs.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINITracer : NSObject
+
+/**
+ * The maximum number of finished spans that are kept. If there are more finished spans, the oldest ones are dropped.
+ * Defaults to 10000.
+ */
+@property NSUInteger maximumSpanCount;
+
+/// The finished spans in the order they were finished.
+@property (readonly) NSArray<GINISpan *> *finishedSpans;
+
+/**
+ * Starts a new span which is a child of the current span (see `GINISpan currentSpan`) or a new root span if there is
+ * no current span.
+ *
+ * @param name      The name of the operation.
+ */
+- (GINISpan *)startSpanWithName:(NSString *)name;
+
+/**
+ * Starts a new span.
+ *
+ * @param name      The name of the operation.
+ * @param parent    The parent span or nil to start a new trace.
+ */
+- (GINISpan *)startSpanWithName:(NSString *)name parent:(GINISpan *)parent;
+
+/**
+ * Starts a new span which continues the trace of the given `traceparent` header value, e.g. of an incoming request
+ * or a request that was created by the app itself.
+ *
+ * @param name          The name of the operation.
+ * @param traceParent   The value of a `traceparent` header. If it is invalid, a new trace is started.
+ */
+- (GINISpan *)startSpanWithName:(NSString *)name traceParent:(NSString *)traceParent;
+
+/**
+ * Exports the finished spans as a JSON array in the [Zipkin v2](https://zipkin.io/zipkin-api/) format.
+ *
+ * @param remove    Whether the exported spans are removed from the tracer.
+ */
+- (NSData *)exportFinishedSpansRemovingThem:(BOOL)remove;
+
+/**
+ * Removes all finished spans.
+ */
+- (void)removeAllSpans;
+
+@end
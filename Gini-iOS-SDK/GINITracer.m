@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINITracer.h"
+#import "GINIHistogram.h"
+
+
+NSString *const GINITraceParentHeaderField = @"traceparent";
+NSString *const GINISpanKindClient = @"CLIENT";
+
+/// The key of the current span in the thread dictionary.
+static NSString *const GINICurrentSpanKey = @"net.gini.tracing.currentSpan";
+
+/// The service name which is used in the exported spans.
+static NSString *const GINITracingServiceName = @"gini-sdk-ios";
+
+/**
+ * Returns a random identifier with the given number of bytes as a string of lower case hex digits.
+ */
+static NSString *GINIRandomHexIdentifier(NSUInteger byteCount) {
+    uint8_t bytes[16];
+    NSCParameterAssert(byteCount <= sizeof(bytes));
+    arc4random_buf(bytes, byteCount);
+    NSMutableString *identifier = [NSMutableString stringWithCapacity:byteCount * 2];
+    for (NSUInteger i = 0; i < byteCount; i++) {
+        [identifier appendFormat:@"%02x", bytes[i]];
+    }
+    return identifier;
+}
+
+/**
+ * Returns YES if the given string consists of exactly the given number of lower case hex digits.
+ */
+static BOOL GINIIsHexIdentifier(NSString *string, NSUInteger length) {
+    static NSCharacterSet *nonHexCharacters;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        nonHexCharacters = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    });
+    return [string length] == length && [string rangeOfCharacterFromSet:nonHexCharacters].location == NSNotFound;
+}
+
+
+@interface GINITracer ()
+- (void)collectSpan:(GINISpan *)span;
+@end
+
+
+@implementation GINISpan {
+    __weak GINITracer *_tracer;
+    NSTimeInterval _startTimestamp;
+    NSMutableDictionary<NSString *, NSString *> *_tags;
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithTracer:(GINITracer *)tracer
+                          name:(NSString *)name
+                       traceId:(NSString *)traceId
+                  parentSpanId:(NSString *)parentSpanId {
+    NSParameterAssert([name isKindOfClass:[NSString class]]);
+
+    self = [super init];
+    if (self) {
+        _tracer = tracer;
+        _name = [name copy];
+        _traceId = traceId ?: GINIRandomHexIdentifier(16);
+        _spanId = GINIRandomHexIdentifier(8);
+        _parentSpanId = parentSpanId;
+        _startDate = [NSDate date];
+        _startTimestamp = GINIMonotonicTimestamp();
+        _tags = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Current span
++ (GINISpan *)currentSpan {
+    return [[NSThread currentThread] threadDictionary][GINICurrentSpanKey];
+}
+
+#pragma mark - Properties
+- (NSDictionary *)tags {
+    @synchronized (self) {
+        return [_tags copy];
+    }
+}
+
+- (NSString *)traceParentHeaderValue {
+    return [NSString stringWithFormat:@"00-%@-%@-01", _traceId, _spanId];
+}
+
+#pragma mark - Public methods
+- (void)setTag:(NSString *)value forKey:(NSString *)key {
+    NSParameterAssert([key isKindOfClass:[NSString class]]);
+
+    @synchronized (self) {
+        _tags[key] = [value description];
+    }
+}
+
+- (void)finish {
+    @synchronized (self) {
+        if (_finished) {
+            return;
+        }
+        _duration = GINIMonotonicTimestamp() - _startTimestamp;
+        _finished = YES;
+    }
+    [_tracer collectSpan:self];
+}
+
+- (void)finishWithError:(NSError *)error {
+    [self setTag:[NSString stringWithFormat:@"%@ %ld", error.domain, (long)error.code] forKey:@"error"];
+    [self finish];
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    NSMutableDictionary *dictionary = [NSMutableDictionary new];
+    dictionary[@"traceId"] = _traceId;
+    dictionary[@"id"] = _spanId;
+    dictionary[@"name"] = _name;
+    dictionary[@"timestamp"] = @((long long)([_startDate timeIntervalSince1970] * USEC_PER_SEC));
+    dictionary[@"duration"] = @((long long)(self.duration * USEC_PER_SEC));
+    dictionary[@"localEndpoint"] = @{@"serviceName": GINITracingServiceName};
+    if (_parentSpanId) {
+        dictionary[@"parentId"] = _parentSpanId;
+    }
+    if (self.kind) {
+        dictionary[@"kind"] = self.kind;
+    }
+    NSDictionary *tags = self.tags;
+    if ([tags count] > 0) {
+        dictionary[@"tags"] = tags;
+    }
+    return dictionary;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<GINISpan %@ trace=%@ id=%@>", _name, _traceId, _spanId];
+}
+
+@end
+
+
+id GINISpanPerform(GINISpan *span, id (^block)(void)) {
+    if (!span) {
+        return block();
+    }
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    GINISpan *previousSpan = threadDictionary[GINICurrentSpanKey];
+    threadDictionary[GINICurrentSpanKey] = span;
+    @try {
+        return block();
+    }
+    @finally {
+        if (previousSpan) {
+            threadDictionary[GINICurrentSpanKey] = previousSpan;
+        } else {
+            [threadDictionary removeObjectForKey:GINICurrentSpanKey];
+        }
+    }
+}
+
+
+@implementation GINITracer {
+    NSMutableArray<GINISpan *> *_finishedSpans;
+}
+
+#pragma mark - Initializer
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _finishedSpans = [NSMutableArray new];
+        _maximumSpanCount = 10000;
+    }
+    return self;
+}
+
+#pragma mark - Creating spans
+- (GINISpan *)startSpanWithName:(NSString *)name {
+    return [self startSpanWithName:name parent:[GINISpan currentSpan]];
+}
+
+- (GINISpan *)startSpanWithName:(NSString *)name parent:(GINISpan *)parent {
+    return [[GINISpan alloc] initWithTracer:self name:name traceId:parent.traceId parentSpanId:parent.spanId];
+}
+
+- (GINISpan *)startSpanWithName:(NSString *)name traceParent:(NSString *)traceParent {
+    // The header has the format "version-traceId-parentId-flags", e.g. "00-<32 hex digits>-<16 hex digits>-01".
+    NSArray *components = [traceParent componentsSeparatedByString:@"-"];
+    if ([components count] == 4 && GINIIsHexIdentifier(components[1], 32) && GINIIsHexIdentifier(components[2], 16)) {
+        return [[GINISpan alloc] initWithTracer:self name:name traceId:components[1] parentSpanId:components[2]];
+    }
+    return [self startSpanWithName:name parent:nil];
+}
+
+#pragma mark - Finished spans
+- (NSArray *)finishedSpans {
+    @synchronized (_finishedSpans) {
+        return [_finishedSpans copy];
+    }
+}
+
+- (void)collectSpan:(GINISpan *)span {
+    @synchronized (_finishedSpans) {
+        [_finishedSpans addObject:span];
+        if ([_finishedSpans count] > self.maximumSpanCount) {
+            [_finishedSpans removeObjectsInRange:NSMakeRange(0, [_finishedSpans count] - self.maximumSpanCount)];
+        }
+    }
+}
+
+- (NSData *)exportFinishedSpansRemovingThem:(BOOL)remove {
+    NSArray *spans;
+    @synchronized (_finishedSpans) {
+        spans = [_finishedSpans copy];
+        if (remove) {
+            [_finishedSpans removeAllObjects];
+        }
+    }
+
+    NSMutableArray *exportedSpans = [NSMutableArray arrayWithCapacity:[spans count]];
+    for (GINISpan *span in spans) {
+        [exportedSpans addObject:[span dictionaryRepresentation]];
+    }
+    return [NSJSONSerialization dataWithJSONObject:exportedSpans options:0 error:nil];
+}
+
+- (void)removeAllSpans {
+    @synchronized (_finishedSpans) {
+        [_finishedSpans removeAllObjects];
+    }
+}
+
+@end
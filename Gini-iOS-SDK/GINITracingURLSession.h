@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import "GINIURLSession.h"
+
+@class GINITracer;
+
+
+/**
+ * The `GINITracingURLSession` wraps another <GINIURLSession> and records every request as a span of the given tracer.
+ *
+ * If the request has a `traceparent` HTTP header, the span of the request becomes a child of the span referenced by
+ * the header. The header of the request which is passed to the wrapped session is replaced with a reference to the
+ * request's span, so the server side can attach its logs to it.
+ *
+ * Usually you don't use this class directly. The `GINIAPIManager` uses it when a tracer is set.
+ */
+@interface GINITracingURLSession : NSObject <GINIURLSession>
+
+/**
+ * Factory to create a new tracing URL session.
+ *
+ * @param urlSession    The URL session that does the actual requests.
+ * @param tracer        The tracer that records the spans of the requests.
+ */
++ (instancetype)tracingURLSessionWithURLSession:(id<GINIURLSession>)urlSession tracer:(GINITracer *)tracer;
+
+/**
+ * The designated initializer.
+ *
+ * @param urlSession    The URL session that does the actual requests.
+ * @param tracer        The tracer that records the spans of the requests.
+ */
+- (instancetype)initWithURLSession:(id<GINIURLSession>)urlSession tracer:(GINITracer *)tracer;
+
+/// The URL session that does the actual requests.
+@property (readonly) id<GINIURLSession> urlSession;
+
+@end
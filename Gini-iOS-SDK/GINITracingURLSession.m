@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINITracingURLSession.h"
+#import "GINITracer.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+
+
+@implementation GINITracingURLSession {
+    GINITracer *_tracer;
+}
+
+#pragma mark - Factory
++ (instancetype)tracingURLSessionWithURLSession:(id<GINIURLSession>)urlSession tracer:(GINITracer *)tracer {
+    return [[self alloc] initWithURLSession:urlSession tracer:tracer];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithURLSession:(id<GINIURLSession>)urlSession tracer:(GINITracer *)tracer {
+    NSParameterAssert([urlSession conformsToProtocol:@protocol(GINIURLSession)]);
+    NSParameterAssert([tracer isKindOfClass:[GINITracer class]]);
+
+    self = [super init];
+    if (self) {
+        _urlSession = urlSession;
+        _tracer = tracer;
+    }
+    return self;
+}
+
+#pragma mark - GINIURLSession protocol
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request {
+    return [self traceRequest:request usingBlock:^BFTask *(NSURLRequest *tracedRequest) {
+        return [self->_urlSession BFDataTaskWithRequest:tracedRequest];
+    }];
+}
+
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self traceRequest:request usingBlock:^BFTask *(NSURLRequest *tracedRequest) {
+        return GINIDataTaskWithRequest(self->_urlSession, tracedRequest, cancellationToken);
+    }];
+}
+
+- (BFTask *)BFStreamingDataTaskWithRequest:(NSURLRequest *)request
+                                 dataBlock:(BOOL (^)(NSData *data))dataBlock
+                         cancellationToken:(BFCancellationToken *)cancellationToken {
+    return [self traceRequest:request usingBlock:^BFTask *(NSURLRequest *tracedRequest) {
+        return GINIStreamingDataTaskWithRequest(self->_urlSession, tracedRequest, dataBlock, cancellationToken);
+    }];
+}
+
+- (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
+    return [self traceRequest:request usingBlock:^BFTask *(NSURLRequest *tracedRequest) {
+        return [self->_urlSession BFDownloadTaskWithRequest:tracedRequest];
+    }];
+}
+
+- (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
+    return [self traceRequest:request usingBlock:^BFTask *(NSURLRequest *tracedRequest) {
+        return [self->_urlSession BFUploadTaskWithRequest:tracedRequest fromData:uploadData];
+    }];
+}
+
+#pragma mark - Private methods
+- (BFTask *)traceRequest:(NSURLRequest *)request usingBlock:(BFTask *(^)(NSURLRequest *tracedRequest))block {
+    NSString *method = request.HTTPMethod ?: @"GET";
+    // Only the path is used as the name, the query may contain file names or search terms.
+    NSString *name = [NSString stringWithFormat:@"%@ %@", method, request.URL.path];
+    NSString *traceParent = [request valueForHTTPHeaderField:GINITraceParentHeaderField];
+    GINISpan *span = traceParent ? [_tracer startSpanWithName:name traceParent:traceParent] : [_tracer startSpanWithName:name];
+    span.kind = GINISpanKindClient;
+    [span setTag:method forKey:@"http.method"];
+    [span setTag:request.URL.path forKey:@"http.path"];
+
+    NSMutableURLRequest *tracedRequest = [request mutableCopy];
+    [tracedRequest setValue:span.traceParentHeaderValue forHTTPHeaderField:GINITraceParentHeaderField];
+
+    return [block(tracedRequest) continueWithBlock:^id(BFTask *task) {
+        GINIURLResponse *response = task.result;
+        if ([task.error isKindOfClass:[GINIHTTPError class]]) {
+            response = ((GINIHTTPError *)task.error).response;
+        }
+        if (response.response) {
+            [span setTag:[@(response.response.statusCode) stringValue] forKey:@"http.status_code"];
+        }
+        if (task.error) {
+            [span finishWithError:task.error];
+        } else {
+            if (task.cancelled) {
+                [span setTag:@"true" forKey:@"cancelled"];
+            }
+            [span finish];
+        }
+        return task;
+    }];
+}
+
+@end
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ * The `GINITrafficRecorder` captures the HTTP requests of a `GINIURLSession` together with the raw responses and their
+ * timing into a compact archive, which can be served back by a `GINIReplayURLSession`.
+ *
+ * To record a session, set the `recorder` property of the `GINIURLSession`. Only the method, the URL without its query
+ * (which may contain e.g. the summary of an error report or a token) and the body size of the requests are recorded,
+ * never the headers (which contain the access token) or the uploaded documents. The responses of the requests accepted
+ * by the `requestFilterBlock` are recorded completely, so archives contain document data and must be treated
+ * accordingly. Archives written with `writeToURL:error:` are protected with
+ * `NSFileProtectionCompleteUntilFirstUserAuthentication`.
+ *
+ * All methods of this class are thread-safe.
+ */
+@interface GINITrafficRecorder : NSObject
+
+/// The number of recorded requests.
+@property (readonly) NSUInteger entryCount;
+
+/**
+ * Returns NO for requests whose response headers and bodies must not be recorded. Only the timing and the status code
+ * of these requests are recorded. The default rejects the requests of the Gini User Center (paths starting with
+ * `/oauth/` or `/api/users`), whose responses contain the access and refresh tokens and the user's credentials.
+ */
+@property (copy) BOOL (^requestFilterBlock)(NSURLRequest *request);
+
+/**
+ * Records a request. Called by the `GINIURLSession` when the response has arrived.
+ *
+ * @param request           The request.
+ * @param uploadLength      The size of the request's body in bytes.
+ * @param startTimestamp    The monotonic timestamp when the request was started (see `GINIMonotonicTimestamp`).
+ * @param response          The response or nil if the request failed.
+ * @param body              The raw body of the response.
+ * @param error             The error if the request failed.
+ */
+- (void)recordRequest:(NSURLRequest *)request
+         uploadLength:(NSUInteger)uploadLength
+       startTimestamp:(NSTimeInterval)startTimestamp
+             response:(NSURLResponse *)response
+                 body:(NSData *)body
+                error:(NSError *)error;
+
+/**
+ * The recorded requests as a binary property list which can be passed to `GINIReplayURLSession`.
+ */
+- (NSData *)archivedData;
+
+/**
+ * Writes the archive (see `archivedData`) to the given file.
+ *
+ * @param url       The file URL.
+ * @param error     Set if writing the file failed.
+ */
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error;
+
+/**
+ * Removes all recorded requests and restarts the recording clock.
+ */
+- (void)reset;
+
+@end
@@ -0,0 +1,133 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINITrafficRecorder.h"
+#import "GINITrafficRecorder_Private.h"
+#import "GINIHistogram.h"
+
+
+NSInteger const GINITrafficArchiveVersion = 1;
+
+NSString *const GINITrafficArchiveVersionKey = @"version";
+NSString *const GINITrafficArchiveEntriesKey = @"entries";
+NSString *const GINITrafficEntryMethodKey = @"m";
+NSString *const GINITrafficEntryURLKey = @"u";
+NSString *const GINITrafficEntryUploadLengthKey = @"l";
+NSString *const GINITrafficEntryStartKey = @"t";
+NSString *const GINITrafficEntryDurationKey = @"d";
+NSString *const GINITrafficEntryStatusCodeKey = @"s";
+NSString *const GINITrafficEntryHeadersKey = @"h";
+NSString *const GINITrafficEntryBodyKey = @"b";
+NSString *const GINITrafficEntryErrorDomainKey = @"ed";
+NSString *const GINITrafficEntryErrorCodeKey = @"ec";
+
+NSString *GINITrafficRequestKey(NSString *method, NSURL *url) {
+    return [NSString stringWithFormat:@"%@ %@", method ?: @"GET", url.path];
+}
+
+/**
+ * Returns the URL without its query, since the query may contain user input or tokens.
+ */
+static NSString *GINITrafficRecordedURL(NSURL *url) {
+    NSURLComponents *components = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:YES];
+    components.query = nil;
+    components.fragment = nil;
+    return components.string ?: [url absoluteString];
+}
+
+
+@implementation GINITrafficRecorder {
+    NSMutableArray<NSDictionary *> *_entries;
+    NSTimeInterval _startTimestamp;
+}
+
+#pragma mark - Initializer
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _entries = [NSMutableArray new];
+        _startTimestamp = GINIMonotonicTimestamp();
+        _requestFilterBlock = ^BOOL(NSURLRequest *request) {
+            NSString *path = request.URL.path;
+            return !([path hasPrefix:@"/oauth/"] || [path hasPrefix:@"/api/users"]);
+        };
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSUInteger)entryCount {
+    @synchronized (_entries) {
+        return [_entries count];
+    }
+}
+
+#pragma mark - Recording
+- (void)recordRequest:(NSURLRequest *)request
+         uploadLength:(NSUInteger)uploadLength
+       startTimestamp:(NSTimeInterval)startTimestamp
+             response:(NSURLResponse *)response
+                 body:(NSData *)body
+                error:(NSError *)error {
+    NSParameterAssert([request isKindOfClass:[NSURLRequest class]]);
+
+    NSTimeInterval duration = GINIMonotonicTimestamp() - startTimestamp;
+    BOOL (^requestFilterBlock)(NSURLRequest *) = self.requestFilterBlock;
+    BOOL recordsContent = !requestFilterBlock || requestFilterBlock(request);
+    NSMutableDictionary *entry = [NSMutableDictionary new];
+    entry[GINITrafficEntryMethodKey] = request.HTTPMethod ?: @"GET";
+    entry[GINITrafficEntryURLKey] = GINITrafficRecordedURL(request.URL);
+    entry[GINITrafficEntryUploadLengthKey] = @(uploadLength);
+    entry[GINITrafficEntryDurationKey] = @(duration);
+    if (error) {
+        entry[GINITrafficEntryErrorDomainKey] = error.domain;
+        entry[GINITrafficEntryErrorCodeKey] = @(error.code);
+    }
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+        entry[GINITrafficEntryStatusCodeKey] = @(httpResponse.statusCode);
+        if (recordsContent) {
+            // Property lists only support string keys and values, which all HTTP headers are.
+            entry[GINITrafficEntryHeadersKey] = [httpResponse allHeaderFields];
+        }
+    }
+    if (body && recordsContent) {
+        entry[GINITrafficEntryBodyKey] = body;
+    }
+
+    @synchronized (_entries) {
+        entry[GINITrafficEntryStartKey] = @(startTimestamp - _startTimestamp);
+        [_entries addObject:entry];
+    }
+}
+
+#pragma mark - Archive
+- (NSData *)archivedData {
+    NSArray *entries;
+    @synchronized (_entries) {
+        entries = [_entries copy];
+    }
+    NSDictionary *archive = @{GINITrafficArchiveVersionKey: @(GINITrafficArchiveVersion),
+                              GINITrafficArchiveEntriesKey: entries};
+    return [NSPropertyListSerialization dataWithPropertyList:archive
+                                                      format:NSPropertyListBinaryFormat_v1_0
+                                                     options:0
+                                                       error:nil];
+}
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error {
+    return [[self archivedData] writeToURL:url
+                                   options:NSDataWritingAtomic | NSDataWritingFileProtectionCompleteUntilFirstUserAuthentication
+                                     error:error];
+}
+
+- (void)reset {
+    @synchronized (_entries) {
+        [_entries removeAllObjects];
+        _startTimestamp = GINIMonotonicTimestamp();
+    }
+}
+
+@end
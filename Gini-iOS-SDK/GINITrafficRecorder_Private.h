@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import "GINITrafficRecorder.h"
+
+/// The version of the archive format.
+extern NSInteger const GINITrafficArchiveVersion;
+
+/// The keys of the archive. The keys of the entries are kept short, since there is one set of keys per request.
+extern NSString *const GINITrafficArchiveVersionKey;
+extern NSString *const GINITrafficArchiveEntriesKey;
+extern NSString *const GINITrafficEntryMethodKey;
+extern NSString *const GINITrafficEntryURLKey;
+extern NSString *const GINITrafficEntryUploadLengthKey;
+extern NSString *const GINITrafficEntryStartKey;
+extern NSString *const GINITrafficEntryDurationKey;
+extern NSString *const GINITrafficEntryStatusCodeKey;
+extern NSString *const GINITrafficEntryHeadersKey;
+extern NSString *const GINITrafficEntryBodyKey;
+extern NSString *const GINITrafficEntryErrorDomainKey;
+extern NSString *const GINITrafficEntryErrorCodeKey;
+
+/**
+ * Returns the key which identifies the recorded requests that can answer the given request: the method and the path.
+ * The query is not recorded, and the host is ignored, so recordings can be replayed against another base URL.
+ */
+NSString *GINITrafficRequestKey(NSString *method, NSURL *url);
@@ -45,13 +45,34 @@
  */
 - (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse data:(id)responseData;
 
+/**
+ * Initializer for a response whose body is decoded lazily, on the first access of the `data` or the `parseError`
+ * property. Callers which only need the meta data of the response (e.g. the `Location` header) never pay for decoding.
+ *
+ * @param urlResponse       The `NSHTTPURLResponse` which will be the property `response`.
+ * @param rawData           The undecoded body of the HTTP response.
+ * @param decoder           Decodes the body, is called at most once and from the thread which first accesses the
+ *                          decoded data. If it returns nil, the `data` property is the raw data.
+ */
+- (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse
+                         rawData:(NSData *)rawData
+                         decoder:(id (^)(NSData *rawData, NSError **error))decoder;
+
 
 /**
  * The interpreted data, based on the content type of the response. See the `GINIURLSession` documentation for more
  * detailed information about the of the content-type deserialization of the data.
+ *
+ * If the response was created with a decoder, the body is decoded on the first access. Accessing the property from
+ * several threads at the same time is safe, the body is decoded only once.
  */
 @property id data;
 
+/**
+ * The undecoded body of the HTTP response, or nil if the response was created with already interpreted data.
+ */
+@property (readonly) NSData *rawData;
+
 /**
  * The NSHTTPURLResponse (including the HTTP headers and other meta data).
  */
@@ -60,7 +81,7 @@
 
 /**
  * If there has been an error while parsing the response (e.g. invalid JSON or a corrupted image), this property holds
- * the error which occurred.
+ * the error which occurred. Like `data`, it decodes the body on the first access.
  */
 @property NSError *parseError;
 
@@ -3,9 +3,17 @@
  *  All rights reserved.
  */
 
+#import <pthread.h>
 #import "GINIURLResponse.h"
 
-@implementation GINIURLResponse
+@implementation GINIURLResponse {
+    /// Guards the decoding of the body and the decoded data.
+    pthread_mutex_t _lock;
+    /// Decodes the raw data, nil once the raw data has been decoded (or if there is nothing to decode).
+    id (^_decoder)(NSData *rawData, NSError **error);
+    id _data;
+    NSError *_parseError;
+}
 
 #pragma mark - Factories
 + (instancetype)urlResponseWithResponse:(NSHTTPURLResponse *)urlResponse {
@@ -18,8 +26,16 @@
 
 
 #pragma mark - Initializers
-- (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse {
+- (instancetype)init {
     self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse {
+    self = [self init];
     if (self) {
         self.response = urlResponse;
     }
@@ -27,12 +43,81 @@
 }
 
 - (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse data:(id)responseData {
-    self = [super init];
+    self = [self init];
     if (self) {
         self.response = urlResponse;
-        self.data = responseData;
+        _data = responseData;
     }
     return self;
 }
 
-@end
\ No newline at end of file
+- (instancetype)initWithResponse:(NSHTTPURLResponse *)urlResponse
+                         rawData:(NSData *)rawData
+                         decoder:(id (^)(NSData *rawData, NSError **error))decoder {
+    NSParameterAssert(decoder);
+
+    self = [self init];
+    if (self) {
+        self.response = urlResponse;
+        _rawData = rawData;
+        _decoder = [decoder copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+
+#pragma mark - Properties
+- (id)data {
+    pthread_mutex_lock(&_lock);
+    [self decodeIfNeeded];
+    id data = _data;
+    pthread_mutex_unlock(&_lock);
+    return data;
+}
+
+- (void)setData:(id)data {
+    pthread_mutex_lock(&_lock);
+    // Setting the data replaces whatever the body would have been decoded to.
+    _decoder = nil;
+    _data = data;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSError *)parseError {
+    pthread_mutex_lock(&_lock);
+    [self decodeIfNeeded];
+    NSError *parseError = _parseError;
+    pthread_mutex_unlock(&_lock);
+    return parseError;
+}
+
+- (void)setParseError:(NSError *)parseError {
+    pthread_mutex_lock(&_lock);
+    _parseError = parseError;
+    pthread_mutex_unlock(&_lock);
+}
+
+
+#pragma mark - Private methods
+/**
+ * Decodes the raw data if that has not happened yet. Must be called with the lock held.
+ */
+- (void)decodeIfNeeded {
+    if (!_decoder) {
+        return;
+    }
+    NSError *error = nil;
+    id data = _decoder(_rawData, &error);
+    _decoder = nil;
+    // If the response could not be deserialized, just use the raw data.
+    _data = data ?: _rawData;
+    if (error) {
+        _parseError = error;
+    }
+}
+
+@end
@@ -6,6 +6,8 @@
 #import <Foundation/Foundation.h>
 
 @class BFTask;
+@class BFCancellationToken;
+@class GINITrafficRecorder;
 
 /**
  * The GINIURLSession is a small wrapper around Apple's NSURLSession. It wraps the Apple's HTTP tasks into BFTask* so
@@ -24,7 +26,8 @@
  *   - If the response has text contents, the data property is a NSString* with the contents of the HTTP body.
  *   - If the response has image contents, the data property is an UIImage*.
  *
- * In all other cases, the data property is a NSData* object containing the response's HTTP body.
+ * In all other cases, the data property is a NSData* object containing the response's HTTP body. The body is decoded
+ * on the first access of the data property, see `GINIURLResponse`.
  * If there have benn errors in the HTTP communication or in the response deserialization (e.g. due to an invalid JSON
  * response), the error property of the task is set accordingly.
  *
@@ -59,9 +62,47 @@
  * @param uploadData    The data that should be uploaded.
  */
 - (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData;
+
+@optional
+/**
+ * Same as `BFDataTaskWithRequest:`, but the HTTP request is cancelled when the given cancellation token is cancelled,
+ * in which case the returned task is cancelled as well.
+ *
+ * @param request               The HTTP request that should be done to get the data.
+ * @param cancellationToken     Cancellation token used to cancel the HTTP request.
+ */
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request cancellationToken:(BFCancellationToken *)cancellationToken;
+
+/**
+ * Same as `BFDataTaskWithRequest:cancellationToken:`, but the HTTP body is handed to the data block in parts as it
+ * arrives instead of being kept in memory. The BFTask* resolves to a `GINIURLResponse` object without data. If the HTTP
+ * status code is an error, the body is not handed to the data block, but the task fails with a `GINIHTTPError` as
+ * usual.
+ *
+ * @param request               The HTTP request that should be done to get the data.
+ * @param dataBlock             Called serially with each part of the body. If it returns NO, the HTTP request is
+ *                              cancelled and the task resolves without the remaining parts.
+ * @param cancellationToken     Cancellation token used to cancel the HTTP request.
+ */
+- (BFTask *)BFStreamingDataTaskWithRequest:(NSURLRequest *)request
+                                 dataBlock:(BOOL (^)(NSData *data))dataBlock
+                         cancellationToken:(BFCancellationToken *)cancellationToken;
 @end
 
 
+/**
+ * Does the given request with `BFDataTaskWithRequest:cancellationToken:` if the session implements it, otherwise with
+ * `BFDataTaskWithRequest:`, in which case the HTTP request is not cancelled, but the returned task is.
+ */
+BFTask *GINIDataTaskWithRequest(id<GINIURLSession> urlSession, NSURLRequest *request, BFCancellationToken *cancellationToken);
+
+/**
+ * Does the given request with `BFStreamingDataTaskWithRequest:dataBlock:cancellationToken:` if the session implements
+ * it, otherwise with `GINIDataTaskWithRequest`, in which case the whole body is handed to the data block at once.
+ */
+BFTask *GINIStreamingDataTaskWithRequest(id<GINIURLSession> urlSession, NSURLRequest *request, BOOL (^dataBlock)(NSData *data), BFCancellationToken *cancellationToken);
+
+
 /**
  * Gini's default implementation of the <GINIURLSession> protocol.
  */
@@ -88,4 +129,10 @@
  */
 - (instancetype)initWithNSURLSession:(NSURLSession *)urlSession;
 
+/**
+ * If set, all requests of this session are recorded together with their responses and timing, so they can be replayed
+ * later with a `GINIReplayURLSession`. Defaults to nil.
+ */
+@property GINITrafficRecorder *recorder;
+
 @end
@@ -9,6 +9,9 @@
 #import "GINIURLResponse.h"
 #import "GINIHTTPError.h"
 #import "GINIConstants.h"
+#import "GINITrafficRecorder.h"
+#import "GINIHistogram.h"
+#import "GINIJSONDecoder.h"
 
 
 #define GINI_DEFAULT_ENCODING NSUTF8StringEncoding
@@ -79,40 +82,53 @@ UIImage *GINIDeserializeImageResponse(NSData *rawData) {
     return [UIImage imageWithData:rawData];
 }
 
+/**
+ * Decodes a JSON response body. Large bodies are decoded with the faster `GINIJSONDecoder`, see
+ * `GINIJSONDecoderMinimumLength`.
+ */
 id GINIDeserializeJSONResponse(NSData *rawData, NSError **error) {
+    if ([rawData length] >= GINIJSONDecoderMinimumLength) {
+        return [GINIJSONDecoder JSONObjectWithData:rawData error:error];
+    }
     return [NSJSONSerialization JSONObjectWithData:rawData options:NSJSONReadingAllowFragments error:error];
 }
 
 
+/**
+ * Creates the response for the raw data. The body is not decoded here but on the first access of the `data` property
+ * of the response (see `-[GINIURLResponse initWithResponse:rawData:decoder:]`), so requests whose callers only look at
+ * the headers or the status code never decode their bodies. Errors while decoding are therefore reported through the
+ * `parseError` property of the response and not through the error argument.
+ */
 GINIURLResponse* GINIDeserializeResponse(NSURLResponse *response, NSData *rawData, NSError **error) {
-    GINIURLResponse *httpResult = [GINIURLResponse new];
-
     // Usually the response object is actually an instance of the sub class NSHTTPURLResponse, but we check to be
     // sure instead of doing a simple downcast.
-    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
-        httpResult.response = (NSHTTPURLResponse *) response;
-        // Fortunately, the Gini API uses correct content types.
-        NSString *contentType = [httpResult.response allHeaderFields][@"Content-Type"];
-        if (GINIIsJSONContent(contentType) && [rawData length] > 0) {
-            httpResult.data = GINIDeserializeJSONResponse(rawData, error);
-        } else if (GINIIsImageContent(contentType)) {
-            httpResult.data = GINIDeserializeImageResponse(rawData);
-        } else if (GINIIsTextContent(contentType) || GINIIsXMLContent(contentType)) {
-            httpResult.data = [[NSString alloc] initWithData:rawData encoding:GINI_DEFAULT_ENCODING];
-        }
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return [GINIURLResponse urlResponseWithResponse:nil data:rawData];
     }
 
-    // If the response could not be deserialized, just use the raw data.
-    if (!httpResult.data) {
-        httpResult.data = rawData;
+    NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *) response;
+    // Fortunately, the Gini API uses correct content types.
+    NSString *contentType = [httpResponse allHeaderFields][@"Content-Type"];
+    id (^decoder)(NSData *, NSError **) = nil;
+    if (GINIIsJSONContent(contentType) && [rawData length] > 0) {
+        decoder = ^id(NSData *data, NSError **decodingError) {
+            return GINIDeserializeJSONResponse(data, decodingError);
+        };
+    } else if (GINIIsImageContent(contentType)) {
+        decoder = ^id(NSData *data, NSError **decodingError) {
+            return GINIDeserializeImageResponse(data);
+        };
+    } else if (GINIIsTextContent(contentType) || GINIIsXMLContent(contentType)) {
+        decoder = ^id(NSData *data, NSError **decodingError) {
+            return [[NSString alloc] initWithData:data encoding:GINI_DEFAULT_ENCODING];
+        };
     }
 
-    // If there was an error during deserialization set the error.
-    if (error) {
-        httpResult.parseError = *error;
+    if (!decoder) {
+        return [GINIURLResponse urlResponseWithResponse:httpResponse data:rawData];
     }
-
-    return httpResult;
+    return [[GINIURLResponse alloc] initWithResponse:httpResponse rawData:rawData decoder:decoder];
 }
 
 void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BFTaskCompletionSource *completionSource) {
@@ -130,8 +146,121 @@ void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BF
 }
 
 
+/**
+ * The state of a streaming data task, see `BFStreamingDataTaskWithRequest:dataBlock:cancellationToken:`.
+ */
+@interface GINIStreamingDataTask : NSObject
+@property NSURLRequest *request;
+@property (copy) BOOL (^dataBlock)(NSData *data);
+@property BFTaskCompletionSource *completionSource;
+@property BFCancellationToken *cancellationToken;
+@property GINITrafficRecorder *recorder;
+@property NSTimeInterval startTimestamp;
+@property NSURLResponse *response;
+/// The body of an error response, or the whole body if the task is recorded.
+@property NSMutableData *body;
+/// Set when the data block has returned NO.
+@property BOOL stopped;
+@end
+
+@implementation GINIStreamingDataTask
+@end
+
+
+/**
+ * The delegate of the session doing the streaming data tasks. Hands the data of the tasks to their data blocks and
+ * forwards authentication challenges to the delegate of the regular session, so e.g. certificate pinning applies.
+ */
+@interface GINIStreamingDataDelegate : NSObject <NSURLSessionDataDelegate>
+@property (weak) id<NSURLSessionDelegate> challengeDelegate;
+- (void)addTask:(GINIStreamingDataTask *)task withIdentifier:(NSUInteger)identifier;
+@end
+
+@implementation GINIStreamingDataDelegate {
+    NSMutableDictionary<NSNumber *, GINIStreamingDataTask *> *_tasks;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _tasks = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)addTask:(GINIStreamingDataTask *)task withIdentifier:(NSUInteger)identifier {
+    @synchronized (_tasks) {
+        _tasks[@(identifier)] = task;
+    }
+}
+
+- (GINIStreamingDataTask *)taskWithIdentifier:(NSUInteger)identifier remove:(BOOL)remove {
+    @synchronized (_tasks) {
+        GINIStreamingDataTask *task = _tasks[@(identifier)];
+        if (remove) {
+            [_tasks removeObjectForKey:@(identifier)];
+        }
+        return task;
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential *))completionHandler {
+    id<NSURLSessionDelegate> challengeDelegate = self.challengeDelegate;
+    if ([challengeDelegate respondsToSelector:@selector(URLSession:didReceiveChallenge:completionHandler:)]) {
+        [challengeDelegate URLSession:session didReceiveChallenge:challenge completionHandler:completionHandler];
+    } else {
+        completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    GINIStreamingDataTask *task = [self taskWithIdentifier:dataTask.taskIdentifier remove:NO];
+    task.response = response;
+    if (task.recorder || GINICheckHTTPError(response)) {
+        task.body = [NSMutableData new];
+    }
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    GINIStreamingDataTask *task = [self taskWithIdentifier:dataTask.taskIdentifier remove:NO];
+    [task.body appendData:data];
+    if (!task || task.stopped || GINICheckHTTPError(task.response)) {
+        return;
+    }
+    if (!task.dataBlock(data)) {
+        task.stopped = YES;
+        [dataTask cancel];
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)sessionTask didCompleteWithError:(NSError *)error {
+    GINIStreamingDataTask *task = [self taskWithIdentifier:sessionTask.taskIdentifier remove:YES];
+    if (!task) {
+        return;
+    }
+    if (task.cancellationToken.cancellationRequested && !task.stopped) {
+        [task.completionSource trySetCancelled];
+        return;
+    }
+    [task.recorder recordRequest:task.request uploadLength:[task.request.HTTPBody length] startTimestamp:task.startTimestamp response:task.response body:task.body error:error];
+    if (task.stopped) {
+        [task.completionSource trySetResult:[GINIURLResponse urlResponseWithResponse:(NSHTTPURLResponse *)task.response]];
+    } else if (error || GINICheckHTTPError(task.response)) {
+        GINIParseResponse(task.body, task.response, error, task.completionSource);
+    } else {
+        [task.completionSource trySetResult:[GINIURLResponse urlResponseWithResponse:(NSHTTPURLResponse *)task.response]];
+    }
+}
+
+@end
+
+
 @implementation GINIURLSession {
     NSURLSession *_nsURLSession;
+    /// The session doing the streaming data tasks, created when it is needed.
+    NSURLSession *_streamingURLSession;
+    GINIStreamingDataDelegate *_streamingDelegate;
 }
 
 + (instancetype)urlSessionWithNSURLSession:(NSURLSession *)urlSession {
@@ -152,20 +281,110 @@ void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BF
     return self;
 }
 
+- (void)dealloc {
+    // The streaming session retains its delegate until it is invalidated. Running tasks are finished.
+    [_streamingURLSession finishTasksAndInvalidate];
+}
+
 
 #pragma mark - Public Methods
 - (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request{
     BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    GINITrafficRecorder *recorder = self.recorder;
+    NSTimeInterval startTimestamp = GINIMonotonicTimestamp();
     NSURLSessionDataTask *task = [_nsURLSession dataTaskWithRequest:request completionHandler:^void(NSData *data, NSURLResponse *response, NSError *error) {
+        [recorder recordRequest:request uploadLength:[request.HTTPBody length] startTimestamp:startTimestamp response:response body:data error:error];
         GINIParseResponse(data, response, error, completionSource);
     }];
     [task resume];
     return completionSource.task;
 }
 
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request cancellationToken:(BFCancellationToken *)cancellationToken {
+    if (!cancellationToken) {
+        return [self BFDataTaskWithRequest:request];
+    }
+    if (cancellationToken.cancellationRequested) {
+        return [BFTask cancelledTask];
+    }
+    BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    GINITrafficRecorder *recorder = self.recorder;
+    NSTimeInterval startTimestamp = GINIMonotonicTimestamp();
+    NSURLSessionDataTask *task = [_nsURLSession dataTaskWithRequest:request completionHandler:^void(NSData *data, NSURLResponse *response, NSError *error) {
+        if (cancellationToken.cancellationRequested && [error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
+            [completionSource trySetCancelled];
+            return;
+        }
+        [recorder recordRequest:request uploadLength:[request.HTTPBody length] startTimestamp:startTimestamp response:response body:data error:error];
+        GINIParseResponse(data, response, error, completionSource);
+    }];
+    BFCancellationTokenRegistration *registration = [cancellationToken registerCancellationObserverWithBlock:^{
+        [task cancel];
+    }];
+    [task resume];
+    return [completionSource.task continueWithBlock:^id(BFTask *completedTask) {
+        [registration dispose];
+        return completedTask;
+    }];
+}
+
+- (BFTask *)BFStreamingDataTaskWithRequest:(NSURLRequest *)request
+                                 dataBlock:(BOOL (^)(NSData *data))dataBlock
+                         cancellationToken:(BFCancellationToken *)cancellationToken {
+    NSParameterAssert(dataBlock);
+
+    if (cancellationToken.cancellationRequested) {
+        return [BFTask cancelledTask];
+    }
+    GINIStreamingDataTask *task = [GINIStreamingDataTask new];
+    task.request = request;
+    task.dataBlock = dataBlock;
+    task.completionSource = [BFTaskCompletionSource taskCompletionSource];
+    task.cancellationToken = cancellationToken;
+    task.recorder = self.recorder;
+    task.startTimestamp = GINIMonotonicTimestamp();
+
+    NSURLSessionDataTask *dataTask = [[self streamingURLSession] dataTaskWithRequest:request];
+    [_streamingDelegate addTask:task withIdentifier:dataTask.taskIdentifier];
+    BFCancellationTokenRegistration *registration = [cancellationToken registerCancellationObserverWithBlock:^{
+        [dataTask cancel];
+    }];
+    [dataTask resume];
+    return [task.completionSource.task continueWithBlock:^id(BFTask *completedTask) {
+        [registration dispose];
+        return completedTask;
+    }];
+}
+
+/**
+ * The session for the streaming data tasks. It has the configuration of the regular session, but delivers the data of
+ * its tasks to a delegate, which the completion handlers of the regular session do not.
+ */
+- (NSURLSession *)streamingURLSession {
+    @synchronized (self) {
+        if (!_streamingURLSession) {
+            _streamingDelegate = [GINIStreamingDataDelegate new];
+            _streamingDelegate.challengeDelegate = _nsURLSession.delegate;
+            NSOperationQueue *delegateQueue = [NSOperationQueue new];
+            delegateQueue.maxConcurrentOperationCount = 1;
+            _streamingURLSession = [NSURLSession sessionWithConfiguration:_nsURLSession.configuration
+                                                                 delegate:_streamingDelegate
+                                                            delegateQueue:delegateQueue];
+        }
+        return _streamingURLSession;
+    }
+}
+
 - (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
     BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    GINITrafficRecorder *recorder = self.recorder;
+    NSTimeInterval startTimestamp = GINIMonotonicTimestamp();
     NSURLSessionDownloadTask *downloadTask = [_nsURLSession downloadTaskWithRequest:request completionHandler:^(NSURL *location, NSURLResponse *response, NSError *error) {
+        // The downloaded file is deleted when this handler returns, so it has to be recorded here.
+        if (recorder) {
+            NSData *body = location ? [NSData dataWithContentsOfURL:location] : nil;
+            [recorder recordRequest:request uploadLength:0 startTimestamp:startTimestamp response:response body:body error:error];
+        }
         // If there has been an error in the HTTP communication, transparently pass-through the error.
         if (error) {
             return [completionSource setError:error];
@@ -183,7 +402,10 @@ void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BF
 
 - (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
     BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    GINITrafficRecorder *recorder = self.recorder;
+    NSTimeInterval startTimestamp = GINIMonotonicTimestamp();
     NSURLSessionUploadTask *uploadTask = [_nsURLSession uploadTaskWithRequest:request fromData:uploadData completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        [recorder recordRequest:request uploadLength:[uploadData length] startTimestamp:startTimestamp response:response body:data error:error];
         GINIParseResponse(data, response, error, completionSource);
     }];
     [uploadTask resume];
@@ -191,3 +413,37 @@ void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BF
 }
 
 @end
+
+
+BFTask *GINIDataTaskWithRequest(id<GINIURLSession> urlSession, NSURLRequest *request, BFCancellationToken *cancellationToken) {
+    if ([urlSession respondsToSelector:@selector(BFDataTaskWithRequest:cancellationToken:)]) {
+        return [urlSession BFDataTaskWithRequest:request cancellationToken:cancellationToken];
+    }
+    return [[urlSession BFDataTaskWithRequest:request] continueWithBlock:^id(BFTask *task) {
+        return task;
+    } cancellationToken:cancellationToken];
+}
+
+BFTask *GINIStreamingDataTaskWithRequest(id<GINIURLSession> urlSession, NSURLRequest *request, BOOL (^dataBlock)(NSData *data), BFCancellationToken *cancellationToken) {
+    if ([urlSession respondsToSelector:@selector(BFStreamingDataTaskWithRequest:dataBlock:cancellationToken:)]) {
+        return [urlSession BFStreamingDataTaskWithRequest:request dataBlock:dataBlock cancellationToken:cancellationToken];
+    }
+    return [GINIDataTaskWithRequest(urlSession, request, cancellationToken) continueWithSuccessBlock:^id(BFTask *task) {
+        // Sessions which decode lazily keep the raw body, so it is passed on without decoding it. Otherwise the body has
+        // already been deserialized according to its content type.
+        GINIURLResponse *response = task.result;
+        NSData *data = response.rawData;
+        id body = data ? nil : response.data;
+        if ([body isKindOfClass:[NSData class]]) {
+            data = body;
+        } else if ([body isKindOfClass:[NSString class]]) {
+            data = [body dataUsingEncoding:GINI_DEFAULT_ENCODING];
+        } else if ([NSJSONSerialization isValidJSONObject:body]) {
+            data = [NSJSONSerialization dataWithJSONObject:body options:0 error:nil];
+        }
+        if ([data length] > 0) {
+            dataBlock(data);
+        }
+        return [GINIURLResponse urlResponseWithResponse:response.response];
+    } cancellationToken:cancellationToken];
+}
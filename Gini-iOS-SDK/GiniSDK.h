@@ -23,6 +23,27 @@
 #import "GINIUserCenterManager.h"
 #import "GINIKeychainManager.h"
 #import "GINIURLSessionDelegate.h"
+#import "GINIHistogram.h"
+#import "GINIDocumentLifecycleMetrics.h"
+#import "GINITracer.h"
+#import "GINITracingURLSession.h"
+#import "GINIFaultInjectingURLSession.h"
+#import "GINITrafficRecorder.h"
+#import "GINIReplayURLSession.h"
+#import "GINIDocumentBundle.h"
+#import "GINIFeedbackBuffer.h"
+#import "GINIOutbox.h"
+#import "GINIBulkOperation.h"
+#import "GINIDocumentPipeline.h"
+#import "GINIDocumentIterator.h"
+#import "GINISearchSession.h"
+#import "GINIDocumentStore.h"
+#import "GINIExtractionIndex.h"
+#import "GINILayoutParser.h"
+#import "GINIIndexedLayoutPage.h"
+#import "GINIDocumentTextIndex.h"
+#import "GINIJSONDecoder.h"
+#import "GINIResourceDecoder.h"
 
 
 // Keys used in the injector. See the discussion on keys at `GINIInjector` class.
@@ -40,6 +61,10 @@ FOUNDATION_EXPORT NSString *const GINIInjectorClientSecretKey;
 /// Use this key to identify the application's certificate paths in the injector.
 FOUNDATION_EXPORT NSString *const GINIInjectorCertificatePathsKey;
 FOUNDATION_EXPORT NSString *const GINIInjectorAPIKey;
+/// Use this key to identify the `BFExecutor` on which the responses are decoded in the injector.
+FOUNDATION_EXPORT NSString *const GINIInjectorDecodingExecutorKey;
+/// Use this key to identify the `BFExecutor` on which the tasks of the document task manager are completed in the injector.
+FOUNDATION_EXPORT NSString *const GINIInjectorResultExecutorKey;
 /**
  * The Gini SDK.
  */
@@ -11,6 +11,8 @@ NSString *const GINIInjectorURLSchemeKey = @"AppURLScheme";
 NSString *const GINIInjectorClientSecretKey = @"AppClientSecret";
 NSString *const GINIInjectorClientIDKey = @"AppClientId";
 NSString *const GINIInjectorAPIKey = @"API";
+NSString *const GINIInjectorDecodingExecutorKey = @"DecodingExecutor";
+NSString *const GINIInjectorResultExecutorKey = @"ResultExecutor";
 
 
 @implementation GiniSDK{
@@ -39,6 +41,10 @@ NSString *const GINIInjectorAPIKey = @"API";
 - (GINIAPIManager *)APIManager {
     if (!_APIManager) {
         _APIManager = [_injector getInstanceOf:[GINIAPIManager class]];
+        BFExecutor *decodingExecutor = [self optionalInstanceOf:GINIInjectorDecodingExecutorKey];
+        if (decodingExecutor) {
+            _APIManager.decodingExecutor = decodingExecutor;
+        }
     }
     return _APIManager;
 }
@@ -53,6 +59,13 @@ NSString *const GINIInjectorAPIKey = @"API";
 - (GINIDocumentTaskManager *)documentTaskManager {
     if (!_documentTaskManager) {
         _documentTaskManager = [_injector getInstanceOf:[GINIDocumentTaskManager class]];
+        // The document task manager uses the API manager, whose responses have to be decoded on the same executor.
+        [self APIManager];
+        BFExecutor *decodingExecutor = [self optionalInstanceOf:GINIInjectorDecodingExecutorKey];
+        if (decodingExecutor) {
+            _documentTaskManager.decodingExecutor = decodingExecutor;
+        }
+        _documentTaskManager.resultExecutor = [self optionalInstanceOf:GINIInjectorResultExecutorKey];
     }
     return _documentTaskManager;
 }
@@ -62,5 +75,16 @@ NSString *const GINIInjectorAPIKey = @"API";
     [store removeCredentials];
 }
 
+#pragma mark - Private methods
+/**
+ * Returns the instance for the given key, or nil if the injector doesn't know the key.
+ */
+- (id)optionalInstanceOf:(id)key {
+    if (![_injector factoryForKey:key]) {
+        return nil;
+    }
+    return [_injector getInstanceOf:key];
+}
+
 
 @end
@@ -13,6 +13,7 @@
 #import "GINIURLResponse.h"
 #import "NSString+GINIAdditions.h"
 #import "GINIPartialDocumentInfo.h"
+#import "GINILayoutParser.h"
 
 
 SPEC_BEGIN(GINIAPIManagerSpec)
@@ -228,6 +229,29 @@ describe(@"The GINIAPIManager", ^{
             [[layoutTask.result should] beKindOfClass:[NSString class]];
             [[layoutTask.result should] equal:xml];
         });
+
+        it(@"should hand the layout to the page block page by page", ^{
+            NSURL *dataPath = [[NSBundle bundleForClass:[self class]] URLForResource:@"layout" withExtension:@"xml"];
+            NSString *xml = [NSString stringWithContentsOfURL:dataPath encoding:GINIStringEncoding error:nil];
+            [urlSessionMock setResponse:[BFTask taskWithResult:[GINIURLResponse urlResponseWithResponse:nil data:xml]]
+                                 forURL:@"https://api.gini.net/documents/Foobar/layout"];
+            NSMutableArray *pages = [NSMutableArray new];
+            BFTask *layoutTask = [apiManager getLayoutForDocument:documentId responseType:GiniAPIResponseTypeXML pageBlock:^(GINILayoutPage *page) {
+                [pages addObject:page];
+            } cancellationToken:nil];
+            checkAPIRequestXML(@"https://api.gini.net/documents/Foobar/layout", 1);
+            [[layoutTask.error should] beNil];
+            [[layoutTask.result should] equal:@1];
+            [[[pages valueForKey:@"number"] should] equal:@[@1]];
+        });
+
+        it(@"should fail if the layout is invalid", ^{
+            [urlSessionMock setResponse:[BFTask taskWithResult:[GINIURLResponse urlResponseWithResponse:nil data:@"{\"pages\": [{]}"]]
+                                 forURL:@"https://api.gini.net/documents/Foobar/layout"];
+            BFTask *layoutTask = [apiManager getLayoutForDocument:documentId responseType:GiniAPIResponseTypeJSON pageBlock:^(GINILayoutPage *page) {
+            } cancellationToken:nil];
+            [[layoutTask.error shouldNot] beNil];
+        });
     });
     
     context(@"The uploadDocumentWithData:contentType:fileName:docType method", ^{
@@ -443,6 +467,11 @@ describe(@"The GINIAPIManager", ^{
             checkAPIRequestBasic(urlString, 1);
         });
         
+        it(@"should escape the search term and omit a missing doctype", ^{
+            [apiManager search:@"cat & dog" limit:(unsigned long)10 offset:(unsigned long)0 docType:nil];
+            checkAPIRequestBasic(@"https://api.gini.net/search?q=cat%20%26%20dog&limit=10&offset=0", 1);
+        });
+        
         it(@"should react correctly on the HTTP response", ^{
             NSURL *dataPath = [[NSBundle bundleForClass:[self class]] URLForResource:@"search" withExtension:@"json"];
             NSDictionary *json = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfURL:dataPath]
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIBulkOperation.h"
+
+
+SPEC_BEGIN(GINIBulkOperationSpec)
+
+describe(@"The GINIBulkOperation", ^{
+    NSArray *documentIds = @[@"1", @"2", @"3", @"4", @"5"];
+
+    it(@"should never run more than the maximum number of operations at the same time", ^{
+        __block NSInteger running = 0;
+        __block NSInteger maxRunning = 0;
+        NSObject *lock = [NSObject new];
+        GINIBulkOperation *bulkOperation = [GINIBulkOperation bulkOperationWithDocumentIds:documentIds maxConcurrentOperations:2 operationBlock:^BFTask *(NSString *documentId) {
+            @synchronized (lock) {
+                running += 1;
+                maxRunning = MAX(maxRunning, running);
+            }
+            return [[BFTask taskWithDelay:10] continueWithBlock:^id(BFTask *task) {
+                @synchronized (lock) {
+                    running -= 1;
+                }
+                return documentId;
+            }];
+        }];
+
+        BFTask *bulkTask = [bulkOperation startWithItemResultBlock:nil cancellationToken:nil];
+        [bulkTask waitUntilFinished];
+        GINIBulkResult *bulkResult = bulkTask.result;
+        [[theValue(maxRunning) should] equal:theValue(2)];
+        [[theValue(bulkResult.succeeded) should] beYes];
+        [[bulkResult.results should] equal:@{@"1": @"1", @"2": @"2", @"3": @"3", @"4": @"4", @"5": @"5"}];
+    });
+
+    it(@"should report the outcome of each document", ^{
+        NSMutableArray *reported = [NSMutableArray new];
+        GINIBulkOperation *bulkOperation = [GINIBulkOperation bulkOperationWithDocumentIds:documentIds maxConcurrentOperations:3 operationBlock:^BFTask *(NSString *documentId) {
+            if ([documentId isEqualToString:@"2"]) {
+                return [BFTask taskWithError:[NSError errorWithDomain:@"mock" code:1 userInfo:nil]];
+            }
+            return [BFTask taskWithResult:documentId];
+        }];
+
+        BFTask *bulkTask = [bulkOperation startWithItemResultBlock:^(GINIBulkItemResult *itemResult) {
+            [reported addObject:itemResult.documentId];
+        } cancellationToken:nil];
+        [bulkTask waitUntilFinished];
+        GINIBulkResult *bulkResult = bulkTask.result;
+        [[bulkTask.error should] beNil];
+        [[theValue(bulkResult.succeeded) should] beNo];
+        [[[bulkResult.errors allKeys] should] equal:@[@"2"]];
+        [[theValue([bulkResult.results count]) should] equal:theValue(4)];
+        [[[reported sortedArrayUsingSelector:@selector(compare:)] should] equal:documentIds];
+        [[[bulkResult.itemResults valueForKey:@"documentId"] should] equal:documentIds];
+    });
+
+    it(@"should not start operations after it was cancelled", ^{
+        BFCancellationTokenSource *cancellationTokenSource = [BFCancellationTokenSource cancellationTokenSource];
+        __block NSInteger started = 0;
+        GINIBulkOperation *bulkOperation = [GINIBulkOperation bulkOperationWithDocumentIds:documentIds maxConcurrentOperations:1 operationBlock:^BFTask *(NSString *documentId) {
+            started += 1;
+            [cancellationTokenSource cancel];
+            return [BFTask taskWithResult:documentId];
+        }];
+
+        BFTask *bulkTask = [bulkOperation startWithItemResultBlock:nil cancellationToken:cancellationTokenSource.token];
+        [bulkTask waitUntilFinished];
+        GINIBulkResult *bulkResult = bulkTask.result;
+        [[theValue(started) should] equal:theValue(1)];
+        [[bulkResult.results should] equal:@{@"1": @"1"}];
+        [[bulkResult.cancelledDocumentIds should] equal:@[@"2", @"3", @"4", @"5"]];
+    });
+});
+
+SPEC_END
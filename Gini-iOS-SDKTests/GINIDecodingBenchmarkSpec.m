@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIMicrobenchmark.h"
+#import "GINIURLResponse.h"
+#import "GINIDocument.h"
+#import "GINIDocumentTaskManager.h"
+#import "GINISessionParser.h"
+#import "GINIConstants.h"
+#import "GINIJSONDecoder.h"
+#import "GINIResourceDecoder.h"
+
+
+/// Defined in GINIURLSession.m.
+GINIURLResponse *GINIDeserializeResponse(NSURLResponse *response, NSData *rawData, NSError **error);
+
+@interface GINIDocumentTaskManager (TestVisibility)
+- (BFTask *)createExtractionsForGetTask:(BFTask *)getTask;
+@end
+
+
+/**
+ * Creates a documents list like the one of the documents.json fixture, but with the given number of documents.
+ */
+static NSData *GINISynthesizeDocumentsList(NSUInteger count) {
+    NSURL *url = [[NSBundle bundleForClass:[GINIMicrobenchmark class]] URLForResource:@"document" withExtension:@"json"];
+    NSString *template = [NSString stringWithContentsOfURL:url encoding:NSUTF8StringEncoding error:nil];
+    NSMutableArray *documents = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *documentId = [NSString stringWithFormat:@"626626a0-749f-11e2-bfd6-%012lu", (unsigned long)i];
+        NSString *json = [template stringByReplacingOccurrencesOfString:@"626626a0-749f-11e2-bfd6-000000000000" withString:documentId];
+        [documents addObject:[NSJSONSerialization JSONObjectWithData:[json dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil]];
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"totalCount": @(count), @"documents": documents} options:0 error:nil];
+}
+
+/**
+ * Creates an extractions response with the given number of extractions and candidates per entity.
+ */
+static NSData *GINISynthesizeExtractions(NSUInteger extractionCount, NSUInteger candidatesPerEntity) {
+    NSArray *entities = @[@"amount", @"iban", @"date"];
+    NSMutableDictionary *candidates = [NSMutableDictionary new];
+    for (NSString *entity in entities) {
+        NSMutableArray *entityCandidates = [NSMutableArray arrayWithCapacity:candidatesPerEntity];
+        for (NSUInteger i = 0; i < candidatesPerEntity; i++) {
+            [entityCandidates addObject:@{@"value": [NSString stringWithFormat:@"%@-%lu", entity, (unsigned long)i],
+                                          @"box": @{@"height": @9.0, @"left": @(516.0 + i), @"page": @1, @"top": @588.0, @"width": @42.0}}];
+        }
+        candidates[entity] = entityCandidates;
+    }
+    NSMutableDictionary *extractions = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < extractionCount; i++) {
+        NSString *entity = entities[i % [entities count]];
+        extractions[[NSString stringWithFormat:@"extraction%lu", (unsigned long)i]] = @{
+            @"entity": entity,
+            @"value": [NSString stringWithFormat:@"%@-%lu", entity, (unsigned long)i],
+            @"box": @{@"height": @9.0, @"left": @516.0, @"page": @1, @"top": @588.0, @"width": @42.0}
+        };
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"extractions": extractions, @"candidates": candidates} options:0 error:nil];
+}
+
+/**
+ * Creates a JSON layout with the given number of pages of 50 lines with 8 words each.
+ */
+static NSData *GINISynthesizeLayout(NSUInteger pageCount) {
+    NSMutableArray *pages = [NSMutableArray arrayWithCapacity:pageCount];
+    for (NSUInteger pageNumber = 1; pageNumber <= pageCount; pageNumber++) {
+        NSMutableArray *lines = [NSMutableArray arrayWithCapacity:50];
+        for (NSUInteger line = 0; line < 50; line++) {
+            NSMutableArray *words = [NSMutableArray arrayWithCapacity:8];
+            for (NSUInteger word = 0; word < 8; word++) {
+                [words addObject:@{@"l": @(54.0 + word * 60), @"t": @(80.0 + line * 14), @"w": @52.5, @"h": @9.5,
+                                   @"fontSize": @9.5, @"fontFamily": @"Arial", @"bold": @NO,
+                                   @"text": [NSString stringWithFormat:@"Wort%lu-%lu", (unsigned long)line, (unsigned long)word]}];
+            }
+            [lines addObject:@{@"l": @54.0, @"t": @(80.0 + line * 14), @"w": @472.5, @"h": @9.5, @"wds": words}];
+        }
+        [pages addObject:@{@"number": @(pageNumber), @"sizeX": @595.5, @"sizeY": @841.75,
+                           @"textZones": @[@{@"paragraphs": @[@{@"lines": lines}]}]}];
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"meta": @{}, @"pages": pages} options:0 error:nil];
+}
+
+static NSHTTPURLResponse *GINIJSONHTTPResponse(void) {
+    return [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://api.gini.net/documents"]
+                                       statusCode:200
+                                      HTTPVersion:@"HTTP/1.1"
+                                     headerFields:@{@"Content-Type": GINIContentJsonV2}];
+}
+
+
+SPEC_BEGIN(GINIDecodingBenchmarkSpec)
+
+// The benchmarks synthesize and measure large payloads, so they only run on request.
+if (![[NSProcessInfo processInfo] environment][@"GINI_RUN_BENCHMARKS"]) {
+    return;
+}
+
+describe(@"The response decoding", ^{
+    __block GINIMicrobenchmark *benchmark;
+    __block NSData *documentsData;
+    __block NSData *extractionsData;
+
+    beforeAll(^{
+        // There is no baseline yet, so the results are only logged. Record one on a reference device with
+        // GINI_BENCHMARK_BASELINE_OUTPUT before checking the results for regressions.
+        benchmark = [GINIMicrobenchmark benchmarkWithBaselineURL:nil];
+        documentsData = GINISynthesizeDocumentsList(1000);
+        extractionsData = GINISynthesizeExtractions(100, 300);
+    });
+
+    afterAll(^{
+        [benchmark writeBaselineIfRequested];
+    });
+
+    GINIMicrobenchmarkResult *(^measure)(NSString *, id (^)(void)) = ^GINIMicrobenchmarkResult *(NSString *name, id (^block)(void)) {
+        GINIMicrobenchmarkResult *result = [benchmark measure:name usingBlock:block];
+        NSLog(@"GINIDecodingBenchmark: %@", result);
+        return result;
+    };
+
+    /**
+     * Measures `NSJSONSerialization` and the `GINIJSONDecoder` with the same data.
+     */
+    void (^compareDecoders)(NSString *, NSData *) = ^(NSString *name, NSData *data) {
+        id expected = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:nil];
+        [[[GINIJSONDecoder JSONObjectWithData:data error:nil] should] equal:expected];
+
+        GINIMicrobenchmarkResult *foundation = measure([@"json.foundation." stringByAppendingString:name], ^id{
+            return [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:nil];
+        });
+        GINIMicrobenchmarkResult *decoder = measure([@"json.decoder." stringByAppendingString:name], ^id{
+            return [GINIJSONDecoder JSONObjectWithData:data error:nil];
+        });
+        NSLog(@"GINIDecodingBenchmark: %@ (%lu bytes): the GINIJSONDecoder needs %.0f%% of the time and %.0f%% of the allocations of NSJSONSerialization",
+              name, (unsigned long)[data length], 100 * decoder.medianTime / foundation.medianTime,
+              100.0 * decoder.allocatedBlocks / MAX(foundation.allocatedBlocks, 1));
+    };
+
+    it(@"should compare the JSON decoders with documents lists", ^{
+        compareDecoders(@"documents1000", documentsData);
+        compareDecoders(@"documents10000", GINISynthesizeDocumentsList(10000));
+    });
+
+    it(@"should compare the JSON decoders with extractions", ^{
+        compareDecoders(@"extractions900", extractionsData);
+        compareDecoders(@"extractions9000", GINISynthesizeExtractions(1000, 3000));
+    });
+
+    it(@"should compare the JSON decoders with layouts", ^{
+        compareDecoders(@"layout1", GINISynthesizeLayout(1));
+        compareDecoders(@"layout20", GINISynthesizeLayout(20));
+    });
+
+    it(@"should deserialize a list of 1000 documents", ^{
+        NSError *error = nil;
+        GINIURLResponse *response = GINIDeserializeResponse(GINIJSONHTTPResponse(), documentsData, &error);
+        [[error should] beNil];
+        [[response.data[@"documents"] should] haveCountOf:1000];
+
+        measure(@"deserialize.documents1000", ^id{
+            // The body is decoded on the first access of the data.
+            return GINIDeserializeResponse(GINIJSONHTTPResponse(), documentsData, NULL).data;
+        });
+    });
+
+    it(@"should create the models of 1000 documents", ^{
+        NSArray *documents = [NSJSONSerialization JSONObjectWithData:documentsData options:0 error:nil][@"documents"];
+        measure(@"model.documents1000", ^id{
+            NSMutableArray *models = [NSMutableArray arrayWithCapacity:[documents count]];
+            for (NSDictionary *document in documents) {
+                [models addObject:[GINIDocument documentFromAPIResponse:document withDocumentManager:nil]];
+            }
+            return models;
+        });
+    });
+
+    it(@"should deserialize extractions with 900 candidates", ^{
+        NSError *error = nil;
+        GINIDeserializeResponse(GINIJSONHTTPResponse(), extractionsData, &error);
+        [[error should] beNil];
+
+        measure(@"deserialize.extractions900", ^id{
+            // The body is decoded on the first access of the data.
+            return GINIDeserializeResponse(GINIJSONHTTPResponse(), extractionsData, NULL).data;
+        });
+    });
+
+    it(@"should create the models of extractions with 900 candidates", ^{
+        NSDictionary *extractions = [NSJSONSerialization JSONObjectWithData:extractionsData options:0 error:nil];
+        GINIDocumentTaskManager *documentTaskManager = [[GINIDocumentTaskManager alloc] initWithAPIManager:nil];
+        BFTask *task = [documentTaskManager createExtractionsForGetTask:[BFTask taskWithResult:extractions]];
+        [task waitUntilFinished];
+        [[task.result[@"extractions"] should] haveCountOf:100];
+
+        measure(@"model.extractions900", ^id{
+            BFTask *task = [documentTaskManager createExtractionsForGetTask:[BFTask taskWithResult:extractions]];
+            [task waitUntilFinished];
+            return task.result;
+        });
+    });
+
+    it(@"should decode 1000 documents with the resource decoder", ^{
+        GINIResourceDecoder *resourceDecoder = [GINIResourceDecoder resourceDecoderWithDocumentManager:nil];
+        [[[resourceDecoder documentsWithData:documentsData totalCount:NULL error:nil] should] haveCountOf:1000];
+
+        measure(@"typed.documents1000", ^id{
+            return [resourceDecoder documentsWithData:documentsData totalCount:NULL error:nil];
+        });
+    });
+
+    it(@"should decode extractions with 900 candidates with the resource decoder", ^{
+        [[[GINIResourceDecoder extractionsWithData:extractionsData error:nil][@"extractions"] should] haveCountOf:100];
+
+        measure(@"typed.extractions900", ^id{
+            return [GINIResourceDecoder extractionsWithData:extractionsData error:nil];
+        });
+    });
+
+    it(@"should parse 1000 sessions", ^{
+        NSDictionary *session = @{@"access_token": @"760822cb-2dec-4275-8da8-fa8f5680e8d4",
+                                  @"refresh_token": @"46463dd6-cdbb-440d-88fc-b10a34f68b26",
+                                  @"expires_in": @300};
+        measure(@"parse.sessions1000", ^id{
+            NSMutableArray *sessions = [NSMutableArray arrayWithCapacity:1000];
+            for (NSUInteger i = 0; i < 1000; i++) {
+                [sessions addObject:[GINISessionParser sessionWithJSONDictionary:session]];
+            }
+            return sessions;
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIDocumentPipeline.h"
+#import "GINIDocumentTaskManager.h"
+#import "GINIDocument.h"
+#import "GINIExtraction.h"
+#import "GINIAPIManagerMock.h"
+
+
+/**
+ * An API manager whose uploads create processed documents with the file name as ID, except for files named "broken".
+ */
+@interface GINIPipelineAPIManagerMock : GINIAPIManagerMock
+@end
+
+@implementation GINIPipelineAPIManagerMock
+
+- (BFTask *)uploadDocumentWithData:(NSData *)documentData
+                       contentType:(NSString *)contentType
+                          fileName:(NSString *)fileName
+                           docType:(NSString *)docType
+                          metadata:(GINIDocumentMetadata *)metadata
+                 cancellationToken:(BFCancellationToken *)cancellationToken {
+    if ([fileName isEqualToString:@"broken"]) {
+        return [BFTask taskWithError:[NSError errorWithDomain:@"mock" code:1 userInfo:nil]];
+    }
+    return [BFTask taskWithResult:@{@"id": fileName, @"progress": @"COMPLETED", @"sourceClassification": @"SCANNED"}];
+}
+
+@end
+
+
+SPEC_BEGIN(GINIDocumentPipelineSpec)
+
+describe(@"The GINIDocumentPipeline", ^{
+    __block GINIPipelineAPIManagerMock *apiManager;
+    __block GINIDocumentPipeline *pipeline;
+    NSData *data = [@"document" dataUsingEncoding:NSUTF8StringEncoding];
+
+    beforeEach(^{
+        apiManager = [GINIPipelineAPIManagerMock new];
+        pipeline = [GINIDocumentPipeline pipelineWithDocumentTaskManager:[GINIDocumentTaskManager documentTaskManagerWithAPIManager:apiManager]];
+    });
+
+    it(@"should report the outcome of every input", ^{
+        NSMutableArray *inputs = [NSMutableArray new];
+        for (NSString *fileName in @[@"1", @"2", @"broken", @"4", @"5"]) {
+            [inputs addObject:[GINIPipelineInput inputWithFileName:fileName data:data docType:nil metadata:nil]];
+        }
+        NSMutableDictionary<NSString *, GINIPipelineResult *> *results = [NSMutableDictionary new];
+
+        BFTask *pipelineTask = [pipeline startWithInputs:inputs resultBlock:^(GINIPipelineResult *result) {
+            results[result.input.fileName] = result;
+        } cancellationToken:nil];
+        [pipelineTask waitUntilFinished];
+
+        [[pipelineTask.result should] equal:@5];
+        [[theValue([results count]) should] equal:theValue(5)];
+        [[results[@"broken"].error shouldNot] beNil];
+        [[theValue(results[@"broken"].failedStage) should] equal:theValue(GINIPipelineStageUpload)];
+        [[results[@"4"].document.documentId should] equal:@"4"];
+        [[results[@"4"].extractions[@"amountToPay"] should] beKindOfClass:[GINIExtraction class]];
+    });
+
+    it(@"should not pull inputs after it was cancelled", ^{
+        BFCancellationTokenSource *cancellationTokenSource = [BFCancellationTokenSource cancellationTokenSource];
+        [cancellationTokenSource cancel];
+        __block NSInteger pulled = 0;
+
+        BFTask *pipelineTask = [pipeline startWithInputBlock:^GINIPipelineInput *{
+            pulled += 1;
+            return [GINIPipelineInput inputWithFileName:@"1" data:data docType:nil metadata:nil];
+        } resultBlock:nil cancellationToken:cancellationTokenSource.token];
+        [pipelineTask waitUntilFinished];
+
+        [[pipelineTask.result should] equal:@0];
+        [[theValue(pulled) should] equal:theValue(0)];
+    });
+});
+
+SPEC_END
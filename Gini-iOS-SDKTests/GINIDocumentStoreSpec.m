@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINIDocumentStore.h"
+
+
+SPEC_BEGIN(GINIDocumentStoreSpec)
+
+describe(@"The GINIDocumentStore", ^{
+    __block NSURL *fileURL;
+    __block GINIDocumentStore *documentStore;
+    NSDictionary *olderDocument = @{@"id": @"1", @"progress": @"COMPLETED", @"creationDate": @1400000000000};
+    NSDictionary *newerDocument = @{@"id": @"2", @"progress": @"PENDING", @"creationDate": @1500000000500};
+    NSDictionary *extractions = @{@"extractions": @{@"iban": @{@"value": @"DE1", @"entity": @"iban"}}, @"candidates": @{}};
+
+    beforeEach(^{
+        fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        documentStore = [GINIDocumentStore documentStoreWithFileURL:fileURL];
+    });
+
+    afterEach(^{
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    });
+
+    it(@"should return the documents the most recent first", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeDocumentResponse:newerDocument];
+        [[[documentStore documentResponses] should] equal:@[newerDocument, olderDocument]];
+        [[documentStore.latestCreationDate should] equal:[NSDate dateWithTimeIntervalSince1970:1500000000]];
+    });
+
+    it(@"should keep the documents and extractions across instances", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeExtractionsResponse:extractions forDocumentWithId:@"1"];
+        // Replacing the document keeps its extractions.
+        [documentStore storeDocumentResponse:olderDocument];
+
+        GINIDocumentStore *reopenedStore = [GINIDocumentStore documentStoreWithFileURL:fileURL];
+        [[theValue(reopenedStore.documentCount) should] equal:theValue(1)];
+        [[[reopenedStore extractionsResponseForDocumentWithId:@"1"] should] equal:extractions];
+    });
+
+    it(@"should return the undecoded responses", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeDocumentResponse:newerDocument];
+        [documentStore storeExtractionsResponse:extractions forDocumentWithId:@"1"];
+
+        NSMutableArray *responses = [NSMutableArray new];
+        [documentStore enumerateDocumentResponseDataUsingBlock:^(NSData *data) {
+            [responses addObject:[NSJSONSerialization JSONObjectWithData:data options:0 error:nil]];
+        }];
+        [[responses should] equal:@[newerDocument, olderDocument]];
+        NSData *extractionsData = [documentStore extractionsResponseDataForDocumentWithId:@"1"];
+        [[[NSJSONSerialization JSONObjectWithData:extractionsData options:0 error:nil] should] equal:extractions];
+        [[[documentStore extractionsResponseDataForDocumentWithId:@"2"] should] beNil];
+    });
+
+    it(@"should tell if the extractions of a document are stored", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeDocumentResponse:newerDocument];
+        [documentStore storeExtractionsResponse:extractions forDocumentWithId:@"1"];
+        [[theValue([documentStore hasExtractionsForDocumentWithId:@"1"]) should] beYes];
+        [[theValue([documentStore hasExtractionsForDocumentWithId:@"2"]) should] beNo];
+        [[theValue([documentStore hasExtractionsForDocumentWithId:@"3"]) should] beNo];
+    });
+
+    it(@"should apply feedback to the stored extractions", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeExtractionsResponse:extractions forDocumentWithId:@"1"];
+        [documentStore updateStoredExtractions:@{@"iban": @{@"value": @"DE2"}} forDocumentWithId:@"1"];
+        [[[documentStore extractionsResponseForDocumentWithId:@"1"][@"extractions"][@"iban"] should] equal:@{@"value": @"DE2", @"entity": @"iban"}];
+    });
+
+    it(@"should remove documents", ^{
+        [documentStore storeDocumentResponse:olderDocument];
+        [documentStore storeDocumentResponse:newerDocument];
+        [documentStore removeDocumentWithId:@"2"];
+        [[[documentStore documentResponses] should] equal:@[olderDocument]];
+        [documentStore removeAllDocuments];
+        [[theValue(documentStore.documentCount) should] equal:theValue(0)];
+        [[documentStore.latestCreationDate should] beNil];
+    });
+});
+
+SPEC_END
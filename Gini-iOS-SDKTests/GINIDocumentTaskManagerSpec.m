@@ -5,11 +5,17 @@
 
 #import <Kiwi/Kiwi.h>
 #import <Bolts/BFTask.h>
+#import <Bolts/BFExecutor.h>
 #import "GINIDocumentTaskManager.h"
 #import "GINIDocument.h"
+#import "GINIDocument_Private.h"
+#import "GINIExtraction.h"
 #import "GINIAPIManagerMock.h"
 
 
+static void *GINIResultQueueKey = &GINIResultQueueKey;
+
+
 SPEC_BEGIN(GINIDocumentTaskManagerSpec)
 
 describe(@"The GINIDocumentTaskManager", ^{
@@ -44,6 +50,14 @@ describe(@"The GINIDocumentTaskManager", ^{
             BFTask *task = [documentTaskManager getDocumentWithId:@"1234"];
             [[task should] beKindOfClass:[BFTask class]];
         });
+
+        it(@"should resolve to the same instance for the same document", ^{
+            BFTask *firstTask = [documentTaskManager getDocumentWithId:@"1234"];
+            BFTask *secondTask = [documentTaskManager getDocumentWithId:@"1234"];
+            [firstTask waitUntilFinished];
+            [secondTask waitUntilFinished];
+            [[firstTask.result should] beIdenticalTo:secondTask.result];
+        });
     });
 
     context(@"The pollDocument method", ^{
@@ -152,6 +166,384 @@ describe(@"The GINIDocumentTaskManager", ^{
             [[[documentTaskManager createDocumentWithFilename:@"foobar.jpg" fromData:data docType:@"Invoice"] should] beKindOfClass:[BFTask class]];
         });
     });
+
+    context(@"The cached results", ^{
+        __block GINIDocument *document;
+
+        beforeEach(^{
+            document = [[GINIDocument alloc] initWithId:@"1234"
+                                                  state:GiniDocumentStateComplete
+                                              pageCount:1
+                                   sourceClassification:GiniDocumentSourceClassificationNative
+                                                  links:nil
+                                     compositeDocuments:nil
+                                   partialDocumentInfos:nil];
+        });
+
+        it(@"should download the extractions only once for extractions and candidates", ^{
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            BFTask *candidatesTask = [documentTaskManager getCandidatesForDocument:document cancellationToken:nil];
+            [extractionsTask waitUntilFinished];
+            [candidatesTask waitUntilFinished];
+            [[extractionsTask.result[@"amountToPay"] should] beKindOfClass:[GINIExtraction class]];
+            [[candidatesTask.result[@"amounts"] should] beKindOfClass:[NSArray class]];
+            [[theValue(apiManager.getExtractionsCalled) should] equal:theValue(1)];
+        });
+
+        it(@"should fetch the layout instead of the extractions", ^{
+            BFTask *firstTask = [documentTaskManager getLayoutForDocument:document];
+            BFTask *secondTask = [documentTaskManager getLayoutForDocument:document];
+            [firstTask waitUntilFinished];
+            [secondTask waitUntilFinished];
+            [[secondTask.result should] equal:@{@"pages": @[]}];
+            [[theValue(apiManager.getLayoutCalled) should] equal:theValue(1)];
+            [[theValue(apiManager.getExtractionsCalled) should] equal:theValue(0)];
+        });
+
+        it(@"should write updated extractions through to the cache", ^{
+            [[documentTaskManager getExtractionsForDocument:document] waitUntilFinished];
+            GINIExtraction *extraction = [GINIExtraction extractionWithName:@"amountToPay" value:@"42.00:EUR" entity:@"amount" box:nil];
+            [[documentTaskManager updateExtraction:extraction forDocument:document] waitUntilFinished];
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            [[((GINIExtraction *)extractionsTask.result[@"amountToPay"]).value should] equal:@"42.00:EUR"];
+            [[theValue(apiManager.getExtractionsCalled) should] equal:theValue(1)];
+        });
+    });
+
+    context(@"The feedback", ^{
+        __block GINIDocument *document;
+
+        beforeEach(^{
+            document = [[GINIDocument alloc] initWithId:@"1234"
+                                                  state:GiniDocumentStateComplete
+                                              pageCount:1
+                                   sourceClassification:GiniDocumentSourceClassificationNative
+                                                  links:nil
+                                     compositeDocuments:nil
+                                   partialDocumentInfos:nil];
+        });
+
+        it(@"should not be submitted if no extraction has changed", ^{
+            BFTask *updateTask = [documentTaskManager updateDocument:document];
+            [updateTask waitUntilFinished];
+            [[updateTask.error should] beNil];
+            [[theValue(apiManager.submitBatchFeedbackCalled) should] equal:theValue(0)];
+        });
+
+        it(@"should only contain the changed extractions", ^{
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            ((GINIExtraction *)extractionsTask.result[@"amountToPay"]).value = @"42.00:EUR";
+            [[documentTaskManager updateDocument:document] waitUntilFinished];
+            [[theValue(apiManager.submitBatchFeedbackCalled) should] equal:theValue(1)];
+            [[apiManager.lastBatchFeedback should] equal:@{@"amountToPay": @{@"value": @"42.00:EUR"}}];
+        });
+
+        it(@"should be written through to the cached extractions and keep the layout", ^{
+            apiManager.submitBatchFeedbackError = nil;
+            [[documentTaskManager getLayoutForDocument:document] waitUntilFinished];
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            ((GINIExtraction *)extractionsTask.result[@"amountToPay"]).value = @"42.00:EUR";
+            [[documentTaskManager updateDocument:document] waitUntilFinished];
+
+            BFTask *updatedExtractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [[documentTaskManager getLayoutForDocument:document] waitUntilFinished];
+            [updatedExtractionsTask waitUntilFinished];
+            [[((GINIExtraction *)updatedExtractionsTask.result[@"amountToPay"]).value should] equal:@"42.00:EUR"];
+            [[document.serverExtractions[@"amountToPay"][@"value"] should] equal:@"42.00:EUR"];
+            [[theValue(apiManager.getExtractionsCalled) should] equal:theValue(1)];
+            [[theValue(apiManager.getLayoutCalled) should] equal:theValue(1)];
+        });
+
+        it(@"should not change the extractions handed out before", ^{
+            apiManager.submitBatchFeedbackError = nil;
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            NSMutableDictionary *extractions = extractionsTask.result;
+            GINIExtraction *extraction = extractions[@"amountToPay"];
+            extraction.value = @"42.00:EUR";
+            [[documentTaskManager updateDocument:document] waitUntilFinished];
+            [[extractions[@"amountToPay"] should] beIdenticalTo:extraction];
+
+            [extractions removeObjectForKey:@"amountToPay"];
+            BFTask *updatedExtractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [updatedExtractionsTask waitUntilFinished];
+            [[updatedExtractionsTask.result shouldNot] beIdenticalTo:extractions];
+            [[((GINIExtraction *)updatedExtractionsTask.result[@"amountToPay"]).value should] equal:@"42.00:EUR"];
+        });
+
+        it(@"should only be written through once the outbox has submitted it", ^{
+            NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            documentTaskManager.outbox = [GINIOutbox outboxWithAPIManager:apiManager fileURL:fileURL];
+            // The outbox reports the document ID, so the document must be the instance known to the task manager.
+            BFTask *documentTask = [documentTaskManager getDocumentWithId:@"1234"];
+            [documentTask waitUntilFinished];
+            GINIDocument *document = documentTask.result;
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            NSString *serverValue = document.serverExtractions[@"amountToPay"][@"value"];
+
+            apiManager.submitBatchFeedbackError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+            ((GINIExtraction *)extractionsTask.result[@"amountToPay"]).value = @"42.00:EUR";
+            BFTask *updateTask = [documentTaskManager updateDocument:document];
+            [updateTask waitUntilFinished];
+            [[updateTask.error should] beNil];
+            [[document.serverExtractions[@"amountToPay"][@"value"] should] equal:serverValue];
+
+            apiManager.submitBatchFeedbackError = nil;
+            [[documentTaskManager.outbox flush] waitUntilFinished];
+            [[document.serverExtractions[@"amountToPay"][@"value"] should] equal:@"42.00:EUR"];
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+        });
+
+        it(@"should be coalesced into one batch if debounced", ^{
+            documentTaskManager.feedbackDebounceInterval = 60;
+            BFTask *firstTask = [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"iban" value:@"DE1" entity:@"iban" box:nil]
+                                                          forDocument:document];
+            BFTask *secondTask = [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"iban" value:@"DE2" entity:@"iban" box:nil]
+                                                           forDocument:document];
+            BFTask *thirdTask = [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"bic" value:@"BIC" entity:@"bic" box:nil]
+                                                          forDocument:document];
+            [[theValue(apiManager.submitBatchFeedbackCalled) should] equal:theValue(0)];
+
+            [[documentTaskManager flushFeedbackForDocument:document] waitUntilFinished];
+            [[theValue(apiManager.submitBatchFeedbackCalled) should] equal:theValue(1)];
+            [[apiManager.lastBatchFeedback should] equal:@{@"iban": @{@"value": @"DE2"}, @"bic": @{@"value": @"BIC"}}];
+            // All updates get the result of the single submission, which fails in the mock.
+            for (BFTask *task in @[firstTask, secondTask, thirdTask]) {
+                [task waitUntilFinished];
+                [[task.error.domain should] equal:@"mock"];
+            }
+        });
+    });
+
+    context(@"The debounced feedback", ^{
+        __block GINIDocument *document;
+
+        beforeEach(^{
+            BFTask *documentTask = [documentTaskManager getDocumentWithId:@"1234"];
+            [documentTask waitUntilFinished];
+            document = documentTask.result;
+            [[documentTaskManager getExtractionsForDocument:document] waitUntilFinished];
+            documentTaskManager.feedbackDebounceInterval = 60;
+        });
+
+        it(@"should drop a pending update if the extraction is changed back to the value on the server", ^{
+            NSString *serverValue = document.serverExtractions[@"amountToPay"][@"value"];
+            NSDictionary *serverBox = document.serverExtractions[@"amountToPay"][@"box"];
+            BFTask *editTask = [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"amountToPay" value:@"42.00:EUR" entity:@"amount" box:serverBox]
+                                                         forDocument:document];
+            BFTask *revertTask = [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"amountToPay" value:serverValue entity:@"amount" box:serverBox]
+                                                           forDocument:document];
+            [editTask waitUntilFinished];
+            [revertTask waitUntilFinished];
+            [[editTask.error should] beNil];
+            [[revertTask.error should] beNil];
+
+            [[documentTaskManager flushFeedbackForDocument:document] waitUntilFinished];
+            [[theValue(apiManager.submitBatchFeedbackCalled) should] equal:theValue(0)];
+        });
+
+        it(@"should only submit the other pending updates", ^{
+            NSString *serverValue = document.serverExtractions[@"amountToPay"][@"value"];
+            NSDictionary *serverBox = document.serverExtractions[@"amountToPay"][@"box"];
+            [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"amountToPay" value:@"42.00:EUR" entity:@"amount" box:serverBox]
+                                      forDocument:document];
+            [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"bic" value:@"BIC" entity:@"bic" box:nil]
+                                      forDocument:document];
+            [documentTaskManager updateExtraction:[GINIExtraction extractionWithName:@"amountToPay" value:serverValue entity:@"amount" box:serverBox]
+                                      forDocument:document];
+
+            [[documentTaskManager flushFeedbackForDocument:document] waitUntilFinished];
+            [[apiManager.lastBatchFeedback should] equal:@{@"bic": @{@"value": @"BIC"}}];
+        });
+    });
+
+    context(@"The deletePartialDocumentWithId:cancellationToken: method", ^{
+        it(@"should queue the deletion in the outbox when offline", ^{
+            NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            documentTaskManager.outbox = [GINIOutbox outboxWithAPIManager:apiManager fileURL:fileURL];
+            apiManager.deleteDocumentError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+
+            BFTask *deleteTask = [documentTaskManager deletePartialDocumentWithId:@"1234" cancellationToken:nil];
+            [deleteTask waitUntilFinished];
+            [[deleteTask.error should] beNil];
+            [[theValue(documentTaskManager.outbox.pendingOperationCount) should] equal:theValue(1)];
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+        });
+
+        it(@"should remove the document from the document store", ^{
+            NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            documentTaskManager.documentStore = [GINIDocumentStore documentStoreWithFileURL:fileURL];
+            [documentTaskManager.documentStore storeDocumentResponse:@{@"id": @"1234", @"progress": @"COMPLETED", @"sourceClassification": @"SCANNED"}];
+
+            BFTask *deleteTask = [documentTaskManager deletePartialDocumentWithId:@"1234" cancellationToken:nil];
+            [deleteTask waitUntilFinished];
+            [[deleteTask.error should] beNil];
+            [[apiManager.deletedDocumentIds should] equal:@[@"1234"]];
+            [[theValue(documentTaskManager.documentStore.documentCount) should] equal:theValue(0)];
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+        });
+    });
+
+    context(@"The documentIteratorWithPageSize:readAheadDepth: method", ^{
+        it(@"should return all documents in order and read ahead", ^{
+            GINIDocumentIterator *iterator = [documentTaskManager documentIteratorWithPageSize:2 readAheadDepth:1];
+            BFTask *pageTask = [iterator nextPage];
+            [pageTask waitUntilFinished];
+            [[[pageTask.result valueForKey:@"documentId"] should] equal:@[@"doc0", @"doc1"]];
+            [[apiManager.requestedDocumentListOffsets should] equal:@[@0, @2]];
+            [[theValue(iterator.totalCount) should] equal:theValue(5)];
+
+            NSMutableArray *documentIds = [NSMutableArray new];
+            BFTask *enumerateTask = [iterator enumerateDocumentsUsingBlock:^(GINIDocument *document, BOOL *stop) {
+                [documentIds addObject:document.documentId];
+            }];
+            [enumerateTask waitUntilFinished];
+            [[documentIds should] equal:@[@"doc2", @"doc3", @"doc4"]];
+            [[apiManager.requestedDocumentListOffsets should] equal:@[@0, @2, @4]];
+            [[theValue(iterator.hasMorePages) should] beNo];
+        });
+    });
+
+    context(@"The getBundleForDocumentWithId:contents:previewSize:cancellationToken: method", ^{
+        it(@"should poll the document once and fetch the requested contents", ^{
+            GINIDocumentBundle *bundle = [documentTaskManager getBundleForDocumentWithId:@"1234"
+                                                                                contents:GINIDocumentBundleContentsExtractions | GINIDocumentBundleContentsLayout
+                                                                             previewSize:GiniApiPreviewSizeMedium
+                                                                       cancellationToken:nil];
+            [bundle.completionTask waitUntilFinished];
+            [[bundle.completionTask.result should] beIdenticalTo:bundle];
+            [[bundle.extractionsTask.result[@"amountToPay"] should] beKindOfClass:[GINIExtraction class]];
+            [[bundle.candidatesTask.result[@"amounts"] should] beKindOfClass:[NSArray class]];
+            [[bundle.layoutTask.result should] equal:@{@"pages": @[]}];
+            [[bundle.pagesTask should] beNil];
+            [[theValue(apiManager.getDocumentCalled) should] equal:theValue(1)];
+            [[theValue(apiManager.getExtractionsCalled) should] equal:theValue(1)];
+            [[theValue(apiManager.getLayoutCalled) should] equal:theValue(1)];
+        });
+    });
+
+    context(@"The updateDocumentsWithIds:itemResultBlock:cancellationToken: method", ^{
+        it(@"should not fetch the documents which are already known", ^{
+            BFTask *documentTask = [documentTaskManager getDocumentWithId:@"1234"];
+            [documentTask waitUntilFinished];
+            GINIDocument *document = documentTask.result;
+            BFTask *extractionsTask = [documentTaskManager getExtractionsForDocument:document];
+            [extractionsTask waitUntilFinished];
+            GINIExtraction *extraction = [GINIExtraction extractionWithName:@"amountToPay" value:@"42.00:EUR" entity:@"amount" box:nil];
+
+            BFTask *bulkTask = [documentTaskManager updateDocumentsWithIds:@{@"1234": @{@"amountToPay": extraction}} itemResultBlock:nil cancellationToken:nil];
+            [bulkTask waitUntilFinished];
+            [[theValue(apiManager.getDocumentCalled) should] equal:theValue(1)];
+            [[apiManager.lastBatchFeedback should] equal:@{@"amountToPay": @{@"value": @"42.00:EUR"}}];
+        });
+    });
+
+    context(@"The executors", ^{
+        __block dispatch_queue_t decodingQueue;
+        __block dispatch_queue_t resultQueue;
+
+        beforeEach(^{
+            decodingQueue = dispatch_queue_create("GINIDocumentTaskManagerSpec.decoding", DISPATCH_QUEUE_CONCURRENT);
+            resultQueue = dispatch_queue_create("GINIDocumentTaskManagerSpec.result", DISPATCH_QUEUE_SERIAL);
+            dispatch_queue_set_specific(resultQueue, GINIResultQueueKey, GINIResultQueueKey, NULL);
+            documentTaskManager.decodingExecutor = [BFExecutor executorWithDispatchQueue:decodingQueue];
+            documentTaskManager.resultExecutor = [BFExecutor executorWithDispatchQueue:resultQueue];
+        });
+
+        it(@"should complete the tasks on the result executor", ^{
+            __block BOOL continuedOnResultQueue = NO;
+            // Holds back the completion until the continuation has been added.
+            dispatch_suspend(resultQueue);
+            BFTask *task = [[documentTaskManager getDocumentWithId:@"1234"] continueWithBlock:^id(BFTask *documentTask) {
+                continuedOnResultQueue = dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey;
+                return documentTask;
+            }];
+            dispatch_resume(resultQueue);
+            [task waitUntilFinished];
+            [[task.result should] beKindOfClass:[GINIDocument class]];
+            [[theValue(continuedOnResultQueue) should] beYes];
+        });
+
+        it(@"should complete the extraction tasks on the result executor", ^{
+            BFTask *documentTask = [documentTaskManager getDocumentWithId:@"1234"];
+            [documentTask waitUntilFinished];
+            GINIDocument *document = documentTask.result;
+            __block BOOL continuedOnResultQueue = NO;
+            dispatch_suspend(resultQueue);
+            BFTask *task = [[documentTaskManager getExtractionsForDocument:document] continueWithBlock:^id(BFTask *extractionsTask) {
+                continuedOnResultQueue = dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey;
+                return extractionsTask;
+            }];
+            dispatch_resume(resultQueue);
+            [task waitUntilFinished];
+            [[task.result[@"amountToPay"] should] beKindOfClass:[GINIExtraction class]];
+            [[theValue(continuedOnResultQueue) should] beYes];
+        });
+
+        it(@"should complete the tasks of bundles on the result executor", ^{
+            NSMutableArray *queueChecks = [NSMutableArray new];
+            dispatch_suspend(resultQueue);
+            GINIDocumentBundle *bundle = [documentTaskManager getBundleForDocumentWithId:@"1234"
+                                                                                contents:GINIDocumentBundleContentsExtractions | GINIDocumentBundleContentsLayout
+                                                                             previewSize:GiniApiPreviewSizeMedium
+                                                                       cancellationToken:nil];
+            NSMutableArray *tasks = [NSMutableArray new];
+            for (BFTask *bundleTask in @[bundle.documentTask, bundle.extractionsTask, bundle.layoutTask, bundle.completionTask]) {
+                [tasks addObject:[bundleTask continueWithBlock:^id(BFTask *task) {
+                    @synchronized (queueChecks) {
+                        [queueChecks addObject:@(dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey)];
+                    }
+                    return task;
+                }]];
+            }
+            dispatch_resume(resultQueue);
+            [[BFTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+            [[queueChecks should] equal:@[@YES, @YES, @YES, @YES]];
+        });
+
+        it(@"should complete the tasks of iterators on the result executor", ^{
+            __block BOOL continuedOnResultQueue = NO;
+            GINIDocumentIterator *iterator = [documentTaskManager documentIteratorWithPageSize:2 readAheadDepth:1];
+            dispatch_suspend(resultQueue);
+            BFTask *task = [[iterator nextPage] continueWithBlock:^id(BFTask *pageTask) {
+                continuedOnResultQueue = dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey;
+                return pageTask;
+            }];
+            dispatch_resume(resultQueue);
+            [task waitUntilFinished];
+            [[task.result should] haveCountOf:2];
+            [[theValue(continuedOnResultQueue) should] beYes];
+        });
+
+        it(@"should only complete the outermost task on the result executor", ^{
+            dispatch_semaphore_t itemSemaphore = dispatch_semaphore_create(0);
+            __block BOOL continuedOnResultQueue = NO;
+            // The nested operations must finish while the result queue is held back.
+            dispatch_suspend(resultQueue);
+            BFTask *task = [[documentTaskManager getExtractionsForDocumentsWithIds:@[@"1234"] itemResultBlock:^(GINIBulkItemResult *itemResult) {
+                dispatch_semaphore_signal(itemSemaphore);
+            } cancellationToken:nil] continueWithBlock:^id(BFTask *bulkTask) {
+                continuedOnResultQueue = dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey;
+                return bulkTask;
+            }];
+            long itemTimedOut = dispatch_semaphore_wait(itemSemaphore, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC));
+            dispatch_resume(resultQueue);
+            [task waitUntilFinished];
+            [[theValue(itemTimedOut) should] equal:theValue(0)];
+            [[task.result should] beKindOfClass:[GINIBulkResult class]];
+            [[theValue(continuedOnResultQueue) should] beYes];
+        });
+
+        it(@"should not accept a nil decoding executor", ^{
+            [[theBlock(^{
+                documentTaskManager.decodingExecutor = nil;
+            }) should] raise];
+        });
+    });
 });
 
 SPEC_END
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <UIKit/UIKit.h>
+#import "GINIDocumentTextIndex.h"
+#import "GINIIndexedLayoutPage.h"
+#import "GINIMicrobenchmark.h"
+
+
+/**
+ * Creates a layout page with one line per array of words. Every character of a word is 10 wide, the lines are 20 apart.
+ */
+static NSDictionary *GINITextIndexPage(NSUInteger number, NSArray<NSArray<NSString *> *> *lines) {
+    NSMutableArray *lineDictionaries = [NSMutableArray new];
+    for (NSUInteger lineIndex = 0; lineIndex < [lines count]; lineIndex++) {
+        NSMutableArray *words = [NSMutableArray new];
+        double left = 0;
+        for (NSString *text in lines[lineIndex]) {
+            [words addObject:@{@"l": @(left), @"t": @(lineIndex * 20), @"w": @([text length] * 10), @"h": @10, @"text": text}];
+            left += [text length] * 10 + 10;
+        }
+        [lineDictionaries addObject:@{@"l": @0, @"t": @(lineIndex * 20), @"w": @(left), @"h": @10, @"wds": words}];
+    }
+    return @{@"number": @(number), @"sizeX": @600, @"sizeY": @800, @"textZones": @[@{@"paragraphs": @[@{@"lines": lineDictionaries}]}]};
+}
+
+
+SPEC_BEGIN(GINIDocumentTextIndexSpec)
+
+describe(@"The GINIDocumentTextIndex", ^{
+    __block GINIDocumentTextIndex *textIndex;
+
+    beforeEach(^{
+        NSDictionary *layout = @{@"pages": @[GINITextIndexPage(1, @[@[@"SEPA-Überweisung", @"an"], @[@"Stadtwerke", @"München"]]),
+                                             GINITextIndexPage(2, @[@[@"Überweisung"], @[@"Betrag"]])]};
+        textIndex = [GINIDocumentTextIndex textIndexWithLayoutPages:[GINIIndexedLayoutPage indexedLayoutPagesWithLayout:layout]];
+    });
+
+    it(@"should find substrings ignoring case and diacritics", ^{
+        NSArray<GINITextSearchMatch *> *matches = [textIndex searchForString:@"UBERWEIS" limit:10];
+        [[[matches valueForKey:@"pageNumber"] should] equal:@[@1, @2]];
+        [[matches[0].text should] equal:@"SEPA-Überweisung"];
+        [[theValue(matches[1].wordRange) should] equal:theValue(NSMakeRange(0, 1))];
+        [[[textIndex searchForString:@"UBERWEIS" limit:1] should] haveCountOf:1];
+    });
+
+    it(@"should narrow the box to the matched characters", ^{
+        // "uberweis" are the characters 5 to 12 of "SEPA-Überweisung", which is 160 wide.
+        GINITextSearchMatch *match = [textIndex searchForString:@"überweis" limit:1][0];
+        [[match.rects should] haveCountOf:1];
+        [[theValue([match.rects[0] CGRectValue]) should] equal:theValue(CGRectMake(50, 0, 80, 10))];
+    });
+
+    it(@"should find text across lines, but not across pages", ^{
+        NSArray<GINITextSearchMatch *> *matches = [textIndex searchForString:@"an  stadtwerke" limit:10];
+        [[matches should] haveCountOf:1];
+        [[matches[0].text should] equal:@"an Stadtwerke"];
+        [[theValue(matches[0].wordRange) should] equal:theValue(NSMakeRange(1, 2))];
+        [[matches[0].rects should] haveCountOf:2];
+        [[theValue([matches[0].rects[1] CGRectValue]) should] equal:theValue(CGRectMake(0, 20, 100, 10))];
+
+        [[[textIndex searchForString:@"munchen uberweisung" limit:10] should] beEmpty];
+        [[[textIndex searchForString:@" \n" limit:10] should] beEmpty];
+    });
+
+    it(@"should search 50 pages within a frame", ^{
+        NSArray *words = @[@"Rechnung", @"Betrag", @"Überweisung", @"Kundennummer", @"Datum", @"Gesamt", @"EUR", @"Steuer"];
+        NSMutableArray *pages = [NSMutableArray new];
+        for (NSUInteger number = 1; number <= 50; number++) {
+            NSMutableArray *lines = [NSMutableArray new];
+            for (NSUInteger line = 0; line < 40; line++) {
+                NSMutableArray *lineWords = [NSMutableArray new];
+                for (NSUInteger word = 0; word < 10; word++) {
+                    [lineWords addObject:[NSString stringWithFormat:@"%@%lu", words[(line + word) % [words count]], (unsigned long)(number * line + word)]];
+                }
+                [lines addObject:lineWords];
+            }
+            [pages addObject:GINITextIndexPage(number, lines)];
+        }
+        GINIDocumentTextIndex *largeIndex = [GINIDocumentTextIndex textIndexWithLayoutPages:[GINIIndexedLayoutPage indexedLayoutPagesWithLayout:@{@"pages": pages}]];
+
+        GINIMicrobenchmark *benchmark = [GINIMicrobenchmark benchmarkWithBaselineURL:nil];
+        GINIMicrobenchmarkResult *result = [benchmark measure:@"search.pages50" usingBlock:^id{
+            return [largeIndex searchForString:@"uberweisung1234" limit:100];
+        }];
+        [[theValue(result.medianTime) should] beLessThan:theValue(1.0 / 60)];
+        [[[largeIndex searchForString:@"uberweisung1234" limit:100] shouldNot] beEmpty];
+    });
+});
+
+SPEC_END
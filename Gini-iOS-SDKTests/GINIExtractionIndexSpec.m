@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINIExtractionIndex.h"
+#import "GINIExtraction.h"
+
+
+SPEC_BEGIN(GINIExtractionIndexSpec)
+
+describe(@"The GINIExtractionIndex", ^{
+    __block GINIExtractionIndex *extractionIndex;
+
+    NSArray *(^documentIds)(NSArray *) = ^NSArray *(NSArray *results) {
+        return [results valueForKey:@"documentId"];
+    };
+
+    beforeEach(^{
+        extractionIndex = [GINIExtractionIndex new];
+        [extractionIndex indexExtractions:@{@"iban": [GINIExtraction extractionWithName:@"iban" value:@"DE89 3704 0044 0532 0130 00" entity:@"iban" box:nil],
+                                            @"paymentRecipient": [GINIExtraction extractionWithName:@"paymentRecipient" value:@"Stadtwerke München" entity:@"companyname" box:nil]}
+                        forDocumentWithId:@"doc1"];
+        [extractionIndex indexExtractions:@{@"paymentPurpose": [GINIExtraction extractionWithName:@"paymentPurpose" value:@"Stadtwerke Rechnung 4711" entity:@"text" box:nil]}
+                        forDocumentWithId:@"doc2"];
+    });
+
+    it(@"should find documents by whole words ignoring case and diacritics", ^{
+        [[documentIds([extractionIndex searchWithQuery:@"MUNCHEN" options:GINIExtractionIndexSearchExact limit:10]) should] equal:@[@"doc1"]];
+        [[documentIds([extractionIndex searchWithQuery:@"stadt" options:GINIExtractionIndexSearchExact limit:10]) should] beEmpty];
+        [[theValue(extractionIndex.documentCount) should] equal:theValue(2)];
+    });
+
+    it(@"should find an IBAN with or without spaces", ^{
+        [[documentIds([extractionIndex searchWithQuery:@"DE89370400440532013000" options:GINIExtractionIndexSearchExact limit:10]) should] equal:@[@"doc1"]];
+        [[documentIds([extractionIndex searchWithQuery:@"DE89 3704" options:GINIExtractionIndexSearchExact limit:10]) should] equal:@[@"doc1"]];
+    });
+
+    it(@"should find documents by prefixes and rank by entity", ^{
+        NSArray *results = [extractionIndex searchWithQuery:@"stadt" options:GINIExtractionIndexSearchPrefix limit:10];
+        [[documentIds(results) should] equal:@[@"doc1", @"doc2"]];
+        [[[results[0] extractionNames] should] equal:[NSSet setWithObject:@"paymentRecipient"]];
+        [[documentIds([extractionIndex searchWithQuery:@"stadt" options:GINIExtractionIndexSearchPrefix limit:1]) should] equal:@[@"doc1"]];
+    });
+
+    it(@"should only find documents matching all words", ^{
+        [[documentIds([extractionIndex searchWithQuery:@"stadtwerke 4711" options:GINIExtractionIndexSearchExact limit:10]) should] equal:@[@"doc2"]];
+    });
+
+    it(@"should apply feedback and remove documents", ^{
+        [extractionIndex updateIndexedExtractions:@{@"paymentRecipient": @{@"value": @"Gini GmbH"}} forDocumentWithId:@"doc1"];
+        [[documentIds([extractionIndex searchWithQuery:@"münchen" options:GINIExtractionIndexSearchExact limit:10]) should] beEmpty];
+        [[documentIds([extractionIndex searchWithQuery:@"gini" options:GINIExtractionIndexSearchExact limit:10]) should] equal:@[@"doc1"]];
+
+        [extractionIndex removeDocumentWithId:@"doc1"];
+        [[documentIds([extractionIndex searchWithQuery:@"gini" options:GINIExtractionIndexSearchExact limit:10]) should] beEmpty];
+        [[theValue(extractionIndex.documentCount) should] equal:theValue(1)];
+    });
+
+    it(@"should be written to and read from a file", ^{
+        NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        [[theValue([extractionIndex writeToURL:fileURL error:nil]) should] beYes];
+
+        GINIExtractionIndex *readIndex = [GINIExtractionIndex extractionIndexWithContentsOfURL:fileURL error:nil];
+        [[theValue(readIndex.documentCount) should] equal:theValue(2)];
+        [[documentIds([readIndex searchWithQuery:@"stadt" options:GINIExtractionIndexSearchPrefix limit:10]) should] equal:@[@"doc1", @"doc2"]];
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    });
+
+    it(@"should not read files with an unsupported format", ^{
+        NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        [[@{@"version": @99} description] writeToURL:fileURL atomically:YES encoding:NSUTF8StringEncoding error:nil];
+        NSError *error;
+        [[GINIExtractionIndex extractionIndexWithContentsOfURL:fileURL error:&error] shouldBeNil];
+        [[error shouldNot] beNil];
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIFaultInjectingURLSession.h"
+#import "GINIURLSessionMock.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+#import "GINISDKBuilder.h"
+#import "GINIInjector.h"
+
+
+SPEC_BEGIN(GINIFaultInjectingURLSessionSpec)
+
+describe(@"The GINIFaultInjectingURLSession", ^{
+    __block GINIURLSessionMock *urlSessionMock;
+    __block NSURLRequest *request;
+
+    GINIFaultInjectingURLSession *(^sessionWithRule)(GINIFaultRule *) = ^GINIFaultInjectingURLSession *(GINIFaultRule *rule) {
+        return [GINIFaultInjectingURLSession faultInjectingURLSessionWithURLSession:urlSessionMock rules:@[rule] seed:42];
+    };
+
+    beforeEach(^{
+        urlSessionMock = [GINIURLSessionMock new];
+        [urlSessionMock createAndSetResponse:[@"0123456789" dataUsingEncoding:NSUTF8StringEncoding]
+                                  httpStatus:200
+                                      forURL:@"https://api.gini.net/documents/1234"
+                                       error:NO];
+        request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234"]];
+    });
+
+    it(@"should pass requests through if no rule matches", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:@"POST" pathPattern:nil];
+        rule.serverErrorRate = 1;
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        [[task.error should] beNil];
+        [[theValue(urlSessionMock.requestCount) should] equal:theValue(1)];
+    });
+
+    it(@"should match rules by the path", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:@"^/documents/[^/]+/extractions$"];
+        [[theValue([rule matchesRequest:request]) should] beNo];
+        [[theValue([rule matchesRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234/extractions"]]]) should] beYes];
+    });
+
+    it(@"should inject server errors", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:@"GET" pathPattern:@"^/documents"];
+        rule.serverErrorRate = 1;
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        [[task.error should] beKindOfClass:[GINIHTTPError class]];
+        [[theValue(((GINIHTTPError *)task.error).response.response.statusCode) should] equal:theValue(503)];
+        [[theValue(urlSessionMock.requestCount) should] equal:theValue(0)];
+    });
+
+    it(@"should inject rate limiting with a Retry-After header", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.rateLimitRate = 1;
+        rule.retryAfter = 5;
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        NSHTTPURLResponse *response = ((GINIHTTPError *)task.error).response.response;
+        [[theValue(response.statusCode) should] equal:theValue(429)];
+        [[[response allHeaderFields][@"Retry-After"] should] equal:@"5"];
+    });
+
+    it(@"should inject connection resets", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.connectionResetRate = 1;
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        [[task.error.domain should] equal:NSURLErrorDomain];
+        [[theValue(task.error.code) should] equal:theValue(NSURLErrorNetworkConnectionLost)];
+    });
+
+    it(@"should truncate response bodies", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.truncationRate = 1;
+        GINIFaultInjectingURLSession *session = sessionWithRule(rule);
+        BFTask *task = [session BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        GINIURLResponse *response = task.result;
+        [[theValue([response.data length]) should] beLessThan:theValue(10)];
+        [[theValue(session.injectedFaultCount) should] equal:theValue(1)];
+    });
+
+    it(@"should delay the responses", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.latency = 0.05;
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request];
+        [[theValue(task.completed) should] beNo];
+        [task waitUntilFinished];
+        [[task.error should] beNil];
+    });
+
+    it(@"should stream the bodies of the wrapped session", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.latency = 0.01;
+        NSMutableData *body = [NSMutableData new];
+        BFTask *task = [sessionWithRule(rule) BFStreamingDataTaskWithRequest:request dataBlock:^BOOL(NSData *data) {
+            [body appendData:data];
+            return YES;
+        } cancellationToken:nil];
+        [task waitUntilFinished];
+        [[task.error should] beNil];
+        [[body should] equal:[@"0123456789" dataUsingEncoding:NSUTF8StringEncoding]];
+    });
+
+    it(@"should inject faults into streamed requests", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.serverErrorRate = 1;
+        BFTask *task = [sessionWithRule(rule) BFStreamingDataTaskWithRequest:request dataBlock:^BOOL(NSData *data) {
+            return YES;
+        } cancellationToken:nil];
+        [task waitUntilFinished];
+        [[task.error should] beKindOfClass:[GINIHTTPError class]];
+    });
+
+    it(@"should cancel delayed requests when the cancellation token is cancelled", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.latency = 0.05;
+        BFCancellationTokenSource *cancellationTokenSource = [BFCancellationTokenSource cancellationTokenSource];
+        BFTask *task = [sessionWithRule(rule) BFDataTaskWithRequest:request cancellationToken:cancellationTokenSource.token];
+        [cancellationTokenSource cancel];
+        [task waitUntilFinished];
+        [[theValue(task.cancelled) should] beYes];
+        [[theValue(urlSessionMock.requestCount) should] equal:theValue(0)];
+    });
+
+    it(@"should inject the same faults for the same seed", ^{
+        GINIFaultRule *rule = [GINIFaultRule ruleWithMethod:nil pathPattern:nil];
+        rule.serverErrorRate = 0.5;
+        NSMutableArray *(^run)(void) = ^NSMutableArray *{
+            GINIFaultInjectingURLSession *session = sessionWithRule(rule);
+            NSMutableArray *outcomes = [NSMutableArray new];
+            for (NSUInteger i = 0; i < 20; i++) {
+                BFTask *task = [session BFDataTaskWithRequest:request];
+                [task waitUntilFinished];
+                [outcomes addObject:@(task.error != nil)];
+            }
+            return outcomes;
+        };
+        NSArray *outcomes = run();
+        [[outcomes should] equal:run()];
+        [[outcomes should] containObjects:@YES, @NO, nil];
+    });
+
+    it(@"should be installable in an injector", ^{
+        GINIInjector *injector = [GINISDKBuilder clientFlowWithClientID:@"foobar" urlScheme:@"foobar"].injector;
+        [GINIFaultInjectingURLSession installInInjector:injector rules:@[] seed:1];
+        GINIFaultInjectingURLSession *session = [injector getInstanceOf:@protocol(GINIURLSession)];
+        [[session should] beKindOfClass:[GINIFaultInjectingURLSession class]];
+        [[(NSObject *)session.urlSession should] beKindOfClass:[GINIURLSession class]];
+        [[[injector getInstanceOf:@protocol(GINIURLSession)] should] beIdenticalTo:session];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINIHistogram.h"
+#import "GINIDocumentLifecycleMetrics.h"
+
+
+SPEC_BEGIN(GINIHistogramSpec)
+
+describe(@"The GINIHistogram", ^{
+    __block GINIHistogram *histogram;
+
+    beforeEach(^{
+        histogram = [GINIHistogram new];
+    });
+
+    it(@"should return 0 for all queries when no value was recorded", ^{
+        [[theValue(histogram.totalCount) should] equal:theValue(0)];
+        [[theValue(histogram.minValue) should] equal:theValue(0)];
+        [[theValue(histogram.maxValue) should] equal:theValue(0)];
+        [[theValue([histogram valueAtPercentile:99]) should] equal:theValue(0)];
+    });
+
+    it(@"should count the recorded values", ^{
+        [histogram recordValue:0.1];
+        [histogram recordValue:0.2];
+        [[theValue(histogram.totalCount) should] equal:theValue(2)];
+    });
+
+    it(@"should track the minimum, maximum and mean", ^{
+        [histogram recordValue:0.5];
+        [histogram recordValue:1.5];
+        [[theValue(histogram.minValue) should] equal:0.5 withDelta:0.000001];
+        [[theValue(histogram.maxValue) should] equal:1.5 withDelta:0.000001];
+        [[theValue(histogram.mean) should] equal:1.0 withDelta:0.000001];
+    });
+
+    it(@"should return percentiles with a relative error of less than 4%", ^{
+        for (NSUInteger i = 1; i <= 1000; i++) {
+            [histogram recordValue:i / 1000.0];
+        }
+        [[theValue([histogram valueAtPercentile:50]) should] equal:0.5 withDelta:0.02];
+        [[theValue([histogram valueAtPercentile:90]) should] equal:0.9 withDelta:0.036];
+        [[theValue([histogram valueAtPercentile:100]) should] equal:1.0 withDelta:0.000001];
+    });
+
+    it(@"should not return percentiles larger than the maximum", ^{
+        [histogram recordValue:1.001];
+        [[theValue([histogram valueAtPercentile:99]) should] beLessThanOrEqualTo:theValue(histogram.maxValue)];
+    });
+
+    it(@"should remove all values when being reset", ^{
+        [histogram recordValue:0.1];
+        [histogram reset];
+        [[theValue(histogram.totalCount) should] equal:theValue(0)];
+        [[theValue([histogram valueAtPercentile:50]) should] equal:theValue(0)];
+    });
+
+    it(@"should create independent copies", ^{
+        [histogram recordValue:0.1];
+        GINIHistogram *copy = [histogram copy];
+        [histogram recordValue:0.2];
+        [[theValue(copy.totalCount) should] equal:theValue(1)];
+    });
+
+    it(@"should add the values of another histogram", ^{
+        GINIHistogram *other = [GINIHistogram new];
+        [other recordValue:2];
+        [histogram recordValue:1];
+        [histogram addHistogram:other];
+        [[theValue(histogram.totalCount) should] equal:theValue(2)];
+        [[theValue(histogram.maxValue) should] equal:2 withDelta:0.000001];
+    });
+});
+
+describe(@"The GINIDocumentLifecycleMetrics", ^{
+    __block GINIDocumentLifecycleMetrics *metrics;
+
+    beforeEach(^{
+        metrics = [GINIDocumentLifecycleMetrics new];
+    });
+
+    it(@"should record durations per stage and doctype", ^{
+        [metrics recordDuration:1 forStage:GINIDocumentLifecycleStageUpload docType:@"Invoice"];
+        [metrics recordDuration:2 forStage:GINIDocumentLifecycleStageUpload docType:@"Invoice"];
+        [metrics recordDuration:3 forStage:GINIDocumentLifecycleStageUpload docType:nil];
+
+        [[theValue([metrics histogramForStage:GINIDocumentLifecycleStageUpload docType:@"Invoice"].totalCount) should] equal:theValue(2)];
+        [[theValue([metrics histogramForStage:GINIDocumentLifecycleStageUpload docType:GINIDocumentLifecycleUnknownDocType].totalCount) should] equal:theValue(1)];
+        [[theValue([metrics histogramForStage:GINIDocumentLifecycleStageUpload docType:nil].totalCount) should] equal:theValue(3)];
+        [[theValue([metrics histogramForStage:GINIDocumentLifecycleStageFeedback docType:nil].totalCount) should] equal:theValue(0)];
+    });
+
+    it(@"should create snapshots keyed by the stage name", ^{
+        [metrics recordDuration:1 forStage:GINIDocumentLifecycleStagePending docType:@"Invoice"];
+        NSDictionary *snapshot = [metrics snapshot];
+        GINIHistogram *histogram = snapshot[@"pending"][@"Invoice"];
+        [[theValue(histogram.totalCount) should] equal:theValue(1)];
+    });
+
+    it(@"should remove all values when taking a snapshot with reset", ^{
+        [metrics recordDuration:1 forStage:GINIDocumentLifecycleStageExtractions docType:@"Invoice"];
+        NSDictionary *snapshot = [metrics snapshotAndReset];
+        [[theValue([snapshot count]) should] equal:theValue(1)];
+        [[theValue([[metrics snapshot] count]) should] equal:theValue(0)];
+    });
+});
+
+SPEC_END
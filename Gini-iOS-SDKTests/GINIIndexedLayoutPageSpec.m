@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINIIndexedLayoutPage.h"
+#import "GINILayoutParser.h"
+#import "GINIExtraction.h"
+
+
+SPEC_BEGIN(GINIIndexedLayoutPageSpec)
+
+describe(@"The GINIIndexedLayoutPage", ^{
+    NSDictionary *(^word)(NSString *, double, double, double, double) = ^NSDictionary *(NSString *text, double l, double t, double w, double h) {
+        return @{@"l": @(l), @"t": @(t), @"w": @(w), @"h": @(h), @"text": text};
+    };
+    NSDictionary *pageDictionary = @{@"number": @1, @"sizeX": @600, @"sizeY": @800, @"textZones": @[@{@"paragraphs": @[@{@"lines": @[
+        @{@"l": @50, @"t": @100, @"w": @200, @"h": @10, @"wds": @[word(@"Rechnung", 50, 100, 80, 10), word(@"Nr.", 140, 100, 20, 10), word(@"4711", 170, 100, 80, 10)]},
+        @{@"l": @50, @"t": @120, @"w": @80, @"h": @10, @"wds": @[word(@"Rechnung", 50, 120, 80, 10)]}
+    ]}]}]};
+    __block GINIIndexedLayoutPage *page;
+
+    beforeEach(^{
+        page = [GINIIndexedLayoutPage indexedLayoutPageWithLayoutPage:[GINILayoutPage layoutPageWithDictionary:pageDictionary]];
+    });
+
+    it(@"should keep the words and lines", ^{
+        [[theValue(page.number) should] equal:theValue(1)];
+        [[theValue(page.wordCount) should] equal:theValue(4)];
+        [[theValue(page.lineCount) should] equal:theValue(2)];
+        [[[page textOfWordAtIndex:2] should] equal:@"4711"];
+        [[[page textOfWordAtIndex:3] should] equal:@"Rechnung"];
+        [[theValue([page rectOfWordAtIndex:1]) should] equal:theValue(CGRectMake(140, 100, 20, 10))];
+        [[theValue([page lineIndexOfWordAtIndex:3]) should] equal:theValue(1)];
+        [[theValue([page wordRangeOfLineAtIndex:0]) should] equal:theValue(NSMakeRange(0, 3))];
+        [[theValue([page rectOfLineAtIndex:1]) should] equal:theValue(CGRectMake(50, 120, 80, 10))];
+    });
+
+    it(@"should find the word at a point", ^{
+        [[theValue([page wordIndexAtPoint:CGPointMake(150, 105)]) should] equal:theValue(1)];
+        [[theValue([page wordIndexAtPoint:CGPointMake(135, 105)]) should] equal:theValue(NSNotFound)];
+        [[theValue([page wordIndexAtPoint:CGPointMake(-10, -10)]) should] equal:theValue(NSNotFound)];
+    });
+
+    it(@"should find the nearest word", ^{
+        [[theValue([page nearestWordIndexToPoint:CGPointMake(136, 105) maximumDistance:10]) should] equal:theValue(1)];
+        [[theValue([page nearestWordIndexToPoint:CGPointMake(500, 700) maximumDistance:10]) should] equal:theValue(NSNotFound)];
+        [[theValue([page nearestWordIndexToPoint:CGPointMake(500, 700) maximumDistance:1000]) should] equal:theValue(2)];
+    });
+
+    it(@"should find the words and the text in a rectangle", ^{
+        [[[page wordIndexesInRect:CGRectMake(120, 90, 40, 20)] should] equal:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 2)]];
+        [[[page textInRect:CGRectMake(0, 0, 600, 800)] should] equal:@"Rechnung Nr. 4711\nRechnung"];
+        [[[page textInRect:CGRectMake(300, 300, 10, 10)] should] equal:@""];
+    });
+
+    it(@"should agree with a search of all words on a large page", ^{
+        NSMutableArray *words = [NSMutableArray new];
+        for (NSUInteger i = 0; i < 400; i++) {
+            [words addObject:word([@(i) stringValue], (i % 20) * 30, (i / 20) * 40, 25, 12)];
+        }
+        GINIIndexedLayoutPage *largePage = [GINIIndexedLayoutPage indexedLayoutPagesWithLayout:@{@"pages": @[
+            @{@"number": @1, @"sizeX": @600, @"sizeY": @800, @"textZones": @[@{@"paragraphs": @[@{@"lines": @[@{@"wds": words}]}]}]}
+        ]}][0];
+        for (NSUInteger i = 0; i < 200; i++) {
+            CGPoint point = CGPointMake((CGFloat)((i * 7919) % 640) - 20, (CGFloat)((i * 104729) % 840) - 20);
+            NSUInteger expected = NSNotFound;
+            CGFloat expectedDistance = CGFLOAT_MAX;
+            for (NSUInteger w = 0; w < 400; w++) {
+                CGRect rect = [largePage rectOfWordAtIndex:w];
+                CGFloat dx = MAX(MAX(CGRectGetMinX(rect) - point.x, 0), point.x - CGRectGetMaxX(rect));
+                CGFloat dy = MAX(MAX(CGRectGetMinY(rect) - point.y, 0), point.y - CGRectGetMaxY(rect));
+                CGFloat distance = sqrt(dx * dx + dy * dy);
+                if (distance <= 15 && distance < expectedDistance) {
+                    expected = w;
+                    expectedDistance = distance;
+                }
+            }
+            [[theValue([largePage nearestWordIndexToPoint:point maximumDistance:15]) should] equal:theValue(expected)];
+        }
+    });
+
+    it(@"should find the extraction at a point", ^{
+        GINIExtraction *amount = [GINIExtraction extractionWithName:@"amountToPay" value:@"1:EUR" entity:@"amount"
+                                                                box:@{@"left": @40, @"top": @90, @"width": @300, @"height": @50, @"page": @1}];
+        GINIExtraction *number = [GINIExtraction extractionWithName:@"invoiceNumber" value:@"4711" entity:@"text"
+                                                                box:@{@"left": @170, @"top": @100, @"width": @80, @"height": @10, @"page": @1}];
+        GINIExtraction *otherPage = [GINIExtraction extractionWithName:@"iban" value:@"DE" entity:@"iban"
+                                                                   box:@{@"left": @0, @"top": @0, @"width": @600, @"height": @800, @"page": @2}];
+        NSDictionary *extractions = @{@"amountToPay": amount, @"invoiceNumber": number, @"iban": otherPage};
+        [[[page extractionAtPoint:CGPointMake(200, 105) inExtractions:extractions] should] equal:number];
+        [[[page extractionAtPoint:CGPointMake(60, 130) inExtractions:extractions] should] equal:amount];
+        [[[page extractionAtPoint:CGPointMake(500, 500) inExtractions:extractions] should] beNil];
+    });
+
+    it(@"should convert between the layout and the preview images", ^{
+        // 600x800 fits into 750x900 with a scale of 1.125 and into 1280x1810 with a scale of 2.1333.
+        [[theValue([page scaleForPreviewSize:GiniApiPreviewSizeMedium]) should] equal:1.125 withDelta:0.0001];
+        [[theValue([page scaleForPreviewSize:GiniApiPreviewSizeBig]) should] equal:1280.0 / 600 withDelta:0.0001];
+        CGRect rect = [page convertRect:CGRectMake(100, 200, 40, 80) toPreviewSize:GiniApiPreviewSizeMedium];
+        [[theValue(rect) should] equal:theValue(CGRectMake(112.5, 225, 45, 90))];
+        CGPoint point = [page convertPoint:[page convertPoint:CGPointMake(10, 20) toPreviewSize:GiniApiPreviewSizeBig] fromPreviewSize:GiniApiPreviewSizeBig];
+        [[theValue(point.x) should] equal:10 withDelta:0.0001];
+        [[theValue(point.y) should] equal:20 withDelta:0.0001];
+        CGRect layoutRect = [page convertRect:rect fromPreviewSize:GiniApiPreviewSizeMedium];
+        [[theValue(layoutRect.origin.x) should] equal:100 withDelta:0.0001];
+        [[theValue(layoutRect.size.height) should] equal:80 withDelta:0.0001];
+    });
+});
+
+SPEC_END
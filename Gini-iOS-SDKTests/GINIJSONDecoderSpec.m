@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINIJSONDecoder.h"
+
+
+SPEC_BEGIN(GINIJSONDecoderSpec)
+
+describe(@"The GINIJSONDecoder", ^{
+
+    id (^decode)(NSString *) = ^id(NSString *json) {
+        return [GINIJSONDecoder JSONObjectWithData:[json dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+    };
+
+    NSError *(^decodingError)(NSData *) = ^NSError *(NSData *data) {
+        NSError *error = nil;
+        id result = [GINIJSONDecoder JSONObjectWithData:data error:&error];
+        [[result should] beNil];
+        return error;
+    };
+
+    it(@"should decode the fixtures like NSJSONSerialization", ^{
+        for (NSString *name in @[@"document", @"documents", @"compositedocument", @"pages", @"search", @"session", @"errorreport", @"feedback"]) {
+            NSURL *url = [[NSBundle bundleForClass:[self class]] URLForResource:name withExtension:@"json"];
+            NSData *data = [NSData dataWithContentsOfURL:url];
+            id expected = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:nil];
+            [[expected shouldNot] beNil];
+            [[[GINIJSONDecoder JSONObjectWithData:data error:nil] should] equal:expected];
+        }
+    });
+
+    it(@"should decode nested containers", ^{
+        id result = decode(@" { \"a\" : [ 1 , [ ] , { } , [ { \"b\" : null } ] ] , \"c\" : { \"d\" : [ true , false ] } } ");
+        [[result should] equal:@{@"a": @[@1, @[], @{}, @[@{@"b": [NSNull null]}]], @"c": @{@"d": @[@YES, @NO]}}];
+    });
+
+    it(@"should decode fragments", ^{
+        [[decode(@"\"text\"") should] equal:@"text"];
+        [[decode(@" 42 ") should] equal:@42];
+        [[decode(@"true") should] equal:@YES];
+        [[decode(@"null") should] equal:[NSNull null]];
+    });
+
+    it(@"should decode numbers", ^{
+        NSArray *numbers = decode(@"[0, -7, 123456789012345678, 1.5, -2.25e2, 1E-2, 12345678901234567890]");
+        [[numbers should] equal:@[@0, @-7, @123456789012345678LL, @1.5, @-225.0, @0.01, @12345678901234567890.0]];
+        [[theValue(strcmp([numbers[2] objCType], @encode(long long))) should] equal:theValue(0)];
+    });
+
+    it(@"should decode escapes and unicode", ^{
+        NSString *string = decode(@"\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t \\u00e4\\u20AC\\ud83d\\ude00 äöü €\"");
+        [[string should] equal:@"a\"b\\c/d\b\f\n\r\t ä€\U0001F600 äöü €"];
+    });
+
+    it(@"should decode long strings with escapes at any position", ^{
+        for (NSUInteger position = 0; position < 40; position++) {
+            NSMutableString *expected = [[@"" stringByPaddingToLength:40 withString:@"abcdefgh" startingAtIndex:0] mutableCopy];
+            [expected insertString:@"\"" atIndex:position];
+            NSString *json = [NSString stringWithFormat:@"[\"%@\"]", [expected stringByReplacingOccurrencesOfString:@"\"" withString:@"\\\""]];
+            [[decode(json) should] equal:@[expected]];
+        }
+    });
+
+    it(@"should decode documents with a byte order mark or in UTF-16", ^{
+        NSMutableData *data = [NSMutableData dataWithBytes:"\xEF\xBB\xBF" length:3];
+        [data appendData:[@"[1]" dataUsingEncoding:NSUTF8StringEncoding]];
+        [[[GINIJSONDecoder JSONObjectWithData:data error:nil] should] equal:@[@1]];
+        [[[GINIJSONDecoder JSONObjectWithData:[@"{\"a\": 1}" dataUsingEncoding:NSUTF16LittleEndianStringEncoding] error:nil] should] equal:@{@"a": @1}];
+    });
+
+    it(@"should intern the keys", ^{
+        NSArray *objects = decode(@"[{\"extraction\": 1}, {\"extraction\": 2}]");
+        NSString *firstKey = [[objects[0] allKeys] firstObject];
+        NSString *secondKey = [[objects[1] allKeys] firstObject];
+        [[firstKey should] equal:@"extraction"];
+        [[theValue(firstKey == secondKey) should] beYes];
+    });
+
+    it(@"should return errors for invalid documents", ^{
+        NSArray *invalidDocuments = @[@"", @"[1,]", @"{\"a\": 1,}", @"{\"a\" 1}", @"{a: 1}", @"[1] 2", @"\"unterminated",
+                                      @"\"\\x\"", @"\"\\ud83d\"", @"\"\\ude00\"", @"\"\\u12\"", @"\"a\tb\"", @"01", @"1.",
+                                      @"-", @"1e", @"tru", @"nul", @"[", @"{\"a\":"];
+        for (NSString *document in invalidDocuments) {
+            NSError *error = decodingError([document dataUsingEncoding:NSUTF8StringEncoding]);
+            [[error.domain should] equal:NSCocoaErrorDomain];
+            [[theValue(error.code) should] equal:theValue(NSPropertyListReadCorruptError)];
+            [[error.userInfo[NSDebugDescriptionErrorKey] shouldNot] beNil];
+        }
+    });
+
+    it(@"should return an error for invalid UTF-8", ^{
+        [[decodingError([NSData dataWithBytes:"[\"\xC3\x28\"]" length:6]) shouldNot] beNil];
+    });
+
+    it(@"should return an error for too deeply nested documents", ^{
+        NSString *document = [@"" stringByPaddingToLength:1000 withString:@"[" startingAtIndex:0];
+        [[decodingError([document dataUsingEncoding:NSUTF8StringEncoding]) shouldNot] beNil];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import "GINILayoutParser.h"
+
+
+SPEC_BEGIN(GINILayoutParserSpec)
+
+describe(@"The GINILayoutParser", ^{
+    __block NSMutableArray<GINILayoutPage *> *pages;
+
+    NSDictionary *word = @{@"l": @54.0, @"t": @158.75, @"w": @18.125, @"h": @9.5, @"fontSize": @9.5,
+                           @"fontFamily": @"Arial", @"bold": @NO, @"text": @"Ihre \"Rechnung\" {1}"};
+    NSDictionary *firstPage = @{@"number": @1, @"sizeX": @595.5, @"sizeY": @841.75,
+                                @"textZones": @[@{@"paragraphs": @[@{@"lines": @[@{@"wds": @[word]}]}]}]};
+    NSDictionary *secondPage = @{@"number": @2, @"sizeX": @595.5, @"sizeY": @841.75, @"textZones": @[]};
+
+    /**
+     * Appends the data in parts of the given length and finishes the parser.
+     */
+    BOOL (^parseInParts)(GINILayoutParser *, NSData *, NSUInteger) = ^BOOL(GINILayoutParser *parser, NSData *data, NSUInteger partLength) {
+        for (NSUInteger offset = 0; offset < [data length]; offset += partLength) {
+            NSData *part = [data subdataWithRange:NSMakeRange(offset, MIN(partLength, [data length] - offset))];
+            if (![parser appendData:part error:nil]) {
+                return NO;
+            }
+        }
+        return [parser finishWithError:nil];
+    };
+
+    beforeEach(^{
+        pages = [NSMutableArray new];
+    });
+
+    context(@"with JSON", ^{
+        NSData *json = [NSJSONSerialization dataWithJSONObject:@{@"meta": @{@"pages": @[@"no page"]}, @"pages": @[firstPage, secondPage]}
+                                                       options:NSJSONWritingPrettyPrinted
+                                                         error:nil];
+
+        it(@"should emit each page when its data is complete", ^{
+            GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeJSON pageBlock:^(GINILayoutPage *page) {
+                [pages addObject:page];
+            }];
+            NSUInteger firstPageEnd = [json rangeOfData:[@"\"number\" : 2" dataUsingEncoding:NSUTF8StringEncoding] options:0 range:NSMakeRange(0, [json length])].location;
+            [[theValue([parser appendData:[json subdataWithRange:NSMakeRange(0, firstPageEnd)] error:nil]) should] beYes];
+            [[theValue([pages count]) should] equal:theValue(1)];
+
+            [[theValue([parser appendData:[json subdataWithRange:NSMakeRange(firstPageEnd, [json length] - firstPageEnd)] error:nil]) should] beYes];
+            [[theValue([parser finishWithError:nil]) should] beYes];
+            [[[pages valueForKey:@"dictionary"] should] equal:@[firstPage, secondPage]];
+            [[theValue(pages[0].number) should] equal:theValue(1)];
+            [[theValue(pages[0].width) should] equal:595.5 withDelta:0.001];
+            [[theValue(parser.pageCount) should] equal:theValue(2)];
+        });
+
+        it(@"should decode the data in arbitrary parts", ^{
+            for (NSUInteger partLength = 1; partLength < 12; partLength++) {
+                [pages removeAllObjects];
+                GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeJSON pageBlock:^(GINILayoutPage *page) {
+                    [pages addObject:page];
+                }];
+                [[theValue(parseInParts(parser, json, partLength)) should] beYes];
+                [[[pages valueForKey:@"dictionary"] should] equal:@[firstPage, secondPage]];
+            }
+        });
+
+        it(@"should fail for invalid and incomplete data", ^{
+            GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeJSON pageBlock:^(GINILayoutPage *page) {}];
+            NSError *error;
+            [[theValue([parser appendData:[@"{\"pages\": [{]}" dataUsingEncoding:NSUTF8StringEncoding] error:&error]) should] beNo];
+            [[error shouldNot] beNil];
+
+            parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeJSON pageBlock:^(GINILayoutPage *page) {}];
+            [[theValue(parseInParts(parser, [json subdataWithRange:NSMakeRange(0, [json length] - 1)], 100)) should] beNo];
+        });
+    });
+
+    context(@"with XML", ^{
+        it(@"should convert the pages to the format of the JSON layout", ^{
+            NSData *xml = [NSData dataWithContentsOfURL:[[NSBundle bundleForClass:[self class]] URLForResource:@"layout" withExtension:@"xml"]];
+            for (NSUInteger partLength = 1; partLength < 4096; partLength *= 4) {
+                [pages removeAllObjects];
+                GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeXML pageBlock:^(GINILayoutPage *page) {
+                    [pages addObject:page];
+                }];
+                [[theValue(parseInParts(parser, xml, partLength)) should] beYes];
+                [[theValue([pages count]) should] equal:theValue(1)];
+                GINILayoutPage *page = pages[0];
+                [[theValue(page.number) should] equal:theValue(1)];
+                [[theValue(page.width) should] equal:337.327637 withDelta:0.000001];
+
+                NSDictionary *firstWord = page.dictionary[@"textZones"][0][@"paragraphs"][0][@"lines"][0][@"wds"][0];
+                [[firstWord[@"text"] should] equal:@"SEPA-Überweisung"];
+                [[firstWord[@"fontFamily"] should] equal:@"Arial"];
+                [[firstWord[@"l"] should] equal:@16.0];
+                [[firstWord[@"bold"] should] equal:@NO];
+                NSDictionary *secondLine = page.dictionary[@"textZones"][1][@"paragraphs"][0][@"lines"][0];
+                [[[secondLine[@"wds"] valueForKey:@"text"] should] equal:@[@"l&l", @"Internet", @"AG"]];
+            }
+        });
+
+        it(@"should fail for an incomplete page", ^{
+            GINILayoutParser *parser = [GINILayoutParser layoutParserWithResponseType:GiniAPIResponseTypeXML pageBlock:^(GINILayoutPage *page) {}];
+            NSData *xml = [@"<Document><Pages><Page Number=\"1\"><TextZone>" dataUsingEncoding:NSUTF8StringEncoding];
+            [[theValue([parser appendData:xml error:nil]) should] beYes];
+            [[theValue([parser finishWithError:nil]) should] beNo];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIOutbox.h"
+#import "GINIHistogram.h"
+#import "GINIAPIManagerMock.h"
+
+
+/**
+ * An API manager whose feedback and delete requests fail with the configured error.
+ */
+@interface GINIOutboxAPIManagerMock : GINIAPIManagerMock
+@property NSError *error;
+@property NSMutableArray<NSString *> *requests;
+@end
+
+@implementation GINIOutboxAPIManagerMock
+
+- (BFTask *)submitBatchFeedbackForDocument:(NSString *)documentId feedback:(NSDictionary *)feedback {
+    [self.requests addObject:[NSString stringWithFormat:@"feedback %@ %@", documentId, [[[feedback allKeys] sortedArrayUsingSelector:@selector(compare:)] componentsJoinedByString:@","]]];
+    return self.error ? [BFTask taskWithError:self.error] : [BFTask taskWithResult:nil];
+}
+
+- (BFTask *)deleteDocument:(NSString *)documentId {
+    [self.requests addObject:[NSString stringWithFormat:@"delete %@", documentId]];
+    return self.error ? [BFTask taskWithError:self.error] : [BFTask taskWithResult:nil];
+}
+
+@end
+
+
+SPEC_BEGIN(GINIOutboxSpec)
+
+describe(@"The GINIOutbox", ^{
+    __block GINIOutboxAPIManagerMock *apiManager;
+    __block NSURL *fileURL;
+    __block GINIOutbox *outbox;
+
+    beforeEach(^{
+        apiManager = [GINIOutboxAPIManagerMock new];
+        apiManager.requests = [NSMutableArray new];
+        fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        outbox = [GINIOutbox outboxWithAPIManager:apiManager fileURL:fileURL];
+    });
+
+    afterEach(^{
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    });
+
+    it(@"should merge the feedback of a document", ^{
+        [outbox enqueueFeedback:@{@"iban": @{@"value": @"DE1"}} forDocumentWithId:@"1234"];
+        [outbox enqueueFeedback:@{@"bic": @{@"value": @"BIC"}} forDocumentWithId:@"1234"];
+        [[theValue(outbox.pendingOperationCount) should] equal:theValue(1)];
+
+        BFTask *flushTask = [outbox flush];
+        [flushTask waitUntilFinished];
+        [[flushTask.result should] equal:@0];
+        [[apiManager.requests should] equal:@[@"feedback 1234 bic,iban"]];
+        [[theValue(outbox.flushLatency.totalCount) should] equal:theValue(1)];
+    });
+
+    it(@"should replace all operations of a document by its deletion", ^{
+        [outbox enqueueFeedback:@{@"iban": @{@"value": @"DE1"}} forDocumentWithId:@"1234"];
+        [outbox enqueueDeletionOfDocumentWithId:@"1234"];
+        [[outbox flush] waitUntilFinished];
+        [[apiManager.requests should] equal:@[@"delete 1234"]];
+    });
+
+    it(@"should keep operations that failed because of the network", ^{
+        apiManager.error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+        [outbox enqueueDeletionOfDocumentWithId:@"1234"];
+        BFTask *flushTask = [outbox flush];
+        [flushTask waitUntilFinished];
+        [[flushTask.result should] equal:@1];
+
+        apiManager.error = nil;
+        [[outbox flush] waitUntilFinished];
+        [[theValue(outbox.pendingOperationCount) should] equal:theValue(0)];
+        [[apiManager.requests should] equal:@[@"delete 1234", @"delete 1234"]];
+    });
+
+    it(@"should start a new flush after a flush completed synchronously", ^{
+        BFTask *emptyFlushTask = [outbox flush];
+        [emptyFlushTask waitUntilFinished];
+        [[emptyFlushTask.result should] equal:@0];
+        [outbox enqueueDeletionOfDocumentWithId:@"1234"];
+        BFTask *flushTask = [outbox flush];
+        [flushTask waitUntilFinished];
+        [[flushTask.result should] equal:@0];
+        [[apiManager.requests should] equal:@[@"delete 1234"]];
+    });
+
+    it(@"should only treat connectivity errors as transient", ^{
+        for (NSNumber *code in @[@(NSURLErrorNotConnectedToInternet), @(NSURLErrorNetworkConnectionLost), @(NSURLErrorTimedOut)]) {
+            [[theValue([GINIOutbox isTransientError:[NSError errorWithDomain:NSURLErrorDomain code:[code integerValue] userInfo:nil]]) should] beYes];
+        }
+        for (NSNumber *code in @[@(NSURLErrorCancelled), @(NSURLErrorBadURL), @(NSURLErrorUserAuthenticationRequired), @(NSURLErrorServerCertificateUntrusted)]) {
+            [[theValue([GINIOutbox isTransientError:[NSError errorWithDomain:NSURLErrorDomain code:[code integerValue] userInfo:nil]]) should] beNo];
+        }
+    });
+
+    it(@"should report the submitted operations", ^{
+        NSMutableArray *submitted = [NSMutableArray new];
+        outbox.feedbackSubmittedBlock = ^(NSString *documentId, NSDictionary *feedback) {
+            [submitted addObject:@[documentId, feedback]];
+        };
+        outbox.deletionSubmittedBlock = ^(NSString *documentId) {
+            [submitted addObject:@[documentId]];
+        };
+        [outbox enqueueFeedback:@{@"iban": @{@"value": @"DE1"}} forDocumentWithId:@"1234"];
+        [outbox enqueueDeletionOfDocumentWithId:@"5678"];
+        [[outbox flush] waitUntilFinished];
+        [[submitted should] haveCountOf:2];
+        [[submitted should] containObjectsInArray:@[@[@"1234", @{@"iban": @{@"value": @"DE1"}}], @[@"5678"]]];
+    });
+
+    it(@"should not report dropped operations", ^{
+        __block BOOL reported = NO;
+        outbox.deletionSubmittedBlock = ^(NSString *documentId) {
+            reported = YES;
+        };
+        apiManager.error = [NSError errorWithDomain:@"mock" code:1 userInfo:nil];
+        [outbox enqueueDeletionOfDocumentWithId:@"1234"];
+        [[outbox flush] waitUntilFinished];
+        [[theValue(reported) should] beNo];
+    });
+
+    it(@"should drop operations that failed permanently", ^{
+        apiManager.error = [NSError errorWithDomain:@"mock" code:1 userInfo:nil];
+        [outbox enqueueDeletionOfDocumentWithId:@"1234"];
+        [[outbox flush] waitUntilFinished];
+        [[theValue(outbox.pendingOperationCount) should] equal:theValue(0)];
+        [[theValue(outbox.flushLatency.totalCount) should] equal:theValue(0)];
+    });
+
+    it(@"should restore the queued operations from its file", ^{
+        [outbox enqueueErrorReportWithSummary:@"summary" description:@"description" forDocumentWithId:@"1234"];
+        GINIOutbox *restoredOutbox = [GINIOutbox outboxWithAPIManager:apiManager fileURL:fileURL];
+        [[theValue(restoredOutbox.pendingOperationCount) should] equal:theValue(1)];
+    });
+});
+
+SPEC_END
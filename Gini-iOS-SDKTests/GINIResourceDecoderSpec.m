@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIResourceDecoder.h"
+#import "GINIJSONDecoder.h"
+#import "GINIDocument.h"
+#import "GINIDocumentTaskManager.h"
+#import "GINIExtraction.h"
+#import "GINISession.h"
+#import "GINISessionParser.h"
+
+
+@interface GINIDocumentTaskManager (TestVisibility)
+- (BFTask *)createExtractionsForGetTask:(BFTask *)getTask;
+@end
+
+
+SPEC_BEGIN(GINIResourceDecoderSpec)
+
+describe(@"The GINIResourceDecoder", ^{
+    __block GINIResourceDecoder *resourceDecoder;
+
+    NSData *(^fixture)(NSString *) = ^NSData *(NSString *name) {
+        NSURL *url = [[NSBundle bundleForClass:[GINIResourceDecoder class]] URLForResource:name withExtension:@"json"];
+        return [NSData dataWithContentsOfURL:url];
+    };
+
+    void (^compareDocuments)(GINIDocument *, GINIDocument *) = ^(GINIDocument *document, GINIDocument *expected) {
+        [[document.documentId should] equal:expected.documentId];
+        [[theValue(document.state) should] equal:theValue(expected.state)];
+        [[theValue(document.pageCount) should] equal:theValue(expected.pageCount)];
+        [[theValue(document.sourceClassification) should] equal:theValue(expected.sourceClassification)];
+        [[document.filename should] equal:expected.filename];
+        [[document.creationDate should] equal:expected.creationDate];
+        [[document.links.extractions should] equal:expected.links.extractions];
+        [[document.links.layout should] equal:expected.links.layout];
+        [[document.compositeDocuments should] equal:expected.compositeDocuments];
+        [[theValue([document.partialDocumentInfos count]) should] equal:theValue([expected.partialDocumentInfos count])];
+        for (NSUInteger i = 0; i < [document.partialDocumentInfos count]; i++) {
+            [[document.partialDocumentInfos[i].documentUrl should] equal:expected.partialDocumentInfos[i].documentUrl];
+            [[theValue(document.partialDocumentInfos[i].rotationDelta) should] equal:theValue(expected.partialDocumentInfos[i].rotationDelta)];
+        }
+    };
+
+    beforeEach(^{
+        resourceDecoder = [GINIResourceDecoder resourceDecoderWithDocumentManager:nil];
+    });
+
+    it(@"should decode documents like the dictionaries", ^{
+        for (NSString *name in @[@"document", @"compositedocument"]) {
+            NSData *data = fixture(name);
+            NSDictionary *apiResponse = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+            GINIDocument *document = [resourceDecoder documentWithData:data error:nil];
+            [[document shouldNot] beNil];
+            compareDocuments(document, [GINIDocument documentFromAPIResponse:apiResponse withDocumentManager:nil]);
+        }
+    });
+
+    it(@"should decode lists of documents", ^{
+        NSData *data = fixture(@"documents");
+        NSDictionary *apiResponse = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+        NSUInteger totalCount = 0;
+        NSArray<GINIDocument *> *documents = [resourceDecoder documentsWithData:data totalCount:&totalCount error:nil];
+        [[documents should] haveCountOf:[apiResponse[@"documents"] count]];
+        [[theValue(totalCount) should] equal:apiResponse[@"totalCount"]];
+        for (NSUInteger i = 0; i < [documents count]; i++) {
+            compareDocuments(documents[i], [GINIDocument documentFromAPIResponse:apiResponse[@"documents"][i] withDocumentManager:nil]);
+        }
+    });
+
+    it(@"should leave out invalid documents of lists", ^{
+        NSData *data = [@"{\"documents\": [{\"id\": \"1\", \"progress\": \"UNKNOWN\", \"sourceClassification\": \"NATIVE\"}, 42, "
+                        "{\"progress\": \"PENDING\", \"sourceClassification\": \"NATIVE\"}, "
+                        "{\"id\": \"2\", \"progress\": \"PENDING\", \"sourceClassification\": \"NATIVE\", \"unknown\": [{\"a\": \"\\\"\"}]}]}"
+                        dataUsingEncoding:NSUTF8StringEncoding];
+        NSUInteger totalCount = 7;
+        NSArray<GINIDocument *> *documents = [resourceDecoder documentsWithData:data totalCount:&totalCount error:nil];
+        [[documents should] haveCountOf:1];
+        [[documents[0].documentId should] equal:@"2"];
+        [[theValue(documents[0].state) should] equal:theValue(GiniDocumentStatePending)];
+        [[theValue(totalCount) should] equal:theValue(7)];
+    });
+
+    it(@"should return an error for data which is not a document", ^{
+        NSError *error = nil;
+        [[[resourceDecoder documentWithData:[@"[]" dataUsingEncoding:NSUTF8StringEncoding] error:&error] should] beNil];
+        [[error.domain should] equal:NSCocoaErrorDomain];
+        error = nil;
+        [[[resourceDecoder documentWithData:[@"{\"id\": " dataUsingEncoding:NSUTF8StringEncoding] error:&error] should] beNil];
+        [[error shouldNot] beNil];
+    });
+
+    it(@"should decode extractions like the dictionaries", ^{
+        NSDictionary *apiResponse = @{@"extractions": @{@"amountToPay": @{@"entity": @"amount", @"value": @"24.99:EUR",
+                                                                          @"box": @{@"height": @9.0, @"left": @516.0, @"page": @1, @"top": @588.0, @"width": @42.0}},
+                                                        @"iban": @{@"entity": @"iban", @"value": @"DE22790400470213930400"},
+                                                        @"docType": @{@"entity": @"text", @"value": @"Invoice"}},
+                                      @"candidates": @{@"amount": @[@{@"value": @"24.99:EUR", @"box": @{@"page": @1}}, @{@"value": @"5.00:EUR"}],
+                                                       @"iban": @[@{@"value": @"DE22790400470213930400"}]}};
+        NSData *data = [NSJSONSerialization dataWithJSONObject:apiResponse options:0 error:nil];
+        NSMutableDictionary *result = [GINIResourceDecoder extractionsWithData:data error:nil];
+        BFTask *expectedTask = [[[GINIDocumentTaskManager alloc] initWithAPIManager:nil] createExtractionsForGetTask:[BFTask taskWithResult:apiResponse]];
+        [expectedTask waitUntilFinished];
+        NSDictionary *expected = expectedTask.result;
+
+        [[result[@"extractions"] should] beKindOfClass:[NSMutableDictionary class]];
+        [[[result[@"extractions"] allKeys] should] containObjectsInArray:[expected[@"extractions"] allKeys]];
+        [[result[@"extractions"] should] haveCountOf:[expected[@"extractions"] count]];
+        for (NSString *name in expected[@"extractions"]) {
+            GINIExtraction *extraction = result[@"extractions"][name];
+            GINIExtraction *expectedExtraction = expected[@"extractions"][name];
+            [[extraction.name should] equal:expectedExtraction.name];
+            [[extraction.value should] equal:expectedExtraction.value];
+            [[extraction.entity should] equal:expectedExtraction.entity];
+            [[extraction.box should] equal:expectedExtraction.box];
+            [[extraction.candidates should] haveCountOf:[expectedExtraction.candidates count]];
+            [[theValue(extraction.candidates == result[@"candidates"][extraction.entity] || [extraction.candidates count] == 0) should] beYes];
+        }
+        for (NSString *entity in expected[@"candidates"]) {
+            NSArray<GINIExtraction *> *candidates = result[@"candidates"][entity];
+            [[candidates should] haveCountOf:[expected[@"candidates"][entity] count]];
+            for (NSUInteger i = 0; i < [candidates count]; i++) {
+                GINIExtraction *expectedCandidate = expected[@"candidates"][entity][i];
+                [[candidates[i].name should] beNil];
+                [[candidates[i].entity should] equal:entity];
+                [[candidates[i].value should] equal:expectedCandidate.value];
+                [[candidates[i].box should] equal:expectedCandidate.box];
+            }
+        }
+    });
+
+    it(@"should intern the entities", ^{
+        NSData *data = [@"{\"extractions\": {\"a\": {\"entity\": \"amount\", \"value\": \"1\"}, \"b\": {\"entity\": \"amount\", \"value\": \"2\"}}}"
+                        dataUsingEncoding:NSUTF8StringEncoding];
+        NSDictionary *extractions = [GINIResourceDecoder extractionsWithData:data error:nil][@"extractions"];
+        [[theValue(((GINIExtraction *)extractions[@"a"]).entity == ((GINIExtraction *)extractions[@"b"]).entity) should] beYes];
+    });
+
+    it(@"should decode sessions", ^{
+        NSData *data = fixture(@"session");
+        GINISession *session = [GINIResourceDecoder sessionWithData:data error:nil];
+        GINISession *expected = [GINISessionParser sessionWithJSONDictionary:[NSJSONSerialization JSONObjectWithData:data options:0 error:nil]];
+        [[session.accessToken should] equal:expected.accessToken];
+        [[session.refreshToken should] equal:expected.refreshToken];
+        [[theValue([session.expirationDate timeIntervalSinceDate:expected.expirationDate]) should] beWithin:theValue(1) of:theValue(0)];
+    });
+});
+
+describe(@"The GINIJSONSchema", ^{
+
+    it(@"should skip the values which do not match", ^{
+        GINIJSONSchema *schema = [GINIJSONSchema objectSchemaWithKeys:@[@"number", @"strings", @"map"]
+                                                              schemas:@[[GINIJSONSchema numberSchema],
+                                                                        [GINIJSONSchema arraySchemaWithElements:[GINIJSONSchema stringSchema]],
+                                                                        [GINIJSONSchema mapSchemaWithValues:[GINIJSONSchema numberSchema]]]
+                                                                build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            return @[fields[0] ?: [NSNull null], fields[1] ?: [NSNull null], fields[2] ?: [NSNull null]];
+        }];
+        NSData *data = [@"{\"number\": \"1\", \"strings\": [\"a\", 1, null, \"b\", {\"c\": [true]}], \"map\": {\"x\": 1, \"y\": \"2\"}, \"other\": {\"d\": [1.5e3, false]}}"
+                        dataUsingEncoding:NSUTF8StringEncoding];
+        NSArray *result = [GINIJSONDecoder objectWithData:data schema:schema error:nil];
+        [[result should] equal:@[[NSNull null], @[@"a", @"b"], @{@"x": @1}]];
+    });
+
+    it(@"should return an error for invalid JSON in skipped values", ^{
+        GINIJSONSchema *schema = [GINIJSONSchema objectSchemaWithKeys:@[] schemas:@[] build:^id(const __unsafe_unretained id *fields, NSString *mapKey) {
+            return @YES;
+        }];
+        NSError *error = nil;
+        [[[GINIJSONDecoder objectWithData:[@"{\"other\": [1,]}" dataUsingEncoding:NSUTF8StringEncoding] schema:schema error:&error] should] beNil];
+        [[theValue(error.code) should] equal:theValue(NSPropertyListReadCorruptError)];
+        [[[GINIJSONDecoder objectWithData:[@"{\"other\": [1]}" dataUsingEncoding:NSUTF8StringEncoding] schema:schema error:nil] should] equal:@YES];
+    });
+});
+
+SPEC_END
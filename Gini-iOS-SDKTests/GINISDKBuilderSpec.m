@@ -1,4 +1,5 @@
 #import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
 #import "GINISDKBuilder.h"
 #import "GiniSDK.h"
 #import "GINISessionManagerClientFlow.h"
@@ -192,6 +193,52 @@ SPEC_BEGIN(GINISDKBuilderSpec)
             });
         });
 
+        context(@"The useDecodingQualityOfService: method", ^{
+            it(@"should decode on a queue which is not the main queue by default", ^{
+                GiniSDK *sdk = [[GINISDKBuilder clientFlowWithClientID:@"foobar" urlScheme:@"foobar"] build];
+                BFExecutor *decodingExecutor = sdk.APIManager.decodingExecutor;
+                [[decodingExecutor shouldNot] equal:[BFExecutor defaultExecutor]];
+                [[sdk.documentTaskManager.decodingExecutor should] equal:decodingExecutor];
+
+                __block BOOL isMainThread = YES;
+                BFTask *task = [[BFTask taskWithResult:nil] continueWithExecutor:decodingExecutor withBlock:^id(BFTask *t) {
+                    isMainThread = [NSThread isMainThread];
+                    return nil;
+                }];
+                [task waitUntilFinished];
+                [[theValue(isMainThread) should] beNo];
+            });
+
+            it(@"should be chainable", ^{
+                GINISDKBuilder *builder = [GINISDKBuilder clientFlowWithClientID:@"foobar" urlScheme:@"foobar"];
+
+                [[[builder useDecodingQualityOfService:NSQualityOfServiceUtility] should] equal:builder];
+            });
+        });
+
+        context(@"The useResultQueue: method", ^{
+            it(@"should complete the tasks of the document task manager on the queue", ^{
+                dispatch_queue_t queue = dispatch_queue_create("GINISDKBuilderSpec", DISPATCH_QUEUE_SERIAL);
+                GiniSDK *sdk = [[[GINISDKBuilder clientFlowWithClientID:@"foobar" urlScheme:@"foobar"] useResultQueue:queue] build];
+                [[sdk.documentTaskManager.resultExecutor shouldNot] beNil];
+
+                static void *GINIResultQueueKey = &GINIResultQueueKey;
+                dispatch_queue_set_specific(queue, GINIResultQueueKey, GINIResultQueueKey, NULL);
+                __block BOOL isResultQueue = NO;
+                BFTask *task = [[BFTask taskWithResult:nil] continueWithExecutor:sdk.documentTaskManager.resultExecutor withBlock:^id(BFTask *t) {
+                    isResultQueue = dispatch_get_specific(GINIResultQueueKey) == GINIResultQueueKey;
+                    return nil;
+                }];
+                [task waitUntilFinished];
+                [[theValue(isResultQueue) should] beYes];
+            });
+
+            it(@"should not complete the tasks on another queue by default", ^{
+                GiniSDK *sdk = [[GINISDKBuilder clientFlowWithClientID:@"foobar" urlScheme:@"foobar"] build];
+                [[sdk.documentTaskManager.resultExecutor should] beNil];
+            });
+        });
+
     });
 
 SPEC_END
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINISearchSession.h"
+#import "GINIDocumentTaskManager.h"
+#import "GINIAPIManagerMock.h"
+
+
+/**
+ * An API manager which records the search terms and finds one document per search.
+ */
+@interface GINISearchAPIManagerMock : GINIAPIManagerMock
+@property NSMutableArray<NSString *> *searchTerms;
+@end
+
+@implementation GINISearchAPIManagerMock
+
+- (BFTask *)search:(NSString *)searchTerm
+             limit:(NSUInteger)limit
+            offset:(NSUInteger)offset
+           docType:(NSString *)docType
+ cancellationToken:(BFCancellationToken *)cancellationToken {
+    [self.searchTerms addObject:searchTerm];
+    return [BFTask taskWithResult:@{
+                                    @"totalCount": @1,
+                                    @"documents": @[@{@"id": @"1234", @"progress": @"COMPLETED", @"sourceClassification": @"SCANNED"}]
+                                    }];
+}
+
+@end
+
+
+SPEC_BEGIN(GINISearchSessionSpec)
+
+describe(@"The GINISearchSession", ^{
+    __block GINISearchAPIManagerMock *apiManager;
+    __block GINISearchSession *searchSession;
+
+    beforeEach(^{
+        apiManager = [GINISearchAPIManagerMock new];
+        apiManager.searchTerms = [NSMutableArray new];
+        searchSession = [GINISearchSession searchSessionWithDocumentTaskManager:[GINIDocumentTaskManager documentTaskManagerWithAPIManager:apiManager]];
+        searchSession.debounceInterval = 0.05;
+    });
+
+    it(@"should normalize the queries", ^{
+        [[[GINISearchSession normalizedQuery:@"  Kitten \n Invoice "] should] equal:@"kitten invoice"];
+    });
+
+    it(@"should only search for the latest query", ^{
+        BFTask *firstTask = [searchSession searchWithQuery:@"inv"];
+        BFTask *secondTask = [searchSession searchWithQuery:@"Invoice"];
+        [secondTask waitUntilFinished];
+        [[theValue(firstTask.cancelled) should] beYes];
+        [[[secondTask.result query] should] equal:@"invoice"];
+        [[apiManager.searchTerms should] equal:@[@"invoice"]];
+    });
+
+    it(@"should answer repeated queries from the cache", ^{
+        [[searchSession searchWithQuery:@"invoice"] waitUntilFinished];
+        BFTask *cachedTask = [searchSession searchWithQuery:@" INVOICE"];
+        [[theValue(cachedTask.completed) should] beYes];
+        [[[[cachedTask.result documents] valueForKey:@"documentId"] should] equal:@[@"1234"]];
+        [[apiManager.searchTerms should] equal:@[@"invoice"]];
+    });
+
+    it(@"should evict the least recently used results", ^{
+        searchSession.cacheCapacity = 1;
+        [[searchSession searchWithQuery:@"invoice"] waitUntilFinished];
+        [[searchSession searchWithQuery:@"kitten"] waitUntilFinished];
+        [[searchSession searchWithQuery:@"invoice"] waitUntilFinished];
+        [[apiManager.searchTerms should] equal:@[@"invoice", @"kitten", @"invoice"]];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINIAPIStandInURLSession.h"
+#import "GINIAPIManager.h"
+#import "GINIAPIManagerRequestFactory.h"
+#import "GINIDocumentTaskManager.h"
+#import "GINISessionManagerMock.h"
+#import "GINIHistogram.h"
+
+
+/**
+ * Runs the upload → poll → extract workflow for a number of documents with a fixed number of concurrent workers and
+ * records the latency of every document.
+ */
+@interface GINIBenchmarkWorkload : NSObject
+
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager data:(NSData *)data;
+
+/// Resolves when all documents are processed. Failed documents don't fail the task but are counted in `errorCount`.
+- (BFTask *)runWithDocumentCount:(NSUInteger)documentCount concurrency:(NSUInteger)concurrency;
+
+/// The latencies of the successfully processed documents.
+@property (readonly) GINIHistogram *latencies;
+
+@property (readonly) NSUInteger errorCount;
+
+/// The processed documents per second of the last run.
+@property (readonly) double throughput;
+
+@end
+
+@implementation GINIBenchmarkWorkload {
+    GINIDocumentTaskManager *_documentTaskManager;
+    NSData *_data;
+    NSUInteger _remainingDocuments;
+}
+
+- (instancetype)initWithDocumentTaskManager:(GINIDocumentTaskManager *)documentTaskManager data:(NSData *)data {
+    self = [super init];
+    if (self) {
+        _documentTaskManager = documentTaskManager;
+        _data = data;
+        _latencies = [GINIHistogram new];
+    }
+    return self;
+}
+
+- (BFTask *)runWithDocumentCount:(NSUInteger)documentCount concurrency:(NSUInteger)concurrency {
+    _remainingDocuments = documentCount;
+    NSTimeInterval start = GINIMonotonicTimestamp();
+    NSMutableArray *workers = [NSMutableArray new];
+    for (NSUInteger i = 0; i < concurrency; i++) {
+        [workers addObject:[self processNextDocument]];
+    }
+    return [[BFTask taskForCompletionOfAllTasks:workers] continueWithBlock:^id(BFTask *task) {
+        self->_throughput = documentCount / (GINIMonotonicTimestamp() - start);
+        return nil;
+    }];
+}
+
+- (BFTask *)processNextDocument {
+    @synchronized (self) {
+        if (_remainingDocuments == 0) {
+            return [BFTask taskWithResult:nil];
+        }
+        _remainingDocuments--;
+    }
+    NSTimeInterval start = GINIMonotonicTimestamp();
+    BFTask *documentTask = [[_documentTaskManager createDocumentWithFilename:@"yoda.jpg" fromData:_data docType:nil] continueWithSuccessBlock:^id(BFTask *task) {
+        return [self->_documentTaskManager getExtractionsForDocument:task.result];
+    }];
+    return [documentTask continueWithBlock:^id(BFTask *task) {
+        if (task.error) {
+            @synchronized (self) {
+                self->_errorCount++;
+            }
+        } else {
+            [self->_latencies recordValue:GINIMonotonicTimestamp() - start];
+        }
+        return [self processNextDocument];
+    }];
+}
+
+- (NSString *)reportWithConcurrency:(NSUInteger)concurrency {
+    return [NSString stringWithFormat:@"concurrency=%lu documents=%llu errors=%lu throughput=%.1f/s p50=%.1fms p90=%.1fms p99=%.1fms",
+            (unsigned long)concurrency, (unsigned long long)_latencies.totalCount, (unsigned long)_errorCount, _throughput,
+            [_latencies valueAtPercentile:50] * 1000, [_latencies valueAtPercentile:90] * 1000,
+            [_latencies valueAtPercentile:99] * 1000];
+}
+
+@end
+
+
+SPEC_BEGIN(GINIThroughputBenchmarkSpec)
+
+// The workloads take several seconds, so they only run on request.
+if (![[NSProcessInfo processInfo] environment][@"GINI_RUN_BENCHMARKS"]) {
+    return;
+}
+
+describe(@"The document workflow against the API stand-in", ^{
+    __block GINIAPIStandInURLSession *standIn;
+    __block GINIDocumentTaskManager *documentTaskManager;
+    __block NSData *imageData;
+
+    GINIBenchmarkWorkload *(^runWorkload)(NSUInteger, NSUInteger) = ^GINIBenchmarkWorkload *(NSUInteger documentCount, NSUInteger concurrency) {
+        GINIBenchmarkWorkload *workload = [[GINIBenchmarkWorkload alloc] initWithDocumentTaskManager:documentTaskManager data:imageData];
+        [[workload runWithDocumentCount:documentCount concurrency:concurrency] waitUntilFinished];
+        NSLog(@"GINIThroughputBenchmark: %@", [workload reportWithConcurrency:concurrency]);
+        return workload;
+    };
+
+    beforeEach(^{
+        NSURL *baseURL = [NSURL URLWithString:@"https://api.gini.net/"];
+        standIn = [GINIAPIStandInURLSession standInWithBaseURL:baseURL];
+        standIn.latency = 0.01;
+        standIn.processingDelay = 0.03;
+        standIn.bandwidth = 10 * 1024 * 1024;
+        standIn.randomSeed = 42;
+
+        GINISessionManagerMock *sessionManager = [GINISessionManagerMock sessionManagerWithAccessToken:@"1234"];
+        GINIAPIManagerRequestFactory *requestFactory = [[GINIAPIManagerRequestFactory alloc] initWithSessionManager:(GINISessionManager *)sessionManager];
+        GINIAPIManager *apiManager = [GINIAPIManager apiManagerWithURLSession:standIn requestFactory:requestFactory baseURL:baseURL];
+        documentTaskManager = [GINIDocumentTaskManager documentTaskManagerWithAPIManager:apiManager];
+        documentTaskManager.pollingInterval = 0;
+
+        NSURL *imageURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"yoda" withExtension:@"jpg"];
+        imageData = [NSData dataWithContentsOfURL:imageURL];
+    });
+
+    it(@"should process all documents at varying concurrency", ^{
+        for (NSNumber *concurrency in @[@1, @4, @16]) {
+            GINIBenchmarkWorkload *workload = runWorkload(20, [concurrency unsignedIntegerValue]);
+            [[theValue(workload.errorCount) should] equal:theValue(0)];
+            [[theValue(workload.latencies.totalCount) should] equal:theValue(20)];
+        }
+        [[theValue(standIn.documentCount) should] equal:theValue(60)];
+    });
+
+    it(@"should have a higher throughput with concurrent workers when the latency dominates", ^{
+        GINIBenchmarkWorkload *sequential = runWorkload(16, 1);
+        GINIBenchmarkWorkload *concurrent = runWorkload(16, 8);
+        [[theValue(concurrent.throughput) should] beGreaterThan:theValue(2 * sequential.throughput)];
+    });
+
+    it(@"should report the failed documents when requests fail", ^{
+        standIn.errorRate = 0.2;
+        GINIBenchmarkWorkload *workload = runWorkload(20, 4);
+        [[theValue(standIn.failedRequestCount) should] beGreaterThan:theValue(0)];
+        [[theValue(workload.errorCount) should] beGreaterThan:theValue(0)];
+        [[theValue(workload.errorCount + workload.latencies.totalCount) should] equal:theValue(20)];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINITracer.h"
+#import "GINIAPIManager.h"
+#import "GINIAPIManagerRequestFactory.h"
+#import "GINIURLSessionMock.h"
+#import "GINISessionManagerMock.h"
+
+
+SPEC_BEGIN(GINITracerSpec)
+
+describe(@"The GINITracer", ^{
+    __block GINITracer *tracer;
+
+    beforeEach(^{
+        tracer = [GINITracer new];
+    });
+
+    it(@"should create root spans with valid identifiers", ^{
+        GINISpan *span = [tracer startSpanWithName:@"foo"];
+        [[theValue([span.traceId length]) should] equal:theValue(32)];
+        [[theValue([span.spanId length]) should] equal:theValue(16)];
+        [[span.parentSpanId should] beNil];
+    });
+
+    it(@"should create child spans of the current span", ^{
+        GINISpan *parent = [tracer startSpanWithName:@"parent"];
+        GINISpan *child = GINISpanPerform(parent, ^id{
+            [[[GINISpan currentSpan] should] equal:parent];
+            return [tracer startSpanWithName:@"child"];
+        });
+        [[child.traceId should] equal:parent.traceId];
+        [[child.parentSpanId should] equal:parent.spanId];
+        [[[GINISpan currentSpan] should] beNil];
+    });
+
+    it(@"should continue the trace of a traceparent header", ^{
+        NSString *traceParent = @"00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+        GINISpan *span = [tracer startSpanWithName:@"foo" traceParent:traceParent];
+        [[span.traceId should] equal:@"0af7651916cd43dd8448eb211c80319c"];
+        [[span.parentSpanId should] equal:@"b7ad6b7169203331"];
+    });
+
+    it(@"should start a new trace for invalid traceparent headers", ^{
+        GINISpan *span = [tracer startSpanWithName:@"foo" traceParent:@"00-foo-bar-01"];
+        [[span.parentSpanId should] beNil];
+        [[theValue([span.traceId length]) should] equal:theValue(32)];
+    });
+
+    it(@"should collect finished spans only once", ^{
+        GINISpan *span = [tracer startSpanWithName:@"foo"];
+        [[theValue([tracer.finishedSpans count]) should] equal:theValue(0)];
+        [span finish];
+        [span finish];
+        [[theValue([tracer.finishedSpans count]) should] equal:theValue(1)];
+        [[theValue(span.isFinished) should] beYes];
+    });
+
+    it(@"should drop the oldest spans when there are too many", ^{
+        tracer.maximumSpanCount = 2;
+        [[tracer startSpanWithName:@"1"] finish];
+        [[tracer startSpanWithName:@"2"] finish];
+        [[tracer startSpanWithName:@"3"] finish];
+        [[[tracer.finishedSpans valueForKey:@"name"] should] equal:@[@"2", @"3"]];
+    });
+
+    it(@"should export the spans in the Zipkin format", ^{
+        GINISpan *span = [tracer startSpanWithName:@"foo"];
+        [span setTag:@"200" forKey:@"http.status_code"];
+        [span finish];
+        NSArray *exported = [NSJSONSerialization JSONObjectWithData:[tracer exportFinishedSpansRemovingThem:YES] options:0 error:nil];
+        [[theValue([exported count]) should] equal:theValue(1)];
+        [[exported[0][@"id"] should] equal:span.spanId];
+        [[exported[0][@"traceId"] should] equal:span.traceId];
+        [[exported[0][@"tags"][@"http.status_code"] should] equal:@"200"];
+        [[theValue([tracer.finishedSpans count]) should] equal:theValue(0)];
+    });
+
+    context(@"when used by the GINIAPIManager", ^{
+        __block GINIAPIManager *apiManager;
+        __block GINIURLSessionMock *urlSessionMock;
+
+        beforeEach(^{
+            GINISessionManagerMock *sessionManager = [GINISessionManagerMock sessionManagerWithAccessToken:@"1234"];
+            GINIAPIManagerRequestFactory *requestFactory = [[GINIAPIManagerRequestFactory alloc] initWithSessionManager:(GINISessionManager *)sessionManager];
+            urlSessionMock = [GINIURLSessionMock new];
+            apiManager = [[GINIAPIManager alloc] initWithURLSession:urlSessionMock requestFactory:requestFactory baseURL:[NSURL URLWithString:@"https://api.gini.net"]];
+            apiManager.tracer = tracer;
+        });
+
+        it(@"should send the trace context of the current span", ^{
+            GINISpan *operation = [tracer startSpanWithName:@"operation"];
+            GINISpanPerform(operation, ^id{
+                return [apiManager getDocument:@"Foobar"];
+            });
+            NSString *traceParent = [urlSessionMock.lastRequest valueForHTTPHeaderField:GINITraceParentHeaderField];
+            [[traceParent should] startWithString:[NSString stringWithFormat:@"00-%@-", operation.traceId]];
+        });
+
+        it(@"should record the requests as child spans", ^{
+            GINISpan *operation = [tracer startSpanWithName:@"operation"];
+            [urlSessionMock createAndSetResponse:@{} httpStatus:200 forURL:@"https://api.gini.net/documents/Foobar" error:NO];
+            GINISpanPerform(operation, ^id{
+                return [apiManager getDocument:@"Foobar"];
+            });
+            GINISpan *requestSpan = [tracer.finishedSpans firstObject];
+            [[requestSpan.name should] equal:@"GET /documents/Foobar"];
+            [[requestSpan.kind should] equal:GINISpanKindClient];
+            [[requestSpan.parentSpanId should] equal:operation.spanId];
+            [[requestSpan.tags[@"http.status_code"] should] equal:@"200"];
+        });
+
+        it(@"should not send the trace context when no tracer is set", ^{
+            apiManager.tracer = nil;
+            GINISpan *operation = [tracer startSpanWithName:@"operation"];
+            GINISpanPerform(operation, ^id{
+                return [apiManager getDocument:@"Foobar"];
+            });
+            [[[urlSessionMock.lastRequest valueForHTTPHeaderField:GINITraceParentHeaderField] should] beNil];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Kiwi/Kiwi.h>
+#import <Bolts/Bolts.h>
+#import "GINITrafficRecorder.h"
+#import "GINIReplayURLSession.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+#import "GINIHistogram.h"
+
+
+SPEC_BEGIN(GINITrafficRecorderSpec)
+
+describe(@"The GINITrafficRecorder", ^{
+    __block GINITrafficRecorder *recorder;
+
+    void (^record)(NSString *, NSString *, NSInteger, NSString *) = ^(NSString *method, NSString *url, NSInteger statusCode, NSString *body) {
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:url]];
+        request.HTTPMethod = method;
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                                                  statusCode:statusCode
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:@{@"Content-Type": @"application/json"}];
+        [recorder recordRequest:request
+                   uploadLength:0
+                 startTimestamp:GINIMonotonicTimestamp()
+                       response:response
+                           body:[body dataUsingEncoding:NSUTF8StringEncoding]
+                          error:nil];
+    };
+
+    GINIReplayURLSession *(^replaySession)(void) = ^GINIReplayURLSession *{
+        GINIReplayURLSession *session = [GINIReplayURLSession replayURLSessionWithArchiveData:[recorder archivedData] error:nil];
+        session.timeScale = 0;
+        return session;
+    };
+
+    beforeEach(^{
+        recorder = [GINITrafficRecorder new];
+    });
+
+    it(@"should count the recorded requests", ^{
+        record(@"GET", @"https://api.gini.net/documents/1234", 200, @"{}");
+        [[theValue(recorder.entryCount) should] equal:theValue(1)];
+        [recorder reset];
+        [[theValue(recorder.entryCount) should] equal:theValue(0)];
+    });
+
+    it(@"should not record the responses of the user center", ^{
+        record(@"POST", @"https://user.gini.net/oauth/token?grant_type=password", 200, @"{\"access_token\": \"SECRET-ACCESS\", \"refresh_token\": \"SECRET-REFRESH\"}");
+        record(@"GET", @"https://user.gini.net/api/users/1234", 200, @"{\"email\": \"foo@example.com\"}");
+        NSData *archive = [recorder archivedData];
+        NSString *archiveString = [[NSString alloc] initWithData:archive encoding:NSISOLatin1StringEncoding];
+        [[theValue([archiveString containsString:@"SECRET"]) should] beNo];
+        [[theValue([archiveString containsString:@"foo@example.com"]) should] beNo];
+        [[theValue(recorder.entryCount) should] equal:theValue(2)];
+    });
+
+    it(@"should record the responses of requests accepted by the filter", ^{
+        recorder.requestFilterBlock = nil;
+        record(@"POST", @"https://user.gini.net/oauth/token", 200, @"{\"access_token\": \"SECRET-ACCESS\"}");
+        NSString *archiveString = [[NSString alloc] initWithData:[recorder archivedData] encoding:NSISOLatin1StringEncoding];
+        [[theValue([archiveString containsString:@"SECRET-ACCESS"]) should] beYes];
+    });
+
+    it(@"should not record the query of the requests", ^{
+        record(@"POST", @"https://api.gini.net/documents/1234/errorreport?summary=SECRET-SUMMARY&description=foo", 200, @"{}");
+        NSString *archiveString = [[NSString alloc] initWithData:[recorder archivedData] encoding:NSISOLatin1StringEncoding];
+        [[theValue([archiveString containsString:@"SECRET-SUMMARY"]) should] beNo];
+
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234/errorreport?summary=other"]];
+        request.HTTPMethod = @"POST";
+        BFTask *task = [replaySession() BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        [[task.error should] beNil];
+    });
+
+    it(@"should replay the recorded responses in order", ^{
+        record(@"GET", @"https://api.gini.net/documents/1234", 200, @"{\"progress\": \"PENDING\"}");
+        record(@"GET", @"https://api.gini.net/documents/1234", 200, @"{\"progress\": \"COMPLETED\"}");
+        GINIReplayURLSession *session = replaySession();
+
+        NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://localhost/documents/1234"]];
+        BFTask *first = [session BFDataTaskWithRequest:request];
+        [first waitUntilFinished];
+        BFTask *second = [session BFDataTaskWithRequest:request];
+        [second waitUntilFinished];
+        [[((GINIURLResponse *)first.result).data[@"progress"] should] equal:@"PENDING"];
+        [[((GINIURLResponse *)second.result).data[@"progress"] should] equal:@"COMPLETED"];
+        [[theValue(session.remainingEntryCount) should] equal:theValue(0)];
+    });
+
+    it(@"should match requests by the method", ^{
+        record(@"DELETE", @"https://api.gini.net/documents/1234", 204, @"");
+        GINIReplayURLSession *session = replaySession();
+
+        BFTask *task = [session BFDataTaskWithRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234"]]];
+        [task waitUntilFinished];
+        [[theValue(task.error.code) should] equal:theValue(NSURLErrorResourceUnavailable)];
+        [[theValue(session.remainingEntryCount) should] equal:theValue(1)];
+    });
+
+    it(@"should replay HTTP errors", ^{
+        record(@"GET", @"https://api.gini.net/documents/1234", 404, @"{}");
+        BFTask *task = [replaySession() BFDataTaskWithRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234"]]];
+        [task waitUntilFinished];
+        [[task.error should] beKindOfClass:[GINIHTTPError class]];
+    });
+
+    it(@"should replay connection errors", ^{
+        NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents"]];
+        [recorder recordRequest:request
+                   uploadLength:0
+                 startTimestamp:GINIMonotonicTimestamp()
+                       response:nil
+                           body:nil
+                          error:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil]];
+        BFTask *task = [replaySession() BFDataTaskWithRequest:request];
+        [task waitUntilFinished];
+        [[task.error.domain should] equal:NSURLErrorDomain];
+        [[theValue(task.error.code) should] equal:theValue(NSURLErrorTimedOut)];
+    });
+
+    it(@"should replay downloads into a file", ^{
+        record(@"GET", @"https://api.gini.net/documents/1234/processed", 200, @"PDF");
+        BFTask *task = [replaySession() BFDownloadTaskWithRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.gini.net/documents/1234/processed"]]];
+        [task waitUntilFinished];
+        NSURL *location = ((GINIURLResponse *)task.result).data;
+        [[[NSData dataWithContentsOfURL:location] should] equal:[@"PDF" dataUsingEncoding:NSUTF8StringEncoding]];
+    });
+
+    it(@"should reject invalid archives", ^{
+        NSError *error;
+        GINIReplayURLSession *session = [GINIReplayURLSession replayURLSessionWithArchiveData:[@"foo" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+        [[session should] beNil];
+        [[error shouldNot] beNil];
+    });
+});
+
+SPEC_END
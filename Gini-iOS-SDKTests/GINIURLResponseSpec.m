@@ -24,6 +24,62 @@ describe(@"The GINIURLResponse", ^{
         [[response.response should] equal:httpurlResponse];
         [[response.data should] equal:data];
     });
+
+    it(@"should decode the raw data on the first access", ^{
+        NSData *rawData = [@"raw" dataUsingEncoding:NSUTF8StringEncoding];
+        __block NSUInteger decodeCount = 0;
+        GINIURLResponse *response = [[GINIURLResponse alloc] initWithResponse:nil rawData:rawData decoder:^id(NSData *data, NSError **error) {
+            decodeCount++;
+            return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+        }];
+        [[response.rawData should] equal:rawData];
+        [[theValue(decodeCount) should] equal:theValue(0)];
+        [[response.data should] equal:@"raw"];
+        [[response.data should] equal:@"raw"];
+        [[response.parseError should] beNil];
+        [[theValue(decodeCount) should] equal:theValue(1)];
+    });
+
+    it(@"should decode the raw data only once when accessed from several threads", ^{
+        __block NSUInteger decodeCount = 0;
+        NSMutableArray *results = [NSMutableArray new];
+        GINIURLResponse *response = [[GINIURLResponse alloc] initWithResponse:nil rawData:[NSData new] decoder:^id(NSData *data, NSError **error) {
+            @synchronized (results) {
+                decodeCount++;
+            }
+            [NSThread sleepForTimeInterval:0.01];
+            return @{@"decoded": @YES};
+        }];
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            id data = response.data;
+            @synchronized (results) {
+                [results addObject:data];
+            }
+        });
+        [[theValue(decodeCount) should] equal:theValue(1)];
+        [[results should] haveCountOf:8];
+        for (id data in results) {
+            [[theValue(data == results[0]) should] beYes];
+        }
+    });
+
+    it(@"should fall back to the raw data and report the error if decoding fails", ^{
+        NSData *rawData = [@"{" dataUsingEncoding:NSUTF8StringEncoding];
+        GINIURLResponse *response = [[GINIURLResponse alloc] initWithResponse:nil rawData:rawData decoder:^id(NSData *data, NSError **error) {
+            return [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+        }];
+        [[response.parseError should] beKindOfClass:[NSError class]];
+        [[response.data should] equal:rawData];
+    });
+
+    it(@"should not decode the raw data once the data has been set", ^{
+        GINIURLResponse *response = [[GINIURLResponse alloc] initWithResponse:nil rawData:[NSData new] decoder:^id(NSData *data, NSError **error) {
+            fail(@"The raw data should not be decoded");
+            return nil;
+        }];
+        response.data = @"replaced";
+        [[response.data should] equal:@"replaced"];
+    });
 });
 
 SPEC_END
\ No newline at end of file
@@ -54,6 +54,33 @@ BOOL GINIIsTextContent(NSString *contentType);
 
 
 
+#pragma mark - GINIBaseURLSessionMock
+/**
+ * A session which only implements the required methods of the `GINIURLSession` protocol, like sessions of apps or the
+ * tests do. Forwards them to another session.
+ */
+@interface GINIBaseURLSessionMock : NSObject <GINIURLSession>
+@property id<GINIURLSession> urlSession;
+@end
+
+@implementation GINIBaseURLSessionMock
+
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request {
+    return [self.urlSession BFDataTaskWithRequest:request];
+}
+
+- (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
+    return [self.urlSession BFDownloadTaskWithRequest:request];
+}
+
+- (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
+    return [self.urlSession BFUploadTaskWithRequest:request fromData:uploadData];
+}
+
+@end
+
+
+
 #pragma mark - GININSURLSessionDownloadTaskMock
 @interface GININSURLSessionDownloadTaskMock : NSObject
 @property NSURL *location;
@@ -372,6 +399,28 @@ SPEC_BEGIN(GINIURLSessionSpec)
             });
         });
 
+        context(@"The GINIStreamingDataTaskWithRequest function", ^{
+            it(@"should pass the raw body of sessions without streaming support to the data block", ^{
+                GINIBaseURLSessionMock *baseSession = [GINIBaseURLSessionMock new];
+                baseSession.urlSession = giniURLSession;
+                nsURLSessionMock.response = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://api.gini.net"]
+                                                                        statusCode:200
+                                                                       HTTPVersion:@"1.1"
+                                                                      headerFields:@{@"Content-Type" : @"application/json"}];
+                NSData *body = [@"{\"foo\": \"bar\"}" dataUsingEncoding:NSUTF8StringEncoding];
+                nsURLSessionMock.data = body;
+
+                NSMutableData *streamedData = [NSMutableData new];
+                BFTask *task = GINIStreamingDataTaskWithRequest(baseSession, request, ^BOOL(NSData *data) {
+                    [streamedData appendData:data];
+                    return YES;
+                }, nil);
+                [task waitUntilFinished];
+                [[task.error should] beNil];
+                [[streamedData should] equal:body];
+            });
+        });
+
         // TODO: more tests
     });
 
@@ -11,4 +11,44 @@
  * A counter that counts how many times the `getDocument:` method has been called.
  */
 @property NSUInteger getDocumentCalled;
+
+/**
+ * A counter that counts how many times the extractions have been requested.
+ */
+@property NSUInteger getExtractionsCalled;
+
+/**
+ * A counter that counts how many times the layout has been requested.
+ */
+@property NSUInteger getLayoutCalled;
+
+/**
+ * A counter that counts how many times batch feedback has been submitted.
+ */
+@property NSUInteger submitBatchFeedbackCalled;
+
+/**
+ * The feedback of the last batch feedback submission.
+ */
+@property NSDictionary *lastBatchFeedback;
+
+/**
+ * The error batch feedback submissions fail with, or nil if they succeed. Defaults to an error.
+ */
+@property NSError *submitBatchFeedbackError;
+
+/**
+ * The error document deletions fail with, or nil if they succeed (the default).
+ */
+@property NSError *deleteDocumentError;
+
+/**
+ * The IDs of the documents whose deletion has been requested.
+ */
+@property (readonly) NSMutableArray<NSString *> *deletedDocumentIds;
+
+/**
+ * The offsets of the requested pages of the document list, which contains five documents with the IDs "doc0" to "doc4".
+ */
+@property (readonly) NSMutableArray<NSNumber *> *requestedDocumentListOffsets;
 @end
@@ -25,6 +25,9 @@
     self = [super self];
     if (self) {
         _getDocumentCalled = 0;
+        _submitBatchFeedbackError = [NSError errorWithDomain:@"mock" code:1 userInfo:nil];
+        _requestedDocumentListOffsets = [NSMutableArray new];
+        _deletedDocumentIds = [NSMutableArray new];
     }
     return self;
 }
@@ -42,6 +45,19 @@
                                     }];
 }
 
+- (BFTask *)getDocumentsWithLimit:(NSUInteger)limit offset:(NSUInteger)offset cancellationToken:(BFCancellationToken *)cancellationToken {
+    [_requestedDocumentListOffsets addObject:@(offset)];
+    NSMutableArray *documents = [NSMutableArray new];
+    for (NSUInteger i = offset; i < MIN(offset + limit, 5); i++) {
+        [documents addObject:@{
+                               @"id": [NSString stringWithFormat:@"doc%lu", (unsigned long)i],
+                               @"progress": @"COMPLETED",
+                               @"sourceClassification": @"SCANNED"
+                               }];
+    }
+    return [BFTask taskWithResult:@{@"totalCount": @5, @"documents": documents}];
+}
+
 - (BFTask *)uploadDocumentWithData:(NSData *)documentData
                        contentType:(NSString *)contentType
                           fileName:(NSString *)fileName
@@ -61,11 +77,34 @@
 }
 
 - (BFTask *)submitBatchFeedbackForDocument:(NSString *)documentId feedback:(NSDictionary *)feedback {
-    return [BFTask taskWithError:[NSError errorWithDomain:@"mock" code:1 userInfo:nil]];
+    _submitBatchFeedbackCalled += 1;
+    _lastBatchFeedback = feedback;
+    return _submitBatchFeedbackError ? [BFTask taskWithError:_submitBatchFeedbackError] : [BFTask taskWithResult:nil];
 }
 
 - (BFTask *)getExtractionsForDocument:(NSString *)documentId {
+    return [self getExtractionsForDocument:documentId cancellationToken:nil];
+}
+
+- (BFTask *)getExtractionsForDocument:(NSString *)documentId cancellationToken:(BFCancellationToken *)cancellationToken {
+    _getExtractionsCalled += 1;
     return [BFTask taskWithResult:[GINIAPIManagerMock extractionsData]];
 }
 
+- (BFTask *)getLayoutForDocument:(NSString *)documentId
+                    responseType:(GiniAPIResponseType)responseType
+               cancellationToken:(BFCancellationToken *)cancellationToken {
+    _getLayoutCalled += 1;
+    return [BFTask taskWithResult:@{@"pages": @[]}];
+}
+
+- (BFTask *)deleteDocument:(NSString *)documentId cancellationToken:(BFCancellationToken *)cancellationToken {
+    [_deletedDocumentIds addObject:documentId];
+    return _deleteDocumentError ? [BFTask taskWithError:_deleteDocumentError] : [BFTask taskWithResult:nil];
+}
+
+- (BFTask *)submitFeedbackForDocument:(NSString *)documentId label:(NSString *)label value:(NSString *)value boundingBox:(NSDictionary *)boundingBox {
+    return [BFTask taskWithResult:nil];
+}
+
 @end
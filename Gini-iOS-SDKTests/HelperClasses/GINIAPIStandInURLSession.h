@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+#import "GINIURLSession.h"
+
+
+/**
+ * The `GINIAPIStandInURLSession` implements the `<GINIURLSession>` protocol and emulates the Gini API in-process, so
+ * complete workflows (upload, polling, extractions, layout, previews, feedback and OAuth) can be run without network
+ * access.
+ *
+ * Unlike the `GINIURLSessionMock`, the stand-in keeps state: uploaded documents are stored and stay in the PENDING
+ * state for `processingDelay` seconds. Responses are delivered asynchronously after the configured latency and transfer
+ * time, and are deserialized by the same code as the responses of the real `GINIURLSession`. The response bodies are
+ * created from the fixtures in the test bundle's resources.
+ *
+ * This class is thread-safe.
+ */
+@interface GINIAPIStandInURLSession : NSObject <GINIURLSession>
+
+/**
+ * Factory to create a new stand-in which responds with the given base URL in the `Location` headers.
+ *
+ * @param baseURL       The base URL of the emulated Gini API, e.g. https://api.gini.net/.
+ */
++ (instancetype)standInWithBaseURL:(NSURL *)baseURL;
+
+/// The time in seconds an uploaded document stays in the PENDING state. Defaults to 0.
+@property NSTimeInterval processingDelay;
+
+/// The time in seconds it takes until a response starts to arrive. Defaults to 0.
+@property NSTimeInterval latency;
+
+/// The bandwidth in bytes per second used to calculate the transfer time of requests and responses. 0 (the default)
+/// means unlimited bandwidth.
+@property NSUInteger bandwidth;
+
+/// The probability (between 0 and 1) that a request fails with a HTTP 503 response. Defaults to 0.
+@property double errorRate;
+
+/// The seed of the random generator which decides which requests fail. Set it to get reproducible runs.
+@property (nonatomic) unsigned int randomSeed;
+
+/// The number of requests that were received.
+@property (readonly) NSUInteger requestCount;
+
+/// The number of requests that failed because of the `errorRate`.
+@property (readonly) NSUInteger failedRequestCount;
+
+/// The number of documents that were uploaded.
+@property (readonly) NSUInteger documentCount;
+
+@end
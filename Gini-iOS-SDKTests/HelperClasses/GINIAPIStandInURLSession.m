@@ -0,0 +1,315 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Bolts/Bolts.h>
+#import "GINIAPIStandInURLSession.h"
+#import "GINIURLResponse.h"
+#import "GINIHTTPError.h"
+#import "GINIConstants.h"
+
+
+/// Defined in GINIURLSession.m, deserializes the response exactly like the real URL session.
+void GINIParseResponse(NSData *data, NSURLResponse *response, NSError *error, BFTaskCompletionSource *completionSource);
+
+/// The document ID that is used in the document.json fixture.
+static NSString *const GINIFixtureDocumentId = @"626626a0-749f-11e2-bfd6-000000000000";
+
+
+/**
+ * A response of the stand-in before it is delivered.
+ */
+@interface GINIStandInResponse : NSObject
+@property NSInteger statusCode;
+@property NSString *contentType;
+@property NSData *body;
+@property NSDictionary *headers;
+/// If set, the response is delivered like a download: the data of the GINIURLResponse is the file URL.
+@property NSURL *fileURL;
+@end
+
+@implementation GINIStandInResponse
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode contentType:(NSString *)contentType body:(NSData *)body {
+    GINIStandInResponse *response = [self new];
+    response.statusCode = statusCode;
+    response.contentType = contentType;
+    response.body = body;
+    return response;
+}
+
++ (instancetype)JSONResponseWithStatusCode:(NSInteger)statusCode object:(id)object {
+    return [self responseWithStatusCode:statusCode
+                            contentType:GINIContentJsonV2
+                                   body:[NSJSONSerialization dataWithJSONObject:object options:0 error:nil]];
+}
+
+@end
+
+
+@implementation GINIAPIStandInURLSession {
+    NSURL *_baseURL;
+    /// Maps the document ID to the time the document was uploaded (based on the system uptime).
+    NSMutableDictionary<NSString *, NSNumber *> *_uploadTimes;
+    /// Maps the document ID to the name of the uploaded file.
+    NSMutableDictionary<NSString *, NSString *> *_fileNames;
+    /// The fixtures, keyed by file name.
+    NSMutableDictionary<NSString *, NSData *> *_fixtures;
+    NSString *_documentTemplate;
+    dispatch_queue_t _deliveryQueue;
+    unsigned int _randomState;
+    NSUInteger _requestCount;
+    NSUInteger _failedRequestCount;
+}
+
+#pragma mark - Factory
++ (instancetype)standInWithBaseURL:(NSURL *)baseURL {
+    return [[self alloc] initWithBaseURL:baseURL];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithBaseURL:(NSURL *)baseURL {
+    NSParameterAssert([baseURL isKindOfClass:[NSURL class]]);
+
+    self = [super init];
+    if (self) {
+        _baseURL = baseURL;
+        _uploadTimes = [NSMutableDictionary new];
+        _fileNames = [NSMutableDictionary new];
+        _fixtures = [NSMutableDictionary new];
+        _deliveryQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+        _randomState = 1;
+        _documentTemplate = [[NSString alloc] initWithData:[self fixture:@"document.json"] encoding:NSUTF8StringEncoding];
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (void)setRandomSeed:(unsigned int)randomSeed {
+    @synchronized (self) {
+        _randomSeed = randomSeed;
+        _randomState = randomSeed;
+    }
+}
+
+- (NSUInteger)requestCount {
+    @synchronized (self) {
+        return _requestCount;
+    }
+}
+
+- (NSUInteger)failedRequestCount {
+    @synchronized (self) {
+        return _failedRequestCount;
+    }
+}
+
+- (NSUInteger)documentCount {
+    @synchronized (self) {
+        return [_uploadTimes count];
+    }
+}
+
+#pragma mark - GINIURLSession protocol
+- (BFTask *)BFDataTaskWithRequest:(NSURLRequest *)request {
+    return [self handleRequest:request body:request.HTTPBody];
+}
+
+- (BFTask *)BFDownloadTaskWithRequest:(NSURLRequest *)request {
+    return [self handleRequest:request body:nil];
+}
+
+- (BFTask *)BFUploadTaskWithRequest:(NSURLRequest *)request fromData:(NSData *)uploadData {
+    return [self handleRequest:request body:uploadData];
+}
+
+#pragma mark - Request handling
+- (BFTask *)handleRequest:(NSURLRequest *)request body:(NSData *)body {
+    BOOL fails;
+    @synchronized (self) {
+        _requestCount++;
+        fails = self.errorRate > 0 && (double)rand_r(&_randomState) / RAND_MAX < self.errorRate;
+        if (fails) {
+            _failedRequestCount++;
+        }
+    }
+
+    GINIStandInResponse *response;
+    if (fails) {
+        response = [GINIStandInResponse JSONResponseWithStatusCode:503 object:@{@"message": @"Service Unavailable"}];
+    } else {
+        response = [self responseForRequest:request body:body];
+    }
+
+    NSTimeInterval delay = self.latency;
+    NSUInteger bandwidth = self.bandwidth;
+    if (bandwidth > 0) {
+        delay += (double)([body length] + [response.body length]) / bandwidth;
+    }
+    return [self deliverResponse:response forRequest:request afterDelay:delay];
+}
+
+- (BFTask *)deliverResponse:(GINIStandInResponse *)response forRequest:(NSURLRequest *)request afterDelay:(NSTimeInterval)delay {
+    BFTaskCompletionSource *completionSource = [BFTaskCompletionSource taskCompletionSource];
+    NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithDictionary:response.headers ?: @{}];
+    if (response.contentType) {
+        headers[@"Content-Type"] = response.contentType;
+    }
+    NSHTTPURLResponse *httpResponse = [[NSHTTPURLResponse alloc] initWithURL:request.URL
+                                                                  statusCode:response.statusCode
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:headers];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _deliveryQueue, ^{
+        if (response.fileURL && response.statusCode < 300) {
+            [completionSource setResult:[GINIURLResponse urlResponseWithResponse:httpResponse data:response.fileURL]];
+        } else {
+            GINIParseResponse(response.body, httpResponse, nil, completionSource);
+        }
+    });
+    return completionSource.task;
+}
+
+- (GINIStandInResponse *)responseForRequest:(NSURLRequest *)request body:(NSData *)body {
+    NSString *method = request.HTTPMethod ?: @"GET";
+    NSArray *path = [[request.URL.path componentsSeparatedByString:@"/"] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+    NSString *resource = [path firstObject];
+
+    if ([resource isEqualToString:@"oauth"]) {
+        return [self fixtureResponse:@"session.json"];
+    }
+    if ([resource isEqualToString:@"search"]) {
+        return [self fixtureResponse:@"search.json"];
+    }
+    if (![resource isEqualToString:@"documents"]) {
+        return [self notFound];
+    }
+
+    // The document collection.
+    if ([path count] == 1) {
+        if ([method isEqualToString:@"POST"]) {
+            return [self uploadDocumentFromRequest:request];
+        }
+        return [self fixtureResponse:@"documents.json"];
+    }
+
+    NSString *documentId = path[1];
+    NSTimeInterval uploadTime;
+    @synchronized (self) {
+        NSNumber *time = _uploadTimes[documentId];
+        if (!time) {
+            return [self notFound];
+        }
+        uploadTime = [time doubleValue];
+    }
+
+    NSString *subresource = [path count] > 2 ? path[2] : nil;
+    if (!subresource) {
+        if ([method isEqualToString:@"DELETE"]) {
+            @synchronized (self) {
+                [_uploadTimes removeObjectForKey:documentId];
+                [_fileNames removeObjectForKey:documentId];
+            }
+            return [GINIStandInResponse responseWithStatusCode:204 contentType:nil body:nil];
+        }
+        return [GINIStandInResponse JSONResponseWithStatusCode:200 object:[self documentWithId:documentId uploadTime:uploadTime]];
+    }
+    if ([subresource isEqualToString:@"extractions"]) {
+        if ([method isEqualToString:@"GET"]) {
+            return [self fixtureResponse:@"extractions.json"];
+        }
+        return [GINIStandInResponse responseWithStatusCode:204 contentType:nil body:nil];
+    }
+    if ([subresource isEqualToString:@"layout"]) {
+        NSString *accept = [request valueForHTTPHeaderField:@"Accept"];
+        if ([accept rangeOfString:@"xml"].location != NSNotFound) {
+            return [GINIStandInResponse responseWithStatusCode:200 contentType:GINIContentXmlV2 body:[self fixture:@"layout.xml"]];
+        }
+        return [self fixtureResponse:@"layout.json"];
+    }
+    if ([subresource isEqualToString:@"pages"]) {
+        if ([path count] == 5) {
+            GINIStandInResponse *response = [GINIStandInResponse responseWithStatusCode:200 contentType:@"image/jpeg" body:[self fixture:@"yoda.jpg"]];
+            response.fileURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"yoda" withExtension:@"jpg"];
+            return response;
+        }
+        return [self fixtureResponse:@"pages.json"];
+    }
+    if ([subresource isEqualToString:@"errorreport"]) {
+        return [self fixtureResponse:@"errorreport.json"];
+    }
+    return [self notFound];
+}
+
+- (GINIStandInResponse *)uploadDocumentFromRequest:(NSURLRequest *)request {
+    NSString *documentId = [[[NSUUID UUID] UUIDString] lowercaseString];
+    NSString *fileName = @"upload";
+    for (NSURLQueryItem *item in [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:YES].queryItems) {
+        if ([item.name isEqualToString:@"filename"] && item.value) {
+            fileName = item.value;
+        }
+    }
+    @synchronized (self) {
+        _uploadTimes[documentId] = @([[NSProcessInfo processInfo] systemUptime]);
+        _fileNames[documentId] = fileName;
+    }
+    NSURL *location = [NSURL URLWithString:[NSString stringWithFormat:@"documents/%@", documentId] relativeToURL:_baseURL];
+    GINIStandInResponse *response = [GINIStandInResponse responseWithStatusCode:201 contentType:nil body:nil];
+    response.headers = @{@"Location": [location absoluteString]};
+    return response;
+}
+
+- (NSDictionary *)documentWithId:(NSString *)documentId uploadTime:(NSTimeInterval)uploadTime {
+    NSString *json = [_documentTemplate stringByReplacingOccurrencesOfString:GINIFixtureDocumentId withString:documentId];
+    NSMutableDictionary *document = [NSJSONSerialization JSONObjectWithData:[json dataUsingEncoding:NSUTF8StringEncoding]
+                                                                    options:NSJSONReadingMutableContainers
+                                                                      error:nil];
+    BOOL processed = [[NSProcessInfo processInfo] systemUptime] - uploadTime >= self.processingDelay;
+    document[@"progress"] = processed ? @"COMPLETED" : @"PENDING";
+    document[@"compositeDocuments"] = @[];
+    @synchronized (self) {
+        document[@"name"] = _fileNames[documentId] ?: document[@"name"];
+    }
+    return document;
+}
+
+#pragma mark - Fixtures
+- (GINIStandInResponse *)fixtureResponse:(NSString *)name {
+    return [GINIStandInResponse responseWithStatusCode:200 contentType:GINIContentJsonV2 body:[self fixture:name]];
+}
+
+- (GINIStandInResponse *)notFound {
+    return [GINIStandInResponse JSONResponseWithStatusCode:404 object:@{@"message": @"Not Found"}];
+}
+
+- (NSData *)fixture:(NSString *)name {
+    @synchronized (_fixtures) {
+        NSData *fixture = _fixtures[name];
+        if (!fixture) {
+            NSURL *url = [[NSBundle bundleForClass:[self class]] URLForResource:[name stringByDeletingPathExtension]
+                                                                  withExtension:[name pathExtension]];
+            fixture = [NSData dataWithContentsOfURL:url];
+            if ([[name pathExtension] isEqualToString:@"json"]) {
+                fixture = [self strictJSONFromFixture:fixture];
+            }
+            _fixtures[name] = fixture ?: [NSData data];
+        }
+        return _fixtures[name];
+    }
+}
+
+/**
+ * Some fixtures contain trailing commas which NSJSONSerialization rejects. The real API never sends those, so they are
+ * removed to make the stand-in's responses valid JSON.
+ */
+- (NSData *)strictJSONFromFixture:(NSData *)fixture {
+    if (!fixture || [NSJSONSerialization JSONObjectWithData:fixture options:0 error:nil]) {
+        return fixture;
+    }
+    NSString *json = [[NSString alloc] initWithData:fixture encoding:NSUTF8StringEncoding];
+    NSRegularExpression *trailingComma = [NSRegularExpression regularExpressionWithPattern:@",(\\s*[}\\]])" options:0 error:nil];
+    json = [trailingComma stringByReplacingMatchesInString:json options:0 range:NSMakeRange(0, [json length]) withTemplate:@"$1"];
+    return [json dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@end
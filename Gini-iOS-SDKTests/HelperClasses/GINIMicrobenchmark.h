@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ * The measurements of a single operation.
+ */
+@interface GINIMicrobenchmarkResult : NSObject
+
+/// The name of the operation, also used as the key in the baseline.
+@property (readonly) NSString *name;
+
+/// The median wall clock time of one operation in seconds.
+@property (readonly) NSTimeInterval medianTime;
+
+/// The fastest wall clock time of one operation in seconds.
+@property (readonly) NSTimeInterval minimumTime;
+
+/// The number of heap blocks that were allocated by one operation and were still alive when it returned, including
+/// autoreleased objects.
+@property (readonly) int64_t allocatedBlocks;
+
+/// The number of heap bytes in use when one operation returned (again including autoreleased objects) minus the bytes
+/// in use before. This approximates the peak memory of the operation.
+@property (readonly) int64_t peakBytes;
+
+/// The measurements in the format of the baseline file.
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
+
+
+/**
+ * The `GINIMicrobenchmark` measures the time, the allocations and the memory of single operations and compares them
+ * against a stored baseline.
+ *
+ * The baseline is a JSON file with the format
+ *
+ *     {
+ *         "tolerance": {"time": 1.5, "allocatedBlocks": 1.1, "peakBytes": 1.2},
+ *         "operations": {"<name>": {"time": 0.001, "allocatedBlocks": 1000, "peakBytes": 100000}}
+ *     }
+ *
+ * where the tolerances are the factors by which an operation may be worse than the baseline. Operations without a
+ * baseline are measured, but never reported as regressions. To record a new baseline, run the benchmarks with the
+ * `GINI_BENCHMARK_BASELINE_OUTPUT` environment variable set to the path the results are written to.
+ *
+ * The benchmark specs only run if the `GINI_RUN_BENCHMARKS` environment variable is set.
+ */
+@interface GINIMicrobenchmark : NSObject
+
+/**
+ * Factory to create a new benchmark.
+ *
+ * @param baselineURL   The URL of the baseline file, or nil if there is no baseline.
+ */
++ (instancetype)benchmarkWithBaselineURL:(NSURL *)baselineURL;
+
+/// The number of timed runs of every operation. Defaults to 10.
+@property NSUInteger iterations;
+
+/// The number of untimed runs before measuring, to warm up caches. Defaults to 2.
+@property NSUInteger warmupIterations;
+
+/// All results of this benchmark, keyed by the operation name.
+@property (readonly) NSDictionary<NSString *, GINIMicrobenchmarkResult *> *results;
+
+/**
+ * Measures the given operation.
+ *
+ * @param name      The name of the operation.
+ * @param block     The operation. The returned object is kept alive until the allocations are measured, so the
+ *                  construction of the result is accounted to the operation.
+ */
+- (GINIMicrobenchmarkResult *)measure:(NSString *)name usingBlock:(id (^)(void))block;
+
+/**
+ * Returns a description for every measurement of the result that is worse than the baseline allows. The array is
+ * empty if there is no regression.
+ */
+- (NSArray<NSString *> *)regressionsOfResult:(GINIMicrobenchmarkResult *)result;
+
+/**
+ * Writes all results in the baseline format to the path in the `GINI_BENCHMARK_BASELINE_OUTPUT` environment variable.
+ * Does nothing if the variable is not set.
+ */
+- (void)writeBaselineIfRequested;
+
+@end
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2014, Gini GmbH.
+ *  All rights reserved.
+ */
+
+#import <malloc/malloc.h>
+#import "GINIMicrobenchmark.h"
+#import "GINIHistogram.h"
+
+
+@implementation GINIMicrobenchmarkResult
+
+- (instancetype)initWithName:(NSString *)name
+                  medianTime:(NSTimeInterval)medianTime
+                 minimumTime:(NSTimeInterval)minimumTime
+             allocatedBlocks:(int64_t)allocatedBlocks
+                   peakBytes:(int64_t)peakBytes {
+    self = [super init];
+    if (self) {
+        _name = name;
+        _medianTime = medianTime;
+        _minimumTime = minimumTime;
+        _allocatedBlocks = allocatedBlocks;
+        _peakBytes = peakBytes;
+    }
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    return @{@"time": @(_medianTime), @"allocatedBlocks": @(_allocatedBlocks), @"peakBytes": @(_peakBytes)};
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@: median=%.3fms min=%.3fms blocks=%lld bytes=%lld", _name,
+            _medianTime * 1000, _minimumTime * 1000, _allocatedBlocks, _peakBytes];
+}
+
+@end
+
+
+@implementation GINIMicrobenchmark {
+    NSDictionary *_baseline;
+    NSMutableDictionary<NSString *, GINIMicrobenchmarkResult *> *_results;
+}
+
+#pragma mark - Factory
++ (instancetype)benchmarkWithBaselineURL:(NSURL *)baselineURL {
+    return [[self alloc] initWithBaselineURL:baselineURL];
+}
+
+#pragma mark - Initializer
+- (instancetype)initWithBaselineURL:(NSURL *)baselineURL {
+    self = [super init];
+    if (self) {
+        NSData *baselineData = baselineURL ? [NSData dataWithContentsOfURL:baselineURL] : nil;
+        _baseline = baselineData ? [NSJSONSerialization JSONObjectWithData:baselineData options:0 error:nil] : nil;
+        _results = [NSMutableDictionary new];
+        _iterations = 10;
+        _warmupIterations = 2;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+- (NSDictionary *)results {
+    return [_results copy];
+}
+
+#pragma mark - Measuring
+- (GINIMicrobenchmarkResult *)measure:(NSString *)name usingBlock:(id (^)(void))block {
+    NSParameterAssert([name isKindOfClass:[NSString class]]);
+    NSParameterAssert(self.iterations > 0);
+
+    for (NSUInteger i = 0; i < self.warmupIterations; i++) {
+        @autoreleasepool {
+            block();
+        }
+    }
+
+    // The time is measured separately, so the statistics of the malloc zones don't add to the time.
+    NSMutableArray<NSNumber *> *times = [NSMutableArray arrayWithCapacity:self.iterations];
+    for (NSUInteger i = 0; i < self.iterations; i++) {
+        @autoreleasepool {
+            NSTimeInterval start = GINIMonotonicTimestamp();
+            id result = block();
+            [times addObject:@(GINIMonotonicTimestamp() - start)];
+            result = nil;
+        }
+    }
+    [times sortUsingSelector:@selector(compare:)];
+
+    malloc_statistics_t before, after;
+    @autoreleasepool {
+        malloc_zone_statistics(NULL, &before);
+        id result = block();
+        malloc_zone_statistics(NULL, &after);
+        result = nil;
+    }
+
+    GINIMicrobenchmarkResult *result = [[GINIMicrobenchmarkResult alloc] initWithName:name
+                                                                           medianTime:[times[[times count] / 2] doubleValue]
+                                                                          minimumTime:[[times firstObject] doubleValue]
+                                                                      allocatedBlocks:(int64_t)after.blocks_in_use - (int64_t)before.blocks_in_use
+                                                                            peakBytes:(int64_t)after.size_in_use - (int64_t)before.size_in_use];
+    _results[name] = result;
+    return result;
+}
+
+#pragma mark - Baseline
+- (NSArray<NSString *> *)regressionsOfResult:(GINIMicrobenchmarkResult *)result {
+    NSDictionary *baseline = _baseline[@"operations"][result.name];
+    if (!baseline) {
+        NSLog(@"GINIMicrobenchmark: no baseline for %@", result.name);
+        return @[];
+    }
+
+    NSMutableArray *regressions = [NSMutableArray new];
+    NSDictionary *measurements = [result dictionaryRepresentation];
+    for (NSString *key in measurements) {
+        double tolerance = [_baseline[@"tolerance"][key] doubleValue] ?: 1.0;
+        double allowed = [baseline[key] doubleValue] * tolerance;
+        if (baseline[key] && [measurements[key] doubleValue] > allowed) {
+            [regressions addObject:[NSString stringWithFormat:@"%@ %@ is %@, allowed %g", result.name, key, measurements[key], allowed]];
+        }
+    }
+    return regressions;
+}
+
+- (void)writeBaselineIfRequested {
+    NSString *path = [[NSProcessInfo processInfo] environment][@"GINI_BENCHMARK_BASELINE_OUTPUT"];
+    if (!path) {
+        return;
+    }
+    NSMutableDictionary *operations = [NSMutableDictionary new];
+    for (NSString *name in _results) {
+        operations[name] = [_results[name] dictionaryRepresentation];
+    }
+    NSDictionary *baseline = @{@"tolerance": _baseline[@"tolerance"] ?: @{}, @"operations": operations};
+    NSData *data = [NSJSONSerialization dataWithJSONObject:baseline options:NSJSONWritingPrettyPrinted error:nil];
+    [data writeToFile:path atomically:YES];
+}
+
+@end